@@ -0,0 +1,921 @@
+/* gas-bench: headless scenario benchmarks for gasManagerAnimate
+ *
+ * Usage: gas-bench [scenario [entries [frames]]]
+ *
+ * Without arguments a default matrix of scenarios and sizes is run. Every
+ * scenario runs in its own child process so that peak RSS is per scenario.
+ * Set GAS_BENCH_BATCHING to run with manager batching enabled,
+ * GAS_BENCH_PARKING to run with parking of idle animations enabled and
+ * GAS_BENCH_COMPILE to run the trees as compiled programs. Set
+ * GAS_BENCH_THREADS to a thread count, 0 meaning one per processor, to run
+ * on a threaded manager. The fireworks scenarios call into the manager from
+ * their callbacks, which threaded managers do not allow, so they ignore it.
+ * Set GAS_BENCH_DEFER_ACTIONS to defer actions and dispatch them after every
+ * frame. Set GAS_BENCH_TEMPLATES to spawn fireworks shrapnel as instances of
+ * shared templates, with its motion rounded to one of the templates. Set
+ * GAS_BENCH_DELTA to the seconds every frame advances by, in place of 1/30,
+ * to measure catching up after stalls. Set GAS_BENCH_BIND to bind crowd
+ * gestures as they are spawned, outside of the measured frame, and
+ * GAS_BENCH_LOD to have every other crowd character pose its skeleton only
+ * every fourth frame.
+ *
+ * Scenarios:
+ *   fireworks         test/manager.c rockets and shrapnel, blink ends itself
+ *   fireworks-remove  as above, but dying shrapnel calls
+ *                     gasManagerRemoveObjectAnimations like test/manager.c
+ *   fireworks-handles as above, but dying shrapnel removes its blink
+ *                     animation through its handle
+ *   pathfind          deep sequential chains of test/pathfind.c move steps
+ *   pathfind-vector   as above, each step two position vector animations
+ *   pathfind-path     as above, each route one hopping path animation
+ *   looping           nested looping trees in the style of test/looping.c
+ *   tweens            standalone X/Y/Z parallel and rotation number tweens
+ *   delays            looping hops behind long random delays, mostly idle
+ *   crowd             skinned characters, each spawning a one second model
+ *                     animation gesture once it finishes the last one
+ */
+
+#include "glhck/glhck.h"
+#include "gas.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#define FRAME_DELTA (1.0f / 30.0f)
+#define DEFAULT_FRAMES 120
+
+#define NUM_SHRAPNEL 64
+#define WIDTH 800
+#define HEIGHT 480
+
+#define PATH_DEPTH 32
+#define GRID_SIZE 8
+
+/* Allocation counting. Worker threads of threaded managers allocate too, so
+ * the counters are only touched atomically. */
+
+static unsigned long benchAllocs = 0;
+static unsigned long benchFrees = 0;
+static int benchCountAllocs = 0;
+
+#if defined(__GLIBC__)
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static void benchCountAlloc(unsigned long* counter)
+{
+  if (__atomic_load_n(&benchCountAllocs, __ATOMIC_RELAXED))
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+void* malloc(size_t size)
+{
+  benchCountAlloc(&benchAllocs);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size)
+{
+  benchCountAlloc(&benchAllocs);
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+  benchCountAlloc(&benchAllocs);
+  return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+  if (ptr)
+    benchCountAlloc(&benchFrees);
+  __libc_free(ptr);
+}
+#define BENCH_COUNTS_ALLOCS 1
+#else
+#define BENCH_COUNTS_ALLOCS 0
+#endif
+
+/* Deterministic random numbers so runs are comparable */
+
+static unsigned int benchSeed = 12345;
+
+static int benchRand()
+{
+  benchSeed = benchSeed * 1103515245u + 12345u;
+  return (benchSeed >> 16) & 0x7fff;
+}
+
+static double benchNow()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int benchCompile = 0;
+
+/* Optionally swaps a tree for its compiled program */
+static gasAnimation* benchPrepare(gasAnimation* animation)
+{
+  if (!benchCompile)
+    return animation;
+
+  gasAnimation* compiled = gasAnimationCompile(animation);
+  gasAnimationFree(animation);
+  return compiled;
+}
+
+typedef struct BenchResult
+{
+  double nanoseconds;
+  double entryFrames;
+  unsigned long allocs;
+  unsigned long frees;
+  unsigned long writes;
+  unsigned int frames;
+} BenchResult;
+
+typedef struct BenchScenario
+{
+  char const* name;
+  void (*setup)(gasManager* manager, unsigned int entries);
+  void (*frame)(gasManager* manager);
+  unsigned long (*liveEntries)();
+  void (*teardown)();
+  int threadable;
+} BenchScenario;
+
+static int benchDeferActions = 0;
+static float benchDelta = FRAME_DELTA;
+
+static void benchAnimateFrame(gasManager* manager, BenchResult* result, unsigned long entries)
+{
+  __atomic_store_n(&benchCountAllocs, 1, __ATOMIC_RELAXED);
+  double start = benchNow();
+  gasManagerAnimate(manager, benchDelta);
+  if (benchDeferActions)
+  {
+    gasManagerDispatchEvents(manager);
+  }
+  double end = benchNow();
+  __atomic_store_n(&benchCountAllocs, 0, __ATOMIC_RELAXED);
+
+  result->nanoseconds += end - start;
+  result->entryFrames += entries;
+}
+
+/* Fireworks */
+
+typedef struct Particle
+{
+  glhckObject* object;
+  char alive;
+  unsigned char color[3];
+  gasAnimationHandle blink;
+  struct Particle* next;
+} Particle;
+
+typedef struct Fireworks
+{
+  gasManager* manager;
+  Particle* particles;
+  unsigned int numParticles;
+  Particle* freeParticles;
+  Particle* dyingParticles;
+  Particle* coolingParticles;
+  unsigned int numFree;
+  unsigned long entries;
+  int removeOnDeath;
+  int removeByHandle;
+} Fireworks;
+
+static Fireworks fireworks;
+
+static Particle* fireworksTakeParticle()
+{
+  Particle* p = fireworks.freeParticles;
+  if (p)
+  {
+    fireworks.freeParticles = p->next;
+    fireworks.numFree -= 1;
+    p->alive = 1;
+  }
+  return p;
+}
+
+/* Dead particles are recycled two frames later so that animations still
+ * referring to them have seen them die before they come back to life. */
+static void fireworksKillParticle(Particle* p)
+{
+  p->alive = 0;
+  p->next = fireworks.dyingParticles;
+  fireworks.dyingParticles = p;
+}
+
+static void fireworksRecycle()
+{
+  while (fireworks.coolingParticles)
+  {
+    Particle* p = fireworks.coolingParticles;
+    fireworks.coolingParticles = p->next;
+    p->next = fireworks.freeParticles;
+    fireworks.freeParticles = p;
+    fireworks.numFree += 1;
+  }
+  fireworks.coolingParticles = fireworks.dyingParticles;
+  fireworks.dyingParticles = NULL;
+}
+
+static float fireworksBlink(glhckObject* object, float delta, void* userdata)
+{
+  (void) object;
+  Particle* p = userdata;
+  if (!p->alive && !fireworks.removeOnDeath)
+  {
+    fireworks.entries -= 1;
+    return delta > 0 ? delta : 1.0f;
+  }
+
+  p->color[0] = benchRand() % 256;
+  p->color[1] = benchRand() % 256;
+  p->color[2] = benchRand() % 256;
+  return 0;
+}
+
+static void fireworksShrapnelDie(glhckObject* object, void* userdata)
+{
+  Particle* p = userdata;
+  fireworks.entries -= 1;
+  fireworksKillParticle(p);
+
+  if (fireworks.removeOnDeath)
+  {
+    fireworks.entries -= 1;
+    if (fireworks.removeByHandle)
+      gasManagerRemoveHandle(fireworks.manager, p->blink);
+    else
+      gasManagerRemoveObjectAnimations(fireworks.manager, object);
+  }
+}
+
+/* Templates clone their action userdata for every instance, which is where
+ * an instance picks up the particle being spawned */
+#define SHRAPNEL_TEMPLATE_STEPS 8
+#define SHRAPNEL_TEMPLATE_DURATIONS 10
+
+static int benchTemplates = 0;
+static Particle* fireworksSpawning = NULL;
+static gasAnimationTemplate* shrapnelTemplates[SHRAPNEL_TEMPLATE_STEPS][SHRAPNEL_TEMPLATE_STEPS][SHRAPNEL_TEMPLATE_DURATIONS];
+
+static void* fireworksSpawningParticle(void* userdata)
+{
+  (void) userdata;
+  return fireworksSpawning;
+}
+
+static gasAnimation* fireworksShrapnelAnimation(Particle* p, float dx, float dy, float duration)
+{
+  gasAnimation* a1[] = {
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingQuadOut, dx, duration),
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadOut, dy, duration),
+  };
+
+  gasAnimation* a2[] = {
+    gasParallelAnimationNew(a1, 2),
+    gasActionNew(fireworksShrapnelDie, NULL, benchTemplates ? fireworksSpawningParticle : NULL, NULL, p)
+  };
+  return gasSequentialAnimationNew(a2, 2);
+}
+
+static gasAnimation* fireworksShrapnelInstance(Particle* p, float dx, float dy, float duration)
+{
+  int const step = 128 / SHRAPNEL_TEMPLATE_STEPS;
+  int const x = ((int) dx + 64) / step;
+  int const y = ((int) dy + 64) / step;
+  int const d = (int) ((duration - 0.25f) * 20.0f + 0.5f);
+
+  gasAnimationTemplate** animationTemplate = &shrapnelTemplates[x][y][d];
+  if (!*animationTemplate)
+  {
+    gasAnimation* animation = fireworksShrapnelAnimation(NULL, x * step - 64 + step / 2, y * step - 64 + step / 2,
+                                                         duration);
+    *animationTemplate = gasAnimationTemplateNew(animation);
+    gasAnimationFree(animation);
+  }
+
+  fireworksSpawning = p;
+  return gasAnimationTemplateInstantiate(*animationTemplate);
+}
+
+static void fireworksRocketBoom(glhckObject* object, void* userdata)
+{
+  Particle* rocket = userdata;
+  fireworks.entries -= 1;
+  fireworksKillParticle(rocket);
+
+  kmVec3 const* pos = glhckObjectGetPosition(object);
+  int n;
+  for (n = 0; n < NUM_SHRAPNEL; ++n)
+  {
+    Particle* p = fireworksTakeParticle();
+    if (!p)
+      break;
+
+    glhckObjectPosition(p->object, pos);
+    gasAnimation* a = benchTemplates
+      ? fireworksShrapnelInstance(p, benchRand() % 128 - 64, benchRand() % 128 - 64, 0.25f + (benchRand() % 10) / 20.0f)
+      : benchPrepare(fireworksShrapnelAnimation(p, benchRand() % 128 - 64, benchRand() % 128 - 64,
+                                                 0.25f + (benchRand() % 10) / 20.0f));
+    gasManagerAddAnimation(fireworks.manager, a, p->object);
+    p->blink = gasManagerAddAnimation(fireworks.manager, gasCustomAnimationNew(fireworksBlink, NULL, NULL, NULL, p),
+                                      p->object);
+    fireworks.entries += 2;
+  }
+}
+
+static gasAnimation* fireworksRocketAnimation(Particle* p, float x, float y, float dx, float dy, float duration)
+{
+  gasAnimation* a1[] = {
+    gasNumberAnimationNewFromDelta(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingQuadIn, x, dx, duration),
+    gasNumberAnimationNewFromDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingLinear, y, dy, duration),
+  };
+
+  gasAnimation* a2[] = {
+    gasParallelAnimationNew(a1, 2),
+    gasActionNew(fireworksRocketBoom, NULL, NULL, NULL, p)
+  };
+  return gasSequentialAnimationNew(a2, 2);
+}
+
+static void fireworksAddRocket()
+{
+  Particle* p = fireworksTakeParticle();
+  if (!p)
+    return;
+
+  gasAnimation* a = benchPrepare(fireworksRocketAnimation(p, benchRand() % WIDTH, HEIGHT, benchRand() % 128 - 64,
+                                             -HEIGHT/2 - benchRand() % (HEIGHT/2), 0.25f + (benchRand() % 25) / 20.0f));
+  gasManagerAddAnimation(fireworks.manager, a, p->object);
+  fireworks.entries += 1;
+}
+
+static void fireworksSetup(gasManager* manager, unsigned int entries)
+{
+  memset(&fireworks, 0, sizeof(fireworks));
+  fireworks.manager = manager;
+  fireworks.numParticles = entries;
+  fireworks.particles = calloc(entries, sizeof(Particle));
+
+  unsigned int i;
+  for (i = 0; i < entries; ++i)
+  {
+    fireworks.particles[i].object = glhckObjectNew();
+    fireworks.particles[i].next = fireworks.freeParticles;
+    fireworks.freeParticles = &fireworks.particles[i];
+  }
+  fireworks.numFree = entries;
+
+  for (i = 0; i < entries / (NUM_SHRAPNEL + 1); ++i)
+  {
+    fireworksAddRocket();
+  }
+}
+
+static void fireworksRemoveSetup(gasManager* manager, unsigned int entries)
+{
+  fireworksSetup(manager, entries);
+  fireworks.removeOnDeath = 1;
+}
+
+static void fireworksHandlesSetup(gasManager* manager, unsigned int entries)
+{
+  fireworksRemoveSetup(manager, entries);
+  fireworks.removeByHandle = 1;
+}
+
+static void fireworksFrame(gasManager* manager)
+{
+  (void) manager;
+  fireworksRecycle();
+
+  unsigned int maxRockets = fireworks.numParticles / (NUM_SHRAPNEL * 30) + 1;
+  while (maxRockets > 0 && fireworks.numFree > NUM_SHRAPNEL + 1)
+  {
+    fireworksAddRocket();
+    maxRockets -= 1;
+  }
+}
+
+static unsigned long fireworksLiveEntries()
+{
+  return fireworks.entries;
+}
+
+static void fireworksTeardown()
+{
+  unsigned int i;
+  for (i = 0; i < fireworks.numParticles; ++i)
+  {
+    glhckObjectFree(fireworks.particles[i].object);
+  }
+  free(fireworks.particles);
+
+  gasAnimationTemplate** animationTemplate = &shrapnelTemplates[0][0][0];
+  for (i = 0; i < sizeof(shrapnelTemplates) / sizeof(shrapnelTemplates[0][0][0]); ++i)
+  {
+    if (animationTemplate[i])
+    {
+      gasAnimationTemplateFree(animationTemplate[i]);
+      animationTemplate[i] = NULL;
+    }
+  }
+}
+
+/* Pathfind chains */
+
+static glhckObject** chainObjects = NULL;
+static unsigned int numChainObjects = 0;
+
+static gasAnimation* pathfindMoveStep(kmVec3 const* from, kmVec3 const* to, float duration)
+{
+  gasAnimation* x = gasNumberAnimationNewFromTo(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingLinear, from->x, to->x, duration);
+  float peak = (from->y > to->y ? from->y : to->y) + 4.0f;
+  float t = (from->y > to->y ? 0.3f : from->y < to->y ? 0.7f : 0.5f);
+  gasAnimation* ys[2] = {
+    gasNumberAnimationNewFromTo(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadOut, from->y, peak, t * duration),
+    gasNumberAnimationNewFromTo(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadIn, peak, to->y, (1.0f - t) * duration)
+  };
+  gasAnimation* y = gasSequentialAnimationNew(ys, 2);
+
+  gasAnimation* z = gasNumberAnimationNewFromTo(GAS_NUMBER_ANIMATION_TARGET_Z, gasEasingLinear, from->z, to->z, duration);
+  gasAnimation* animations[] = {x, y, z};
+  return gasParallelAnimationNew(animations, 3);
+}
+
+static gasAnimation* pathfindVectorMoveStep(kmVec3 const* from, kmVec3 const* to, float duration)
+{
+  float t = (from->y > to->y ? 0.3f : from->y < to->y ? 0.7f : 0.5f);
+  kmVec3 peak = {
+    from->x + (to->x - from->x) * t,
+    (from->y > to->y ? from->y : to->y) + 4.0f,
+    from->z + (to->z - from->z) * t
+  };
+  gasAnimation* halves[2] = {
+    gasVectorAnimationNewFromTo(GAS_VECTOR_ANIMATION_TARGET_POSITION, gasEasingQuadOut, from, &peak, t * duration),
+    gasVectorAnimationNewFromTo(GAS_VECTOR_ANIMATION_TARGET_POSITION, gasEasingQuadIn, &peak, to, (1.0f - t) * duration)
+  };
+  return gasSequentialAnimationNew(halves, 2);
+}
+
+static gasAnimation* (*pathfindStep)(kmVec3 const* from, kmVec3 const* to, float duration) = pathfindMoveStep;
+
+static void pathfindSetup(gasManager* manager, unsigned int entries)
+{
+  numChainObjects = entries;
+  chainObjects = calloc(entries, sizeof(glhckObject*));
+
+  unsigned int i;
+  for (i = 0; i < entries; ++i)
+  {
+    chainObjects[i] = glhckObjectNew();
+
+    gasAnimation* steps[PATH_DEPTH];
+    kmVec3 from = {0, 0, 0};
+    int j;
+    for (j = 0; j < PATH_DEPTH; ++j)
+    {
+      kmVec3 to = from;
+      if (benchRand() % 2)
+        to.x += (benchRand() % 2 ? 1 : -1) * GRID_SIZE;
+      else
+        to.z += (benchRand() % 2 ? 1 : -1) * GRID_SIZE;
+      to.y = (benchRand() % 4) * GRID_SIZE;
+
+      steps[j] = pathfindStep(&from, &to, 0.1f);
+      from = to;
+    }
+
+    gasAnimation* route = gasSequentialAnimationNew(steps, PATH_DEPTH);
+    gasManagerAddAnimation(manager, benchPrepare(gasAnimationLoop(route)), chainObjects[i]);
+  }
+}
+
+static void pathfindVectorSetup(gasManager* manager, unsigned int entries)
+{
+  pathfindStep = pathfindVectorMoveStep;
+  pathfindSetup(manager, entries);
+}
+
+static void pathfindPathSetup(gasManager* manager, unsigned int entries)
+{
+  numChainObjects = entries;
+  chainObjects = calloc(entries, sizeof(glhckObject*));
+
+  unsigned int i;
+  for (i = 0; i < entries; ++i)
+  {
+    chainObjects[i] = glhckObjectNew();
+
+    kmVec3 points[PATH_DEPTH + 1] = {{0, 0, 0}};
+    int j;
+    for (j = 0; j < PATH_DEPTH; ++j)
+    {
+      kmVec3 to = points[j];
+      if (benchRand() % 2)
+        to.x += (benchRand() % 2 ? 1 : -1) * GRID_SIZE;
+      else
+        to.z += (benchRand() % 2 ? 1 : -1) * GRID_SIZE;
+      to.y = (benchRand() % 4) * GRID_SIZE;
+      points[j + 1] = to;
+    }
+
+    gasAnimation* route = gasPathAnimationNew(GAS_PATH_LINEAR, gasEasingLinear, points, PATH_DEPTH + 1, 4.0f,
+                                              PATH_DEPTH * 0.1f);
+    gasManagerAddAnimation(manager, benchPrepare(gasAnimationLoop(route)), chainObjects[i]);
+  }
+}
+
+static unsigned long chainLiveEntries()
+{
+  return numChainObjects;
+}
+
+static void chainTeardown()
+{
+  unsigned int i;
+  for (i = 0; i < numChainObjects; ++i)
+  {
+    glhckObjectFree(chainObjects[i]);
+  }
+  free(chainObjects);
+}
+
+/* Looping trees */
+
+static gasAnimation* loopingCircle()
+{
+  gasAnimation* topRight[] = {
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingQuadIn, -100.0f, 0.3f),
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadOut, -100.0f, 0.3f)
+  };
+  gasAnimation* topLeft[] = {
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingQuadOut, -100.0f, 0.3f),
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadIn, 100.0f, 0.3f)
+  };
+  gasAnimation* bottomLeft[] = {
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingQuadIn, 100.0f, 0.3f),
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadOut, 100.0f, 0.3f)
+  };
+  gasAnimation* bottomRight[] = {
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingQuadOut, 100.0f, 0.3f),
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadIn, -100.0f, 0.3f)
+  };
+
+  gasAnimation* circleParts[] = {
+    gasAnimationLoopTimes(gasParallelAnimationNew(topRight, 2), 2),
+    gasAnimationLoopTimes(gasParallelAnimationNew(topLeft, 2), 2),
+    gasAnimationLoopTimes(gasParallelAnimationNew(bottomLeft, 2), 2),
+    gasAnimationLoopTimes(gasParallelAnimationNew(bottomRight, 2), 2)
+  };
+
+  return gasAnimationLoopTimes(gasSequentialAnimationNew(circleParts, 4), 3);
+}
+
+static void loopingSetup(gasManager* manager, unsigned int entries)
+{
+  numChainObjects = entries;
+  chainObjects = calloc(entries, sizeof(glhckObject*));
+
+  unsigned int i;
+  for (i = 0; i < entries; ++i)
+  {
+    chainObjects[i] = glhckObjectNew();
+
+    gasAnimation* parts[] = {
+      loopingCircle(),
+      gasAnimationLoopTimes(gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingEase, 80.0f, 0.5f), 4),
+      gasAnimationLoopTimes(gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_ROT_Z, gasEasingEaseInOut, 90.0f, 0.25f), 2)
+    };
+    gasAnimation* tree = gasSequentialAnimationNew(parts, 3);
+    gasManagerAddAnimation(manager, benchPrepare(gasAnimationLoop(tree)), chainObjects[i]);
+  }
+}
+
+/* Standalone tweens */
+
+static void tweensSetup(gasManager* manager, unsigned int entries)
+{
+  numChainObjects = entries;
+  chainObjects = calloc(entries, sizeof(glhckObject*));
+
+  unsigned int i;
+  for (i = 0; i < entries; ++i)
+  {
+    chainObjects[i] = glhckObjectNew();
+
+    float duration = 5.0f + (benchRand() % 50) / 10.0f;
+    gasAnimation* xyz[] = {
+      gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingQuadOut, benchRand() % 256 - 128, duration),
+      gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingLinear, benchRand() % 256 - 128, duration),
+      gasNumberAnimationNewTo(GAS_NUMBER_ANIMATION_TARGET_Z, gasEasingEaseInOut, benchRand() % 256 - 128, duration)
+    };
+    gasManagerAddAnimation(manager, gasParallelAnimationNew(xyz, 3), chainObjects[i]);
+    gasManagerAddAnimation(manager, gasNumberAnimationNewTo(GAS_NUMBER_ANIMATION_TARGET_ROT_Y, gasEasingQuadIn, 360.0f, duration),
+                           chainObjects[i]);
+  }
+}
+
+static unsigned long tweensLiveEntries()
+{
+  return numChainObjects * 2;
+}
+
+/* Delayed hops */
+
+static void delaysSetup(gasManager* manager, unsigned int entries)
+{
+  numChainObjects = entries;
+  chainObjects = calloc(entries, sizeof(glhckObject*));
+
+  unsigned int i;
+  for (i = 0; i < entries; ++i)
+  {
+    chainObjects[i] = glhckObjectNew();
+
+    gasAnimation* hop[] = {
+      gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadOut, 8.0f, 0.25f),
+      gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadIn, -8.0f, 0.25f)
+    };
+    gasAnimation* parts[] = {
+      gasPauseAnimationNew(2.0f + (benchRand() % 80) / 10.0f),
+      gasSequentialAnimationNew(hop, 2)
+    };
+    gasAnimation* tree = gasSequentialAnimationNew(parts, 2);
+    gasManagerAddAnimation(manager, benchPrepare(gasAnimationLoop(tree)), chainObjects[i]);
+  }
+}
+
+/* Skinned crowd */
+
+#define CROWD_ANIMATIONS 16
+#define CROWD_BONES 32
+#define CROWD_GESTURES 4
+
+static gasAnimation* crowdGestures[CROWD_GESTURES];
+static unsigned int crowdNext = 0;
+static unsigned int crowdSpawned = 0;
+static int benchBind = 0;
+static int benchLod = 0;
+
+static void crowdSetup(gasManager* manager, unsigned int entries)
+{
+  (void) manager;
+  numChainObjects = entries;
+  chainObjects = calloc(entries, sizeof(glhckObject*));
+  crowdNext = 0;
+  crowdSpawned = 0;
+  benchBind = getenv("GAS_BENCH_BIND") != NULL;
+  benchLod = getenv("GAS_BENCH_LOD") != NULL;
+
+  unsigned int i, j;
+  for (i = 0; i < CROWD_GESTURES; ++i)
+  {
+    char name[16];
+    snprintf(name, sizeof(name), "gesture%u", CROWD_ANIMATIONS - CROWD_GESTURES + i);
+    crowdGestures[i] = gasModelAnimationNew(name, 1.0f);
+  }
+
+  for (i = 0; i < entries; ++i)
+  {
+    chainObjects[i] = glhckObjectNew();
+
+    glhckAnimation* animations[CROWD_ANIMATIONS];
+    for (j = 0; j < CROWD_ANIMATIONS; ++j)
+    {
+      char name[16];
+      snprintf(name, sizeof(name), "gesture%u", j);
+      animations[j] = glhckAnimationNew();
+      glhckAnimationName(animations[j], name);
+      glhckAnimationDuration(animations[j], 2.0f);
+    }
+    glhckObjectInsertAnimations(chainObjects[i], animations, CROWD_ANIMATIONS);
+
+    glhckBone* bones[CROWD_BONES];
+    for (j = 0; j < CROWD_BONES; ++j)
+    {
+      bones[j] = glhckBoneNew();
+    }
+    glhckObjectInsertBones(chainObjects[i], bones, CROWD_BONES);
+
+    for (j = 0; j < CROWD_ANIMATIONS; ++j)
+    {
+      glhckAnimationFree(animations[j]);
+    }
+    for (j = 0; j < CROWD_BONES; ++j)
+    {
+      glhckBoneFree(bones[j]);
+    }
+  }
+}
+
+/* Gestures last 30 frames, so spawning for a thirtieth of the crowd every
+ * frame keeps every character busy */
+static void crowdFrame(gasManager* manager)
+{
+  unsigned int const spawns = (numChainObjects + 29) / 30;
+  unsigned int i;
+  for (i = 0; i < spawns; ++i)
+  {
+    glhckObject* object = chainObjects[crowdNext];
+    gasAnimation* gesture = gasAnimationClone(crowdGestures[crowdNext % CROWD_GESTURES]);
+    if (benchLod && crowdNext % 2)
+    {
+      gasModelAnimationUpdateRate(gesture, 4, 0.0f);
+    }
+    if (benchBind)
+    {
+      gasModelAnimationBind(gesture, object);
+    }
+    gasManagerAddAnimation(manager, benchPrepare(gesture), object);
+    crowdNext = (crowdNext + 1) % numChainObjects;
+    crowdSpawned += crowdSpawned < numChainObjects;
+  }
+}
+
+static unsigned long crowdLiveEntries()
+{
+  return crowdSpawned;
+}
+
+static void crowdTeardown()
+{
+  unsigned int i;
+  for (i = 0; i < CROWD_GESTURES; ++i)
+  {
+    gasAnimationFree(crowdGestures[i]);
+  }
+  chainTeardown();
+  gasModelAnimationClearCache();
+}
+
+static BenchScenario const SCENARIOS[] = {
+  { "tweens", tweensSetup, NULL, tweensLiveEntries, chainTeardown, 1 },
+  { "fireworks", fireworksSetup, fireworksFrame, fireworksLiveEntries, fireworksTeardown, 0 },
+  { "fireworks-remove", fireworksRemoveSetup, fireworksFrame, fireworksLiveEntries, fireworksTeardown, 0 },
+  { "fireworks-handles", fireworksHandlesSetup, fireworksFrame, fireworksLiveEntries, fireworksTeardown, 0 },
+  { "pathfind", pathfindSetup, NULL, chainLiveEntries, chainTeardown, 1 },
+  { "pathfind-vector", pathfindVectorSetup, NULL, chainLiveEntries, chainTeardown, 1 },
+  { "pathfind-path", pathfindPathSetup, NULL, chainLiveEntries, chainTeardown, 1 },
+  { "looping", loopingSetup, NULL, chainLiveEntries, chainTeardown, 1 },
+  { "delays", delaysSetup, NULL, chainLiveEntries, chainTeardown, 1 },
+  { "crowd", crowdSetup, crowdFrame, crowdLiveEntries, crowdTeardown, 1 },
+};
+
+#define NUM_SCENARIOS (sizeof(SCENARIOS) / sizeof(SCENARIOS[0]))
+
+static void benchRun(BenchScenario const* scenario, unsigned int entries, unsigned int frames)
+{
+  BenchResult result;
+  memset(&result, 0, sizeof(result));
+  result.frames = frames;
+
+  char const* threads = getenv("GAS_BENCH_THREADS");
+  gasManager* manager = threads && scenario->threadable
+    ? gasManagerNewThreaded((unsigned int) strtoul(threads, NULL, 10)) : gasManagerNew();
+  benchCompile = getenv("GAS_BENCH_COMPILE") != NULL;
+  benchTemplates = getenv("GAS_BENCH_TEMPLATES") != NULL;
+  benchDeferActions = getenv("GAS_BENCH_DEFER_ACTIONS") != NULL;
+  benchDelta = getenv("GAS_BENCH_DELTA") ? strtof(getenv("GAS_BENCH_DELTA"), NULL) : FRAME_DELTA;
+  gasManagerDeferActions(manager, benchDeferActions ? GAS_TRUE : GAS_FALSE);
+  if (getenv("GAS_BENCH_BATCHING"))
+  {
+    gasManagerBatching(manager, GAS_TRUE);
+  }
+  if (getenv("GAS_BENCH_PARKING"))
+  {
+    gasManagerParking(manager, GAS_TRUE);
+  }
+  scenario->setup(manager, entries);
+
+  /* Let newly added animations join the manager before measuring */
+  gasManagerAnimate(manager, 0.0f);
+
+  glhckStubResetStats();
+  __atomic_store_n(&benchAllocs, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&benchFrees, 0, __ATOMIC_RELAXED);
+
+  unsigned int f;
+  for (f = 0; f < frames; ++f)
+  {
+    if (scenario->frame)
+    {
+      scenario->frame(manager);
+    }
+    benchAnimateFrame(manager, &result, scenario->liveEntries());
+  }
+
+  glhckStubStats stats;
+  glhckStubGetStats(&stats);
+  result.allocs = __atomic_load_n(&benchAllocs, __ATOMIC_RELAXED);
+  result.frees = __atomic_load_n(&benchFrees, __ATOMIC_RELAXED);
+  result.writes = stats.positionWrites + stats.rotationWrites + stats.scaleWrites;
+
+  gasManagerFree(manager);
+  scenario->teardown();
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  printf("%-18s %9u %7u %15.2f", scenario->name, entries, frames,
+         result.entryFrames > 0 ? result.nanoseconds / result.entryFrames : 0.0);
+  if (BENCH_COUNTS_ALLOCS)
+  {
+    printf(" %13.1f %13.1f", (double) result.allocs / frames, (double) result.frees / frames);
+  }
+  else
+  {
+    printf(" %13s %13s", "n/a", "n/a");
+  }
+  printf(" %13.1f %13ld\n", (double) result.writes / frames, usage.ru_maxrss);
+  fflush(stdout);
+}
+
+static int benchRunIsolated(BenchScenario const* scenario, unsigned int entries, unsigned int frames)
+{
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0)
+  {
+    benchRun(scenario, entries, frames);
+    exit(EXIT_SUCCESS);
+  }
+  else if (pid < 0)
+  {
+    benchRun(scenario, entries, frames);
+    return 1;
+  }
+
+  int status;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+static BenchScenario const* benchFindScenario(char const* name)
+{
+  unsigned int i;
+  for (i = 0; i < NUM_SCENARIOS; ++i)
+  {
+    if (strcmp(SCENARIOS[i].name, name) == 0)
+      return &SCENARIOS[i];
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  printf("%-18s %9s %7s %15s %13s %13s %13s %13s\n", "scenario", "entries", "frames",
+         "ns/entry/frame", "allocs/frame", "frees/frame", "writes/frame", "peak RSS KiB");
+
+  if (argc > 1)
+  {
+    BenchScenario const* scenario = benchFindScenario(argv[1]);
+    if (!scenario)
+    {
+      fprintf(stderr, "Unknown scenario '%s'\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+
+    unsigned int entries = argc > 2 ? strtoul(argv[2], NULL, 10) : 10000;
+    unsigned int frames = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_FRAMES;
+    return benchRunIsolated(scenario, entries, frames) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  int ok = 1;
+  ok &= benchRunIsolated(benchFindScenario("fireworks"), 10000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("fireworks"), 100000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("fireworks"), 1000000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("fireworks-remove"), 10000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("fireworks-handles"), 10000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("pathfind"), 1000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("pathfind"), 10000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("pathfind-vector"), 10000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("pathfind-path"), 10000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("looping"), 10000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("looping"), 100000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("tweens"), 100000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("tweens"), 1000000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("delays"), 100000, DEFAULT_FRAMES);
+  ok &= benchRunIsolated(benchFindScenario("crowd"), 10000, DEFAULT_FRAMES);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+/* Model animation bindings and the idle animators they leave behind, on
+ * serial, batched and threaded managers */
+
+#include "check.h"
+
+#define CHECK_BINDING_OBJECTS 16
+
+static glhckObject* checkBindingObject(glhckAnimation** animations, glhckBone** bones)
+{
+  glhckObject* object = glhckObjectNew();
+  glhckObjectInsertAnimations(object, animations, 2);
+  glhckObjectInsertBones(object, bones, 2);
+  return object;
+}
+
+static unsigned long checkAnimatorsCreated()
+{
+  glhckStubStats stats;
+  glhckStubGetStats(&stats);
+  return stats.animatorsCreated;
+}
+
+static unsigned int checkBindingKind(int const kind, glhckAnimation** animations, glhckBone** skeletons)
+{
+  char const* const name = CHECK_KIND_NAMES[kind];
+  gasManager* manager = checkKindManager(kind);
+  glhckObject* objects[CHECK_BINDING_OBJECTS];
+  unsigned int failures = 0;
+  unsigned int i;
+
+  gasModelAnimationClearCache();
+  glhckStubResetStats();
+  for (i = 0; i < CHECK_BINDING_OBJECTS; ++i)
+  {
+    objects[i] = checkBindingObject(animations, skeletons + (i < CHECK_BINDING_OBJECTS / 2 ? 0 : 2));
+  }
+
+  /* Binding up front reports names the object lacks, and live bindings are
+   * never shared */
+  gasAnimation* children[2] = { gasModelAnimationNew("walk", 0.5f), gasModelAnimationNew("missing", 0.5f) };
+  gasAnimation* partial = gasSequentialAnimationNew(children, 2);
+  gasAnimation* walk = gasModelAnimationNew("walk", 0.5f);
+  CHECK(failures, !gasModelAnimationBind(partial, objects[0]), "%s: binding a missing name succeeded", name);
+  CHECK(failures, gasModelAnimationBind(walk, objects[1]), "%s: binding walk failed", name);
+  CHECK(failures, checkAnimatorsCreated() == 2, "%s: two live bindings created %lu animators", name,
+        checkAnimatorsCreated());
+  gasAnimationFree(partial);
+  gasAnimationFree(walk);
+
+  /* The two idle animators go to the first skeleton, the rest are new */
+  for (i = 0; i < CHECK_BINDING_OBJECTS; ++i)
+  {
+    gasManagerAddAnimation(manager, gasModelAnimationNew("walk", 0.5f), objects[i]);
+  }
+  gasManagerAnimate(manager, 0.25f);
+  CHECK(failures, checkAnimatorsCreated() == CHECK_BINDING_OBJECTS, "%s: %d bindings created %lu animators", name,
+        CHECK_BINDING_OBJECTS, checkAnimatorsCreated());
+  gasManagerAnimate(manager, 1.0f);
+  gasManagerAnimate(manager, 0.0f);
+
+  /* Once they finish, the same animations on the same skeletons need no new
+   * animators, while other animations and cleared caches do */
+  for (i = 0; i < CHECK_BINDING_OBJECTS; ++i)
+  {
+    gasManagerAddAnimation(manager, gasModelAnimationNew("walk", 0.5f), objects[i]);
+  }
+  gasManagerAnimate(manager, 0.25f);
+  CHECK(failures, checkAnimatorsCreated() == CHECK_BINDING_OBJECTS, "%s: idle animators were not reused, %lu created",
+        name, checkAnimatorsCreated());
+  gasManagerAddAnimation(manager, gasModelAnimationNew("run", 0.5f), objects[0]);
+  gasManagerAnimate(manager, 1.0f);
+  gasManagerAnimate(manager, 0.0f);
+  CHECK(failures, checkAnimatorsCreated() == CHECK_BINDING_OBJECTS + 1, "%s: another animation created %lu animators",
+        name, checkAnimatorsCreated());
+  CHECK(failures, gasManagerGetObjectAnimations(manager, objects[0], NULL, 0) == 0,
+        "%s: model animations did not finish", name);
+
+  gasModelAnimationClearCache();
+  for (i = 0; i < CHECK_BINDING_OBJECTS; ++i)
+  {
+    gasManagerAddAnimation(manager, gasModelAnimationNew("walk", 0.5f), objects[i]);
+  }
+  gasManagerAnimate(manager, 0.25f);
+  CHECK(failures, checkAnimatorsCreated() == 2 * CHECK_BINDING_OBJECTS + 1,
+        "%s: a cleared cache left %lu animators created", name, checkAnimatorsCreated());
+
+  gasManagerFree(manager);
+  for (i = 0; i < CHECK_BINDING_OBJECTS; ++i)
+  {
+    glhckObjectFree(objects[i]);
+  }
+  gasModelAnimationClearCache();
+  return failures;
+}
+
+unsigned int checkBindings(unsigned int const seed)
+{
+  glhckAnimation* animations[2] = { glhckAnimationNew(), glhckAnimationNew() };
+  glhckAnimationName(animations[0], "walk");
+  glhckAnimationName(animations[1], "run");
+  glhckAnimationDuration(animations[0], 2.0f);
+  glhckAnimationDuration(animations[1], 2.0f);
+  glhckBone* skeletons[4] = { glhckBoneNew(), glhckBoneNew(), glhckBoneNew(), glhckBoneNew() };
+
+  unsigned int failures = 0;
+  int kind;
+  for (kind = 0; kind < CHECK_KINDS; ++kind)
+  {
+    failures += checkBindingKind(kind, animations, skeletons);
+  }
+
+  unsigned int i;
+  for (i = 0; i < 4; ++i)
+  {
+    glhckBoneFree(skeletons[i]);
+  }
+  glhckAnimationFree(animations[0]);
+  glhckAnimationFree(animations[1]);
+
+  (void) seed;
+  return failures;
+}
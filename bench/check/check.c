@@ -0,0 +1,192 @@
+/* gas-check: headless behaviour checks
+ *
+ * Usage: gas-check [seed [check]]
+ *
+ * Every check prints one line and the program exits with a nonzero status
+ * when any of them fails, after printing the first few differences. Random
+ * trees, tweens and deltas come from the seed, 1 by default. Without a check
+ * name all of them run. Times, values and durations are multiples of 1/64
+ * small enough that adding them up in any order gives the same float, so
+ * results are compared bit for bit unless noted otherwise.
+ *
+ * Checks:
+ *   managers  random trees and tweens on random objects advanced by random
+ *             deltas, with stalls, pauses, removals and respawns, on a
+ *             serial manager running trees and on managers running them
+ *             compiled, as template instances, batched, parked, threaded
+ *             and all of the last three at once, comparing every object
+ *             and its number of animations after every frame
+ *   easing    batch easings and baked curves against their scalar
+ *             functions, with the kernels this machine picks, easings out
+ *             of range, automatic resolutions against their error bound
+ *             and explicit ones past the largest
+ *   quaternion quaternion nlerp and normalization batches against their
+ *             scalar functions, with opposite and zero quaternions
+ *   skip      looping trees advanced in one step spanning many loops
+ *             against the same trees advanced frame by frame, and compiled
+ *             animations against trees in the same step, comparing
+ *             rotations as orientations
+ *   sample    gasAnimationSample of trees and compiled animations, and
+ *             gasAnimationTemplateSample, against playing to the same
+ *             time
+ *   handles   handles of animations removed before and after joining the
+ *             manager, paused, finished, reused and cleared, on serial,
+ *             batched and threaded managers
+ *   objects   object scoped queries, pauses and removals, also of
+ *             animations that have not joined the manager yet, on serial,
+ *             batched and threaded managers
+ *   writes    one position and one rotation write per object and frame,
+ *             with actions seeing earlier writes and keeping their own, on
+ *             serial, batched and threaded managers
+ *   events    deferred actions recorded as events in firing order,
+ *             dispatched in that order and freed after, with callbacks
+ *             adding animations and pending events dispatched by the next
+ *             frame, on serial, batched and threaded managers
+ *   bindings  model animations bound up front, with missing names, and the
+ *             idle animators of finished ones reused for the same animation
+ *             and skeleton until the cache is cleared, on serial, batched and
+ *             threaded managers
+ *   rates     model animations posing at their update rate, set before and
+ *             while playing, as trees and compiled, with the final pose kept
+ *             and steps not moving the play time skipped, on serial, batched
+ *             and threaded managers
+ *   serial    random trees serialized, read back and played against their
+ *             source, every shorter size and changed byte of the first few,
+ *             node counts past the data, and banks found by name, played
+ *             from their templates, truncated, out of order and with
+ *             duplicate names
+ *   parse     a text definition against the tree it describes, where malformed
+ *             ones stop, and parse caches parsing each distinct text once and
+ *             never keeping failures
+ */
+
+#include "check.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct CheckEntry
+{
+  char const* name;
+  unsigned int (*run)(unsigned int const seed);
+} CheckEntry;
+
+static CheckEntry const CHECKS[] = {
+  { "managers", checkManagers },
+  { "easing", checkEasings },
+  { "quaternion", checkQuaternions },
+  { "skip", checkSkip },
+  { "sample", checkSample },
+  { "handles", checkHandles },
+  { "objects", checkObjects },
+  { "writes", checkWrites },
+  { "events", checkEvents },
+  { "bindings", checkBindings },
+  { "rates", checkRates },
+  { "serial", checkSerial },
+  { "parse", checkParse },
+};
+
+#define NUM_CHECKS ((int) (sizeof(CHECKS) / sizeof(CHECKS[0])))
+
+unsigned int checkSeed = 1;
+
+int checkRand()
+{
+  checkSeed = checkSeed * 1103515245u + 12345u;
+  return (checkSeed >> 16) & 0x7fff;
+}
+
+int checkSameFloat(float const a, float const b)
+{
+  return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+int checkSameVec3(kmVec3 const* a, kmVec3 const* b)
+{
+  return checkSameFloat(a->x, b->x) && checkSameFloat(a->y, b->y) && checkSameFloat(a->z, b->z);
+}
+
+int checkSameObject(glhckObject* a, glhckObject* b)
+{
+  return checkSameVec3(glhckObjectGetPosition(a), glhckObjectGetPosition(b))
+      && checkSameVec3(glhckObjectGetRotation(a), glhckObjectGetRotation(b))
+      && checkSameVec3(glhckObjectGetScale(a), glhckObjectGetScale(b));
+}
+
+/* Orientations are compared as quaternions, since Euler angles written
+ * after rounding differently may differ a lot for the same orientation */
+static int checkCloseRotation(kmVec3 const* a, kmVec3 const* b)
+{
+  kmQuaternion qa, qb;
+  gasQuaternionFromEuler(a, &qa);
+  gasQuaternionFromEuler(b, &qb);
+  float const sign = qa.x * qb.x + qa.y * qb.y + qa.z * qb.z + qa.w * qb.w < 0.0f ? -1.0f : 1.0f;
+  return fabsf(qa.x - sign * qb.x) < CHECK_ROTATION_TOLERANCE && fabsf(qa.y - sign * qb.y) < CHECK_ROTATION_TOLERANCE
+      && fabsf(qa.z - sign * qb.z) < CHECK_ROTATION_TOLERANCE && fabsf(qa.w - sign * qb.w) < CHECK_ROTATION_TOLERANCE;
+}
+
+/* Rotations pass through quaternions and Euler angles a different number of
+ * times depending on how far a step goes, so they are only close */
+int checkCloseObject(glhckObject* a, glhckObject* b)
+{
+  return checkSameVec3(glhckObjectGetPosition(a), glhckObjectGetPosition(b))
+      && checkCloseRotation(glhckObjectGetRotation(a), glhckObjectGetRotation(b))
+      && checkSameVec3(glhckObjectGetScale(a), glhckObjectGetScale(b));
+}
+
+void checkPrintObject(char const* label, glhckObject* object)
+{
+  kmVec3 const* p = glhckObjectGetPosition(object);
+  kmVec3 const* r = glhckObjectGetRotation(object);
+  kmVec3 const* s = glhckObjectGetScale(object);
+  printf("    %-10s position %.9g %.9g %.9g rotation %.9g %.9g %.9g scale %.9g %.9g %.9g\n",
+         label, p->x, p->y, p->z, r->x, r->y, r->z, s->x, s->y, s->z);
+}
+
+void checkResetObject(glhckObject* object, unsigned int const index)
+{
+  glhckObjectPositionf(object, (float) (index % 7), (float) (index % 5) * 0.25f, 0.0f);
+  glhckObjectRotationf(object, 0.0f, (float) (index % 4) * 15.0f, 0.0f);
+  glhckObjectScalef(object, 1.0f, 1.0f, 1.0f);
+}
+
+char const* const CHECK_KIND_NAMES[CHECK_KINDS] = { "serial", "batched", "threaded" };
+
+gasManager* checkKindManager(int const kind)
+{
+  gasManager* manager = kind == 2 ? gasManagerNewThreaded(2) : gasManagerNew();
+  gasManagerBatching(manager, kind == 1 ? GAS_TRUE : GAS_FALSE);
+  return manager;
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int const seed = argc > 1 ? strtoul(argv[1], NULL, 10) : 1;
+  char const* only = argc > 2 ? argv[2] : NULL;
+  checkCurve = gasEasingBake(0.25f, 0.1f, 0.25f, 1.0f, 0);
+
+  unsigned int failures = 0;
+  int ran = 0;
+  int i;
+  for (i = 0; i < NUM_CHECKS; ++i)
+  {
+    if (only && strcmp(only, CHECKS[i].name))
+      continue;
+
+    unsigned int const checkFailures = CHECKS[i].run(seed);
+    printf("%-10s %s\n", CHECKS[i].name, checkFailures ? "FAILED" : "ok");
+    failures += checkFailures;
+    ran += 1;
+  }
+
+  gasEasingCurveFree(checkCurve);
+
+  if (!ran)
+  {
+    fprintf(stderr, "gas-check: no check named %s\n", only);
+    return EXIT_FAILURE;
+  }
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
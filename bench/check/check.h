@@ -0,0 +1,73 @@
+#ifndef GAS_CHECK_H
+#define GAS_CHECK_H
+
+#include "glhck/glhck.h"
+#include "gas.h"
+
+#include <stdio.h>
+
+#define CHECK_MAX_REPORTS 5
+#define CHECK_ROTATION_TOLERANCE 1e-5f
+
+/* Checks return how many failures they found, after printing the first few */
+unsigned int checkManagers(unsigned int const seed);
+unsigned int checkEasings(unsigned int const seed);
+unsigned int checkQuaternions(unsigned int const seed);
+unsigned int checkSkip(unsigned int const seed);
+unsigned int checkSample(unsigned int const seed);
+unsigned int checkHandles(unsigned int const seed);
+unsigned int checkObjects(unsigned int const seed);
+unsigned int checkWrites(unsigned int const seed);
+unsigned int checkEvents(unsigned int const seed);
+unsigned int checkBindings(unsigned int const seed);
+unsigned int checkRates(unsigned int const seed);
+unsigned int checkSerial(unsigned int const seed);
+unsigned int checkParse(unsigned int const seed);
+
+/* Deterministic random numbers so every run builds the same trees */
+extern unsigned int checkSeed;
+int checkRand();
+
+int checkSameFloat(float const a, float const b);
+int checkSameVec3(kmVec3 const* a, kmVec3 const* b);
+int checkSameObject(glhckObject* a, glhckObject* b);
+int checkCloseObject(glhckObject* a, glhckObject* b);
+void checkPrintObject(char const* label, glhckObject* object);
+void checkResetObject(glhckObject* object, unsigned int const index);
+
+/* Serial, batched and threaded managers, for checks that should hold on
+ * every kind */
+#define CHECK_KINDS 3
+extern char const* const CHECK_KIND_NAMES[CHECK_KINDS];
+gasManager* checkKindManager(int const kind);
+
+/* Counts failures of cond, printing the first few with their message */
+#define CHECK(failures, cond, ...) \
+  do { if (!(cond) && (failures)++ < CHECK_MAX_REPORTS) { printf("  "); printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+/* Random animations. Values and durations are multiples of 1/64 and 1/8
+ * small enough that adding them up in any order gives the same float. */
+
+/* Channels an animation may write. Parallel children get channels of their
+ * own while checkDisjoint is set, as only then do big steps and sampling
+ * give the same results as small steps. Actions count in the Z scale, so
+ * trees that skip loops leave scale animations out when they have any. */
+#define CHECK_X (1 << GAS_NUMBER_ANIMATION_TARGET_X)
+#define CHECK_ROT_X (1 << GAS_NUMBER_ANIMATION_TARGET_ROT_X)
+#define CHECK_POSITION (7 * CHECK_X)
+#define CHECK_ROTATION (7 * CHECK_ROT_X)
+#define CHECK_SCALE (1 << 6)
+#define CHECK_ACTIONS (1 << 7)
+#define CHECK_CHANNELS (CHECK_POSITION | CHECK_ROTATION | CHECK_SCALE | CHECK_ACTIONS)
+
+extern gasEasingCurve* checkCurve;
+extern int checkInstant;
+extern int checkDisjoint;
+
+void checkAction(glhckObject* object, void* userdata);
+gasAnimation* checkNumber(unsigned int const channels);
+gasAnimation* checkTree(unsigned int const depth, unsigned int const channels);
+gasAnimation* checkTimedTree(unsigned int const channels);
+gasAnimation* checkSpawn();
+
+#endif // GAS_CHECK_H
@@ -0,0 +1,173 @@
+/* Batch easings and baked curves against their scalar functions, with the
+ * kernels this machine picks, and the error bound of automatic resolutions */
+
+#include "check.h"
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#define CHECK_INPUTS 1027
+
+typedef struct CheckEasing
+{
+  char const* name;
+  gasEasingId easing;
+  float (*scalar)(float);
+} CheckEasing;
+
+static CheckEasing const EASINGS[] = {
+  { "Linear", GAS_EASING_LINEAR, gasEasingLinear },
+  { "QuadIn", GAS_EASING_QUAD_IN, gasEasingQuadIn },
+  { "QuadOut", GAS_EASING_QUAD_OUT, gasEasingQuadOut },
+  { "Ease", GAS_EASING_EASE, gasEasingEase },
+  { "EaseIn", GAS_EASING_EASE_IN, gasEasingEaseIn },
+  { "EaseOut", GAS_EASING_EASE_OUT, gasEasingEaseOut },
+  { "EaseInOut", GAS_EASING_EASE_IN_OUT, gasEasingEaseInOut },
+};
+
+#define NUM_EASINGS ((int) (sizeof(EASINGS) / sizeof(EASINGS[0])))
+
+static float inputs[CHECK_INPUTS];
+static float outputs[CHECK_INPUTS];
+
+/* Odd lengths and offsets reach the scalar tails and unaligned loads of the
+ * vector kernels */
+static unsigned int checkEasingBatch(char const* name, gasEasingId const easing, float (*scalar)(float),
+                                     gasEasingCurve const* curve)
+{
+  unsigned int failures = 0;
+  unsigned int offset, n, i;
+  for (offset = 0; offset < 4; ++offset)
+  {
+    for (n = 0; n + offset <= CHECK_INPUTS; n = n < 40 ? n + 1 : CHECK_INPUTS - offset)
+    {
+      if (curve)
+        gasEasingCurveEvaluateBatch(curve, inputs + offset, outputs, n);
+      else
+        gasEasingEvaluateBatch(easing, inputs + offset, outputs, n);
+
+      for (i = 0; i < n; ++i)
+      {
+        float const expected = curve ? gasEasingCurveEvaluate(curve, inputs[offset + i]) : scalar(inputs[offset + i]);
+        if (!checkSameFloat(outputs[i], expected) && failures++ < CHECK_MAX_REPORTS)
+        {
+          printf("  %s at %.9g: batch %.9g, scalar %.9g\n", name, inputs[offset + i], outputs[i], expected);
+        }
+      }
+
+      if (n == CHECK_INPUTS - offset)
+        break;
+    }
+  }
+
+  memcpy(outputs, inputs, sizeof(inputs));
+  if (curve)
+    gasEasingCurveEvaluateBatch(curve, outputs, outputs, CHECK_INPUTS);
+  else
+    gasEasingEvaluateBatch(easing, outputs, outputs, CHECK_INPUTS);
+
+  for (i = 0; i < CHECK_INPUTS; ++i)
+  {
+    float const expected = curve ? gasEasingCurveEvaluate(curve, inputs[i]) : scalar(inputs[i]);
+    if (!checkSameFloat(outputs[i], expected) && failures++ < CHECK_MAX_REPORTS)
+    {
+      printf("  %s in place at %.9g: batch %.9g, scalar %.9g\n", name, inputs[i], outputs[i], expected);
+    }
+  }
+
+  return failures;
+}
+
+/* Easings past the last one leave the output alone */
+static unsigned int checkEasingRange()
+{
+  unsigned int failures = 0;
+  memcpy(outputs, inputs, sizeof(inputs));
+  gasEasingEvaluateBatch((gasEasingId) (GAS_EASING_EASE_IN_OUT + 1), inputs, outputs, CHECK_INPUTS);
+  gasEasingEvaluateBatch((gasEasingId) -1, inputs, outputs, CHECK_INPUTS);
+  CHECK(failures, memcmp(outputs, inputs, sizeof(inputs)) == 0, "out of range easings wrote their output");
+  return failures;
+}
+
+static float checkEasingStep(float t)
+{
+  return t < 0.5f ? 0.0f : 1.0f;
+}
+
+/* Automatic resolutions meet the bound against the scalar bezier or give up
+ * with NULL, and explicit ones are clamped */
+static unsigned int checkEasingBounds()
+{
+  static float const BEZIERS[][4] = {
+    { 0.25f, 0.1f, 0.25f, 1.0f },
+    { 0.42f, 0.0f, 0.58f, 1.0f },
+    { 0.3f, -0.2f, 0.6f, 1.3f },
+    { 0.9f, 0.05f, 0.1f, 0.95f },
+  };
+  unsigned int failures = 0;
+  unsigned int b, i;
+  for (b = 0; b < sizeof(BEZIERS) / sizeof(BEZIERS[0]); ++b)
+  {
+    float const* p = BEZIERS[b];
+    gasEasingCurve* curve = gasEasingBake(p[0], p[1], p[2], p[3], 0);
+    CHECK(failures, curve, "bezier %u did not bake", b);
+    if (!curve)
+      continue;
+
+    unsigned int const resolution = gasEasingCurveResolution(curve);
+    CHECK(failures, gasEasingCurveError(curve) <= 1e-5f && resolution <= 65536 && !(resolution & (resolution - 1)),
+          "bezier %u baked at %u with error %g", b, resolution, gasEasingCurveError(curve));
+    for (i = 0; i < CHECK_INPUTS; ++i)
+    {
+      float const error = fabsf(gasEasingCurveEvaluate(curve, inputs[i])
+                                - gasEasingCubicBezier(inputs[i], p[0], p[1], p[2], p[3]));
+      CHECK(failures, error <= 2e-5f, "bezier %u at %.9g is off by %g", b, inputs[i], error);
+    }
+    gasEasingCurveFree(curve);
+  }
+
+  gasEasingCurve* steep = gasEasingBake(0.0f, 1.0f, 0.0f, 1.0f, 0);
+  gasEasingCurve* step = gasEasingBakeFunc(checkEasingStep, 0);
+  CHECK(failures, !steep && !step, "easings no resolution meets the bound for still baked");
+  gasEasingCurveFree(steep);
+  gasEasingCurveFree(step);
+
+  gasEasingCurve* clamped = gasEasingBakeFunc(gasEasingQuadOut, UINT_MAX);
+  CHECK(failures, gasEasingCurveResolution(clamped) == 65536, "a resolution of UINT_MAX baked at %u",
+        gasEasingCurveResolution(clamped));
+  CHECK(failures, gasEasingCurveEvaluate(clamped, 1.0f) == 1.0f, "a clamped curve ends at %g",
+        gasEasingCurveEvaluate(clamped, 1.0f));
+  gasEasingCurveFree(clamped);
+
+  return failures;
+}
+
+unsigned int checkEasings(unsigned int const seed)
+{
+  unsigned int i;
+  for (i = 0; i < CHECK_INPUTS; ++i)
+  {
+    inputs[i] = (float) i / (CHECK_INPUTS - 1);
+  }
+
+  unsigned int failures = 0;
+  int e;
+  for (e = 0; e < NUM_EASINGS; ++e)
+  {
+    failures += checkEasingBatch(EASINGS[e].name, EASINGS[e].easing, EASINGS[e].scalar, NULL);
+  }
+
+  gasEasingCurve* bakedAuto = gasEasingBake(0.3f, -0.2f, 0.6f, 1.3f, 0);
+  gasEasingCurve* bakedCoarse = gasEasingBakeFunc(gasEasingQuadOut, 7);
+  failures += checkEasingBatch("baked curve", GAS_EASING_LINEAR, NULL, bakedAuto);
+  failures += checkEasingBatch("coarse curve", GAS_EASING_LINEAR, NULL, bakedCoarse);
+  gasEasingCurveFree(bakedAuto);
+  gasEasingCurveFree(bakedCoarse);
+
+  failures += checkEasingRange();
+  failures += checkEasingBounds();
+
+  (void) seed;
+  return failures;
+}
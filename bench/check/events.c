@@ -0,0 +1,146 @@
+/* Deferred actions recorded as events and dispatched in firing order */
+
+#include "check.h"
+
+#define CHECK_EVENT_OBJECTS 64
+#define CHECK_EVENTS (2 * CHECK_EVENT_OBJECTS + 1)
+
+typedef struct CheckEventData
+{
+  unsigned int object;
+  unsigned int which;
+  int freed;
+} CheckEventData;
+
+static gasManager* eventManager;
+static glhckObject* eventObjects[CHECK_EVENT_OBJECTS];
+static CheckEventData eventData[CHECK_EVENT_OBJECTS][2];
+static CheckEventData lateData;
+static CheckEventData const* eventLog[CHECK_EVENTS];
+static unsigned int numLogged;
+
+/* The second action of every fourth object starts another animation on it,
+ * which dispatched callbacks are allowed to */
+static void checkEventAction(glhckObject* object, void* userdata)
+{
+  CheckEventData const* data = userdata;
+  if (numLogged < CHECK_EVENTS)
+    eventLog[numLogged++] = data;
+  if (data->which == 1 && data->object % 4 == 0)
+    gasManagerAddAnimation(eventManager, gasNumberAnimationNewTo(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingLinear,
+                                                                 9.0f, 0.25f), object);
+}
+
+static void checkEventFree(void* userdata)
+{
+  ((CheckEventData*) userdata)->freed = 1;
+}
+
+static gasAnimation* checkEventAnimation(unsigned int const i)
+{
+  eventData[i][0].object = eventData[i][1].object = i;
+  eventData[i][0].which = 0;
+  eventData[i][1].which = 1;
+  eventData[i][0].freed = eventData[i][1].freed = 0;
+  gasAnimation* children[4] = {
+    gasPauseAnimationNew((float) (i % 8) / 16.0f),
+    gasActionNew(checkEventAction, NULL, NULL, checkEventFree, &eventData[i][0]),
+    gasPauseAnimationNew((float) (i % 3) / 16.0f),
+    gasActionNew(checkEventAction, NULL, NULL, checkEventFree, &eventData[i][1])
+  };
+  return gasSequentialAnimationNew(children, 4);
+}
+
+static unsigned int checkEventKind(int const kind)
+{
+  static gasEvent events[CHECK_EVENTS];
+  static gasAnimation* animations[CHECK_EVENT_OBJECTS];
+  char const* const name = CHECK_KIND_NAMES[kind];
+  unsigned int failures = 0;
+  unsigned int i;
+
+  eventManager = checkKindManager(kind);
+  gasManagerDeferActions(eventManager, GAS_TRUE);
+  numLogged = 0;
+  for (i = 0; i < CHECK_EVENT_OBJECTS; ++i)
+  {
+    eventObjects[i] = glhckObjectNew();
+    animations[i] = checkEventAnimation(i);
+    gasManagerAddAnimation(eventManager, animations[i], eventObjects[i]);
+  }
+
+  gasManagerAnimate(eventManager, 1.0f);
+  CHECK(failures, numLogged == 0, "%s: %u actions ran inside gasManagerAnimate", name, numLogged);
+
+  unsigned int const numEvents = gasManagerGetEvents(eventManager, events, CHECK_EVENTS);
+  CHECK(failures, numEvents == 2 * CHECK_EVENT_OBJECTS, "%s: %u events pending instead of %d", name, numEvents,
+        2 * CHECK_EVENT_OBJECTS);
+  for (i = 0; i < numEvents && i < CHECK_EVENTS; ++i)
+  {
+    CheckEventData const* data = events[i].userdata;
+    unsigned int const o = data->object;
+    float const expected = (float) (o % 8) / 16.0f + (data->which ? (float) (o % 3) / 16.0f : 0.0f);
+    CHECK(failures, events[i].animation == animations[o] && events[i].object == eventObjects[o]
+          && events[i].callback == checkEventAction, "%s: event %u does not name its animation and object", name, i);
+    CHECK(failures, events[i].time == expected, "%s: event %u fired at %g instead of %g", name, i, events[i].time,
+          expected);
+    CHECK(failures, i == 0 || events[i - 1].time <= events[i].time, "%s: event %u fired before the one ahead of it",
+          name, i);
+  }
+  for (i = 0; i < CHECK_EVENT_OBJECTS; ++i)
+  {
+    CHECK(failures, !eventData[i][0].freed && !eventData[i][1].freed,
+          "%s: object %u animation was freed before its events were dispatched", name, i);
+  }
+
+  unsigned int const dispatched = gasManagerDispatchEvents(eventManager);
+  CHECK(failures, dispatched == numEvents && numLogged == numEvents, "%s: dispatched %u events and ran %u of %u",
+        name, dispatched, numLogged, numEvents);
+  for (i = 0; i < numLogged && i < numEvents; ++i)
+  {
+    CHECK(failures, eventLog[i] == events[i].userdata, "%s: event %u was dispatched out of order", name, i);
+  }
+  for (i = 0; i < CHECK_EVENT_OBJECTS; ++i)
+  {
+    CHECK(failures, eventData[i][0].freed && eventData[i][1].freed,
+          "%s: object %u animation was not freed once its events were dispatched", name, i);
+  }
+  CHECK(failures, gasManagerGetEvents(eventManager, events, CHECK_EVENTS) == 0, "%s: events left after dispatch",
+        name);
+
+  /* Animations added by dispatched callbacks run from the next frame, and
+   * events left pending are dispatched before it */
+  lateData.object = 1;
+  lateData.which = 0;
+  gasManagerAddAnimation(eventManager, gasActionNew(checkEventAction, NULL, NULL, NULL, &lateData), eventObjects[1]);
+  gasManagerAnimate(eventManager, 0.25f);
+  CHECK(failures, numLogged == numEvents, "%s: a late action ran inside gasManagerAnimate", name);
+  gasManagerAnimate(eventManager, 0.25f);
+  CHECK(failures, numLogged == numEvents + 1 && eventLog[numEvents] == &lateData,
+        "%s: a pending event was not dispatched by the next frame", name);
+  for (i = 0; i < CHECK_EVENT_OBJECTS; ++i)
+  {
+    float const x = glhckObjectGetPosition(eventObjects[i])->x;
+    CHECK(failures, x == (i % 4 == 0 ? 9.0f : 0.0f), "%s: object %u ended at %g", name, i, x);
+  }
+
+  gasManagerFree(eventManager);
+  for (i = 0; i < CHECK_EVENT_OBJECTS; ++i)
+  {
+    glhckObjectFree(eventObjects[i]);
+  }
+  return failures;
+}
+
+unsigned int checkEvents(unsigned int const seed)
+{
+  unsigned int failures = 0;
+  int kind;
+  for (kind = 0; kind < CHECK_KINDS; ++kind)
+  {
+    failures += checkEventKind(kind);
+  }
+
+  (void) seed;
+  return failures;
+}
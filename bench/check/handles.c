@@ -0,0 +1,92 @@
+/* Generational handles on serial, batched and threaded managers */
+
+#include "check.h"
+
+static gasAnimation* checkHandleTween()
+{
+  return gasNumberAnimationNewTo(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingLinear, 4.0f, 1.0f);
+}
+
+static unsigned int checkHandleKind(int const kind)
+{
+  char const* const name = CHECK_KIND_NAMES[kind];
+  gasManager* manager = checkKindManager(kind);
+  glhckObject* object = glhckObjectNew();
+  unsigned int failures = 0;
+  gasAnimationHandle handles[2];
+
+  gasAnimationHandle const zero = { 0, 0 };
+  CHECK(failures, !gasManagerHandleValid(manager, zero), "%s: a zeroed handle is valid", name);
+
+  /* Removed while still waiting to join the manager */
+  gasAnimationHandle const removed = gasManagerAddAnimation(manager, checkHandleTween(), object);
+  CHECK(failures, gasManagerHandleValid(manager, removed), "%s: a new handle is not valid", name);
+  CHECK(failures, gasManagerRemoveHandle(manager, removed), "%s: removing a new handle failed", name);
+  CHECK(failures, !gasManagerHandleValid(manager, removed), "%s: a removed handle is still valid", name);
+  CHECK(failures, !gasManagerRemoveHandle(manager, removed), "%s: a removed handle was removed twice", name);
+  CHECK(failures, gasManagerGetHandleState(manager, removed) == GAS_ANIMATION_STATE_FINISHED,
+        "%s: a removed handle is not finished", name);
+  gasManagerAnimate(manager, 0.5f);
+  CHECK(failures, glhckObjectGetPosition(object)->x == 0.0f, "%s: a removed animation moved its object", name);
+  CHECK(failures, gasManagerGetObjectAnimations(manager, object, handles, 2) == 0,
+        "%s: a removed animation is still on its object", name);
+
+  /* Removed by pointer while still waiting to join the manager */
+  gasAnimation* animation = checkHandleTween();
+  gasAnimationHandle const pointer = gasManagerAddAnimation(manager, animation, object);
+  gasManagerRemoveAnimation(manager, animation);
+  gasManagerAnimate(manager, 0.5f);
+  CHECK(failures, !gasManagerHandleValid(manager, pointer), "%s: an animation removed by pointer is valid", name);
+  CHECK(failures, glhckObjectGetPosition(object)->x == 0.0f, "%s: an animation removed by pointer moved", name);
+
+  /* A slot reused by a later animation does not revive the old handle */
+  gasAnimationHandle const reused = gasManagerAddAnimation(manager, checkHandleTween(), object);
+  CHECK(failures, reused.index != removed.index || reused.generation != removed.generation,
+        "%s: a reused slot kept its generation", name);
+  CHECK(failures, !gasManagerHandleValid(manager, removed) && !gasManagerHandleValid(manager, pointer),
+        "%s: a reused slot revived a stale handle", name);
+
+  /* Paused, resumed and finished */
+  gasManagerAnimate(manager, 0.25f);
+  CHECK(failures, gasManagerGetHandleState(manager, reused) == GAS_ANIMATION_STATE_RUNNING,
+        "%s: a running animation reports state %d", name, gasManagerGetHandleState(manager, reused));
+  CHECK(failures, gasManagerPauseHandle(manager, reused, GAS_TRUE), "%s: pausing a handle failed", name);
+  gasManagerAnimate(manager, 0.25f);
+  CHECK(failures, glhckObjectGetPosition(object)->x == 1.0f, "%s: a paused animation moved to %g", name,
+        glhckObjectGetPosition(object)->x);
+  CHECK(failures, gasManagerPauseHandle(manager, reused, GAS_FALSE), "%s: resuming a handle failed", name);
+  gasManagerAnimate(manager, 0.25f);
+  CHECK(failures, glhckObjectGetPosition(object)->x == 2.0f, "%s: a resumed animation moved to %g", name,
+        glhckObjectGetPosition(object)->x);
+  gasManagerAnimate(manager, 1.0f);
+  gasManagerAnimate(manager, 0.0f);
+  CHECK(failures, !gasManagerHandleValid(manager, reused), "%s: a finished animation's handle is valid", name);
+  CHECK(failures, !gasManagerPauseHandle(manager, reused, GAS_TRUE), "%s: a stale handle was paused", name);
+  CHECK(failures, glhckObjectGetPosition(object)->x == 4.0f, "%s: a finished animation ended at %g", name,
+        glhckObjectGetPosition(object)->x);
+
+  /* Clearing the manager makes every handle stale */
+  handles[0] = gasManagerAddAnimation(manager, checkHandleTween(), object);
+  gasManagerAnimate(manager, 0.25f);
+  handles[1] = gasManagerAddAnimation(manager, checkHandleTween(), object);
+  gasManagerClear(manager);
+  CHECK(failures, !gasManagerHandleValid(manager, handles[0]) && !gasManagerHandleValid(manager, handles[1]),
+        "%s: handles survived gasManagerClear", name);
+
+  gasManagerFree(manager);
+  glhckObjectFree(object);
+  return failures;
+}
+
+unsigned int checkHandles(unsigned int const seed)
+{
+  unsigned int failures = 0;
+  int kind;
+  for (kind = 0; kind < CHECK_KINDS; ++kind)
+  {
+    failures += checkHandleKind(kind);
+  }
+
+  (void) seed;
+  return failures;
+}
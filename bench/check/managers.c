@@ -0,0 +1,190 @@
+/* Managers running the same random animations every way they can */
+
+#include "check.h"
+
+#include <stdlib.h>
+
+#define CHECK_OBJECTS 6000
+#define CHECK_FRAMES 240
+#define CHECK_THREADS 4
+
+typedef enum CheckForm
+{
+  CHECK_TREE,
+  CHECK_COMPILED,
+  CHECK_TEMPLATE
+} CheckForm;
+
+typedef struct CheckManager
+{
+  char const* name;
+  CheckForm form;
+  int batching;
+  int parking;
+  int threaded;
+  gasManager* manager;
+  glhckObject** objects;
+  unsigned int failures;
+} CheckManager;
+
+/* The first manager is the reference the others are compared against */
+static CheckManager managers[] = {
+  { "tree", CHECK_TREE, 0, 0, 0, NULL, NULL, 0 },
+  { "compiled", CHECK_COMPILED, 0, 0, 0, NULL, NULL, 0 },
+  { "template", CHECK_TEMPLATE, 0, 0, 0, NULL, NULL, 0 },
+  { "batched", CHECK_TREE, 1, 0, 0, NULL, NULL, 0 },
+  { "parked", CHECK_TREE, 0, 1, 0, NULL, NULL, 0 },
+  { "threaded", CHECK_TREE, 0, 0, 1, NULL, NULL, 0 },
+  { "all three", CHECK_TREE, 1, 1, 1, NULL, NULL, 0 },
+};
+
+#define NUM_MANAGERS ((int) (sizeof(managers) / sizeof(managers[0])))
+
+static gasAnimation* checkForm(gasAnimation* animation, CheckForm const form)
+{
+  gasAnimation* formed;
+  gasAnimationTemplate* animationTemplate;
+  switch (form)
+  {
+    case CHECK_COMPILED:
+      formed = gasAnimationCompile(animation);
+      gasAnimationFree(animation);
+      return formed;
+    case CHECK_TEMPLATE:
+      animationTemplate = gasAnimationTemplateNew(animation);
+      formed = gasAnimationTemplateInstantiate(animationTemplate);
+      gasAnimationTemplateFree(animationTemplate);
+      gasAnimationFree(animation);
+      return formed;
+    default:
+      return animation;
+  }
+}
+
+typedef enum CheckOperation
+{
+  CHECK_PAUSE,
+  CHECK_RESUME,
+  CHECK_REMOVE,
+  CHECK_SPAWN
+} CheckOperation;
+
+typedef struct CheckStep
+{
+  CheckOperation operation;
+  unsigned int object;
+  unsigned int seed;
+} CheckStep;
+
+static void checkApply(CheckManager* m, CheckStep const* step)
+{
+  glhckObject* object = m->objects[step->object];
+  switch (step->operation)
+  {
+    case CHECK_PAUSE: gasManagerPauseObjectAnimations(m->manager, object, GAS_TRUE); break;
+    case CHECK_RESUME: gasManagerPauseObjectAnimations(m->manager, object, GAS_FALSE); break;
+    case CHECK_REMOVE: gasManagerRemoveObjectAnimations(m->manager, object); break;
+    case CHECK_SPAWN:
+      checkSeed = step->seed;
+      gasManagerAddAnimation(m->manager, checkForm(checkSpawn(), m->form), object);
+      break;
+  }
+}
+
+/* Frames are a mix of small steps, zero steps and stalls spanning many
+ * loops. Every eighth frame pauses, resumes and removes the animations of a
+ * few objects and spawns new ones on objects left without any, so that no
+ * object ever has two animations writing the same channel. */
+unsigned int checkManagers(unsigned int const seed)
+{
+  static CheckStep steps[CHECK_OBJECTS / 32];
+  static unsigned int spawned[CHECK_OBJECTS];
+  int k;
+  unsigned int i, f;
+
+  for (k = 0; k < NUM_MANAGERS; ++k)
+  {
+    CheckManager* m = &managers[k];
+    m->manager = m->threaded ? gasManagerNewThreaded(CHECK_THREADS) : gasManagerNew();
+    gasManagerBatching(m->manager, m->batching ? GAS_TRUE : GAS_FALSE);
+    gasManagerParking(m->manager, m->parking ? GAS_TRUE : GAS_FALSE);
+    m->objects = calloc(CHECK_OBJECTS, sizeof(glhckObject*));
+    m->failures = 0;
+
+    for (i = 0; i < CHECK_OBJECTS; ++i)
+    {
+      m->objects[i] = glhckObjectNew();
+      checkResetObject(m->objects[i], i);
+      checkSeed = seed * 104729u + i;
+      gasManagerAddAnimation(m->manager, checkForm(checkSpawn(), m->form), m->objects[i]);
+    }
+  }
+
+  gasAnimationHandle handle;
+  for (f = 0; f < CHECK_FRAMES; ++f)
+  {
+    checkSeed = seed * 7919u + f;
+    int const kind = checkRand() % 16;
+    float const delta = kind == 0 ? 0.0f : kind == 1 ? 1.5f : (float) (1 + checkRand() % 6) / 64.0f;
+
+    unsigned int numSteps = 0;
+    if (f % 8 == 0)
+    {
+      for (numSteps = 0; numSteps < CHECK_OBJECTS / 32; ++numSteps)
+      {
+        CheckStep* step = &steps[numSteps];
+        step->operation = checkRand() % 4;
+        step->object = checkRand() % CHECK_OBJECTS;
+        step->seed = checkRand();
+        if (step->operation == CHECK_SPAWN
+            && (spawned[step->object] == f + 1
+                || gasManagerGetObjectAnimations(managers[0].manager, managers[0].objects[step->object], &handle, 1)))
+          step->operation = CHECK_REMOVE;
+        if (step->operation == CHECK_SPAWN)
+          spawned[step->object] = f + 1;
+      }
+    }
+
+    for (k = 0; k < NUM_MANAGERS; ++k)
+    {
+      for (i = 0; i < numSteps; ++i)
+      {
+        checkApply(&managers[k], &steps[i]);
+      }
+      gasManagerAnimate(managers[k].manager, delta);
+    }
+
+    for (k = 1; k < NUM_MANAGERS; ++k)
+    {
+      CheckManager* m = &managers[k];
+      for (i = 0; i < CHECK_OBJECTS && !m->failures; ++i)
+      {
+        unsigned int const expected = gasManagerGetObjectAnimations(managers[0].manager, managers[0].objects[i], &handle, 1);
+        unsigned int const animations = gasManagerGetObjectAnimations(m->manager, m->objects[i], &handle, 1);
+        if (!checkSameObject(m->objects[i], managers[0].objects[i]) || animations != expected)
+        {
+          m->failures += 1;
+          printf("  %s differs from %s at frame %u, object %u, %u animations instead of %u\n",
+                 m->name, managers[0].name, f, i, animations, expected);
+          checkPrintObject(managers[0].name, managers[0].objects[i]);
+          checkPrintObject(m->name, m->objects[i]);
+        }
+      }
+    }
+  }
+
+  unsigned int failures = 0;
+  for (k = 0; k < NUM_MANAGERS; ++k)
+  {
+    CheckManager* m = &managers[k];
+    failures += m->failures;
+    gasManagerFree(m->manager);
+    for (i = 0; i < CHECK_OBJECTS; ++i)
+    {
+      glhckObjectFree(m->objects[i]);
+    }
+    free(m->objects);
+  }
+
+  return failures;
+}
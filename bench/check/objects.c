@@ -0,0 +1,129 @@
+/* Object scoped queries, pauses and removals on serial, batched and
+ * threaded managers */
+
+#include "check.h"
+
+#define CHECK_OBJECT_COUNT 64
+
+/* Moves one channel of its own by one unit per second, as a tween or as a
+ * tree depending on which */
+static gasAnimation* checkObjectAnimation(unsigned int const which)
+{
+  gasNumberAnimationTarget const target = GAS_NUMBER_ANIMATION_TARGET_X + which;
+  gasAnimation* delta = gasNumberAnimationNewDelta(target, gasEasingLinear, 8.0f, 8.0f);
+  if (which % 2 == 0)
+    return delta;
+
+  gasAnimation* children[2] = { delta, gasPauseAnimationNew(1.0f) };
+  return gasSequentialAnimationNew(children, 2);
+}
+
+static float checkObjectMoved(glhckObject* object, unsigned int const index)
+{
+  kmVec3 const* position = glhckObjectGetPosition(object);
+  return position->x + position->y + position->z - (float) index;
+}
+
+static unsigned int checkObjectKind(int const kind)
+{
+  char const* const name = CHECK_KIND_NAMES[kind];
+  gasManager* manager = checkKindManager(kind);
+  glhckObject* objects[CHECK_OBJECT_COUNT];
+  gasAnimationHandle handles[CHECK_OBJECT_COUNT][2];
+  unsigned int failures = 0;
+  unsigned int i, j;
+
+  for (i = 0; i < CHECK_OBJECT_COUNT; ++i)
+  {
+    objects[i] = glhckObjectNew();
+    glhckObjectPositionf(objects[i], (float) i, 0.0f, 0.0f);
+    for (j = 0; j < i % 4; ++j)
+    {
+      gasManagerAddAnimation(manager, checkObjectAnimation(j), objects[i]);
+    }
+  }
+
+  /* Pausing takes hold of animations that have not joined the manager yet */
+  gasManagerPauseObjectAnimations(manager, objects[1], GAS_TRUE);
+  gasManagerAnimate(manager, 0.25f);
+  CHECK(failures, checkObjectMoved(objects[1], 1) == 0.0f, "%s: a new animation ran while paused", name);
+  gasManagerPauseObjectAnimations(manager, objects[1], GAS_FALSE);
+
+  for (i = 0; i < CHECK_OBJECT_COUNT; ++i)
+  {
+    unsigned int const count = gasManagerGetObjectAnimations(manager, objects[i], handles[i], 2);
+    CHECK(failures, count == i % 4, "%s: object %u has %u animations instead of %u", name, i, count, i % 4);
+    for (j = 0; j < count && j < 2; ++j)
+    {
+      CHECK(failures, gasManagerHandleValid(manager, handles[i][j]), "%s: object %u handle %u is not valid", name, i, j);
+    }
+  }
+
+  for (i = 0; i < CHECK_OBJECT_COUNT; i += 3)
+  {
+    gasManagerPauseObjectAnimations(manager, objects[i], GAS_TRUE);
+  }
+  gasManagerAnimate(manager, 0.25f);
+  for (i = 0; i < CHECK_OBJECT_COUNT; ++i)
+  {
+    float const expected = (float) (i % 4) * (i % 3 == 0 ? 0.25f : i == 1 ? 0.25f : 0.5f);
+    CHECK(failures, checkObjectMoved(objects[i], i) == expected, "%s: object %u moved %g instead of %g while others paused",
+          name, i, checkObjectMoved(objects[i], i), expected);
+  }
+
+  for (i = 0; i < CHECK_OBJECT_COUNT; i += 3)
+  {
+    gasManagerPauseObjectAnimations(manager, objects[i], GAS_FALSE);
+  }
+  for (i = 0; i < CHECK_OBJECT_COUNT; i += 5)
+  {
+    gasManagerRemoveObjectAnimations(manager, objects[i]);
+    CHECK(failures, gasManagerGetObjectAnimations(manager, objects[i], NULL, 0) == 0,
+          "%s: object %u kept animations after removing them", name, i);
+    for (j = 0; j < i % 4 && j < 2; ++j)
+    {
+      CHECK(failures, !gasManagerHandleValid(manager, handles[i][j]), "%s: object %u handle %u survived removal", name, i, j);
+    }
+  }
+
+  float moved[CHECK_OBJECT_COUNT];
+  for (i = 0; i < CHECK_OBJECT_COUNT; ++i)
+  {
+    moved[i] = checkObjectMoved(objects[i], i);
+  }
+  gasManagerAnimate(manager, 0.25f);
+  for (i = 0; i < CHECK_OBJECT_COUNT; ++i)
+  {
+    float const expected = moved[i] + (i % 5 == 0 ? 0.0f : (float) (i % 4) * 0.25f);
+    CHECK(failures, checkObjectMoved(objects[i], i) == expected, "%s: object %u moved %g instead of %g after removals",
+          name, i, checkObjectMoved(objects[i], i), expected);
+  }
+
+  /* Objects the manager never saw */
+  glhckObject* stranger = glhckObjectNew();
+  gasManagerPauseObjectAnimations(manager, stranger, GAS_TRUE);
+  gasManagerRemoveObjectAnimations(manager, stranger);
+  CHECK(failures, gasManagerGetObjectAnimations(manager, stranger, handles[0], 2) == 0,
+        "%s: an unknown object has animations", name);
+  glhckObjectFree(stranger);
+
+  gasManagerFree(manager);
+  for (i = 0; i < CHECK_OBJECT_COUNT; ++i)
+  {
+    glhckObjectFree(objects[i]);
+  }
+  return failures;
+}
+
+unsigned int checkObjects(unsigned int const seed)
+{
+  unsigned int failures = 0;
+  int kind;
+  for (kind = 0; kind < CHECK_KINDS; ++kind)
+  {
+    failures += checkObjectKind(kind);
+  }
+
+  (void) seed;
+  return failures;
+}
@@ -0,0 +1,158 @@
+/* Text definitions against the trees they describe, where malformed ones
+ * stop, and parse caches parsing each distinct text once */
+
+#include "check.h"
+
+#include <string.h>
+
+#define CHECK_PARSE_FRAMES 256
+#define CHECK_PARSE_LOADS 4
+
+typedef struct CheckParseError
+{
+  char const* source;
+  size_t offset;
+} CheckParseError;
+
+static CheckParseError const ERRORS[] = {
+  { "", 0 },
+  { "  # nothing but a comment\n", 26 },
+  { "seq(", 4 },
+  { "seq(pause(1),)", 13 },
+  { "x.to(1, 1", 9 },
+  { "x.bogus(1, 1)", 2 },
+  { "x.to(1, 1, nope)", 11 },
+  { "x.to(1, -1)", 8 },
+  { "x.keys()", 7 },
+  { "position.to([1, 2], 1)", 12 },
+  { "action(missing)", 7 },
+  { "pause(1) pause(2)", 9 },
+  { "pause(1) loop 1.5", 9 },
+  { "pause(1) loop 1e20", 9 },
+  { "pause(1) rate(1.5, 0)", 9 },
+};
+
+#define NUM_ERRORS ((int) (sizeof(ERRORS) / sizeof(ERRORS[0])))
+
+static unsigned int numClones;
+
+static void* checkParseClone(void* userdata)
+{
+  numClones += 1;
+  return userdata;
+}
+
+static unsigned int checkParseTree(gasReference const* references)
+{
+  char const* const source = "seq(x.to(4, 0.5, quadIn), pause(0.25),  # wait\n"
+                             "    par(y.delta(2, 0.5), action(count) once), seq()) loop 2";
+  gasAnimation* children[4] = {
+    gasNumberAnimationNewTo(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingQuadIn, 4.0f, 0.5f),
+    gasPauseAnimationNew(0.25f),
+    NULL,
+    gasSequentialAnimationNew(NULL, 0)
+  };
+  gasAnimation* parallel[2] = {
+    gasNumberAnimationNewDelta(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingLinear, 2.0f, 0.5f),
+    gasActionFireOnce(gasActionNew(checkAction, NULL, NULL, NULL, NULL), GAS_TRUE)
+  };
+  children[2] = gasParallelAnimationNew(parallel, 2);
+  gasAnimation* expected = gasAnimationLoopTimes(gasSequentialAnimationNew(children, 4), 2);
+
+  size_t errorOffset = 1;
+  gasAnimation* parsed = gasAnimationParse(source, strlen(source), references, 1, &errorOffset);
+  unsigned int failures = 0;
+  CHECK(failures, parsed && errorOffset == 0, "a valid definition failed at %zu", errorOffset);
+
+  glhckObject* objects[2] = { glhckObjectNew(), glhckObjectNew() };
+  unsigned int i;
+  for (i = 0; parsed && i < CHECK_PARSE_FRAMES; ++i)
+  {
+    gasAnimate(expected, objects[0], 1.0f / 64.0f);
+    gasAnimate(parsed, objects[1], 1.0f / 64.0f);
+    if (!checkSameObject(objects[0], objects[1]))
+    {
+      printf("  the definition differs from its tree after %u frames\n", i + 1);
+      checkPrintObject("tree", objects[0]);
+      checkPrintObject("parsed", objects[1]);
+      failures += 1;
+      break;
+    }
+  }
+
+  glhckObjectFree(objects[0]);
+  glhckObjectFree(objects[1]);
+  gasAnimationFree(expected);
+  if (parsed)
+    gasAnimationFree(parsed);
+  return failures;
+}
+
+/* Only the first load of a text parses it, which clones the action's
+ * userdata once more than instantiating does. Texts are told apart by
+ * length too, and failures are not cached. */
+static unsigned int checkParseCache(gasReference const* references)
+{
+  gasAnimationCache* cache = gasAnimationCacheNew(references, 1);
+  char const* const source = "seq(x.delta(1, 0.5), action(count))  ";
+  size_t const length = strlen(source);
+  unsigned int failures = 0;
+  unsigned int i;
+
+  for (i = 0; i < CHECK_PARSE_LOADS; ++i)
+  {
+    numClones = 0;
+    size_t errorOffset = 1;
+    gasAnimation* animation = gasAnimationCacheLoad(cache, source, length, &errorOffset);
+    CHECK(failures, animation && errorOffset == 0, "load %u failed at %zu", i, errorOffset);
+    CHECK(failures, i == 0 ? numClones > 1 : numClones == 1, "load %u cloned userdata %u times", i, numClones);
+    if (animation)
+      gasAnimationFree(animation);
+  }
+
+  numClones = 0;
+  gasAnimation* shorter = gasAnimationCacheLoad(cache, source, length - 2, NULL);
+  CHECK(failures, shorter && numClones > 1, "a shorter text was not parsed on its own");
+  if (shorter)
+    gasAnimationFree(shorter);
+
+  for (i = 0; i < 2; ++i)
+  {
+    size_t errorOffset = 0;
+    gasAnimation* animation = gasAnimationCacheLoad(cache, "seq(action(count)", 17, &errorOffset);
+    CHECK(failures, !animation && errorOffset == 17, "a malformed text loaded, failing at %zu", errorOffset);
+    if (animation)
+      gasAnimationFree(animation);
+  }
+
+  gasAnimationCacheFree(cache);
+  return failures;
+}
+
+unsigned int checkParse(unsigned int const seed)
+{
+  gasReference references[1];
+  memset(references, 0, sizeof(references));
+  references[0].action = checkAction;
+  references[0].cloneCallback = checkParseClone;
+  references[0].name = "count";
+
+  unsigned int failures = 0;
+  int e;
+  for (e = 0; e < NUM_ERRORS; ++e)
+  {
+    size_t errorOffset = 0;
+    gasAnimation* animation = gasAnimationParse(ERRORS[e].source, strlen(ERRORS[e].source), references, 1,
+                                                &errorOffset);
+    CHECK(failures, !animation && errorOffset == ERRORS[e].offset, "\"%s\" %s at %zu instead of failing at %zu",
+          ERRORS[e].source, animation ? "parsed" : "failed", errorOffset, ERRORS[e].offset);
+    if (animation)
+      gasAnimationFree(animation);
+  }
+
+  failures += checkParseTree(references);
+  failures += checkParseCache(references);
+
+  (void) seed;
+  return failures;
+}
@@ -0,0 +1,67 @@
+/* Quaternion batches against the scalar nlerp and normalization */
+
+#include "check.h"
+#include "internal.h"
+
+#include <string.h>
+
+#define CHECK_QUATERNIONS 515
+
+unsigned int checkQuaternions(unsigned int const seed)
+{
+  static kmQuaternion from[CHECK_QUATERNIONS];
+  static kmQuaternion to[CHECK_QUATERNIONS];
+  static kmQuaternion batch[CHECK_QUATERNIONS];
+  static float t[CHECK_QUATERNIONS];
+
+  checkSeed = seed;
+  unsigned int i;
+  for (i = 0; i < CHECK_QUATERNIONS; ++i)
+  {
+    kmVec3 a = { (float) (checkRand() % 360), (float) (checkRand() % 360), (float) (checkRand() % 360) };
+    kmVec3 b = { (float) (checkRand() % 360), (float) (checkRand() % 360), (float) (checkRand() % 360) };
+    gasQuaternionFromEuler(&a, &from[i]);
+    gasQuaternionFromEuler(&b, &to[i]);
+    t[i] = (float) (checkRand() % 65) / 64.0f;
+  }
+
+  /* Opposite and zero length quaternions */
+  to[1].x = -from[1].x;
+  to[1].y = -from[1].y;
+  to[1].z = -from[1].z;
+  to[1].w = -from[1].w;
+  memset(&from[2], 0, sizeof(kmQuaternion));
+
+  unsigned int failures = 0;
+  gasQuaternionNlerpBatch(from, to, t, batch, CHECK_QUATERNIONS);
+  for (i = 0; i < CHECK_QUATERNIONS; ++i)
+  {
+    kmQuaternion expected;
+    _gasQuaternionNlerp(&from[i], &to[i], t[i], &expected);
+    if (memcmp(&batch[i], &expected, sizeof(kmQuaternion)) && failures++ < CHECK_MAX_REPORTS)
+    {
+      printf("  nlerp %u: batch %.9g %.9g %.9g %.9g, scalar %.9g %.9g %.9g %.9g\n", i,
+             batch[i].x, batch[i].y, batch[i].z, batch[i].w, expected.x, expected.y, expected.z, expected.w);
+    }
+  }
+
+  memcpy(batch, from, sizeof(from));
+  for (i = 0; i < CHECK_QUATERNIONS; ++i)
+  {
+    batch[i].w *= (float) (i % 5);
+  }
+  gasQuaternionNormalizeBatch(batch, CHECK_QUATERNIONS);
+  for (i = 0; i < CHECK_QUATERNIONS; ++i)
+  {
+    kmQuaternion expected = from[i];
+    expected.w *= (float) (i % 5);
+    _gasQuaternionNormalize(&expected);
+    if (memcmp(&batch[i], &expected, sizeof(kmQuaternion)) && failures++ < CHECK_MAX_REPORTS)
+    {
+      printf("  normalize %u: batch %.9g %.9g %.9g %.9g, scalar %.9g %.9g %.9g %.9g\n", i,
+             batch[i].x, batch[i].y, batch[i].z, batch[i].w, expected.x, expected.y, expected.z, expected.w);
+    }
+  }
+
+  return failures;
+}
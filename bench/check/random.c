@@ -0,0 +1,265 @@
+/* Random animations for the managers, skip and sample checks */
+
+#include "check.h"
+
+static gasEasingFunc const EASING_FUNCS[] = {
+  gasEasingLinear, gasEasingQuadIn, gasEasingQuadOut, gasEasingEase, gasEasingEaseInOut
+};
+
+#define NUM_EASING_FUNCS ((int) (sizeof(EASING_FUNCS) / sizeof(EASING_FUNCS[0])))
+
+gasEasingCurve* checkCurve = NULL;
+int checkInstant = 1;
+int checkDisjoint = 0;
+
+/* Actions count how often they fire in the object's Z scale */
+void checkAction(glhckObject* object, void* userdata)
+{
+  kmVec3 const* scale = glhckObjectGetScale(object);
+  glhckObjectScalef(object, scale->x, scale->y, scale->z + 1.0f);
+  (void) userdata;
+}
+
+static float checkDuration()
+{
+  return (float) (checkRand() % 16 + (checkInstant ? 0 : 1)) / 8.0f;
+}
+
+static float checkValue()
+{
+  return (float) (checkRand() % 41 - 20) / 4.0f;
+}
+
+static kmVec3 checkVector()
+{
+  kmVec3 v = { checkValue(), checkValue(), checkValue() };
+  return v;
+}
+
+/* Clear of the poles, where Euler angles are ambiguous */
+static kmQuaternion checkQuaternion()
+{
+  kmVec3 degrees = { (float) (checkRand() % 24) * 15.0f, (float) (checkRand() % 11 - 5) * 15.0f, 0.0f };
+  kmQuaternion q;
+  gasQuaternionFromEuler(&degrees, &q);
+  return q;
+}
+
+static gasEasingFunc checkEasing()
+{
+  return EASING_FUNCS[checkRand() % NUM_EASING_FUNCS];
+}
+
+static gasAnimation* checkEase(gasAnimation* animation)
+{
+  if (checkRand() % 6 == 0)
+    gasNumberAnimationEasingCurve(animation, checkCurve);
+  return animation;
+}
+
+/* A random number target among channels, or -1 without any */
+static int checkTarget(unsigned int const channels)
+{
+  int targets[6];
+  int numTargets = 0;
+  int target;
+  for (target = GAS_NUMBER_ANIMATION_TARGET_X; target <= GAS_NUMBER_ANIMATION_TARGET_ROT_Z; ++target)
+  {
+    if (channels & (1 << target))
+      targets[numTargets++] = target;
+  }
+  return numTargets ? targets[checkRand() % numTargets] : -1;
+}
+
+gasAnimation* checkNumber(unsigned int const channels)
+{
+  int const target = checkTarget(channels);
+  if (target < 0)
+    return NULL;
+
+  gasEasingFunc const easing = checkEasing();
+  float const a = checkValue();
+  float const b = checkValue();
+  float const duration = checkDuration();
+  switch (checkRand() % 6)
+  {
+    case 0: return checkEase(gasNumberAnimationNewFromTo(target, easing, a, b, duration));
+    case 1: return checkEase(gasNumberAnimationNewFromDelta(target, easing, a, b, duration));
+    case 2: return checkEase(gasNumberAnimationNewDeltaTo(target, easing, a, b, duration));
+    case 3: return checkEase(gasNumberAnimationNewFrom(target, easing, a, duration));
+    case 4: return checkEase(gasNumberAnimationNewTo(target, easing, a, duration));
+    default: return checkEase(gasNumberAnimationNewDelta(target, easing, a, duration));
+  }
+}
+
+static gasAnimation* checkVectorAnimation(unsigned int const channels)
+{
+  unsigned int const masks[3] = { CHECK_POSITION, CHECK_ROTATION, CHECK_SCALE };
+  gasVectorAnimationTarget const target = checkRand() % 3;
+  if ((channels & masks[target]) != masks[target])
+    return NULL;
+
+  gasEasingFunc const easing = checkEasing();
+  kmVec3 const a = checkVector();
+  kmVec3 const b = checkVector();
+  float const duration = checkDuration();
+  switch (checkRand() % 4)
+  {
+    case 0: return checkEase(gasVectorAnimationNewFromTo(target, easing, &a, &b, duration));
+    case 1: return checkEase(gasVectorAnimationNewDelta(target, easing, &a, duration));
+    case 2: return checkEase(gasVectorAnimationNewTo(target, easing, &a, duration));
+    default: return checkEase(gasVectorAnimationNewFrom(target, easing, &a, duration));
+  }
+}
+
+static gasAnimation* checkRotation(unsigned int const channels)
+{
+  if ((channels & CHECK_ROTATION) != CHECK_ROTATION)
+    return NULL;
+
+  gasEasingFunc const easing = checkEasing();
+  kmQuaternion const a = checkQuaternion();
+  kmQuaternion const b = checkQuaternion();
+  float const duration = checkDuration();
+  gasAnimation* animation;
+  switch (checkRand() % 3)
+  {
+    case 0: animation = gasRotationAnimationNewFromTo(easing, &a, &b, duration); break;
+    case 1: animation = gasRotationAnimationNewTo(easing, &a, duration); break;
+    default: animation = gasRotationAnimationNewDelta(easing, &a, duration); break;
+  }
+  return gasRotationAnimationNlerp(animation, checkRand() % 2 ? GAS_TRUE : GAS_FALSE);
+}
+
+static gasAnimation* checkTrack(unsigned int const channels)
+{
+  int const target = checkTarget(channels);
+  if (target < 0)
+    return NULL;
+
+  gasKeyframe keys[5];
+  unsigned int const numKeys = 1 + checkRand() % 5;
+  float time = 0.0f;
+  unsigned int i;
+  for (i = 0; i < numKeys; ++i)
+  {
+    time += checkDuration();
+    keys[i].time = time;
+    keys[i].value = checkValue();
+    keys[i].easing = checkEasing();
+    keys[i].curve = checkRand() % 6 ? NULL : checkCurve;
+  }
+  return gasTrackAnimationNew(target, keys, numKeys);
+}
+
+static gasAnimation* checkPath(unsigned int const channels)
+{
+  if ((channels & CHECK_POSITION) != CHECK_POSITION)
+    return NULL;
+
+  kmVec3 points[5];
+  unsigned int const numPoints = 1 + checkRand() % 5;
+  unsigned int i;
+  for (i = 0; i < numPoints; ++i)
+  {
+    points[i] = checkVector();
+  }
+  gasPathInterpolation const interpolation = checkRand() % 2 ? GAS_PATH_CATMULL_ROM : GAS_PATH_LINEAR;
+  float const hop = (float) (checkRand() % 3);
+  gasEasingFunc const easing = checkEasing();
+  return checkEase(gasPathAnimationNew(interpolation, easing, points, numPoints, hop, checkDuration()));
+}
+
+gasAnimation* checkTree(unsigned int const depth, unsigned int const channels)
+{
+  gasAnimation* animation = NULL;
+  gasAnimation* children[4];
+  unsigned int childChannels[4];
+  unsigned int numChildren, i, bit;
+
+  switch (checkRand() % (depth < 3 ? 14 : 10))
+  {
+    case 0:
+    case 1:
+    case 2: animation = checkNumber(channels); break;
+    case 3: animation = checkVectorAnimation(channels); break;
+    case 4: animation = checkRotation(channels); break;
+    case 5: break;
+    case 6: animation = checkTrack(channels); break;
+    case 7: animation = checkPath(channels); break;
+    case 8:
+    case 9:
+      if (channels & CHECK_ACTIONS)
+        animation = gasActionNew(checkAction, NULL, NULL, NULL, NULL);
+      break;
+    default:
+      numChildren = 1 + checkRand() % 4;
+      gasBoolean const parallel = checkRand() % 2 ? GAS_TRUE : GAS_FALSE;
+      for (i = 0; i < numChildren; ++i)
+      {
+        childChannels[i] = parallel && checkDisjoint ? 0 : channels;
+      }
+      for (bit = 1; parallel && checkDisjoint && bit <= CHECK_ACTIONS; bit <<= 1)
+      {
+        childChannels[checkRand() % numChildren] |= channels & bit;
+      }
+      for (i = 0; i < numChildren; ++i)
+      {
+        children[i] = checkTree(depth + 1, childChannels[i]);
+      }
+      animation = parallel
+          ? gasParallelAnimationNew(children, numChildren)
+          : gasSequentialAnimationNew(children, numChildren);
+      break;
+  }
+
+  /* Anything that cannot write the channels it was left waits instead */
+  if (!animation)
+    animation = gasPauseAnimationNew(checkDuration());
+
+  if (checkRand() % 5 == 0)
+    gasAnimationLoopTimes(animation, 1 + checkRand() % 3);
+
+  return animation;
+}
+
+/* A tree that always takes time, as endless loops that take none play once
+ * per step */
+gasAnimation* checkTimedTree(unsigned int const channels)
+{
+  gasAnimation* children[2];
+  children[0] = checkTree(0, channels);
+  children[1] = gasPauseAnimationNew(checkDuration());
+  return gasSequentialAnimationNew(children, 2);
+}
+
+/* Standalone number animations and parallel groups of them, as batched */
+static gasAnimation* checkTween()
+{
+  unsigned int const numChildren = checkRand() % 4;
+  if (numChildren == 0)
+    return checkNumber(CHECK_CHANNELS);
+
+  gasAnimation* children[3];
+  unsigned int i;
+  for (i = 0; i < numChildren; ++i)
+  {
+    children[i] = checkNumber(CHECK_CHANNELS);
+  }
+  return gasParallelAnimationNew(children, numChildren);
+}
+
+/* A tree, endless or looping a few times, or a tween */
+gasAnimation* checkSpawn()
+{
+  int const kind = checkRand() % 4;
+  if (kind == 3)
+    return checkTween();
+
+  gasAnimation* animation = checkTree(0, CHECK_CHANNELS);
+  if (kind == 0)
+    gasAnimationLoop(animation);
+  else
+    gasAnimationLoopTimes(animation, 1 + checkRand() % 4);
+  return animation;
+}
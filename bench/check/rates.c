@@ -0,0 +1,148 @@
+/* Model animation update rates, as trees and compiled, on serial, batched
+ * and threaded managers */
+
+#include "check.h"
+
+#define CHECK_RATE_OBJECTS 8
+#define CHECK_RATE_STEPS 20
+
+/* A one second model animation plays the two second skeletal animation over
+ * steps of 1/16, so the play time moves on by 1/8 per step and the
+ * animation finishes on the 17th step. Rates set at a step apply from it. */
+typedef struct CheckRate
+{
+  char const* name;
+  unsigned int frames;
+  float minStep;
+  unsigned int at;
+  unsigned long poses;
+} CheckRate;
+
+static CheckRate const RATES[] = {
+  /* The clamped play time of the last step was already posed */
+  { "every step", 1, 0.0f, 0, 16 },
+  { "every 4 frames", 4, 0.0f, 0, 5 },
+  { "every 0.25 s", 1, 0.25f, 0, 9 },
+  { "every 4 frames from step 9", 4, 0.0f, 8, 10 },
+};
+
+#define NUM_RATES ((int) (sizeof(RATES) / sizeof(RATES[0])))
+
+static unsigned int checkRatePlay(char const* name, gasManager* manager, glhckObject** objects,
+                                  CheckRate const* rate, gasBoolean const compiled)
+{
+  gasAnimation* animations[CHECK_RATE_OBJECTS];
+  unsigned int failures = 0;
+  unsigned int i, step;
+  for (i = 0; i < CHECK_RATE_OBJECTS; ++i)
+  {
+    gasAnimation* model = gasModelAnimationNew("walk", 1.0f);
+    if (compiled)
+    {
+      animations[i] = gasAnimationCompile(model);
+      gasAnimationFree(model);
+    }
+    else
+    {
+      animations[i] = model;
+    }
+    gasManagerAddAnimation(manager, animations[i], objects[i]);
+  }
+
+  glhckStubResetStats();
+  for (step = 0; step < CHECK_RATE_STEPS; ++step)
+  {
+    for (i = 0; step == rate->at && i < CHECK_RATE_OBJECTS; ++i)
+    {
+      gasModelAnimationUpdateRate(animations[i], rate->frames, rate->minStep);
+    }
+    gasManagerAnimate(manager, 1.0f / 16.0f);
+  }
+
+  glhckStubStats stats;
+  glhckStubGetStats(&stats);
+  CHECK(failures, stats.animatorUpdates == rate->poses * CHECK_RATE_OBJECTS
+        && stats.animatorTransforms == stats.animatorUpdates, "%s: %s%s: %lu updates and %lu transforms instead of %lu",
+        name, rate->name, compiled ? " compiled" : "", stats.animatorUpdates, stats.animatorTransforms,
+        rate->poses * CHECK_RATE_OBJECTS);
+  CHECK(failures, gasManagerGetObjectAnimations(manager, objects[0], NULL, 0) == 0, "%s: %s%s: did not finish",
+        name, rate->name, compiled ? " compiled" : "");
+  return failures;
+}
+
+/* Steps too small to move the play time on do not pose */
+static unsigned int checkRateStall(char const* name, gasManager* manager, glhckObject** objects)
+{
+  unsigned int failures = 0;
+  unsigned int i;
+  for (i = 0; i < CHECK_RATE_OBJECTS; ++i)
+  {
+    gasManagerAddAnimation(manager, gasModelAnimationNew("walk", 1.0f), objects[i]);
+  }
+
+  glhckStubResetStats();
+  gasManagerAnimate(manager, 1.0f / 16.0f);
+  for (i = 0; i < CHECK_RATE_STEPS; ++i)
+  {
+    gasManagerAnimate(manager, 1e-9f);
+  }
+
+  glhckStubStats stats;
+  glhckStubGetStats(&stats);
+  CHECK(failures, stats.animatorUpdates == CHECK_RATE_OBJECTS, "%s: stalled: %lu updates instead of %d",
+        name, stats.animatorUpdates, CHECK_RATE_OBJECTS);
+  gasManagerClear(manager);
+  return failures;
+}
+
+static unsigned int checkRateKind(int const kind, glhckAnimation* walk, glhckBone* bone)
+{
+  char const* const name = CHECK_KIND_NAMES[kind];
+  gasManager* manager = checkKindManager(kind);
+  glhckObject* objects[CHECK_RATE_OBJECTS];
+  unsigned int failures = 0;
+  unsigned int i;
+  for (i = 0; i < CHECK_RATE_OBJECTS; ++i)
+  {
+    objects[i] = glhckObjectNew();
+    glhckObjectInsertAnimations(objects[i], &walk, 1);
+    glhckObjectInsertBones(objects[i], &bone, 1);
+  }
+
+  int r;
+  for (r = 0; r < NUM_RATES; ++r)
+  {
+    failures += checkRatePlay(name, manager, objects, &RATES[r], GAS_FALSE);
+    failures += checkRatePlay(name, manager, objects, &RATES[r], GAS_TRUE);
+  }
+  failures += checkRateStall(name, manager, objects);
+
+  gasManagerFree(manager);
+  for (i = 0; i < CHECK_RATE_OBJECTS; ++i)
+  {
+    glhckObjectFree(objects[i]);
+  }
+  return failures;
+}
+
+unsigned int checkRates(unsigned int const seed)
+{
+  glhckAnimation* walk = glhckAnimationNew();
+  glhckAnimationName(walk, "walk");
+  glhckAnimationDuration(walk, 2.0f);
+  glhckBone* bone = glhckBoneNew();
+
+  unsigned int failures = 0;
+  int kind;
+  for (kind = 0; kind < CHECK_KINDS; ++kind)
+  {
+    failures += checkRateKind(kind, walk, bone);
+  }
+
+  gasModelAnimationClearCache();
+  glhckBoneFree(bone);
+  glhckAnimationFree(walk);
+
+  (void) seed;
+  return failures;
+}
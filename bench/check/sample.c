@@ -0,0 +1,90 @@
+/* gasAnimationSample of trees and compiled animations, and
+ * gasAnimationTemplateSample, against playing to the same time. Rotations
+ * are compared as orientations, as in the skip check. */
+
+#include "check.h"
+
+#define CHECK_SAMPLE_TRIALS 2000
+
+unsigned int checkSample(unsigned int const seed)
+{
+  glhckObject* objects[4] = { glhckObjectNew(), glhckObjectNew(), glhckObjectNew(), glhckObjectNew() };
+  char const* const labels[4] = { "played", "tree", "compiled", "template" };
+  unsigned int failures = 0;
+  unsigned int sampled = 0;
+  unsigned int trial, i;
+
+  checkInstant = 0;
+  checkDisjoint = 1;
+  for (trial = 0; trial < CHECK_SAMPLE_TRIALS; ++trial)
+  {
+    checkSeed = seed * 131071u + trial;
+    gasAnimation* tree = checkTimedTree(CHECK_POSITION | CHECK_ROTATION | CHECK_SCALE);
+    if (checkRand() % 2)
+      gasAnimationLoop(tree);
+    else
+      gasAnimationLoopTimes(tree, 1 + checkRand() % 5);
+
+    gasAnimation* played = gasAnimationClone(tree);
+    gasAnimation* compiled = gasAnimationCompile(tree);
+    gasAnimationTemplate* animationTemplate = gasAnimationTemplateNew(tree);
+    /* Sampling writes where the tree starts, which playing only does once
+     * stepped */
+    unsigned int const frames = 1 + checkRand() % 1024;
+
+    for (i = 0; i < 4; ++i)
+    {
+      checkResetObject(objects[i], trial);
+    }
+
+    for (i = 0; i < frames; ++i)
+    {
+      gasAnimate(played, objects[0], 1.0f / 64.0f);
+    }
+
+    gasBoolean valid[3];
+    valid[0] = gasAnimationSample(tree, objects[1], frames / 64.0f);
+    valid[1] = gasAnimationSample(compiled, objects[2], frames / 64.0f);
+    valid[2] = gasAnimationTemplateSample(animationTemplate, objects[3], frames / 64.0f);
+
+    if ((valid[0] != valid[1] || valid[0] != valid[2]) && failures++ < CHECK_MAX_REPORTS)
+    {
+      printf("  trial %u: tree, compiled and template disagree on sampling: %d %d %d\n",
+             trial, valid[0], valid[1], valid[2]);
+    }
+    else if (valid[0])
+    {
+      sampled += 1;
+      for (i = 1; i < 4; ++i)
+      {
+        if (!checkCloseObject(objects[0], objects[i]) && failures++ < CHECK_MAX_REPORTS)
+        {
+          printf("  trial %u: %s sample differs from playing for %u frames\n", trial, labels[i], frames);
+          checkPrintObject(labels[0], objects[0]);
+          checkPrintObject(labels[i], objects[i]);
+        }
+      }
+    }
+
+    gasAnimationFree(tree);
+    gasAnimationFree(played);
+    gasAnimationFree(compiled);
+    gasAnimationTemplateFree(animationTemplate);
+  }
+  checkInstant = 1;
+  checkDisjoint = 0;
+
+  for (i = 0; i < 4; ++i)
+  {
+    glhckObjectFree(objects[i]);
+  }
+
+  /* Make sure the trees did not all refuse sampling */
+  if (sampled < CHECK_SAMPLE_TRIALS / 4)
+  {
+    printf("  only %u of %u trees could be sampled\n", sampled, CHECK_SAMPLE_TRIALS);
+    failures += 1;
+  }
+
+  return failures;
+}
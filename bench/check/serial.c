@@ -0,0 +1,233 @@
+/* Serialized animations and banks: round trips against the source trees,
+ * truncated and corrupted data, and bank lookups */
+
+#include "check.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_SERIAL_TRIALS 300
+#define CHECK_SERIAL_CORRUPTED 20
+#define CHECK_SERIAL_FRAMES 256
+#define CHECK_BANK_SIZE 8
+
+static gasReference checkReferences[2];
+
+/* Plays both for the same frames from the same start */
+static unsigned int checkSerialPlay(char const* label, gasAnimation* expected, gasAnimation* actual,
+                                    glhckObject** objects, unsigned int const trial)
+{
+  unsigned int failures = 0;
+  unsigned int i;
+  checkResetObject(objects[0], trial);
+  checkResetObject(objects[1], trial);
+  for (i = 0; i < CHECK_SERIAL_FRAMES; ++i)
+  {
+    gasAnimate(expected, objects[0], 1.0f / 64.0f);
+    gasAnimate(actual, objects[1], 1.0f / 64.0f);
+    if (!checkSameObject(objects[0], objects[1]))
+    {
+      printf("  trial %u: %s differs from the source after %u frames\n", trial, label, i + 1);
+      checkPrintObject("source", objects[0]);
+      checkPrintObject(label, objects[1]);
+      failures += 1;
+      break;
+    }
+  }
+  return failures;
+}
+
+/* Every shorter size fails and every changed byte either fails or reads a
+ * tree that can be freed */
+static unsigned int checkSerialDamage(unsigned char const* data, size_t const size, unsigned int const trial)
+{
+  unsigned char* damaged = malloc(size);
+  unsigned int failures = 0;
+  size_t i;
+  for (i = 0; i < size; ++i)
+  {
+    gasAnimation* truncated = gasAnimationDeserialize(data, i, checkReferences, 2);
+    CHECK(failures, !truncated, "trial %u: %zu of %zu bytes were read", trial, i, size);
+    if (truncated)
+      gasAnimationFree(truncated);
+  }
+
+  static unsigned char const FLIPS[] = { 0x01, 0x80, 0xff };
+  unsigned int f;
+  memcpy(damaged, data, size);
+  for (i = 0; i < size; ++i)
+  {
+    for (f = 0; f < sizeof(FLIPS); ++f)
+    {
+      damaged[i] ^= FLIPS[f];
+      gasAnimation* animation = gasAnimationDeserialize(damaged, size, checkReferences, 2);
+      if (animation)
+        gasAnimationFree(animation);
+      damaged[i] ^= FLIPS[f];
+    }
+  }
+
+  free(damaged);
+  return failures;
+}
+
+/* A node count far beyond the data, with a sequence claiming as many
+ * children, fails before allocating them */
+static unsigned int checkSerialNodeCount()
+{
+  gasAnimation* children[2] = { gasPauseAnimationNew(1.0f), gasPauseAnimationNew(1.0f) };
+  gasAnimation* sequence = gasSequentialAnimationNew(children, 2);
+  size_t size;
+  unsigned char* data = gasAnimationSerialize(sequence, NULL, 0, &size);
+  unsigned int failures = 0;
+
+  uint32_t const numNodes = 0x40000000u;
+  uint32_t const numChildren = numNodes - 1;
+  memcpy(data + 16, &numNodes, sizeof(numNodes));
+  memcpy(data + 28, &numChildren, sizeof(numChildren));
+  gasAnimation* animation = gasAnimationDeserialize(data, size, NULL, 0);
+  CHECK(failures, !animation, "a node count past the data was read");
+  if (animation)
+    gasAnimationFree(animation);
+
+  free(data);
+  gasAnimationFree(sequence);
+  return failures;
+}
+
+static unsigned int checkBank(unsigned int const seed, glhckObject** objects)
+{
+  static char const* const NAMES[CHECK_BANK_SIZE] = {
+    "walk", "jump", "idle", "wave", "fall", "crouch", "run", "turn"
+  };
+  gasAnimation* trees[CHECK_BANK_SIZE];
+  unsigned int failures = 0;
+  unsigned int i;
+  for (i = 0; i < CHECK_BANK_SIZE; ++i)
+  {
+    checkSeed = seed * 524287u + i;
+    trees[i] = checkTimedTree(CHECK_CHANNELS);
+  }
+
+  size_t size;
+  unsigned char* data = gasAnimationBankWrite(trees, (char const**) NAMES, CHECK_BANK_SIZE, checkReferences, 2,
+                                              &size);
+  gasAnimationBank* bank = gasAnimationBankOpen(data, size, checkReferences, 2);
+  CHECK(failures, bank && gasAnimationBankSize(bank) == CHECK_BANK_SIZE, "a bank of %d animations did not open",
+        CHECK_BANK_SIZE);
+  if (!bank)
+  {
+    free(data);
+    return failures;
+  }
+
+  for (i = 0; i < CHECK_BANK_SIZE; ++i)
+  {
+    int const index = gasAnimationBankFind(bank, NAMES[i]);
+    CHECK(failures, index >= 0 && strcmp(gasAnimationBankName(bank, index), NAMES[i]) == 0,
+          "%s was found at %d", NAMES[i], index);
+    CHECK(failures, i == 0 || strcmp(gasAnimationBankName(bank, i - 1), gasAnimationBankName(bank, i)) < 0,
+          "bank names %u and %u are out of order", i - 1, i);
+    if (index < 0)
+      continue;
+
+    gasAnimationTemplate* animationTemplate = gasAnimationBankTemplate(bank, index);
+    CHECK(failures, animationTemplate && gasAnimationBankTemplate(bank, index) == animationTemplate,
+          "%s was not read into one template", NAMES[i]);
+    if (!animationTemplate)
+      continue;
+
+    gasAnimation* expected = gasAnimationClone(trees[i]);
+    gasAnimation* instance = gasAnimationTemplateInstantiate(animationTemplate);
+    failures += checkSerialPlay(NAMES[i], expected, instance, objects, i);
+    gasAnimationFree(expected);
+    gasAnimationFree(instance);
+  }
+  CHECK(failures, gasAnimationBankFind(bank, "swim") == -1 && gasAnimationBankFind(bank, "") == -1,
+        "names not in the bank were found");
+  CHECK(failures, !gasAnimationBankName(bank, CHECK_BANK_SIZE) && !gasAnimationBankTemplate(bank, CHECK_BANK_SIZE),
+        "an index past the bank was read");
+  gasAnimationBankFree(bank);
+
+  /* Shorter banks and directories out of order do not open */
+  for (i = 0; i < size; ++i)
+  {
+    gasAnimationBank* truncated = gasAnimationBankOpen(data, i, checkReferences, 2);
+    CHECK(failures, !truncated, "%u of %zu bank bytes opened", i, size);
+    if (truncated)
+      gasAnimationBankFree(truncated);
+  }
+  unsigned char entry[16];
+  memcpy(entry, data + 20, 16);
+  memcpy(data + 20, data + 36, 16);
+  memcpy(data + 36, entry, 16);
+  bank = gasAnimationBankOpen(data, size, checkReferences, 2);
+  CHECK(failures, !bank, "a bank with its directory out of order opened");
+  if (bank)
+    gasAnimationBankFree(bank);
+  free(data);
+
+  char const* duplicates[CHECK_BANK_SIZE];
+  memcpy(duplicates, NAMES, sizeof(duplicates));
+  duplicates[3] = duplicates[5];
+  data = gasAnimationBankWrite(trees, duplicates, CHECK_BANK_SIZE, checkReferences, 2, &size);
+  CHECK(failures, !data, "a bank with duplicate names was written");
+  free(data);
+
+  for (i = 0; i < CHECK_BANK_SIZE; ++i)
+  {
+    gasAnimationFree(trees[i]);
+  }
+  return failures;
+}
+
+unsigned int checkSerial(unsigned int const seed)
+{
+  glhckObject* objects[2] = { glhckObjectNew(), glhckObjectNew() };
+  unsigned int failures = 0;
+  unsigned int trial;
+
+  memset(checkReferences, 0, sizeof(checkReferences));
+  checkReferences[0].action = checkAction;
+  checkReferences[1].curve = checkCurve;
+
+  for (trial = 0; trial < CHECK_SERIAL_TRIALS; ++trial)
+  {
+    checkSeed = seed * 131071u + trial;
+    gasAnimation* tree = checkTimedTree(CHECK_CHANNELS);
+    size_t size, again;
+    unsigned char* data = gasAnimationSerialize(tree, checkReferences, 2, &size);
+    gasAnimation* copy = data ? gasAnimationDeserialize(data, size, checkReferences, 2) : NULL;
+    unsigned char* copyData = copy ? gasAnimationSerialize(copy, checkReferences, 2, &again) : NULL;
+    int const same = copyData && again == size && memcmp(data, copyData, size) == 0;
+    CHECK(failures, same, "trial %u: the tree did not survive a round trip", trial);
+    if (same)
+    {
+      failures += checkSerialPlay("copy", tree, copy, objects, trial);
+      if (trial < CHECK_SERIAL_CORRUPTED)
+        failures += checkSerialDamage(data, size, trial);
+    }
+
+    if (copy)
+      gasAnimationFree(copy);
+    free(data);
+    free(copyData);
+    gasAnimationFree(tree);
+  }
+
+  /* Actions need their reference */
+  gasAnimation* action = gasActionNew(checkAction, NULL, NULL, NULL, NULL);
+  size_t size;
+  void* data = gasAnimationSerialize(action, checkReferences + 1, 1, &size);
+  CHECK(failures, !data, "an action was written without its reference");
+  free(data);
+  gasAnimationFree(action);
+
+  failures += checkSerialNodeCount();
+  failures += checkBank(seed, objects);
+
+  glhckObjectFree(objects[0]);
+  glhckObjectFree(objects[1]);
+  return failures;
+}
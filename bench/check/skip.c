@@ -0,0 +1,81 @@
+/* Looping trees advanced in one step spanning many loops against the same
+ * trees advanced frame by frame. Skipping loops passes rotations through
+ * quaternions a different number of times than playing does, so rotations
+ * are compared as orientations. */
+
+#include "check.h"
+
+#define CHECK_SKIP_TRIALS 1000
+
+unsigned int checkSkip(unsigned int const seed)
+{
+  glhckObject* objects[3] = { glhckObjectNew(), glhckObjectNew(), glhckObjectNew() };
+  unsigned int failures = 0;
+  unsigned int trial, i;
+
+  checkInstant = 0;
+  checkDisjoint = 1;
+  for (trial = 0; trial < CHECK_SKIP_TRIALS; ++trial)
+  {
+    checkSeed = seed * 65537u + trial;
+    gasAnimation* stepped = checkTimedTree(CHECK_POSITION | CHECK_ROTATION | CHECK_ACTIONS);
+    if (checkRand() % 2)
+      gasAnimationLoop(stepped);
+    else
+      gasAnimationLoopTimes(stepped, 2 + checkRand() % 30);
+
+    gasAnimation* skipped = gasAnimationClone(stepped);
+    gasAnimation* compiled = gasAnimationCompile(stepped);
+    float const warm = (float) (checkRand() % 8) / 64.0f;
+    unsigned int const frames = checkRand() % 2048;
+
+    for (i = 0; i < 3; ++i)
+    {
+      checkResetObject(objects[i], trial);
+    }
+
+    gasAnimate(stepped, objects[0], warm);
+    gasAnimate(skipped, objects[1], warm);
+    gasAnimate(compiled, objects[2], warm);
+
+    gasBoolean running = GAS_TRUE;
+    for (i = 0; i < frames; ++i)
+    {
+      running = gasAnimate(stepped, objects[0], 1.0f / 64.0f);
+    }
+    gasBoolean const skippedRunning = gasAnimate(skipped, objects[1], frames / 64.0f);
+    gasBoolean const compiledRunning = gasAnimate(compiled, objects[2], frames / 64.0f);
+
+    /* A sequence whose last child ends right on a step only finishes on the
+     * next one, which skipped loops do not wait for */
+    if (running && !skippedRunning)
+      running = gasAnimate(stepped, objects[0], 1.0f / 64.0f);
+
+    if ((!checkCloseObject(objects[0], objects[1]) || running != skippedRunning) && failures++ < CHECK_MAX_REPORTS)
+    {
+      printf("  trial %u: one step of %u frames differs from stepping through them\n", trial, frames);
+      checkPrintObject("stepped", objects[0]);
+      checkPrintObject("one step", objects[1]);
+    }
+    if ((!checkSameObject(objects[1], objects[2]) || skippedRunning != compiledRunning)
+        && failures++ < CHECK_MAX_REPORTS)
+    {
+      printf("  trial %u: compiled differs from tree in one step of %u frames\n", trial, frames);
+      checkPrintObject("tree", objects[1]);
+      checkPrintObject("compiled", objects[2]);
+    }
+
+    gasAnimationFree(stepped);
+    gasAnimationFree(skipped);
+    gasAnimationFree(compiled);
+  }
+  checkInstant = 1;
+  checkDisjoint = 0;
+
+  for (i = 0; i < 3; ++i)
+  {
+    glhckObjectFree(objects[i]);
+  }
+
+  return failures;
+}
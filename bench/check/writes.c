@@ -0,0 +1,98 @@
+/* Position and rotation writes coalesced to one per object and frame, with
+ * callbacks seeing and changing the staged transform */
+
+#include "check.h"
+
+#define CHECK_WRITE_OBJECTS 100
+
+static gasAnimation* checkWriteSpread()
+{
+  gasAnimation* children[5];
+  int target;
+  for (target = GAS_NUMBER_ANIMATION_TARGET_X; target <= GAS_NUMBER_ANIMATION_TARGET_ROT_Y; ++target)
+  {
+    children[target] = gasNumberAnimationNewDelta(target, gasEasingLinear, 8.0f, 8.0f);
+  }
+  return gasParallelAnimationNew(children, 5);
+}
+
+/* Records X as it sees it and moves Z */
+static void checkWriteAction(glhckObject* object, void* userdata)
+{
+  kmVec3 const* position = glhckObjectGetPosition(object);
+  *(float*) userdata = position->x;
+  glhckObjectPositionf(object, position->x, position->y, 7.0f);
+}
+
+static unsigned int checkWriteKind(int const kind)
+{
+  char const* const name = CHECK_KIND_NAMES[kind];
+  gasManager* manager = checkKindManager(kind);
+  glhckObject* objects[CHECK_WRITE_OBJECTS];
+  float seen[CHECK_WRITE_OBJECTS];
+  unsigned int failures = 0;
+  unsigned int i;
+
+  for (i = 0; i < CHECK_WRITE_OBJECTS; ++i)
+  {
+    objects[i] = glhckObjectNew();
+    gasManagerAddAnimation(manager, checkWriteSpread(), objects[i]);
+  }
+  gasManagerAnimate(manager, 0.0f);
+
+  glhckStubStats stats;
+  glhckStubResetStats();
+  gasManagerAnimate(manager, 0.25f);
+  glhckStubGetStats(&stats);
+  CHECK(failures, stats.positionWrites == CHECK_WRITE_OBJECTS && stats.rotationWrites == CHECK_WRITE_OBJECTS
+        && stats.scaleWrites == 0, "%s: %lu position, %lu rotation and %lu scale writes for %d objects", name,
+        stats.positionWrites, stats.rotationWrites, stats.scaleWrites, CHECK_WRITE_OBJECTS);
+  for (i = 0; i < CHECK_WRITE_OBJECTS; ++i)
+  {
+    kmVec3 const* p = glhckObjectGetPosition(objects[i]);
+    kmVec3 const* r = glhckObjectGetRotation(objects[i]);
+    CHECK(failures, p->x == 0.25f && p->y == 0.25f && p->z == 0.25f && r->x == 0.25f && r->y == 0.25f,
+          "%s: object %u was left at %g %g %g rotated %g %g", name, i, p->x, p->y, p->z, r->x, r->y);
+  }
+
+  /* An action between writes sees the first and keeps its own change */
+  gasManagerClear(manager);
+  for (i = 0; i < CHECK_WRITE_OBJECTS; ++i)
+  {
+    gasAnimation* children[3] = {
+      gasNumberAnimationNewTo(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingLinear, 5.0f, 0.25f),
+      gasActionNew(checkWriteAction, NULL, NULL, NULL, &seen[i]),
+      gasNumberAnimationNewTo(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingLinear, 3.0f, 0.25f)
+    };
+    seen[i] = 0.0f;
+    gasManagerAddAnimation(manager, gasSequentialAnimationNew(children, 3), objects[i]);
+  }
+  gasManagerAnimate(manager, 0.5f);
+  for (i = 0; i < CHECK_WRITE_OBJECTS; ++i)
+  {
+    kmVec3 const* p = glhckObjectGetPosition(objects[i]);
+    CHECK(failures, seen[i] == 5.0f, "%s: object %u action saw X at %g", name, i, seen[i]);
+    CHECK(failures, p->x == 5.0f && p->y == 3.0f && p->z == 7.0f, "%s: object %u ended at %g %g %g after its action",
+          name, i, p->x, p->y, p->z);
+  }
+
+  gasManagerFree(manager);
+  for (i = 0; i < CHECK_WRITE_OBJECTS; ++i)
+  {
+    glhckObjectFree(objects[i]);
+  }
+  return failures;
+}
+
+unsigned int checkWrites(unsigned int const seed)
+{
+  unsigned int failures = 0;
+  int kind;
+  for (kind = 0; kind < CHECK_KINDS; ++kind)
+  {
+    failures += checkWriteKind(kind);
+  }
+
+  (void) seed;
+  return failures;
+}
@@ -0,0 +1,342 @@
+/* gas-microbench: easing kernels, the cubic-bezier solver, the
+ * number-animation lerp, quaternion interpolation and the batch entry points
+ * timed in isolation
+ *
+ * Usage: gas-microbench [iterations]
+ *
+ * Every kernel is run over a fixed table of inputs in [0, 1]. Cycles/call is
+ * measured with the time stamp counter where available and falls back to
+ * nanoseconds/call elsewhere. Max error is measured against a double
+ * precision reference evaluated over the same inputs. Batch easings are
+ * timed per element and compared against their scalar counterparts, where
+ * any difference at all is reported. Quaternion slerp and nlerp report their
+ * largest component error against a double precision slerp.
+ */
+
+#include "glhck/glhck.h"
+#include "gas.h"
+#include "internal.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MICRO_UNIT "cycles/call"
+static double microNow()
+{
+  return (double) __rdtsc();
+}
+#else
+#define MICRO_UNIT "ns/call"
+static double microNow()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+#endif
+
+#define NUM_INPUTS 4096
+#define DEFAULT_ITERATIONS 2000
+
+static float inputs[NUM_INPUTS];
+static volatile float sink;
+
+/* Reference implementations */
+
+static double referenceBezier(double t, double p1, double p2)
+{
+  return 3 * (1-t) * (1-t) * t * p1 + 3 * (1-t) * t * t * p2 + t * t * t;
+}
+
+static double referenceTFromX(double x, double x1, double x2)
+{
+  double mint = 0;
+  double maxt = 1;
+  int i;
+  for (i = 0; i < 64; ++i)
+  {
+    double guesst = (mint + maxt) / 2;
+    if (x < referenceBezier(guesst, x1, x2))
+      maxt = guesst;
+    else
+      mint = guesst;
+  }
+  return (mint + maxt) / 2;
+}
+
+static double referenceCubicBezier(double x, double x1, double y1, double x2, double y2)
+{
+  if (x <= 0) return 0;
+  if (x >= 1) return 1;
+  return referenceBezier(referenceTFromX(x, x1, x2), y1, y2);
+}
+
+static double referenceLinear(double t) { return t; }
+static double referenceQuadIn(double t) { return t * t; }
+static double referenceQuadOut(double t) { return 2 * t - t * t; }
+static double referenceEase(double t) { return referenceCubicBezier(t, 0.25, 0.1, 0.25, 1); }
+static double referenceEaseIn(double t) { return referenceCubicBezier(t, 0.42, 0, 1, 1); }
+static double referenceEaseOut(double t) { return referenceCubicBezier(t, 0, 0, 0.58, 1); }
+static double referenceEaseInOut(double t) { return referenceCubicBezier(t, 0.42, 0, 0.58, 1); }
+
+/* Kernels under test, all shaped as float -> float */
+
+static float kernelTFromX(float x)
+{
+  return _gasCubicBezierTFromX(x, 0.42f, 0.58f);
+}
+
+static double referenceKernelTFromX(double x)
+{
+  return referenceTFromX(x, 0.42, 0.58);
+}
+
+static float kernelLerp(float t)
+{
+  return _gasNumberAnimationValue(GAS_NUMBER_ANIMATION_TYPE_FROM_TO, -120.0f, 340.0f, t);
+}
+
+static double referenceKernelLerp(double t)
+{
+  return -120.0 + (340.0 + 120.0) * t;
+}
+
+static float kernelCubicBezier(float x)
+{
+  return gasEasingCubicBezier(x, 0.42f, 0.0f, 0.58f, 1.0f);
+}
+
+static gasEasingCurve* bakedAuto = NULL;
+
+static float kernelBakedAuto(float x)
+{
+  return gasEasingCurveEvaluate(bakedAuto, x);
+}
+
+typedef struct MicroKernel
+{
+  char const* name;
+  float (*kernel)(float);
+  double (*reference)(double);
+} MicroKernel;
+
+static MicroKernel const KERNELS[] = {
+  { "gasEasingLinear", gasEasingLinear, referenceLinear },
+  { "gasEasingQuadIn", gasEasingQuadIn, referenceQuadIn },
+  { "gasEasingQuadOut", gasEasingQuadOut, referenceQuadOut },
+  { "gasEasingEase", gasEasingEase, referenceEase },
+  { "gasEasingEaseIn", gasEasingEaseIn, referenceEaseIn },
+  { "gasEasingEaseOut", gasEasingEaseOut, referenceEaseOut },
+  { "gasEasingEaseInOut", gasEasingEaseInOut, referenceEaseInOut },
+  { "gasEasingCubicBezier", kernelCubicBezier, referenceEaseInOut },
+  { "gasEasingBake (auto)", kernelBakedAuto, referenceEaseInOut },
+  { "_gasCubicBezierTFromX", kernelTFromX, referenceKernelTFromX },
+  { "number lerp", kernelLerp, referenceKernelLerp },
+};
+
+#define NUM_KERNELS ((int) (sizeof(KERNELS) / sizeof(KERNELS[0])))
+
+static void microRun(MicroKernel const* kernel, unsigned int iterations)
+{
+  float (* volatile f)(float) = kernel->kernel;
+
+  double maxError = 0;
+  int i;
+  for (i = 0; i < NUM_INPUTS; ++i)
+  {
+    double error = fabs(f(inputs[i]) - kernel->reference(inputs[i]));
+    maxError = error > maxError ? error : maxError;
+  }
+
+  double best = -1;
+  unsigned int r;
+  for (r = 0; r < 5; ++r)
+  {
+    float acc = 0;
+    double start = microNow();
+    unsigned int n;
+    for (n = 0; n < iterations; ++n)
+    {
+      for (i = 0; i < NUM_INPUTS; ++i)
+      {
+        acc += f(inputs[i]);
+      }
+    }
+    double end = microNow();
+    sink = acc;
+
+    double perCall = (end - start) / ((double) iterations * NUM_INPUTS);
+    best = best < 0 || perCall < best ? perCall : best;
+  }
+
+  printf("%-24s %14.2f %14.3e\n", kernel->name, best, maxError);
+}
+
+typedef struct MicroBatch
+{
+  char const* name;
+  gasEasingId easing;
+  float (*scalar)(float);
+} MicroBatch;
+
+static MicroBatch const BATCHES[] = {
+  { "batch Linear", GAS_EASING_LINEAR, gasEasingLinear },
+  { "batch QuadIn", GAS_EASING_QUAD_IN, gasEasingQuadIn },
+  { "batch QuadOut", GAS_EASING_QUAD_OUT, gasEasingQuadOut },
+  { "batch Ease", GAS_EASING_EASE, gasEasingEase },
+  { "batch EaseInOut", GAS_EASING_EASE_IN_OUT, gasEasingEaseInOut },
+};
+
+#define NUM_BATCHES ((int) (sizeof(BATCHES) / sizeof(BATCHES[0])))
+
+static float outputs[NUM_INPUTS];
+
+static void microRunBatch(MicroBatch const* batch, unsigned int iterations)
+{
+  gasEasingEvaluateBatch(batch->easing, inputs, outputs, NUM_INPUTS);
+
+  double maxError = 0;
+  int i;
+  for (i = 0; i < NUM_INPUTS; ++i)
+  {
+    double error = fabs(outputs[i] - batch->scalar(inputs[i]));
+    maxError = error > maxError ? error : maxError;
+  }
+
+  double best = -1;
+  unsigned int r;
+  for (r = 0; r < 5; ++r)
+  {
+    double start = microNow();
+    unsigned int n;
+    for (n = 0; n < iterations; ++n)
+    {
+      gasEasingEvaluateBatch(batch->easing, inputs, outputs, NUM_INPUTS);
+      sink = outputs[n % NUM_INPUTS];
+    }
+    double end = microNow();
+
+    double perCall = (end - start) / ((double) iterations * NUM_INPUTS);
+    best = best < 0 || perCall < best ? perCall : best;
+  }
+
+  printf("%-24s %14.2f %14.3e\n", batch->name, best, maxError);
+}
+
+static kmQuaternion quatFrom[NUM_INPUTS];
+static kmQuaternion quatTo[NUM_INPUTS];
+static kmQuaternion quatOut[NUM_INPUTS];
+
+static void microQuatSetup()
+{
+  int i;
+  for (i = 0; i < NUM_INPUTS; ++i)
+  {
+    kmVec3 a = { (i * 37) % 360 - 180.0f, (i * 11) % 160 - 80.0f, (i * 53) % 360 - 180.0f };
+    kmVec3 b = { a.x + (i % 90), a.y - (i % 40), a.z + (i % 150) };
+    gasQuaternionFromEuler(&a, &quatFrom[i]);
+    gasQuaternionFromEuler(&b, &quatTo[i]);
+  }
+}
+
+static double microQuatReferenceError(int i, kmQuaternion const* q)
+{
+  kmQuaternion const* a = &quatFrom[i];
+  kmQuaternion const* b = &quatTo[i];
+  double dot = (double) a->x * b->x + (double) a->y * b->y + (double) a->z * b->z + (double) a->w * b->w;
+  double sign = dot < 0 ? -1 : 1;
+  dot = fmin(dot * sign, 1.0);
+  double theta = acos(dot);
+  double t = inputs[i];
+  double wa = theta > 1e-9 ? sin((1 - t) * theta) / sin(theta) : 1 - t;
+  double wb = sign * (theta > 1e-9 ? sin(t * theta) / sin(theta) : t);
+  double error = fabs(wa * a->x + wb * b->x - q->x);
+  error = fmax(error, fabs(wa * a->y + wb * b->y - q->y));
+  error = fmax(error, fabs(wa * a->z + wb * b->z - q->z));
+  return fmax(error, fabs(wa * a->w + wb * b->w - q->w));
+}
+
+static void microQuatScalar(void (*interpolate)(kmQuaternion const*, kmQuaternion const*, float, kmQuaternion*))
+{
+  int i;
+  for (i = 0; i < NUM_INPUTS; ++i)
+  {
+    interpolate(&quatFrom[i], &quatTo[i], inputs[i], &quatOut[i]);
+  }
+}
+
+static void microQuatBatch(void (*interpolate)(kmQuaternion const*, kmQuaternion const*, float, kmQuaternion*))
+{
+  (void) interpolate;
+  gasQuaternionNlerpBatch(quatFrom, quatTo, inputs, quatOut, NUM_INPUTS);
+}
+
+static void microRunQuat(char const* name, void (*run)(void (*)(kmQuaternion const*, kmQuaternion const*, float, kmQuaternion*)),
+                         void (*interpolate)(kmQuaternion const*, kmQuaternion const*, float, kmQuaternion*),
+                         unsigned int iterations)
+{
+  run(interpolate);
+
+  double maxError = 0;
+  int i;
+  for (i = 0; i < NUM_INPUTS; ++i)
+  {
+    double error = microQuatReferenceError(i, &quatOut[i]);
+    maxError = error > maxError ? error : maxError;
+  }
+
+  double best = -1;
+  unsigned int r;
+  for (r = 0; r < 5; ++r)
+  {
+    double start = microNow();
+    unsigned int n;
+    for (n = 0; n < iterations; ++n)
+    {
+      run(interpolate);
+      sink = quatOut[n % NUM_INPUTS].w;
+    }
+    double end = microNow();
+
+    double perCall = (end - start) / ((double) iterations * NUM_INPUTS);
+    best = best < 0 || perCall < best ? perCall : best;
+  }
+
+  printf("%-24s %14.2f %14.3e\n", name, best, maxError);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+
+  int i;
+  for (i = 0; i < NUM_INPUTS; ++i)
+  {
+    inputs[i] = (i + 0.5f) / NUM_INPUTS;
+  }
+
+  bakedAuto = gasEasingBake(0.42f, 0.0f, 0.58f, 1.0f, 0);
+
+  printf("%-24s %14s %14s\n", "kernel", MICRO_UNIT, "max error");
+  for (i = 0; i < NUM_KERNELS; ++i)
+  {
+    microRun(&KERNELS[i], iterations);
+  }
+
+  for (i = 0; i < NUM_BATCHES; ++i)
+  {
+    microRunBatch(&BATCHES[i], iterations);
+  }
+
+  microQuatSetup();
+  microRunQuat("quaternion slerp", microQuatScalar, _gasQuaternionSlerp, iterations);
+  microRunQuat("quaternion nlerp", microQuatScalar, _gasQuaternionNlerp, iterations);
+  microRunQuat("batch quaternion nlerp", microQuatBatch, _gasQuaternionNlerp, iterations);
+
+  gasEasingCurveFree(bakedAuto);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,363 @@
+#include "glhck/glhck.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct _glhckObject {
+  size_t refCounter;
+  kmVec3 position;
+  kmVec3 rotation;
+  kmVec3 scale;
+  int transformDirty;
+  glhckAnimation** animations;
+  unsigned int numAnimations;
+  glhckBone** bones;
+  unsigned int numBones;
+};
+
+struct _glhckAnimation {
+  size_t refCounter;
+  char* name;
+  kmScalar duration;
+};
+
+struct _glhckBone {
+  size_t refCounter;
+};
+
+struct _glhckAnimator {
+  size_t refCounter;
+  glhckAnimation* animation;
+  glhckBone** bones;
+  unsigned int numBones;
+  kmScalar playTime;
+};
+
+/* Counters are kept per thread so threaded managers can write objects from
+ * several threads; every thread's block stays registered for the totals. */
+typedef struct _glhckStubThreadStats {
+  glhckStubStats stats;
+  struct _glhckStubThreadStats* next;
+} glhckStubThreadStats;
+
+static pthread_mutex_t statsMutex = PTHREAD_MUTEX_INITIALIZER;
+static glhckStubThreadStats* allStats = NULL;
+static __thread glhckStubStats* threadStats = NULL;
+
+static glhckStubStats* stubStats(void)
+{
+  if (!threadStats)
+  {
+    glhckStubThreadStats* block = calloc(1, sizeof(glhckStubThreadStats));
+    pthread_mutex_lock(&statsMutex);
+    block->next = allStats;
+    allStats = block;
+    pthread_mutex_unlock(&statsMutex);
+    threadStats = &block->stats;
+  }
+  return threadStats;
+}
+
+glhckObject* glhckObjectNew(void)
+{
+  glhckObject* object = calloc(1, sizeof(glhckObject));
+  object->refCounter = 1;
+  object->scale.x = object->scale.y = object->scale.z = 1.0f;
+  return object;
+}
+
+glhckObject* glhckObjectRef(glhckObject* object)
+{
+  object->refCounter += 1;
+  return object;
+}
+
+size_t glhckObjectFree(glhckObject* object)
+{
+  if (--object->refCounter > 0)
+    return object->refCounter;
+
+  unsigned int i;
+  for (i = 0; i < object->numAnimations; ++i)
+  {
+    glhckAnimationFree(object->animations[i]);
+  }
+  for (i = 0; i < object->numBones; ++i)
+  {
+    glhckBoneFree(object->bones[i]);
+  }
+  free(object->animations);
+  free(object->bones);
+  free(object);
+  return 0;
+}
+
+const kmVec3* glhckObjectGetPosition(const glhckObject* object)
+{
+  return &object->position;
+}
+
+void glhckObjectPosition(glhckObject* object, const kmVec3* position)
+{
+  object->position = *position;
+  object->transformDirty = 1;
+  stubStats()->positionWrites += 1;
+}
+
+void glhckObjectPositionf(glhckObject* object, kmScalar x, kmScalar y, kmScalar z)
+{
+  kmVec3 position = { x, y, z };
+  glhckObjectPosition(object, &position);
+}
+
+const kmVec3* glhckObjectGetRotation(const glhckObject* object)
+{
+  return &object->rotation;
+}
+
+void glhckObjectRotation(glhckObject* object, const kmVec3* rotation)
+{
+  object->rotation = *rotation;
+  object->transformDirty = 1;
+  stubStats()->rotationWrites += 1;
+}
+
+void glhckObjectRotationf(glhckObject* object, kmScalar x, kmScalar y, kmScalar z)
+{
+  kmVec3 rotation = { x, y, z };
+  glhckObjectRotation(object, &rotation);
+}
+
+const kmVec3* glhckObjectGetScale(const glhckObject* object)
+{
+  return &object->scale;
+}
+
+void glhckObjectScale(glhckObject* object, const kmVec3* scale)
+{
+  object->scale = *scale;
+  object->transformDirty = 1;
+  stubStats()->scaleWrites += 1;
+}
+
+void glhckObjectScalef(glhckObject* object, kmScalar x, kmScalar y, kmScalar z)
+{
+  kmVec3 scale = { x, y, z };
+  glhckObjectScale(object, &scale);
+}
+
+int glhckObjectInsertAnimations(glhckObject* object, glhckAnimation** animations, unsigned int memb)
+{
+  unsigned int i;
+  for (i = 0; i < object->numAnimations; ++i)
+  {
+    glhckAnimationFree(object->animations[i]);
+  }
+  free(object->animations);
+
+  object->animations = calloc(memb, sizeof(glhckAnimation*));
+  for (i = 0; i < memb; ++i)
+  {
+    animations[i]->refCounter += 1;
+    object->animations[i] = animations[i];
+  }
+  object->numAnimations = memb;
+  return 1;
+}
+
+glhckAnimation** glhckObjectAnimations(glhckObject* object, unsigned int* memb)
+{
+  if (memb) *memb = object->numAnimations;
+  return object->animations;
+}
+
+int glhckObjectInsertBones(glhckObject* object, glhckBone** bones, unsigned int memb)
+{
+  unsigned int i;
+  for (i = 0; i < object->numBones; ++i)
+  {
+    glhckBoneFree(object->bones[i]);
+  }
+  free(object->bones);
+
+  object->bones = calloc(memb, sizeof(glhckBone*));
+  for (i = 0; i < memb; ++i)
+  {
+    bones[i]->refCounter += 1;
+    object->bones[i] = bones[i];
+  }
+  object->numBones = memb;
+  return 1;
+}
+
+glhckBone** glhckObjectBones(glhckObject* object, unsigned int* memb)
+{
+  if (memb) *memb = object->numBones;
+  return object->bones;
+}
+
+glhckAnimation* glhckAnimationNew(void)
+{
+  glhckAnimation* animation = calloc(1, sizeof(glhckAnimation));
+  animation->refCounter = 1;
+  return animation;
+}
+
+size_t glhckAnimationFree(glhckAnimation* object)
+{
+  if (--object->refCounter > 0)
+    return object->refCounter;
+
+  free(object->name);
+  free(object);
+  return 0;
+}
+
+void glhckAnimationName(glhckAnimation* object, const char* name)
+{
+  free(object->name);
+  object->name = name ? strdup(name) : NULL;
+}
+
+const char* glhckAnimationGetName(glhckAnimation* object)
+{
+  return object->name ? object->name : "";
+}
+
+void glhckAnimationDuration(glhckAnimation* object, kmScalar duration)
+{
+  object->duration = duration;
+}
+
+kmScalar glhckAnimationGetDuration(glhckAnimation* object)
+{
+  return object->duration;
+}
+
+glhckBone* glhckBoneNew(void)
+{
+  glhckBone* bone = calloc(1, sizeof(glhckBone));
+  bone->refCounter = 1;
+  return bone;
+}
+
+size_t glhckBoneFree(glhckBone* object)
+{
+  if (--object->refCounter > 0)
+    return object->refCounter;
+
+  free(object);
+  return 0;
+}
+
+glhckAnimator* glhckAnimatorNew(void)
+{
+  glhckAnimator* animator = calloc(1, sizeof(glhckAnimator));
+  animator->refCounter = 1;
+  stubStats()->animatorsCreated += 1;
+  return animator;
+}
+
+glhckAnimator* glhckAnimatorRef(glhckAnimator* object)
+{
+  object->refCounter += 1;
+  return object;
+}
+
+size_t glhckAnimatorFree(glhckAnimator* object)
+{
+  if (--object->refCounter > 0)
+    return object->refCounter;
+
+  unsigned int i;
+  for (i = 0; i < object->numBones; ++i)
+  {
+    glhckBoneFree(object->bones[i]);
+  }
+  if (object->animation)
+  {
+    glhckAnimationFree(object->animation);
+  }
+  free(object->bones);
+  free(object);
+  return 0;
+}
+
+void glhckAnimatorAnimation(glhckAnimator* object, glhckAnimation* animation)
+{
+  if (animation)
+  {
+    animation->refCounter += 1;
+  }
+  if (object->animation)
+  {
+    glhckAnimationFree(object->animation);
+  }
+  object->animation = animation;
+}
+
+glhckAnimation* glhckAnimatorGetAnimation(glhckAnimator* object)
+{
+  return object->animation;
+}
+
+int glhckAnimatorInsertBones(glhckAnimator* object, glhckBone** bones, unsigned int memb)
+{
+  unsigned int i;
+  for (i = 0; i < object->numBones; ++i)
+  {
+    glhckBoneFree(object->bones[i]);
+  }
+  free(object->bones);
+
+  object->bones = calloc(memb, sizeof(glhckBone*));
+  for (i = 0; i < memb; ++i)
+  {
+    bones[i]->refCounter += 1;
+    object->bones[i] = bones[i];
+  }
+  object->numBones = memb;
+  return 1;
+}
+
+void glhckAnimatorUpdate(glhckAnimator* object, kmScalar playTime)
+{
+  object->playTime = playTime;
+  stubStats()->animatorUpdates += 1;
+}
+
+void glhckAnimatorTransform(glhckAnimator* object, glhckObject* gobject)
+{
+  gobject->transformDirty = 1;
+  stubStats()->animatorTransforms += 1;
+  (void) object;
+}
+
+void glhckStubGetStats(glhckStubStats* out)
+{
+  memset(out, 0, sizeof(glhckStubStats));
+  pthread_mutex_lock(&statsMutex);
+  glhckStubThreadStats* block;
+  for (block = allStats; block; block = block->next)
+  {
+    out->positionWrites += block->stats.positionWrites;
+    out->rotationWrites += block->stats.rotationWrites;
+    out->scaleWrites += block->stats.scaleWrites;
+    out->animatorsCreated += block->stats.animatorsCreated;
+    out->animatorUpdates += block->stats.animatorUpdates;
+    out->animatorTransforms += block->stats.animatorTransforms;
+  }
+  pthread_mutex_unlock(&statsMutex);
+}
+
+void glhckStubResetStats(void)
+{
+  pthread_mutex_lock(&statsMutex);
+  glhckStubThreadStats* block;
+  for (block = allStats; block; block = block->next)
+  {
+    memset(&block->stats, 0, sizeof(glhckStubStats));
+  }
+  pthread_mutex_unlock(&statsMutex);
+}
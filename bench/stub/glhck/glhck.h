@@ -0,0 +1,91 @@
+#ifndef GAS_BENCH_GLHCK_STUB_H
+#define GAS_BENCH_GLHCK_STUB_H
+
+/* Headless stand-in for the parts of glhck and kazmath that gas uses.
+ * Objects are plain transform holders, so the benchmarks measure gas itself
+ * without a window, a GL context or a GPU. */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef float kmScalar;
+
+typedef struct kmVec3 {
+  kmScalar x;
+  kmScalar y;
+  kmScalar z;
+} kmVec3;
+
+typedef struct kmQuaternion {
+  kmScalar x;
+  kmScalar y;
+  kmScalar z;
+  kmScalar w;
+} kmQuaternion;
+
+typedef struct _glhckObject glhckObject;
+typedef struct _glhckAnimation glhckAnimation;
+typedef struct _glhckAnimator glhckAnimator;
+typedef struct _glhckBone glhckBone;
+
+/* Object */
+glhckObject* glhckObjectNew(void);
+glhckObject* glhckObjectRef(glhckObject* object);
+size_t glhckObjectFree(glhckObject* object);
+
+const kmVec3* glhckObjectGetPosition(const glhckObject* object);
+void glhckObjectPosition(glhckObject* object, const kmVec3* position);
+void glhckObjectPositionf(glhckObject* object, kmScalar x, kmScalar y, kmScalar z);
+const kmVec3* glhckObjectGetRotation(const glhckObject* object);
+void glhckObjectRotation(glhckObject* object, const kmVec3* rotation);
+void glhckObjectRotationf(glhckObject* object, kmScalar x, kmScalar y, kmScalar z);
+const kmVec3* glhckObjectGetScale(const glhckObject* object);
+void glhckObjectScale(glhckObject* object, const kmVec3* scale);
+void glhckObjectScalef(glhckObject* object, kmScalar x, kmScalar y, kmScalar z);
+
+int glhckObjectInsertAnimations(glhckObject* object, glhckAnimation** animations, unsigned int memb);
+glhckAnimation** glhckObjectAnimations(glhckObject* object, unsigned int* memb);
+int glhckObjectInsertBones(glhckObject* object, glhckBone** bones, unsigned int memb);
+glhckBone** glhckObjectBones(glhckObject* object, unsigned int* memb);
+
+/* Skeletal animation */
+glhckAnimation* glhckAnimationNew(void);
+size_t glhckAnimationFree(glhckAnimation* object);
+void glhckAnimationName(glhckAnimation* object, const char* name);
+const char* glhckAnimationGetName(glhckAnimation* object);
+void glhckAnimationDuration(glhckAnimation* object, kmScalar duration);
+kmScalar glhckAnimationGetDuration(glhckAnimation* object);
+
+glhckBone* glhckBoneNew(void);
+size_t glhckBoneFree(glhckBone* object);
+
+glhckAnimator* glhckAnimatorNew(void);
+glhckAnimator* glhckAnimatorRef(glhckAnimator* object);
+size_t glhckAnimatorFree(glhckAnimator* object);
+void glhckAnimatorAnimation(glhckAnimator* object, glhckAnimation* animation);
+glhckAnimation* glhckAnimatorGetAnimation(glhckAnimator* object);
+int glhckAnimatorInsertBones(glhckAnimator* object, glhckBone** bones, unsigned int memb);
+void glhckAnimatorUpdate(glhckAnimator* object, kmScalar playTime);
+void glhckAnimatorTransform(glhckAnimator* object, glhckObject* gobject);
+
+/* Stand-in only: counters of transform writes and skeleton work */
+typedef struct glhckStubStats {
+  unsigned long positionWrites;
+  unsigned long rotationWrites;
+  unsigned long scaleWrites;
+  unsigned long animatorsCreated;
+  unsigned long animatorUpdates;
+  unsigned long animatorTransforms;
+} glhckStubStats;
+
+void glhckStubGetStats(glhckStubStats* stats);
+void glhckStubResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GAS_BENCH_GLHCK_STUB_H
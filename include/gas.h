@@ -3,6 +3,8 @@
 
 #include "glhck/glhck.h"
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -28,6 +30,22 @@ typedef enum gasNumberAnimationTarget {
   GAS_NUMBER_ANIMATION_TARGET_ROT_Z
 } gasNumberAnimationTarget;
 
+typedef enum gasVectorAnimationTarget {
+  GAS_VECTOR_ANIMATION_TARGET_POSITION,
+  GAS_VECTOR_ANIMATION_TARGET_ROTATION,
+  GAS_VECTOR_ANIMATION_TARGET_SCALE
+} gasVectorAnimationTarget;
+
+typedef enum gasEasingId {
+  GAS_EASING_LINEAR = 1,
+  GAS_EASING_QUAD_IN,
+  GAS_EASING_QUAD_OUT,
+  GAS_EASING_EASE,
+  GAS_EASING_EASE_IN,
+  GAS_EASING_EASE_OUT,
+  GAS_EASING_EASE_IN_OUT
+} gasEasingId;
+
 /* Callbacks */
 typedef void (*gasActionCallback)(glhckObject* object, void* userdata);
 typedef void (*gasActionResetCallback)(void* userdata);
@@ -42,9 +60,36 @@ typedef void (*gasCustomAnimationFreeCallback)(void* userdata);
 
 typedef float (*gasEasingFunc)(float t);
 
+/* Runs run(task, worker) once for every worker in [0, numWorkers), in any
+ * order and on any threads, and returns when all of them have returned */
+typedef void (*gasTaskFunc)(void* task, unsigned int worker);
+typedef void (*gasDispatchCallback)(gasTaskFunc run, void* task, unsigned int numWorkers, void* userdata);
+
 /* Types */
 typedef struct _gasAnimation gasAnimation;
 typedef struct _gasManager gasManager;
+typedef struct _gasAnimationTemplate gasAnimationTemplate;
+typedef struct _gasAnimationBank gasAnimationBank;
+typedef struct _gasAnimationCache gasAnimationCache;
+
+/* Refers to an animation added to a manager. The handle goes stale once the
+ * animation finishes or is removed. A zeroed handle is never valid. */
+typedef struct gasAnimationHandle {
+  unsigned int index;
+  unsigned int generation;
+} gasAnimationHandle;
+
+/* An action that fired while its manager deferred actions. animation is the
+ * animation the action belongs to as it was added to the manager, time is
+ * how far into the frame's delta the action fired. */
+typedef struct gasEvent {
+  gasAnimation* animation;
+  glhckObject* object;
+  gasActionCallback callback;
+  void* userdata;
+  float time;
+} gasEvent;
+typedef struct _gasEasingCurve gasEasingCurve;
 
 
 /* Animation */
@@ -61,6 +106,72 @@ gasAnimation* gasNumberAnimationNewTo(gasNumberAnimationTarget const target, gas
 gasAnimation* gasNumberAnimationNewDelta(gasNumberAnimationTarget const target, gasEasingFunc easing,
                                          float const delta, float const duration);
 
+/* Vector animations move all three components of a target with one easing
+ * evaluation and one transform write, in place of three number animations */
+gasAnimation* gasVectorAnimationNewFromTo(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                          kmVec3 const* from, kmVec3 const* to, float const duration);
+gasAnimation* gasVectorAnimationNewFromDelta(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                             kmVec3 const* from, kmVec3 const* delta, float const duration);
+gasAnimation* gasVectorAnimationNewDeltaTo(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                           kmVec3 const* delta, kmVec3 const* to, float const duration);
+gasAnimation* gasVectorAnimationNewFrom(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                        kmVec3 const* from, float const duration);
+gasAnimation* gasVectorAnimationNewTo(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                      kmVec3 const* to, float const duration);
+gasAnimation* gasVectorAnimationNewDelta(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                         kmVec3 const* delta, float const duration);
+
+/* Rotation animations interpolate orientations as quaternions, by slerp or
+ * optionally nlerp, along the shorter arc, and write the object's rotation
+ * once per step. Quaternions map to glhckObjectRotation's Euler angles as
+ * rotations about X, then Y, then Z, see gasQuaternionFromEuler. Delta
+ * rotations are applied in the local frame of the start orientation. */
+gasAnimation* gasRotationAnimationNewFromTo(gasEasingFunc easing, kmQuaternion const* from, kmQuaternion const* to,
+                                            float const duration);
+gasAnimation* gasRotationAnimationNewFromDelta(gasEasingFunc easing, kmQuaternion const* from, kmQuaternion const* delta,
+                                               float const duration);
+gasAnimation* gasRotationAnimationNewDeltaTo(gasEasingFunc easing, kmQuaternion const* delta, kmQuaternion const* to,
+                                             float const duration);
+gasAnimation* gasRotationAnimationNewFrom(gasEasingFunc easing, kmQuaternion const* from, float const duration);
+gasAnimation* gasRotationAnimationNewTo(gasEasingFunc easing, kmQuaternion const* to, float const duration);
+gasAnimation* gasRotationAnimationNewDelta(gasEasingFunc easing, kmQuaternion const* delta, float const duration);
+gasAnimation* gasRotationAnimationNlerp(gasAnimation* animation, gasBoolean const nlerp);
+
+/* Keyframe tracks play a channel through any number of keys in one node,
+ * in place of a sequence of number animations. Keys are absolute values in
+ * order of time, the track takes as long as its last key's time and holds
+ * its first value until then. A key's easing, or its curve if it has one,
+ * shapes the way there from the key before it, so the first key's is not
+ * used. Playing finds the current key in constant time, jumping elsewhere
+ * takes a binary search. Keys are copied once and shared by clones and
+ * compiled animations. Returns NULL without keys or with keys out of
+ * order. */
+typedef struct gasKeyframe {
+  float time;
+  float value;
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
+} gasKeyframe;
+
+gasAnimation* gasTrackAnimationNew(gasNumberAnimationTarget const target, gasKeyframe const* keys,
+                                   unsigned int const numKeys);
+
+/* Path animations move the object's position through waypoints in one node,
+ * along straight segments or a uniform Catmull-Rom spline through them, at
+ * constant speed: the easing maps time to the distance travelled, looked up
+ * in a table of arc lengths built once. hop lifts Y by a parabola over each
+ * segment peaking at hop in its middle, which does not count towards the
+ * distance. Waypoints are copied once and shared by clones and compiled
+ * animations. Returns NULL without waypoints. */
+typedef enum gasPathInterpolation {
+  GAS_PATH_LINEAR,
+  GAS_PATH_CATMULL_ROM
+} gasPathInterpolation;
+
+gasAnimation* gasPathAnimationNew(gasPathInterpolation const interpolation, gasEasingFunc easing,
+                                  kmVec3 const* points, unsigned int const numPoints, float const hop,
+                                  float const duration);
+
 gasAnimation* gasPauseAnimationNew(float const duration);
 gasAnimation* gasSequentialAnimationNew(gasAnimation** children, unsigned int const numChildren);
 gasAnimation* gasParallelAnimationNew(gasAnimation** children, unsigned int const numChildren);
@@ -72,26 +183,244 @@ gasAnimation* gasCustomAnimationNew(gasCustomAnimationCallback callback, gasCust
                                     void* userdata);
 gasAnimation* gasAnimationClone(gasAnimation* animation);
 
+/* Model animations bind to the object's skeletal animation of their name on
+ * their first step, and clones start out unbound. Binding sets up an
+ * animator, so spawning many model animations can instead bind them up
+ * front, outside of gasAnimate and gasManagerAnimate. Binds every model
+ * animation in the tree, including compiled ones, not bound yet and returns
+ * GAS_FALSE if the object lacks any of their animations. Animators of freed
+ * model animations are kept, holding on to their animation and bones, and
+ * reused by model animations playing the same animation on the same
+ * skeleton. gasModelAnimationClearCache frees the ones kept. */
+gasBoolean gasModelAnimationBind(gasAnimation* animation, glhckObject* object);
+void gasModelAnimationClearCache();
+
+/* Model animations pose their skeleton only when the time they play at
+ * changes. For distant or unimportant objects they can be told to pose it
+ * at most every frames steps, and only once it has moved on by at least
+ * minStep seconds of the model animation. Time keeps running in between and
+ * the next pose catches up, and the final pose is never skipped. Applies to
+ * every model animation in the tree, including compiled ones, and may be
+ * changed while they play. 1 and 0 pose on every step. */
+gasAnimation* gasModelAnimationUpdateRate(gasAnimation* animation, unsigned int const frames, float const minStep);
+
+/* Lowers an animation tree into a flat program evaluated from one contiguous
+ * buffer. The result behaves exactly like the source tree, including its
+ * current progress, and is used like any other animation. The source tree is
+ * left untouched and still owned by the caller. */
+gasAnimation* gasAnimationCompile(gasAnimation* animation);
+
+/* Templates are compiled animations whose definition is built once and never
+ * changes, shared by every animation instantiated from them. An instance is
+ * one small allocation holding only playback state. It starts where the
+ * source tree was when the template was made and is used and freed like any
+ * other animation, and cloning it copies only its state. Action and custom
+ * userdata are cloned per instance through their clone callbacks, as
+ * gasAnimationClone would. Instances keep their template alive, so it may be
+ * freed while instances remain. A template may be instantiated from several
+ * threads at once. */
+gasAnimationTemplate* gasAnimationTemplateNew(gasAnimation* animation);
+gasAnimation* gasAnimationTemplateInstantiate(gasAnimationTemplate* animationTemplate);
+void gasAnimationTemplateFree(gasAnimationTemplate* animationTemplate);
+gasBoolean gasAnimationTemplateSample(gasAnimationTemplate* animationTemplate, glhckObject* object, float const time);
+
+/* Serialized animations store what an animation tree does, not how far it
+ * got, in a compact versioned format of 32 bit words in the byte order of
+ * the machine writing it. Compiled animations and template instances are
+ * stored as the trees they were made from. Functions cannot be stored, so
+ * action and custom animations, easing functions other than the built-in
+ * ones and baked curves are stored as their index in a table of references
+ * passed to both sides. Action and custom animations match an entry with
+ * the same callbacks, preferably one with the same userdata too, and are
+ * read back with the entry's userdata, cloned through its clone callback
+ * if it has one. Names are only used by text definitions, see
+ * gasAnimationParse. gasAnimationSerialize returns a buffer to free() or NULL
+ * if the table lacks something the animation refers to.
+ * gasAnimationDeserialize returns NULL for data that is malformed, written
+ * by another version or byte order, or refers past the table. */
+typedef struct gasReference {
+  gasActionCallback action;
+  gasCustomAnimationCallback custom;
+  gasActionResetCallback resetCallback;
+  gasActionCloneCallback cloneCallback;
+  gasActionFreeCallback freeCallback;
+  void* userdata;
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
+  char const* name;
+} gasReference;
+
+void* gasAnimationSerialize(gasAnimation* animation, gasReference const* references, unsigned int const numReferences,
+                            size_t* size);
+gasAnimation* gasAnimationDeserialize(void const* data, size_t const size, gasReference const* references,
+                                      unsigned int const numReferences);
+
+/* Banks are libraries of serialized animations by name, written in one go
+ * and meant to be mapped from disk. Opening a bank only checks its
+ * directory, including that names are in order, and reads it where it
+ * lies, so data must outlive the bank. Each
+ * animation is read into a template the first time it is asked for, which
+ * the bank owns and keeps until it is freed. Animations are kept sorted by
+ * name, which is what indices refer to, and names must be unique. A bank
+ * may be used from several threads at once. gasAnimationBankFind returns -1
+ * for names not in the bank and gasAnimationBankTemplate NULL for
+ * animations that cannot be read. */
+void* gasAnimationBankWrite(gasAnimation** animations, char const** names, unsigned int const numAnimations,
+                            gasReference const* references, unsigned int const numReferences, size_t* size);
+gasAnimationBank* gasAnimationBankOpen(void const* data, size_t const size, gasReference const* references,
+                                       unsigned int const numReferences);
+unsigned int gasAnimationBankSize(gasAnimationBank* bank);
+char const* gasAnimationBankName(gasAnimationBank* bank, unsigned int const index);
+int gasAnimationBankFind(gasAnimationBank* bank, char const* name);
+gasAnimationTemplate* gasAnimationBankTemplate(gasAnimationBank* bank, unsigned int const index);
+void gasAnimationBankFree(gasAnimationBank* bank);
+
+/* Text definitions describe an animation in a line or two instead of a
+ * constructor call per node:
+ *
+ *   seq(par(x.delta(-100, 0.3, quadIn), y.delta(-100, 0.3, quadOut)),
+ *       pause(0.5), scale.to([2, 2, 2], 1, ease), action(boom) once) loop 3
+ *
+ * Nodes are seq(...) and par(...) of any number of animations, pause(d),
+ * model(name, d), action(name), custom(name) and target.kind(values, d,
+ * easing). Targets x, y, z, rotX, rotY and rotZ take numbers, position,
+ * rotation and scale [x, y, z] vectors, and orientation rotates by
+ * quaternions given as [x, y, z, w] or as [x, y, z] Euler angles in
+ * degrees. Kinds are fromTo, fromDelta and deltaTo with two values and
+ * from, to and delta with one. The easing is optional, linear by default,
+ * and one of linear, quadIn, quadOut, ease, easeIn, easeOut, easeInOut or
+ * the name of a reference. Number targets also take tracks, written as
+ * x.keys([time, value, easing], ...) with every key's easing optional, and
+ * position takes paths, written as position.path([x, y, z], ..., d,
+ * easing), or position.spline for a Catmull-Rom spline. Action, custom,
+ * easing and curve references are found by name in the table and used as
+ * serialized animations use them. Any node may be followed by loop n, loop
+ * to loop endlessly, rate(frames, minStep) for its model animations, nlerp
+ * for rotations, hop h for paths and once for actions, where n and frames
+ * are whole numbers. # starts a comment. gasAnimationParse returns NULL for
+ * text it cannot read and, if errorOffset is given, where it stopped. */
+gasAnimation* gasAnimationParse(char const* source, size_t const length, gasReference const* references,
+                                unsigned int const numReferences, size_t* errorOffset);
+
+/* Caches parse text definitions once per distinct text, keyed by a hash of
+ * the text, and then only instantiate the template they keep for it. The
+ * reference table is copied, what it points to must outlive the cache. A
+ * cache may be used from several threads at once. */
+gasAnimationCache* gasAnimationCacheNew(gasReference const* references, unsigned int const numReferences);
+gasAnimation* gasAnimationCacheLoad(gasAnimationCache* cache, char const* source, size_t const length,
+                                    size_t* errorOffset);
+void gasAnimationCacheFree(gasAnimationCache* cache);
+
 void gasAnimationFree(gasAnimation* animation);
 
 gasBoolean gasAnimate(gasAnimation* animation, glhckObject* object, float const delta);
 
+/* Moves the object to where the animation would have it time seconds after
+ * starting from where the object is now, without playing or changing the
+ * animation, so animations may be sampled from any number of threads at
+ * once as long as nothing plays them meanwhile. Actions do not fire and
+ * model animations leave skeletons alone. Compiled animations and template
+ * instances seek in time logarithmic in the length of the sequences on the
+ * way, trees in time linear in their size. Returns GAS_FALSE, leaving the
+ * object untouched, for animations holding custom animations, delta or FROM
+ * rotations, TO rotations whose easing does not end at 1, or parallel
+ * animations whose children write the same channels. */
+gasBoolean gasAnimationSample(gasAnimation* animation, glhckObject* object, float const time);
+
 gasAnimationState gasAnimationGetState(gasAnimation* animation);
 
 gasAnimation*  gasAnimationLoopTimes(gasAnimation* animation, unsigned int times);
 gasAnimation*  gasAnimationLoop(gasAnimation* animation);
 
+/* When one step spans several loops of an animation, the loops in between
+ * are skipped instead of played if the length of a loop is known up front:
+ * it holds no model or custom animations, delta rotations, from or to
+ * animations whose easing does not end on 1, endlessly looping children or
+ * parallel animations writing the same channel, and nothing in a parallel
+ * animation beside it writes the same channels either.
+ * Skipped loops leave the object where playing them would have, up to float
+ * rounding.
+ * Actions in skipped loops fire once per loop as it ends, or only in the
+ * last skipped loop once gasActionFireOnce is set, and should leave the
+ * channels the loop animates alone. An endless loop that takes no time
+ * plays once per step. */
+gasAnimation* gasActionFireOnce(gasAnimation* animation, gasBoolean const once);
+
 void gasAnimationReset(gasAnimation* animation);
 
 /* Manager */
 gasManager* gasManagerNew();
 void gasManagerFree(gasManager* manager);
 
-void gasManagerAddAnimation(gasManager* manager, gasAnimation* animation, glhckObject* object);
+/* Frees every animation in the manager and releases all of its entries at
+ * once. Must not be called from inside gasManagerAnimate. */
+void gasManagerClear(gasManager* manager);
+
+gasAnimationHandle gasManagerAddAnimation(gasManager* manager, gasAnimation* animation, glhckObject* object);
 void gasManagerRemoveAnimation(gasManager* manager, gasAnimation* animation);
+
+/* Constant time operations through handles. They return GAS_FALSE for stale
+ * handles, and a stale handle reports GAS_ANIMATION_STATE_FINISHED. Removal
+ * takes effect before the animation would next be advanced. */
+gasBoolean gasManagerHandleValid(gasManager* manager, gasAnimationHandle const handle);
+gasBoolean gasManagerRemoveHandle(gasManager* manager, gasAnimationHandle const handle);
+gasBoolean gasManagerPauseHandle(gasManager* manager, gasAnimationHandle const handle, gasBoolean const paused);
+gasAnimationState gasManagerGetHandleState(gasManager* manager, gasAnimationHandle const handle);
+
+/* Object scoped operations cost O(animations on the object).
+ * gasManagerGetObjectAnimations fills up to maxHandles handles and returns
+ * how many animations the object has. */
 void gasManagerRemoveObjectAnimations(gasManager* manager, glhckObject* object);
+void gasManagerPauseObjectAnimations(gasManager* manager, glhckObject* object, gasBoolean const paused);
+unsigned int gasManagerGetObjectAnimations(gasManager* manager, glhckObject* object,
+                                           gasAnimationHandle* handles, unsigned int const maxHandles);
+
 void gasManagerAnimate(gasManager* manager, float const delta);
 
+/* Standalone number animations and parallel groups of them are advanced in a
+ * batched structure-of-arrays pass when batching is enabled (it is disabled
+ * by default). Batched animations keep their state and time up to date, but
+ * they run before the object's other animations, in the order they were
+ * added, so animations writing the same channel of one object may leave it
+ * with a different value than without batching. */
+void gasManagerBatching(gasManager* manager, gasBoolean const enabled);
+
+/* Animations that will stay idle for a while, like ones waiting out a pause,
+ * are parked until shortly before their next change when parking is enabled
+ * (it is disabled by default), so they cost nothing per frame while they
+ * wait. A woken animation catches up on the time it was parked for in one
+ * step and runs before the object's other animations from then on, so
+ * animations writing the same channel of one object, or rounding the time
+ * they catch up on differently, may leave it with a different value than
+ * without parking. */
+void gasManagerParking(gasManager* manager, gasBoolean const enabled);
+
+/* Threaded managers split gasManagerAnimate across workers by target object,
+ * so every animation of one object runs on one thread, in the same order and
+ * with the same results as on a serial manager. Callbacks may then run on any
+ * worker: they may touch their own object but must not call into the manager
+ * or touch other objects. gasManagerNewThreaded starts numThreads - 1 threads
+ * of its own, 0 meaning one per processor. gasManagerDispatch hands the work
+ * to a task system instead, or makes the manager serial again when dispatch
+ * is NULL. */
+gasManager* gasManagerNewThreaded(unsigned int numThreads);
+void gasManagerDispatch(gasManager* manager, gasDispatchCallback dispatch, unsigned int numWorkers, void* userdata);
+
+/* While actions are deferred, gasManagerAnimate records the actions that
+ * fire instead of calling them and gasManagerDispatchEvents calls them
+ * afterwards, ordered by when they fired within the frame. Custom
+ * animations still run inline as their result decides how they advance.
+ * Deferred callbacks run outside the animation pass, on the calling thread
+ * even for threaded managers, and may use the manager freely except for
+ * gasManagerAnimate and gasManagerClear. Animations that finished in the
+ * frame are freed once their events are dispatched. Events still pending
+ * when the manager animates again are dispatched first. gasManagerGetEvents
+ * fills up to maxEvents pending events in dispatch order and returns how
+ * many there are. */
+void gasManagerDeferActions(gasManager* manager, gasBoolean const enabled);
+unsigned int gasManagerDispatchEvents(gasManager* manager);
+unsigned int gasManagerGetEvents(gasManager* manager, gasEvent* events, unsigned int const maxEvents);
+
 /* Easing functions */
 
 float gasEasingLinear(float t);
@@ -105,6 +434,39 @@ float gasEasingEaseInOut(float t);
 /* A general easing curve function to implement others with */
 float gasEasingCubicBezier(float x, float p1x, float p1y, float p2x, float p2y);
 
+/* Baked easing curves: lookup tables with linear interpolation. A resolution
+ * of 0 picks one meeting a default error bound of 1e-5, and baking returns
+ * NULL for easings no resolution up to 65536 meets it for, such as ones with
+ * a jump. Explicit resolutions are clamped to 65536. gasEasingCurveError
+ * reports the largest deviation from the source easing measured while
+ * baking. The built-in Ease* functions use baked curves. */
+gasEasingCurve* gasEasingBake(float const p1x, float const p1y, float const p2x, float const p2y,
+                              unsigned int const resolution);
+gasEasingCurve* gasEasingBakeFunc(gasEasingFunc easing, unsigned int const resolution);
+float gasEasingCurveEvaluate(gasEasingCurve const* curve, float const t);
+float gasEasingCurveError(gasEasingCurve const* curve);
+unsigned int gasEasingCurveResolution(gasEasingCurve const* curve);
+void gasEasingCurveFree(gasEasingCurve* curve);
+
+/* Evaluates one easing over n values with SSE2/AVX2 kernels picked at
+ * runtime. Results match the scalar functions exactly. out may alias t, and
+ * is left untouched for values outside of gasEasingId. */
+void gasEasingEvaluateBatch(gasEasingId const easing, float const* t, float* out, size_t const n);
+void gasEasingCurveEvaluateBatch(gasEasingCurve const* curve, float const* t, float* out, size_t const n);
+
+/* Quaternion helpers. Zero length quaternions normalize to the identity.
+ * gasQuaternionNlerpBatch blends along the shorter arc and normalizes, and
+ * both batch functions match their scalar counterparts exactly. */
+void gasQuaternionFromEuler(kmVec3 const* degrees, kmQuaternion* out);
+void gasQuaternionNormalizeBatch(kmQuaternion* q, size_t const n);
+void gasQuaternionNlerpBatch(kmQuaternion const* from, kmQuaternion const* to, float const* t,
+                             kmQuaternion* out, size_t const n);
+
+/* Makes a number, vector, rotation or path animation ease with a baked
+ * curve instead of its easing function. The curve must outlive the
+ * animation and any clones of it. */
+gasAnimation* gasNumberAnimationEasingCurve(gasAnimation* animation, gasEasingCurve const* curve);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,75 @@ namespace gas
       return Animation(gasNumberAnimationNewDelta(target, easing, delta, duration));
     }
 
+    static Animation fromTo(gasVectorAnimationTarget const target, gasEasingFunc const easing,
+                            kmVec3 const& from, kmVec3 const& to, float const duration)
+    {
+      return Animation(gasVectorAnimationNewFromTo(target, easing, &from, &to, duration));
+    }
+
+    static Animation fromDelta(gasVectorAnimationTarget const target, gasEasingFunc const easing,
+                               kmVec3 const& from, kmVec3 const& delta, float const duration)
+    {
+      return Animation(gasVectorAnimationNewFromDelta(target, easing, &from, &delta, duration));
+    }
+
+    static Animation deltaTo(gasVectorAnimationTarget const target, gasEasingFunc const easing,
+                             kmVec3 const& delta, kmVec3 const& to, float const duration)
+    {
+      return Animation(gasVectorAnimationNewDeltaTo(target, easing, &delta, &to, duration));
+    }
+
+    static Animation from(gasVectorAnimationTarget const target, gasEasingFunc const easing,
+                          kmVec3 const& from, float const duration)
+    {
+      return Animation(gasVectorAnimationNewFrom(target, easing, &from, duration));
+    }
+
+    static Animation to(gasVectorAnimationTarget const target, gasEasingFunc const easing,
+                        kmVec3 const& to, float const duration)
+    {
+      return Animation(gasVectorAnimationNewTo(target, easing, &to, duration));
+    }
+
+    static Animation delta(gasVectorAnimationTarget const target, gasEasingFunc const easing,
+                           kmVec3 const& delta, float const duration)
+    {
+      return Animation(gasVectorAnimationNewDelta(target, easing, &delta, duration));
+    }
+
+    static Animation fromTo(gasEasingFunc const easing, kmQuaternion const& from, kmQuaternion const& to,
+                            float const duration)
+    {
+      return Animation(gasRotationAnimationNewFromTo(easing, &from, &to, duration));
+    }
+
+    static Animation fromDelta(gasEasingFunc const easing, kmQuaternion const& from, kmQuaternion const& delta,
+                               float const duration)
+    {
+      return Animation(gasRotationAnimationNewFromDelta(easing, &from, &delta, duration));
+    }
+
+    static Animation deltaTo(gasEasingFunc const easing, kmQuaternion const& delta, kmQuaternion const& to,
+                             float const duration)
+    {
+      return Animation(gasRotationAnimationNewDeltaTo(easing, &delta, &to, duration));
+    }
+
+    static Animation from(gasEasingFunc const easing, kmQuaternion const& from, float const duration)
+    {
+      return Animation(gasRotationAnimationNewFrom(easing, &from, duration));
+    }
+
+    static Animation to(gasEasingFunc const easing, kmQuaternion const& to, float const duration)
+    {
+      return Animation(gasRotationAnimationNewTo(easing, &to, duration));
+    }
+
+    static Animation delta(gasEasingFunc const easing, kmQuaternion const& delta, float const duration)
+    {
+      return Animation(gasRotationAnimationNewDelta(easing, &delta, duration));
+    }
+
     static Animation pause(float const duration)
     {
       return Animation(gasPauseAnimationNew(duration));
@@ -145,6 +214,11 @@ namespace gas
       return animation == nullptr || gasAnimate(animation, object, delta);
     }
 
+    bool sample(glhckObject* object, float const time) const
+    {
+      return animation != nullptr && gasAnimationSample(animation, object, time);
+    }
+
     gasAnimationState getState()
     {
       return animation == nullptr ? GAS_ANIMATION_STATE_NOT_STARTED : gasAnimationGetState(animation);
@@ -168,6 +242,38 @@ namespace gas
       return *this;
     }
 
+    Animation& easingCurve(gasEasingCurve const* curve)
+    {
+      if(animation != nullptr)
+      {
+        gasNumberAnimationEasingCurve(animation, curve);
+      }
+      return *this;
+    }
+
+    Animation& nlerp(bool const enabled = true)
+    {
+      if(animation != nullptr)
+      {
+        gasRotationAnimationNlerp(animation, enabled ? GAS_TRUE : GAS_FALSE);
+      }
+      return *this;
+    }
+
+    Animation& fireOnce(bool const enabled = true)
+    {
+      if(animation != nullptr)
+      {
+        gasActionFireOnce(animation, enabled ? GAS_TRUE : GAS_FALSE);
+      }
+      return *this;
+    }
+
+    Animation compiled() const
+    {
+      return Animation(animation != nullptr ? gasAnimationCompile(animation) : nullptr);
+    }
+
     void reset()
     {
       if(animation != nullptr)
@@ -177,6 +283,7 @@ namespace gas
     }
 
   protected:
+    friend class AnimationTemplate;
     Animation(gasAnimation* animation) : animation(animation) {}
     static int n;
     void freeAnimation()
@@ -193,6 +300,44 @@ namespace gas
 
    Animation const Animation::NONE = Animation(nullptr);
    int Animation::n = 0;
+
+  class AnimationTemplate
+  {
+  public:
+    explicit AnimationTemplate(Animation const& animation)
+      : animationTemplate(animation.animation != nullptr ? gasAnimationTemplateNew(animation.animation) : nullptr)
+    {
+    }
+
+    ~AnimationTemplate()
+    {
+      if(animationTemplate != nullptr)
+      {
+        gasAnimationTemplateFree(animationTemplate);
+      }
+    }
+
+    AnimationTemplate(AnimationTemplate const& other) = delete;
+    AnimationTemplate& operator=(AnimationTemplate const& other) = delete;
+
+    AnimationTemplate(AnimationTemplate&& other) : animationTemplate(other.animationTemplate)
+    {
+      other.animationTemplate = nullptr;
+    }
+
+    Animation instantiate() const
+    {
+      return Animation(animationTemplate != nullptr ? gasAnimationTemplateInstantiate(animationTemplate) : nullptr);
+    }
+
+    bool sample(glhckObject* object, float const time) const
+    {
+      return animationTemplate != nullptr && gasAnimationTemplateSample(animationTemplate, object, time);
+    }
+
+  private:
+    gasAnimationTemplate* animationTemplate;
+  };
 }
 
 
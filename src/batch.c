@@ -0,0 +1,459 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Batched number animations
+ *
+ * Standalone number animations and parallel groups of them are flattened
+ * into rows of structure-of-arrays storage when they are added to a manager.
+ * Rows are advanced in one tight loop and compacted in place as they finish,
+ * so rows of one group stay contiguous and in insertion order. The original
+ * gasAnimation is kept by the group so removal by pointer keeps working and
+ * it is freed when the group finishes. Every row writes its time and state
+ * back to the number animation it came from, so the animation reports the
+ * same progress as it would outside of a batch. Finished groups are only
+ * queued while rows are advanced and released afterwards, since releasing
+ * touches the manager's slots and pools which a worker thread must leave
+ * alone. */
+
+#define GAS_BATCH_MIN_RUN 16
+
+static gasBoolean _gasManagerBatchAcceptsNumber(gasAnimation* animation)
+{
+  return animation->type == GAS_ANIMATION_TYPE_NUMBER
+      && animation->state == GAS_ANIMATION_STATE_NOT_STARTED
+      && animation->loops == 1
+      && animation->loop == 0
+      ? GAS_TRUE : GAS_FALSE;
+}
+
+gasBoolean _gasManagerBatchAccepts(gasAnimation* animation)
+{
+  if (_gasManagerBatchAcceptsNumber(animation))
+    return GAS_TRUE;
+
+  if (animation->type != GAS_ANIMATION_TYPE_PARALLEL
+      || animation->state != GAS_ANIMATION_STATE_NOT_STARTED
+      || animation->loops != 1
+      || animation->loop != 0
+      || animation->parallelAnimation.numChildren == 0)
+    return GAS_FALSE;
+
+  unsigned int i;
+  for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+  {
+    if (!_gasManagerBatchAcceptsNumber(animation->parallelAnimation.children[i]))
+      return GAS_FALSE;
+  }
+
+  return GAS_TRUE;
+}
+
+static void _gasManagerBatchReserveRows(_gasManagerBatch* batch, unsigned int const numRows)
+{
+  if (numRows <= batch->rowCapacity)
+    return;
+
+  unsigned int capacity = batch->rowCapacity ? batch->rowCapacity : 64;
+  while (capacity < numRows)
+  {
+    capacity *= 2;
+  }
+
+  batch->time = realloc(batch->time, capacity * sizeof(float));
+  batch->duration = realloc(batch->duration, capacity * sizeof(float));
+  batch->a = realloc(batch->a, capacity * sizeof(float));
+  batch->b = realloc(batch->b, capacity * sizeof(float));
+  batch->eased = realloc(batch->eased, capacity * sizeof(float));
+  batch->easing = realloc(batch->easing, capacity * sizeof(gasEasingFunc));
+  batch->curve = realloc(batch->curve, capacity * sizeof(gasEasingCurve const*));
+  batch->easingId = realloc(batch->easingId, capacity * sizeof(unsigned char));
+  batch->type = realloc(batch->type, capacity * sizeof(unsigned char));
+  batch->target = realloc(batch->target, capacity * sizeof(unsigned char));
+  batch->flags = realloc(batch->flags, capacity * sizeof(unsigned char));
+  batch->group = realloc(batch->group, capacity * sizeof(unsigned int));
+  batch->object = realloc(batch->object, capacity * sizeof(glhckObject*));
+  batch->animation = realloc(batch->animation, capacity * sizeof(gasAnimation*));
+  batch->rowCapacity = capacity;
+}
+
+static unsigned int _gasManagerBatchNewGroup(_gasManagerBatch* batch)
+{
+  if (batch->freeGroup != GAS_BATCH_NO_GROUP)
+  {
+    unsigned int index = batch->freeGroup;
+    batch->freeGroup = batch->groups[index].nextFree;
+    return index;
+  }
+
+  if (batch->numGroups == batch->groupCapacity)
+  {
+    batch->groupCapacity = batch->groupCapacity ? batch->groupCapacity * 2 : 64;
+    batch->groups = realloc(batch->groups, batch->groupCapacity * sizeof(_gasManagerBatchGroup));
+  }
+
+  return batch->numGroups++;
+}
+
+static void _gasManagerBatchReleaseSlot(_gasManagerBatch* batch, _gasManagerBatchGroup* group)
+{
+  if (group->slot != GAS_NO_SLOT)
+  {
+    _gasSlotRelease(batch->slots, group->slot);
+    group->slot = GAS_NO_SLOT;
+  }
+}
+
+static void _gasManagerBatchFreeGroup(_gasManagerBatch* batch, unsigned int const index)
+{
+  _gasManagerBatchGroup* group = &batch->groups[index];
+  _gasManagerBatchReleaseSlot(batch, group);
+  gasAnimationFree(group->animation);
+  group->animation = NULL;
+  group->object = NULL;
+  group->nextFree = batch->freeGroup;
+  batch->freeGroup = index;
+}
+
+static void _gasManagerBatchAddRow(_gasManagerBatch* batch, gasAnimation* animation, glhckObject* object,
+                                   unsigned int const group)
+{
+  unsigned int const row = batch->numRows++;
+  batch->time[row] = animation->numberAnimation.time;
+  batch->duration[row] = animation->numberAnimation.duration;
+  batch->a[row] = animation->numberAnimation.a;
+  batch->b[row] = animation->numberAnimation.b;
+  batch->easing[row] = animation->numberAnimation.easing;
+  batch->curve[row] = animation->numberAnimation.curve;
+  batch->easingId[row] = animation->numberAnimation.curve
+      ? GAS_EASING_ID_CURVE
+      : _gasEasingIdFromFunc(animation->numberAnimation.easing);
+  batch->type[row] = animation->numberAnimation.type;
+  batch->target[row] = animation->numberAnimation.target;
+  batch->flags[row] = 0;
+  batch->group[row] = group;
+  batch->object[row] = object;
+  batch->animation[row] = animation;
+}
+
+void _gasManagerBatchInit(_gasManagerBatch* batch, _gasSlotTable* slots)
+{
+  memset(batch, 0, sizeof(_gasManagerBatch));
+  batch->freeGroup = GAS_BATCH_NO_GROUP;
+  batch->doneGroup = GAS_BATCH_NO_GROUP;
+  batch->slots = slots;
+}
+
+void _gasManagerBatchClear(_gasManagerBatch* batch)
+{
+  unsigned int i;
+  for (i = 0; i < batch->numGroups; ++i)
+  {
+    if (batch->groups[i].animation)
+    {
+      gasAnimationFree(batch->groups[i].animation);
+      batch->groups[i].animation = NULL;
+    }
+  }
+
+  batch->numRows = 0;
+  batch->numGroups = 0;
+  batch->freeGroup = GAS_BATCH_NO_GROUP;
+  batch->doneGroup = GAS_BATCH_NO_GROUP;
+}
+
+void _gasManagerBatchFree(_gasManagerBatch* batch)
+{
+  _gasManagerBatchClear(batch);
+
+  free(batch->time);
+  free(batch->duration);
+  free(batch->a);
+  free(batch->b);
+  free(batch->eased);
+  free(batch->easing);
+  free(batch->curve);
+  free(batch->easingId);
+  free(batch->type);
+  free(batch->target);
+  free(batch->flags);
+  free(batch->group);
+  free(batch->object);
+  free(batch->animation);
+  free(batch->groups);
+  _gasManagerBatchInit(batch, batch->slots);
+}
+
+unsigned int _gasManagerBatchAdd(_gasManagerBatch* batch, gasAnimation* animation, glhckObject* object,
+                                 unsigned int const slot)
+{
+  assert(_gasManagerBatchAccepts(animation));
+
+  unsigned int const index = _gasManagerBatchNewGroup(batch);
+  _gasManagerBatchGroup* group = &batch->groups[index];
+  group->animation = animation;
+  group->object = object;
+  group->slot = slot;
+  group->removed = GAS_FALSE;
+  group->paused = GAS_FALSE;
+  group->state = GAS_ANIMATION_STATE_NOT_STARTED;
+  group->nextFree = GAS_BATCH_NO_GROUP;
+
+  if (animation->type == GAS_ANIMATION_TYPE_NUMBER)
+  {
+    group->parallel = GAS_FALSE;
+    group->numRows = 1;
+    _gasManagerBatchReserveRows(batch, batch->numRows + 1);
+    _gasManagerBatchAddRow(batch, animation, object, index);
+  }
+  else
+  {
+    unsigned int const numChildren = animation->parallelAnimation.numChildren;
+    group->parallel = GAS_TRUE;
+    group->numRows = numChildren;
+    _gasManagerBatchReserveRows(batch, batch->numRows + numChildren);
+
+    unsigned int i;
+    for (i = 0; i < numChildren; ++i)
+    {
+      _gasManagerBatchAddRow(batch, animation->parallelAnimation.children[i], object, index);
+    }
+  }
+
+  return index;
+}
+
+/* Rows of a removed group are dropped by the next _gasManagerBatchAnimate,
+ * its handle goes stale right away */
+void _gasManagerBatchRemoveGroup(_gasManagerBatch* batch, unsigned int const index)
+{
+  _gasManagerBatchGroup* group = &batch->groups[index];
+  group->removed = GAS_TRUE;
+  _gasManagerBatchReleaseSlot(batch, group);
+}
+
+gasBoolean _gasManagerBatchRemoveAnimation(_gasManagerBatch* batch, gasAnimation* animation)
+{
+  unsigned int i;
+  for (i = 0; i < batch->numGroups; ++i)
+  {
+    if (batch->groups[i].animation == animation && !batch->groups[i].removed)
+    {
+      _gasManagerBatchRemoveGroup(batch, i);
+      return GAS_TRUE;
+    }
+  }
+  return GAS_FALSE;
+}
+
+static gasBoolean _gasManagerBatchSameEasing(_gasManagerBatch* batch, unsigned int const i, unsigned int const j)
+{
+  return batch->easingId[i] == batch->easingId[j]
+      && batch->easing[i] == batch->easing[j]
+      && batch->curve[i] == batch->curve[j]
+      ? GAS_TRUE : GAS_FALSE;
+}
+
+/* When rows sharing an easing form long enough runs, easing happens before
+ * any row is written: each run has its relative times gathered into the
+ * eased column and is eased with one vectorized call. Otherwise rows are
+ * eased one by one while they are written. Writes always happen in row order
+ * so start values are captured after earlier rows have been applied.
+ *
+ * A row is done once its group no longer needs it: a standalone number as
+ * soon as it reaches its duration, a parallel child once it has time left
+ * over, or else on the next step its group is not paused, which mirrors how
+ * _gasAnimateParallelAnimation decides to finish. */
+void _gasManagerBatchAnimate(_gasManagerBatch* batch, float const delta)
+{
+  if (delta <= 0)
+    return;
+
+  unsigned int const numRows = batch->numRows;
+  unsigned int numRuns = numRows > 0 ? 1 : 0;
+  unsigned int i;
+  for (i = 1; i < numRows; ++i)
+  {
+    numRuns += _gasManagerBatchSameEasing(batch, i, i - 1) ? 0 : 1;
+  }
+
+  gasBoolean const vectorized = numRuns * GAS_BATCH_MIN_RUN <= numRows ? GAS_TRUE : GAS_FALSE;
+  if (vectorized)
+  {
+    unsigned int start = 0;
+    while (start < numRows)
+    {
+      unsigned int end = start + 1;
+      while (end < numRows && _gasManagerBatchSameEasing(batch, end, start))
+      {
+        end += 1;
+      }
+
+      for (i = start; i < end; ++i)
+      {
+        float const time = batch->time[i] + delta;
+        float const duration = batch->duration[i];
+        float const relativeTime = duration > 0.0f ? time / duration : 1.0f;
+        batch->eased[i] = _gasClamp(relativeTime, 0, 1);
+      }
+
+      _gasEasingEvaluateBatch(batch->easingId[start], batch->easing[start], batch->curve[start],
+                              batch->eased + start, batch->eased + start, end - start);
+      start = end;
+    }
+  }
+
+  unsigned int w = 0;
+  for (i = 0; i < numRows; ++i)
+  {
+    unsigned int const g = batch->group[i];
+    _gasManagerBatchGroup* group = &batch->groups[g];
+    gasBoolean done = GAS_FALSE;
+
+    if (group->removed)
+    {
+      done = GAS_TRUE;
+    }
+    else if (!group->paused && (batch->flags[i] & GAS_BATCH_ROW_FINISHED))
+    {
+      done = GAS_TRUE;
+    }
+    else if (!group->paused)
+    {
+      glhckObject* object = batch->object[i];
+      gasNumberAnimationTarget const target = batch->target[i];
+
+      gasAnimation* animation = batch->animation[i];
+      if (!(batch->flags[i] & GAS_BATCH_ROW_STARTED))
+      {
+        switch (batch->type[i])
+        {
+          case GAS_NUMBER_ANIMATION_TYPE_FROM: batch->b[i] = _gasNumberAnimationGetTargetValue(target, object); break;
+          case GAS_NUMBER_ANIMATION_TYPE_TO:
+          case GAS_NUMBER_ANIMATION_TYPE_DELTA: batch->a[i] = _gasNumberAnimationGetTargetValue(target, object); break;
+          default: break;
+        }
+        animation->numberAnimation.a = batch->a[i];
+        animation->numberAnimation.b = batch->b[i];
+        batch->flags[i] |= GAS_BATCH_ROW_STARTED;
+        group->state = GAS_ANIMATION_STATE_RUNNING;
+        group->animation->state = GAS_ANIMATION_STATE_RUNNING;
+      }
+
+      float const time = batch->time[i] + delta;
+      float const duration = batch->duration[i];
+      batch->time[i] = time;
+      animation->numberAnimation.time = time;
+      animation->state = time >= duration ? GAS_ANIMATION_STATE_FINISHED : GAS_ANIMATION_STATE_RUNNING;
+
+      float t;
+      if (vectorized)
+      {
+        t = batch->eased[i];
+      }
+      else
+      {
+        float const relativeTime = duration > 0.0f ? time / duration : 1.0f;
+        t = _gasEasingEvaluate(batch->easingId[i], batch->easing[i], batch->curve[i], _gasClamp(relativeTime, 0, 1));
+      }
+      _gasNumberAnimationSetTargetValue(target, object, _gasNumberAnimationValue(batch->type[i], batch->a[i], batch->b[i], t));
+
+      if (time >= duration)
+      {
+        batch->flags[i] |= GAS_BATCH_ROW_FINISHED;
+        done = !group->parallel || time - duration > 0 ? GAS_TRUE : GAS_FALSE;
+      }
+    }
+
+    if (done)
+    {
+      group->numRows -= 1;
+      if (group->numRows == 0)
+      {
+        group->state = GAS_ANIMATION_STATE_FINISHED;
+        group->animation->state = GAS_ANIMATION_STATE_FINISHED;
+        group->nextFree = batch->doneGroup;
+        batch->doneGroup = g;
+      }
+      continue;
+    }
+
+    if (w != i)
+    {
+      batch->time[w] = batch->time[i];
+      batch->duration[w] = batch->duration[i];
+      batch->a[w] = batch->a[i];
+      batch->b[w] = batch->b[i];
+      batch->easing[w] = batch->easing[i];
+      batch->curve[w] = batch->curve[i];
+      batch->easingId[w] = batch->easingId[i];
+      batch->type[w] = batch->type[i];
+      batch->target[w] = batch->target[i];
+      batch->flags[w] = batch->flags[i];
+      batch->group[w] = batch->group[i];
+      batch->object[w] = batch->object[i];
+      batch->animation[w] = batch->animation[i];
+    }
+    w += 1;
+  }
+
+  batch->numRows = w;
+}
+
+void _gasManagerBatchRelease(_gasManagerBatch* batch)
+{
+  while (batch->doneGroup != GAS_BATCH_NO_GROUP)
+  {
+    unsigned int const index = batch->doneGroup;
+    batch->doneGroup = batch->groups[index].nextFree;
+    _gasManagerBatchFreeGroup(batch, index);
+  }
+}
+
+/* Moves every group to the batch of the shard its object maps to and
+ * leaves this batch empty. Rows of a group are contiguous, so a group is
+ * moved whole the first time one of its rows is seen. */
+void _gasManagerBatchMove(_gasManagerBatch* batch, _gasManagerShard* shards, unsigned int const numShards)
+{
+  _gasManagerBatchRelease(batch);
+
+  unsigned int from = GAS_BATCH_NO_GROUP;
+  unsigned int to = GAS_BATCH_NO_GROUP;
+  _gasManagerBatch* target = NULL;
+  unsigned int i;
+  for (i = 0; i < batch->numRows; ++i)
+  {
+    if (batch->group[i] != from)
+    {
+      from = batch->group[i];
+      target = &shards[_gasManagerShardIndex(batch->object[i], numShards)].batch;
+      to = _gasManagerBatchNewGroup(target);
+      target->groups[to] = batch->groups[from];
+      if (target->groups[to].slot != GAS_NO_SLOT)
+        batch->slots->slots[target->groups[to].slot].group = to;
+    }
+
+    _gasManagerBatchReserveRows(target, target->numRows + 1);
+    unsigned int const w = target->numRows++;
+    target->time[w] = batch->time[i];
+    target->duration[w] = batch->duration[i];
+    target->a[w] = batch->a[i];
+    target->b[w] = batch->b[i];
+    target->easing[w] = batch->easing[i];
+    target->curve[w] = batch->curve[i];
+    target->easingId[w] = batch->easingId[i];
+    target->type[w] = batch->type[i];
+    target->target[w] = batch->target[i];
+    target->flags[w] = batch->flags[i];
+    target->group[w] = to;
+    target->object[w] = batch->object[i];
+    target->animation[w] = batch->animation[i];
+  }
+
+  batch->numRows = 0;
+  batch->numGroups = 0;
+  batch->freeGroup = GAS_BATCH_NO_GROUP;
+}
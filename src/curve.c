@@ -0,0 +1,187 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/* Baked easing curves
+ *
+ * A curve is sampled at resolution + 1 evenly spaced points and evaluated
+ * with linear interpolation. The error reported for a curve is the largest
+ * deviation from the source easing found over a dense set of probes inside
+ * every segment. */
+
+#define GAS_EASING_CURVE_PROBES 8
+#define GAS_EASING_CURVE_MIN_RESOLUTION 16
+#define GAS_EASING_CURVE_MAX_RESOLUTION 65536
+#define GAS_EASING_CURVE_DEFAULT_ERROR 1e-5
+#define GAS_EASING_BUILTIN_RESOLUTION 1024
+
+typedef struct _gasEasingSource
+{
+  gasEasingFunc easing;
+  double p1x;
+  double p1y;
+  double p2x;
+  double p2y;
+} _gasEasingSource;
+
+static double _gasBezierComponent(double t, double p1, double p2)
+{
+  return 3 * (1-t) * (1-t) * t * p1 + 3 * (1-t) * t * t * p2 + t * t * t;
+}
+
+/* Double precision bisection, only used while baking */
+static double _gasEasingSourceEvaluate(_gasEasingSource const* source, double x)
+{
+  if (source->easing)
+    return source->easing((float) x);
+
+  if (x <= 0) return 0;
+  if (x >= 1) return 1;
+
+  double mint = 0;
+  double maxt = 1;
+  int i;
+  for (i = 0; i < 60; ++i)
+  {
+    double guesst = (mint + maxt) / 2;
+    if (x < _gasBezierComponent(guesst, source->p1x, source->p2x))
+      maxt = guesst;
+    else
+      mint = guesst;
+  }
+  return _gasBezierComponent((mint + maxt) / 2, source->p1y, source->p2y);
+}
+
+static gasEasingCurve* _gasEasingCurveNew(_gasEasingSource const* source, unsigned int const resolution)
+{
+  gasEasingCurve* curve = malloc(sizeof(gasEasingCurve) + (resolution + 1) * sizeof(float));
+  curve->resolution = resolution;
+  curve->scale = (float) resolution;
+
+  unsigned int i;
+  for (i = 0; i <= resolution; ++i)
+  {
+    curve->samples[i] = (float) _gasEasingSourceEvaluate(source, (double) i / resolution);
+  }
+
+  double error = 0;
+  for (i = 0; i < resolution; ++i)
+  {
+    int k;
+    for (k = 0; k < GAS_EASING_CURVE_PROBES; ++k)
+    {
+      double const x = (i + (k + 0.5) / GAS_EASING_CURVE_PROBES) / resolution;
+      double const e = fabs(_gasEasingCurveEvaluate(curve, (float) x) - _gasEasingSourceEvaluate(source, x));
+      error = e > error ? e : error;
+    }
+  }
+  curve->error = (float) error;
+
+  return curve;
+}
+
+/* A resolution of 0 picks the smallest power of two meeting the default
+ * error bound, or gives up with NULL when even the largest does not.
+ * Explicit resolutions are clamped to the largest. */
+static gasEasingCurve* _gasEasingCurveBake(_gasEasingSource const* source, unsigned int const resolution)
+{
+  if (resolution > 0)
+    return _gasEasingCurveNew(source, resolution < GAS_EASING_CURVE_MAX_RESOLUTION
+                                      ? resolution : GAS_EASING_CURVE_MAX_RESOLUTION);
+
+  unsigned int r = GAS_EASING_CURVE_MIN_RESOLUTION;
+  gasEasingCurve* curve = _gasEasingCurveNew(source, r);
+  while (curve->error > GAS_EASING_CURVE_DEFAULT_ERROR)
+  {
+    free(curve);
+    if (r >= GAS_EASING_CURVE_MAX_RESOLUTION)
+      return NULL;
+
+    r *= 2;
+    curve = _gasEasingCurveNew(source, r);
+  }
+  return curve;
+}
+
+gasEasingCurve* gasEasingBake(float const p1x, float const p1y, float const p2x, float const p2y,
+                              unsigned int const resolution)
+{
+  _gasEasingSource const source = { NULL, p1x, p1y, p2x, p2y };
+  return _gasEasingCurveBake(&source, resolution);
+}
+
+gasEasingCurve* gasEasingBakeFunc(gasEasingFunc easing, unsigned int const resolution)
+{
+  _gasEasingSource const source = { easing, 0, 0, 0, 0 };
+  return _gasEasingCurveBake(&source, resolution);
+}
+
+float gasEasingCurveEvaluate(gasEasingCurve const* curve, float const t)
+{
+  return _gasEasingCurveEvaluate(curve, t);
+}
+
+float gasEasingCurveError(gasEasingCurve const* curve)
+{
+  return curve->error;
+}
+
+unsigned int gasEasingCurveResolution(gasEasingCurve const* curve)
+{
+  return curve->resolution;
+}
+
+void gasEasingCurveFree(gasEasingCurve* curve)
+{
+  free(curve);
+}
+
+float _gasEasingCurveEvaluate(gasEasingCurve const* curve, float const t)
+{
+  if (t <= 0.0f) return curve->samples[0];
+  if (t >= 1.0f) return curve->samples[curve->resolution];
+
+  float const x = t * curve->scale;
+  unsigned int const i = (unsigned int) x;
+  if (i >= curve->resolution) return curve->samples[curve->resolution];
+
+  float const f = x - i;
+  return curve->samples[i] + (curve->samples[i + 1] - curve->samples[i]) * f;
+}
+
+/* Where an easing ends up, which is not always 1 for baked curves */
+float _gasEasingEnd(gasEasingFunc easing, gasEasingCurve const* curve)
+{
+  return curve ? _gasEasingCurveEvaluate(curve, 1.0f) : easing(1.0f);
+}
+
+/* Built-in cubic-bezier easings are baked on first use. Threads baking the
+ * same curve at once publish only the first one and free the rest. */
+static gasEasingCurve* builtinCurves[GAS_EASING_ID_EASE_IN_OUT + 1] = { NULL };
+
+gasEasingCurve const* _gasEasingBuiltinCurve(_gasEasingId const id)
+{
+  gasEasingCurve* curve = __atomic_load_n(&builtinCurves[id], __ATOMIC_ACQUIRE);
+  if (curve)
+    return curve;
+
+  switch (id)
+  {
+    case GAS_EASING_ID_EASE: curve = gasEasingBake(0.25, 0.1, 0.25, 1, GAS_EASING_BUILTIN_RESOLUTION); break;
+    case GAS_EASING_ID_EASE_IN: curve = gasEasingBake(0.42, 0, 1, 1, GAS_EASING_BUILTIN_RESOLUTION); break;
+    case GAS_EASING_ID_EASE_OUT: curve = gasEasingBake(0, 0, 0.58, 1, GAS_EASING_BUILTIN_RESOLUTION); break;
+    case GAS_EASING_ID_EASE_IN_OUT: curve = gasEasingBake(0.42, 0, 0.58, 1, GAS_EASING_BUILTIN_RESOLUTION); break;
+    default: return NULL;
+  }
+
+  gasEasingCurve* published = NULL;
+  if (!__atomic_compare_exchange_n(&builtinCurves[id], &published, curve, GAS_FALSE,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+  {
+    gasEasingCurveFree(curve);
+    curve = published;
+  }
+  return curve;
+}
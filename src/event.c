@@ -0,0 +1,146 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Deferred action events
+ *
+ * While a manager defers actions, each shard it advances becomes the active
+ * event queue of the advancing thread and _gasActionStep records into it
+ * instead of calling out. Queues of all shards are merged and sorted by the
+ * time the events fired with a stable merge sort, so the events of one
+ * object always come out in firing order. The sort reuses a scratch buffer
+ * kept with the queue, which is why events are not handed to qsort. */
+
+static GAS_THREAD_LOCAL _gasEventQueue* activeQueue = NULL;
+
+void _gasEventQueueInit(_gasEventQueue* queue)
+{
+  memset(queue, 0, sizeof(_gasEventQueue));
+}
+
+void _gasEventQueueFree(_gasEventQueue* queue)
+{
+  free(queue->events);
+  free(queue->scratch);
+  _gasEventQueueInit(queue);
+}
+
+_gasEventQueue* _gasEventQueueBegin(_gasEventQueue* queue)
+{
+  _gasEventQueue* previous = activeQueue;
+  activeQueue = queue;
+  return previous;
+}
+
+void _gasEventQueueEnd(_gasEventQueue* previous)
+{
+  activeQueue = previous;
+}
+
+static void _gasEventQueueReserve(_gasEventQueue* queue, unsigned int const numEvents)
+{
+  if (numEvents <= queue->capacity)
+    return;
+
+  unsigned int capacity = queue->capacity ? queue->capacity : 64;
+  while (capacity < numEvents)
+  {
+    capacity *= 2;
+  }
+
+  queue->events = realloc(queue->events, capacity * sizeof(gasEvent));
+  queue->capacity = capacity;
+}
+
+gasBoolean _gasEventQueuePush(gasActionCallback callback, void* userdata, glhckObject* object, float const delta)
+{
+  _gasEventQueue* queue = activeQueue;
+  if (!queue)
+    return GAS_FALSE;
+
+  _gasEventQueueReserve(queue, queue->numEvents + 1);
+  gasEvent* event = &queue->events[queue->numEvents++];
+  event->animation = queue->animation;
+  event->object = object;
+  event->callback = callback;
+  event->userdata = userdata;
+  event->time = queue->delta - delta;
+  return GAS_TRUE;
+}
+
+static void _gasEventQueueSort(_gasEventQueue* queue)
+{
+  unsigned int const n = queue->numEvents;
+  unsigned int i;
+  for (i = 1; i < n && queue->events[i - 1].time <= queue->events[i].time; ++i);
+  if (i >= n)
+    return;
+
+  if (queue->scratchCapacity < n)
+  {
+    free(queue->scratch);
+    queue->scratch = malloc(queue->capacity * sizeof(gasEvent));
+    queue->scratchCapacity = queue->capacity;
+  }
+
+  gasEvent* from = queue->events;
+  gasEvent* to = queue->scratch;
+  unsigned int width;
+  for (width = 1; width < n; width *= 2)
+  {
+    for (i = 0; i < n; i += 2 * width)
+    {
+      unsigned int const mid = i + width < n ? i + width : n;
+      unsigned int const end = i + 2 * width < n ? i + 2 * width : n;
+      unsigned int a = i, b = mid, w = i;
+      while (a < mid && b < end)
+      {
+        to[w++] = from[b].time < from[a].time ? from[b++] : from[a++];
+      }
+      while (a < mid)
+      {
+        to[w++] = from[a++];
+      }
+      while (b < end)
+      {
+        to[w++] = from[b++];
+      }
+    }
+
+    gasEvent* swap = from;
+    from = to;
+    to = swap;
+  }
+
+  if (from != queue->events)
+  {
+    unsigned int const capacity = queue->capacity;
+    queue->scratch = queue->events;
+    queue->events = from;
+    queue->capacity = queue->scratchCapacity;
+    queue->scratchCapacity = capacity;
+  }
+}
+
+/* Moves the events of every shard to the end of queue and sorts it */
+void _gasEventQueueMerge(_gasEventQueue* queue, _gasManagerShard* shards, unsigned int const numShards)
+{
+  unsigned int const numMerged = queue->numEvents;
+  unsigned int i;
+  for (i = 0; i < numShards; ++i)
+  {
+    _gasEventQueue* shard = &shards[i].events;
+    if (shard->numEvents == 0)
+      continue;
+
+    _gasEventQueueReserve(queue, queue->numEvents + shard->numEvents);
+    memcpy(queue->events + queue->numEvents, shard->events, shard->numEvents * sizeof(gasEvent));
+    queue->numEvents += shard->numEvents;
+    shard->numEvents = 0;
+  }
+
+  if (queue->numEvents != numMerged)
+    _gasEventQueueSort(queue);
+}
@@ -2,6 +2,8 @@
 #include "internal.h"
 
 #include <assert.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <memory.h>
 #include <string.h>
@@ -42,12 +44,109 @@ gasAnimation* gasNumberAnimationNewDelta(gasNumberAnimationTarget const target,
   return _gasNumberAnimationNew(target, easing, GAS_NUMBER_ANIMATION_TYPE_DELTA, 0.0f, delta, duration);
 }
 
+static kmVec3 const _gasZeroVector = { 0.0f, 0.0f, 0.0f };
+
+gasAnimation* gasVectorAnimationNewFromTo(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                          kmVec3 const* from, kmVec3 const* to, float const duration)
+{
+  return _gasVectorAnimationNew(target, easing, GAS_NUMBER_ANIMATION_TYPE_FROM_TO, from, to, duration);
+}
+
+gasAnimation* gasVectorAnimationNewFromDelta(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                             kmVec3 const* from, kmVec3 const* delta, float const duration)
+{
+  return _gasVectorAnimationNew(target, easing, GAS_NUMBER_ANIMATION_TYPE_FROM_DELTA, from, delta, duration);
+}
+
+gasAnimation* gasVectorAnimationNewDeltaTo(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                           kmVec3 const* delta, kmVec3 const* to, float const duration)
+{
+  return _gasVectorAnimationNew(target, easing, GAS_NUMBER_ANIMATION_TYPE_DELTA_TO, delta, to, duration);
+}
+
+gasAnimation* gasVectorAnimationNewFrom(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                        kmVec3 const* from, float const duration)
+{
+  return _gasVectorAnimationNew(target, easing, GAS_NUMBER_ANIMATION_TYPE_FROM, from, &_gasZeroVector, duration);
+}
+
+gasAnimation* gasVectorAnimationNewTo(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                      kmVec3 const* to, float const duration)
+{
+  return _gasVectorAnimationNew(target, easing, GAS_NUMBER_ANIMATION_TYPE_TO, &_gasZeroVector, to, duration);
+}
+
+gasAnimation* gasVectorAnimationNewDelta(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                         kmVec3 const* delta, float const duration)
+{
+  return _gasVectorAnimationNew(target, easing, GAS_NUMBER_ANIMATION_TYPE_DELTA, &_gasZeroVector, delta, duration);
+}
+
+static kmQuaternion const _gasIdentityQuaternion = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+gasAnimation* gasRotationAnimationNewFromTo(gasEasingFunc easing, kmQuaternion const* from, kmQuaternion const* to,
+                                            float const duration)
+{
+  return _gasRotationAnimationNew(easing, GAS_NUMBER_ANIMATION_TYPE_FROM_TO, from, to, duration);
+}
+
+gasAnimation* gasRotationAnimationNewFromDelta(gasEasingFunc easing, kmQuaternion const* from, kmQuaternion const* delta,
+                                               float const duration)
+{
+  return _gasRotationAnimationNew(easing, GAS_NUMBER_ANIMATION_TYPE_FROM_DELTA, from, delta, duration);
+}
+
+gasAnimation* gasRotationAnimationNewDeltaTo(gasEasingFunc easing, kmQuaternion const* delta, kmQuaternion const* to,
+                                             float const duration)
+{
+  return _gasRotationAnimationNew(easing, GAS_NUMBER_ANIMATION_TYPE_DELTA_TO, delta, to, duration);
+}
+
+gasAnimation* gasRotationAnimationNewFrom(gasEasingFunc easing, kmQuaternion const* from, float const duration)
+{
+  return _gasRotationAnimationNew(easing, GAS_NUMBER_ANIMATION_TYPE_FROM, from, &_gasIdentityQuaternion, duration);
+}
+
+gasAnimation* gasRotationAnimationNewTo(gasEasingFunc easing, kmQuaternion const* to, float const duration)
+{
+  return _gasRotationAnimationNew(easing, GAS_NUMBER_ANIMATION_TYPE_TO, &_gasIdentityQuaternion, to, duration);
+}
+
+gasAnimation* gasRotationAnimationNewDelta(gasEasingFunc easing, kmQuaternion const* delta, float const duration)
+{
+  return _gasRotationAnimationNew(easing, GAS_NUMBER_ANIMATION_TYPE_DELTA, &_gasIdentityQuaternion, delta, duration);
+}
+
+gasAnimation* gasRotationAnimationNlerp(gasAnimation* animation, gasBoolean const nlerp)
+{
+  assert(animation->type == GAS_ANIMATION_TYPE_ROTATION);
+  animation->rotationAnimation->nlerp = nlerp;
+  return animation;
+}
+
+gasAnimation* gasActionFireOnce(gasAnimation* animation, gasBoolean const once)
+{
+  assert(animation->type == GAS_ANIMATION_TYPE_ACTION);
+  animation->action.fireOnce = once;
+  return animation;
+}
+
 void gasAnimationFree(gasAnimation* animation)
 {
+  if (animation->allocation == GAS_ALLOCATION_BLOCK_ROOT)
+  {
+    if (animation->finalizers)
+    {
+      _gasAnimationFinalizeTree(animation);
+    }
+    free(animation);
+    return;
+  }
+
+  assert(animation->allocation == GAS_ALLOCATION_POOL);
+
   switch (animation->type)
   {
-    case GAS_ANIMATION_TYPE_NUMBER: free(animation); break;
-    case GAS_ANIMATION_TYPE_PAUSE: free(animation); break;
     case GAS_ANIMATION_TYPE_SEQUENTIAL:
     {
       int i;
@@ -55,8 +154,7 @@ void gasAnimationFree(gasAnimation* animation)
       {
         gasAnimationFree(animation->sequentialAnimation.children[i]);
       }
-      free(animation->sequentialAnimation.children);
-      free(animation);
+      _gasChildrenRelease(animation->sequentialAnimation.children, animation->sequentialAnimation.numChildren);
       break;
     }
     case GAS_ANIMATION_TYPE_PARALLEL:
@@ -66,40 +164,14 @@ void gasAnimationFree(gasAnimation* animation)
       {
         gasAnimationFree(animation->parallelAnimation.children[i]);
       }
-      free(animation->parallelAnimation.children);
-      free(animation);
-      break;
-    }
-    case GAS_ANIMATION_TYPE_MODEL:
-    {
-      if (animation->modelAnimation.animator)
-      {
-        glhckAnimatorFree(animation->modelAnimation.animator);
-      }
-      free(animation->modelAnimation.name);
-      free(animation);
-      break;
-    }
-    case GAS_ANIMATION_TYPE_ACTION:
-    {
-      if(animation->action.freeCallback)
-      {
-        animation->action.freeCallback(animation->action.userdata);
-      }
-      free(animation);
+      _gasChildrenRelease(animation->parallelAnimation.children, GAS_PARALLEL_SLOTS(animation->parallelAnimation.numChildren));
       break;
     }
-    case GAS_ANIMATION_TYPE_CUSTOM:
-    {
-      if(animation->customAnimation.freeCallback)
-      {
-        animation->customAnimation.freeCallback(animation->customAnimation.userdata);
-      }
-      free(animation);
-      break;
-    }
-    default: assert(0);
+    default: break;
   }
+
+  _gasAnimationFinalize(animation);
+  _gasAnimationRelease(animation);
 }
 
 gasAnimation* gasSequentialAnimationNew(gasAnimation** children, const unsigned int numChildren)
@@ -107,8 +179,9 @@ gasAnimation* gasSequentialAnimationNew(gasAnimation** children, const unsigned
   gasAnimation* animation = _gasAnimationNew(GAS_ANIMATION_TYPE_SEQUENTIAL);
   animation->sequentialAnimation.numChildren = numChildren;
   animation->sequentialAnimation.currentIndex = 0;
-  animation->sequentialAnimation.children = calloc(numChildren, sizeof(gasAnimation*));
-  memcpy(animation->sequentialAnimation.children, children, numChildren * sizeof(gasAnimation*));
+  animation->sequentialAnimation.children = _gasChildrenAlloc(numChildren);
+  if (numChildren > 0)
+    memcpy(animation->sequentialAnimation.children, children, numChildren * sizeof(gasAnimation*));
 
   return animation;
 }
@@ -127,17 +200,25 @@ gasAnimation* gasParallelAnimationNew(gasAnimation** children, const unsigned in
 {
   gasAnimation* animation = _gasAnimationNew(GAS_ANIMATION_TYPE_PARALLEL);
   animation->parallelAnimation.numChildren = numChildren;
-  animation->parallelAnimation.children = calloc(numChildren, sizeof(gasAnimation*));
-  memcpy(animation->parallelAnimation.children, children, numChildren * sizeof(gasAnimation*));
+  animation->parallelAnimation.children = _gasChildrenAlloc(GAS_PARALLEL_SLOTS(numChildren));
+  if (numChildren > 0)
+    memcpy(animation->parallelAnimation.children, children, numChildren * sizeof(gasAnimation*));
+  animation->parallelAnimation.overlapping = _gasLoopChannelsOverlap(children, numChildren);
+  animation->parallelAnimation.active = GAS_PARALLEL_TRACKS(numChildren)
+      ? (unsigned int*) (animation->parallelAnimation.children + numChildren)
+      : NULL;
+  _gasParallelAnimationActivate(animation);
   return animation;
 }
 
 gasAnimation* gasModelAnimationNew(const char* name, float duration)
 {
   gasAnimation* animation = _gasAnimationNew(GAS_ANIMATION_TYPE_MODEL);
-  animation->modelAnimation.name = strdup(name);
-  animation->modelAnimation.animator = NULL;
+  animation->modelAnimation.name = _gasModelNameIntern(name);
+  animation->modelAnimation.binding = NULL;
   animation->modelAnimation.duration = duration;
+  animation->modelAnimation.minStep = 0.0f;
+  animation->modelAnimation.frames = 1;
 
   return animation;
 }
@@ -151,6 +232,7 @@ gasAnimation* gasActionNew(gasActionCallback callback, gasActionResetCallback re
   animation->action.cloneCallback = cloneCallback;
   animation->action.freeCallback = freeCallback;
   animation->action.userdata = userdata;
+  animation->action.fireOnce = GAS_FALSE;
   return animation;
 }
 
@@ -167,12 +249,65 @@ gasAnimation* gasCustomAnimationNew(gasCustomAnimationCallback callback, gasCust
   return animation;
 }
 
+gasAnimation* gasAnimationCompile(gasAnimation* animation)
+{
+  if (animation->type == GAS_ANIMATION_TYPE_PROGRAM)
+    return gasAnimationClone(animation);
+
+  gasAnimationTemplate* animationTemplate = gasAnimationTemplateNew(animation);
+  gasAnimation* compiled = gasAnimationTemplateInstantiate(animationTemplate);
+  gasAnimationTemplateFree(animationTemplate);
+  return compiled;
+}
+
+gasAnimationTemplate* gasAnimationTemplateNew(gasAnimation* animation)
+{
+  return _gasProgramNew(animation);
+}
+
+void gasAnimationTemplateFree(gasAnimationTemplate* animationTemplate)
+{
+  _gasProgramRelease(animationTemplate);
+}
+
+/* An instance is one block holding its node and its state block */
+gasAnimation* gasAnimationTemplateInstantiate(gasAnimationTemplate* animationTemplate)
+{
+  _gasProgram* program = animationTemplate;
+  gasAnimation* animation = malloc(sizeof(_gasAnimation) + program->stateSize);
+  animation->type = GAS_ANIMATION_TYPE_PROGRAM;
+  animation->allocation = GAS_ALLOCATION_BLOCK_ROOT;
+  animation->finalizers = GAS_TRUE;
+  animation->state = program->state;
+  animation->loops = program->loops;
+  animation->loop = program->loop;
+
+  _gasProgramRetain(program);
+  animation->programAnimation.program = program;
+  animation->programAnimation.states = (_gasInstructionState*) (animation + 1);
+  _gasProgramStatesCopy(program, animation->programAnimation.states, program->states);
+  return animation;
+}
+
 gasBoolean gasAnimate(gasAnimation* animation, glhckObject* object, float const delta)
 {
   _gasAnimate(animation, object, delta);
   return animation->state != GAS_ANIMATION_STATE_FINISHED ? GAS_TRUE : GAS_FALSE;
 }
 
+gasAnimation* gasNumberAnimationEasingCurve(gasAnimation* animation, gasEasingCurve const* curve)
+{
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER: animation->numberAnimation.curve = curve; break;
+    case GAS_ANIMATION_TYPE_VECTOR: animation->vectorAnimation.curve = curve; break;
+    case GAS_ANIMATION_TYPE_ROTATION: animation->rotationAnimation->curve = curve; break;
+    case GAS_ANIMATION_TYPE_PATH: animation->pathAnimation.curve = curve; break;
+    default: assert(0);
+  }
+  return animation;
+}
+
 gasAnimation*  gasAnimationLoopTimes(gasAnimation* animation, unsigned int times)
 {
   animation->loops = times;
@@ -193,107 +328,407 @@ void gasAnimationReset(gasAnimation* animation)
   _gasAnimationResetCurrentLoop(animation);
 }
 
+/* Threaded managers use several shards per worker so that workers claiming
+ * shards one at a time even out, and only go wide when a frame has enough
+ * work to pay for waking them */
+#define GAS_MANAGER_SHARDS_PER_WORKER 16
+#define GAS_MANAGER_PARALLEL_MIN_WORK 4096
+#define GAS_MANAGER_SHARD_PAGE 4096
+
+/* Entries idle for less than this are not worth parking, and entries that
+ * were not idle are not looked at again for a few ticks */
+#define GAS_MANAGER_PARK_MIN_IDLE (4.0f / GAS_WHEEL_TICKS_PER_SECOND)
+#define GAS_MANAGER_PARK_RETRY_TICKS 8
+
 gasManager* gasManagerNew()
 {
   gasManager* manager = calloc(1, sizeof(_gasManager));
-  manager->animations = NULL;
   manager->newAnimations = NULL;
-  manager->removeAnimations = NULL;
+  _gasSlotTableInit(&manager->slots);
+  manager->shards = _gasManagerShardsNew(manager, 1);
+  manager->numShards = 1;
+  manager->batching = GAS_FALSE;
+  manager->parking = GAS_FALSE;
+  manager->time = 0.0;
+  _gasPoolInit(&manager->entryPool, sizeof(_gasManagerAnimation), 256);
+  _gasEventQueueInit(&manager->events);
   return manager;
 }
 
 
-void gasManagerFree(gasManager* manager)
+gasManager* gasManagerNewThreaded(unsigned int numThreads)
 {
-  while (manager->animations)
+  gasManager* manager = gasManagerNew();
+  if (numThreads == 0)
+    numThreads = _gasProcessorCount();
+
+  if (numThreads > 1)
   {
-    manager->animations = _gasManagerAnimationFree(manager->animations);
+    _gasThreadPool* pool = _gasThreadPoolNew(numThreads);
+    gasManagerDispatch(manager, _gasThreadPoolDispatch, _gasThreadPoolSize(pool), pool);
+    manager->dispatch.pool = pool;
   }
 
-  while (manager->newAnimations)
+  return manager;
+}
+
+
+void gasManagerDispatch(gasManager* manager, gasDispatchCallback dispatch, unsigned int numWorkers, void* userdata)
+{
+  if (manager->dispatch.pool)
   {
-    manager->newAnimations = _gasManagerAnimationFree(manager->newAnimations);
+    _gasThreadPoolFree(manager->dispatch.pool);
+    manager->dispatch.pool = NULL;
   }
 
-  while (manager->removeAnimations)
+  if (numWorkers == 0)
+    dispatch = NULL;
+
+  manager->dispatch.dispatch = dispatch;
+  manager->dispatch.userdata = userdata;
+  manager->dispatch.numWorkers = dispatch ? numWorkers : 1;
+  _gasManagerReshard(manager, dispatch ? numWorkers * GAS_MANAGER_SHARDS_PER_WORKER : 1);
+}
+
+
+void gasManagerDeferActions(gasManager* manager, gasBoolean const enabled)
+{
+  manager->deferActions = enabled;
+}
+
+
+unsigned int gasManagerDispatchEvents(gasManager* manager)
+{
+  if (manager->dispatchingEvents)
+    return 0;
+
+  _gasEventQueueMerge(&manager->events, manager->shards, manager->numShards);
+
+  manager->dispatchingEvents = GAS_TRUE;
+  unsigned int const numEvents = manager->events.numEvents;
+  unsigned int i;
+  for (i = 0; i < numEvents; ++i)
   {
-    _gasManagerAnimationReference* ref = manager->removeAnimations;
-    manager->removeAnimations = ref->next;
-    free(ref);
+    gasEvent const* event = &manager->events.events[i];
+    event->callback(event->object, event->userdata);
   }
+  manager->events.numEvents = 0;
+  manager->dispatchingEvents = GAS_FALSE;
+
+  for (i = 0; i < manager->numShards; ++i)
+  {
+    _gasManagerShardRelease(manager, &manager->shards[i]);
+  }
+
+  return numEvents;
+}
+
+
+unsigned int gasManagerGetEvents(gasManager* manager, gasEvent* events, unsigned int const maxEvents)
+{
+  _gasEventQueueMerge(&manager->events, manager->shards, manager->numShards);
+
+  unsigned int i;
+  for (i = 0; i < manager->events.numEvents && i < maxEvents; ++i)
+  {
+    events[i] = manager->events.events[i];
+  }
+
+  return manager->events.numEvents;
+}
+
 
+void gasManagerFree(gasManager* manager)
+{
+  gasManagerClear(manager);
+  if (manager->dispatch.pool)
+    _gasThreadPoolFree(manager->dispatch.pool);
+
+  unsigned int i;
+  for (i = 0; i < manager->numShards; ++i)
+  {
+    _gasManagerBatchFree(&manager->shards[i].batch);
+    _gasEventQueueFree(&manager->shards[i].events);
+  }
+  free(manager->shards);
+  _gasEventQueueFree(&manager->events);
+  _gasSlotTableFree(&manager->slots);
   free(manager);
 }
 
 
-void gasManagerAddAnimation(gasManager* manager, gasAnimation* animation, glhckObject* object)
+void gasManagerClear(gasManager* manager)
 {
-  _gasManagerAnimation* a = _gasManagerAnimationNew(animation, object);
+  _gasManagerAnimation* a;
+  unsigned int i;
+  for (i = 0; i < manager->numShards; ++i)
+  {
+    _gasManagerShard* shard = &manager->shards[i];
+    for (a = shard->animations; a; a = a->next)
+    {
+      gasAnimationFree(a->animation);
+    }
+
+    for (a = shard->finished; a; a = a->next)
+    {
+      gasAnimationFree(a->animation);
+    }
+
+    for (a = shard->woken; a; a = a->next)
+    {
+      gasAnimationFree(a->animation);
+    }
+
+    for (a = _gasTimingWheelDrain(&shard->wheel); a; a = a->next)
+    {
+      gasAnimationFree(a->animation);
+    }
+
+    shard->animations = NULL;
+    shard->finished = NULL;
+    shard->woken = NULL;
+    shard->numAnimations = 0;
+    shard->events.numEvents = 0;
+    _gasManagerBatchClear(&shard->batch);
+  }
+
+  manager->events.numEvents = 0;
+
+  for (a = manager->newAnimations; a; a = a->next)
+  {
+    gasAnimationFree(a->animation);
+  }
+
+  manager->newAnimations = NULL;
+  _gasPoolReset(&manager->entryPool);
+  _gasSlotTableClear(&manager->slots);
+}
+
+
+gasAnimationHandle gasManagerAddAnimation(gasManager* manager, gasAnimation* animation, glhckObject* object)
+{
+  _gasManagerAnimation* a = _gasManagerAnimationNew(manager, animation, object);
+  gasAnimationHandle const handle = _gasSlotNew(&manager->slots, object);
+  manager->slots.slots[handle.index].entry = a;
+  a->slot = handle.index;
   a->next = manager->newAnimations;
   manager->newAnimations = a;
+  return handle;
+}
+
+
+gasBoolean gasManagerHandleValid(gasManager* manager, gasAnimationHandle const handle)
+{
+  return _gasSlotGet(&manager->slots, handle) ? GAS_TRUE : GAS_FALSE;
+}
+
+
+gasBoolean gasManagerRemoveHandle(gasManager* manager, gasAnimationHandle const handle)
+{
+  _gasSlot* slot = _gasSlotGet(&manager->slots, handle);
+  if (!slot)
+    return GAS_FALSE;
+
+  _gasManagerSlotRemove(manager, slot);
+  return GAS_TRUE;
+}
+
+
+gasBoolean gasManagerPauseHandle(gasManager* manager, gasAnimationHandle const handle, gasBoolean const paused)
+{
+  _gasSlot* slot = _gasSlotGet(&manager->slots, handle);
+  if (!slot)
+    return GAS_FALSE;
+
+  _gasManagerSlotPause(manager, slot, paused);
+  return GAS_TRUE;
+}
+
+
+gasAnimationState gasManagerGetHandleState(gasManager* manager, gasAnimationHandle const handle)
+{
+  _gasSlot* slot = _gasSlotGet(&manager->slots, handle);
+  if (!slot)
+    return GAS_ANIMATION_STATE_FINISHED;
+
+  if (slot->entry)
+    return slot->entry->animation->state;
+
+  return _gasManagerSlotShard(manager, slot)->batch.groups[slot->group].state;
+}
+
+
+void gasManagerBatching(gasManager* manager, gasBoolean const enabled)
+{
+  manager->batching = enabled;
+}
+
+
+void gasManagerParking(gasManager* manager, gasBoolean const enabled)
+{
+  manager->parking = enabled;
 }
 
 
 void gasManagerRemoveAnimation(gasManager* manager, gasAnimation* animation)
 {
-  _gasManagerAnimation** a = &manager->animations;
-  while (*a && (*a)->animation != animation)
+  unsigned int i;
+  for (i = 0; i < manager->numShards; ++i)
   {
-    a = &(*a)->next;
+    if (_gasManagerBatchRemoveAnimation(&manager->shards[i].batch, animation))
+      return;
+  }
+
+  _gasManagerAnimation* a;
+  for (i = 0; i < manager->numShards; ++i)
+  {
+    for (a = manager->shards[i].animations; a; a = a->next)
+    {
+      if (a->animation == animation && !_gasManagerAnimationRemoved(a))
+      {
+        _gasManagerAnimationRemove(manager, a);
+        return;
+      }
+    }
+
+    for (a = manager->shards[i].woken; a; a = a->next)
+    {
+      if (a->animation == animation && !_gasManagerAnimationRemoved(a))
+      {
+        _gasManagerAnimationRemove(manager, a);
+        return;
+      }
+    }
+
+    if ((a = _gasTimingWheelFind(&manager->shards[i].wheel, animation)))
+    {
+      _gasManagerAnimationRemove(manager, a);
+      return;
+    }
   }
 
-  if (*a)
+  for (a = manager->newAnimations; a; a = a->next)
   {
-    _gasManagerEnqueueRemoveAnimation(manager, *a);
+    if (a->animation == animation && !_gasManagerAnimationRemoved(a))
+    {
+      _gasManagerAnimationRemove(manager, a);
+      return;
+    }
   }
 }
 
 
 void gasManagerRemoveObjectAnimations(gasManager* manager, glhckObject* object)
 {
-  _gasManagerAnimation** a = &manager->animations;
-  while (*a)
+  _gasObjectRecord* record = _gasObjectIndexFind(&manager->slots.objects, object);
+  if (!record)
+    return;
+
+  /* Removing a slot swaps the last one into its place and the record is
+   * released with the last slot */
+  while (record->numSlots > 0)
   {
-    if ((*a)->object == object)
-    {
-      _gasManagerEnqueueRemoveAnimation(manager, *a);
-    }
+    _gasManagerSlotRemove(manager, &manager->slots.slots[_gasObjectRecordSlots(record)[record->numSlots - 1]]);
+  }
+}
 
-    a = &(*a)->next;
+
+void gasManagerPauseObjectAnimations(gasManager* manager, glhckObject* object, gasBoolean const paused)
+{
+  _gasObjectRecord* record = _gasObjectIndexFind(&manager->slots.objects, object);
+  if (!record)
+    return;
+
+  unsigned int const* slots = _gasObjectRecordSlots(record);
+  unsigned int i;
+  for (i = 0; i < record->numSlots; ++i)
+  {
+    _gasManagerSlotPause(manager, &manager->slots.slots[slots[i]], paused);
   }
 }
 
 
-void gasManagerAnimate(gasManager* manager, const float delta)
+unsigned int gasManagerGetObjectAnimations(gasManager* manager, glhckObject* object,
+                                           gasAnimationHandle* handles, unsigned int const maxHandles)
 {
-  while (manager->removeAnimations)
+  _gasObjectRecord* record = _gasObjectIndexFind(&manager->slots.objects, object);
+  if (!record)
+    return 0;
+
+  unsigned int const* slots = _gasObjectRecordSlots(record);
+  unsigned int i;
+  for (i = 0; i < record->numSlots && i < maxHandles; ++i)
   {
-    _gasManagerAnimationReference* ref = manager->removeAnimations;
-    manager->removeAnimations = ref->next;
-    _gasManagerRemoveAnimationByReference(manager, ref);
-    free(ref);
+    unsigned int const index = slots[i];
+    handles[i].index = index;
+    handles[i].generation = manager->slots.slots[index].generation;
   }
 
+  return record->numSlots;
+}
+
+
+void gasManagerAnimate(gasManager* manager, const float delta)
+{
+  gasManagerDispatchEvents(manager);
+
   while (manager->newAnimations)
   {
     _gasManagerAnimation* a = manager->newAnimations;
     manager->newAnimations = a->next;
-    a->next = manager->animations;
-    manager->animations = a;
+
+    if (_gasManagerAnimationRemoved(a))
+    {
+      _gasManagerAnimationFree(manager, a);
+      continue;
+    }
+
+    _gasManagerShard* shard = _gasManagerShardOf(manager, a->object);
+    if (manager->batching && _gasManagerBatchAccepts(a->animation))
+    {
+      unsigned int const group = _gasManagerBatchAdd(&shard->batch, a->animation, a->object, a->slot);
+      shard->batch.groups[group].paused = a->flags & GAS_MANAGER_ANIMATION_PAUSED ? GAS_TRUE : GAS_FALSE;
+      manager->slots.slots[a->slot].entry = NULL;
+      manager->slots.slots[a->slot].group = group;
+      _gasPoolRelease(&manager->entryPool, a);
+      continue;
+    }
+
+    a->next = shard->animations;
+    shard->animations = a;
+    shard->numAnimations += 1;
   }
 
-  _gasManagerAnimation** a = &manager->animations;
-  while (*a)
+  manager->time += delta;
+
+  unsigned int i;
+  if (manager->dispatch.dispatch)
   {
-    if (gasAnimate((*a)->animation, (*a)->object, delta))
+    unsigned int work = 0;
+    for (i = 0; i < manager->numShards; ++i)
     {
-      a = &(*a)->next;
+      work += manager->shards[i].batch.numRows + manager->shards[i].numAnimations;
     }
-    else
+
+    if (work >= GAS_MANAGER_PARALLEL_MIN_WORK)
     {
-      *a = _gasManagerAnimationFree(*a);
+      manager->dispatch.nextShard = 0;
+      manager->dispatch.delta = delta;
+      manager->dispatch.dispatch(_gasManagerAnimateTask, manager, manager->dispatch.numWorkers,
+                                 manager->dispatch.userdata);
+
+      for (i = 0; i < manager->numShards && !manager->deferActions; ++i)
+      {
+        _gasManagerShardRelease(manager, &manager->shards[i]);
+      }
+      return;
     }
   }
+
+  for (i = 0; i < manager->numShards; ++i)
+  {
+    _gasManagerShardAnimate(manager, &manager->shards[i], delta, !manager->deferActions);
+  }
 }
 
 
@@ -314,22 +749,22 @@ float gasEasingQuadOut(float t)
 
 float gasEasingEase(float t)
 {
-  return gasEasingCubicBezier(t, 0.25, 0.1, 0.25, 1);
+  return _gasEasingCurveEvaluate(_gasEasingBuiltinCurve(GAS_EASING_ID_EASE), t);
 }
 
 float gasEasingEaseIn(float t)
 {
-  return gasEasingCubicBezier(t, 0.42, 0, 1, 1);
+  return _gasEasingCurveEvaluate(_gasEasingBuiltinCurve(GAS_EASING_ID_EASE_IN), t);
 }
 
 float gasEasingEaseOut(float t)
 {
-  return gasEasingCubicBezier(t, 0, 0, 0.58, 1);
+  return _gasEasingCurveEvaluate(_gasEasingBuiltinCurve(GAS_EASING_ID_EASE_OUT), t);
 }
 
 float gasEasingEaseInOut(float t)
 {
-  return gasEasingCubicBezier(t, 0.42, 0, 0.58, 1);
+  return _gasEasingCurveEvaluate(_gasEasingBuiltinCurve(GAS_EASING_ID_EASE_IN_OUT), t);
 }
 
 float gasEasingCubicBezier(float x, float x1, float y1, float x2, float y2)
@@ -340,12 +775,57 @@ float gasEasingCubicBezier(float x, float x1, float y1, float x2, float y2)
   return _gasCubicBezierYFromT(t, y1, y2);
 }
 
+_gasEasingId _gasEasingIdFromFunc(gasEasingFunc easing)
+{
+  if (easing == gasEasingLinear) return GAS_EASING_ID_LINEAR;
+  if (easing == gasEasingQuadIn) return GAS_EASING_ID_QUAD_IN;
+  if (easing == gasEasingQuadOut) return GAS_EASING_ID_QUAD_OUT;
+  if (easing == gasEasingEase) return GAS_EASING_ID_EASE;
+  if (easing == gasEasingEaseIn) return GAS_EASING_ID_EASE_IN;
+  if (easing == gasEasingEaseOut) return GAS_EASING_ID_EASE_OUT;
+  if (easing == gasEasingEaseInOut) return GAS_EASING_ID_EASE_IN_OUT;
+  return GAS_EASING_ID_CUSTOM;
+}
+
+gasEasingFunc _gasEasingFuncFromId(_gasEasingId const id)
+{
+  switch (id)
+  {
+    case GAS_EASING_ID_LINEAR: return gasEasingLinear;
+    case GAS_EASING_ID_QUAD_IN: return gasEasingQuadIn;
+    case GAS_EASING_ID_QUAD_OUT: return gasEasingQuadOut;
+    case GAS_EASING_ID_EASE: return gasEasingEase;
+    case GAS_EASING_ID_EASE_IN: return gasEasingEaseIn;
+    case GAS_EASING_ID_EASE_OUT: return gasEasingEaseOut;
+    case GAS_EASING_ID_EASE_IN_OUT: return gasEasingEaseInOut;
+    default: return NULL;
+  }
+}
+
+float _gasEasingEvaluate(_gasEasingId const id, gasEasingFunc easing, gasEasingCurve const* curve, float const t)
+{
+  switch (id)
+  {
+    case GAS_EASING_ID_LINEAR: return t;
+    case GAS_EASING_ID_QUAD_IN: return t * t;
+    case GAS_EASING_ID_QUAD_OUT: return 2 * t - t * t;
+    case GAS_EASING_ID_EASE:
+    case GAS_EASING_ID_EASE_IN:
+    case GAS_EASING_ID_EASE_OUT:
+    case GAS_EASING_ID_EASE_IN_OUT: return _gasEasingCurveEvaluate(_gasEasingBuiltinCurve(id), t);
+    case GAS_EASING_ID_CURVE: return _gasEasingCurveEvaluate(curve, t);
+    default: return easing(t);
+  }
+}
+
 // INTERNAL
 
 
 gasAnimation* _gasAnimationNew(_gasAnimationType type)
 {
-  gasAnimation* animation = calloc(1, sizeof(_gasAnimation));
+  gasAnimation* animation = _gasAnimationAlloc();
+  animation->allocation = GAS_ALLOCATION_POOL;
+  animation->finalizers = GAS_FALSE;
   animation->state = GAS_ANIMATION_STATE_NOT_STARTED;
   animation->type = type;
   animation->loops = 1;
@@ -353,6 +833,89 @@ gasAnimation* _gasAnimationNew(_gasAnimationType type)
   return animation;
 }
 
+void _gasAnimationFinalize(gasAnimation* animation)
+{
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      if (animation->modelAnimation.binding)
+      {
+        _gasModelBindingRelease(animation->modelAnimation.binding);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      if(animation->action.freeCallback)
+      {
+        _gasTransformStageFlush();
+        animation->action.freeCallback(animation->action.userdata);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    {
+      if(animation->customAnimation.freeCallback)
+      {
+        _gasTransformStageFlush();
+        animation->customAnimation.freeCallback(animation->customAnimation.userdata);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      _gasProgramStatesFinalize(animation->programAnimation.program, animation->programAnimation.states);
+      _gasProgramRelease(animation->programAnimation.program);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      if (animation->allocation == GAS_ALLOCATION_POOL)
+      {
+        _gasRotationAnimationRelease(animation->rotationAnimation);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      _gasTrackKeysRelease(animation->trackAnimation.keys);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      _gasPathPointsRelease(animation->pathAnimation.points);
+      break;
+    }
+    default: break;
+  }
+}
+
+void _gasAnimationFinalizeTree(gasAnimation* animation)
+{
+  int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for(i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        _gasAnimationFinalizeTree(animation->sequentialAnimation.children[i]);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for(i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        _gasAnimationFinalizeTree(animation->parallelAnimation.children[i]);
+      }
+      break;
+    }
+    default: _gasAnimationFinalize(animation); break;
+  }
+}
+
 gasAnimation* _gasNumberAnimationNew(gasNumberAnimationTarget const target, gasEasingFunc easing,
                                      _gasNumberAnimationType const type, float const a, float const b, float const duration)
 {
@@ -363,37 +926,87 @@ gasAnimation* _gasNumberAnimationNew(gasNumberAnimationTarget const target, gasE
   animation->numberAnimation.b = b;
   animation->numberAnimation.duration = duration;
   animation->numberAnimation.easing = easing;
+  animation->numberAnimation.curve = NULL;
   animation->numberAnimation.time = 0.0f;
   return animation;
 }
 
+gasAnimation* _gasVectorAnimationNew(gasVectorAnimationTarget const target, gasEasingFunc easing,
+                                     _gasNumberAnimationType const type, kmVec3 const* a, kmVec3 const* b,
+                                     float const duration)
+{
+  gasAnimation* animation = _gasAnimationNew(GAS_ANIMATION_TYPE_VECTOR);
+  animation->vectorAnimation.type = type;
+  animation->vectorAnimation.target = target;
+  animation->vectorAnimation.a = *a;
+  animation->vectorAnimation.b = *b;
+  animation->vectorAnimation.duration = duration;
+  animation->vectorAnimation.time = 0.0f;
+  animation->vectorAnimation.easing = easing;
+  animation->vectorAnimation.curve = NULL;
+  return animation;
+}
+
+gasAnimation* _gasRotationAnimationNew(gasEasingFunc easing, _gasNumberAnimationType const type,
+                                       kmQuaternion const* a, kmQuaternion const* b, float const duration)
+{
+  gasAnimation* animation = _gasAnimationNew(GAS_ANIMATION_TYPE_ROTATION);
+  animation->rotationAnimation = _gasRotationAnimationAlloc();
+  animation->rotationAnimation->type = type;
+  animation->rotationAnimation->nlerp = GAS_FALSE;
+  animation->rotationAnimation->a = *a;
+  animation->rotationAnimation->b = *b;
+  animation->rotationAnimation->duration = duration;
+  animation->rotationAnimation->time = 0.0f;
+  animation->rotationAnimation->easing = easing;
+  animation->rotationAnimation->curve = NULL;
+  return animation;
+}
+
 float _gasAnimate(gasAnimation* animation, glhckObject* object, float const delta)
 {
   if (animation->state == GAS_ANIMATION_STATE_FINISHED)
     return delta;
 
   float left = delta;
+  gasBoolean ended = GAS_FALSE;
 
   while (_gasLoopsLeft(animation) && left > 0)
   {
+    if (animation->state == GAS_ANIMATION_STATE_NOT_STARTED && _gasAnimationSkipLoops(animation, object, ended, &left))
+      continue;
+
+    float const before = left;
+    gasBoolean const started = animation->state == GAS_ANIMATION_STATE_NOT_STARTED;
+
     switch (animation->type)
     {
-      case GAS_ANIMATION_TYPE_NUMBER: left = _gasAnimateNumberAnimation(animation, object, delta); break;
-      case GAS_ANIMATION_TYPE_PAUSE: left = _gasAnimatePauseAnimation(animation, object, delta); break;
-      case GAS_ANIMATION_TYPE_SEQUENTIAL: left = _gasAnimateSequentialAnimation(animation, object, delta); break;
-      case GAS_ANIMATION_TYPE_PARALLEL: left = _gasAnimateParallelAnimation(animation, object, delta); break;
-      case GAS_ANIMATION_TYPE_MODEL: left = _gasAnimateModelAnimation(animation, object, delta); break;
-      case GAS_ANIMATION_TYPE_ACTION: left = _gasAnimateAction(animation, object, delta); break;
-      case GAS_ANIMATION_TYPE_CUSTOM: left = _gasAnimateCustomAnimation(animation, object, delta); break;
+      case GAS_ANIMATION_TYPE_NUMBER: left = _gasAnimateNumberAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_PAUSE: left = _gasAnimatePauseAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_SEQUENTIAL: left = _gasAnimateSequentialAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_PARALLEL: left = _gasAnimateParallelAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_MODEL: left = _gasAnimateModelAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_ACTION: left = _gasAnimateAction(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_CUSTOM: left = _gasAnimateCustomAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_PROGRAM: left = _gasAnimateProgramAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_VECTOR: left = _gasAnimateVectorAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_ROTATION: left = _gasAnimateRotationAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_TRACK: left = _gasAnimateTrackAnimation(animation, object, left); break;
+      case GAS_ANIMATION_TYPE_PATH: left = _gasAnimatePathAnimation(animation, object, left); break;
       default: assert(0);
     }
 
     if (animation->state == GAS_ANIMATION_STATE_FINISHED)
     {
       animation->loop += 1;
+      ended = GAS_TRUE;
       if(_gasLoopsLeft(animation))
       {
         _gasAnimationResetCurrentLoop(animation);
+
+        /* An endless loop that takes no time would otherwise never return */
+        if (animation->loops == -1 && started && left >= before)
+          left = 0;
       }
 
     }
@@ -404,80 +1017,231 @@ float _gasAnimate(gasAnimation* animation, glhckObject* object, float const delt
 
 float _gasAnimateNumberAnimation(gasAnimation* animation, glhckObject* object, float const delta)
 {
-  if (animation->state == GAS_ANIMATION_STATE_NOT_STARTED)
+  return _gasNumberAnimationStep(&animation->numberAnimation, &animation->state, object, delta);
+}
+
+float _gasNumberAnimationStep(_gasNumberAnimation* number, gasAnimationState* state, glhckObject* object, float const delta)
+{
+  if (*state == GAS_ANIMATION_STATE_NOT_STARTED)
   {
-    switch (animation->numberAnimation.type)
+    switch (number->type)
     {
       case GAS_NUMBER_ANIMATION_TYPE_FROM:
       {
-        animation->numberAnimation.b = _gasNumberAnimationGetTargetValue(animation->numberAnimation.target, object);
+        number->b = _gasNumberAnimationGetTargetValue(number->target, object);
         break;
       }
       case GAS_NUMBER_ANIMATION_TYPE_TO:
       {
-        animation->numberAnimation.a = _gasNumberAnimationGetTargetValue(animation->numberAnimation.target, object);
+        number->a = _gasNumberAnimationGetTargetValue(number->target, object);
         break;
       }
       case GAS_NUMBER_ANIMATION_TYPE_DELTA:
       {
-        animation->numberAnimation.a = _gasNumberAnimationGetTargetValue(animation->numberAnimation.target, object);
+        number->a = _gasNumberAnimationGetTargetValue(number->target, object);
         break;
       }
       default: break;
     }
   }
 
-  animation->numberAnimation.time += delta;
+  number->time += delta;
 
-  float const relativeTime = animation->numberAnimation.duration > 0.0f
-      ? animation->numberAnimation.time / animation->numberAnimation.duration
+  float const relativeTime = number->duration > 0.0f
+      ? number->time / number->duration
       : 1.0f;
 
-  animation->state = animation->numberAnimation.time >= animation->numberAnimation.duration
+  *state = number->time >= number->duration
       ? GAS_ANIMATION_STATE_FINISHED
       : GAS_ANIMATION_STATE_RUNNING;
 
-  float const t = animation->numberAnimation.easing(_gasClamp(relativeTime, 0, 1));
+  float const x = _gasClamp(relativeTime, 0, 1);
+  float const t = number->curve ? _gasEasingCurveEvaluate(number->curve, x) : number->easing(x);
+
+  float const value = _gasNumberAnimationValue(number->type, number->a, number->b, t);
+
+  _gasNumberAnimationSetTargetValue(number->target, object, value);
+
+  return number->time >= number->duration
+      ? number->time - number->duration
+      : 0;
+}
 
-  float value;
-  switch (animation->numberAnimation.type)
+float _gasNumberAnimationValue(_gasNumberAnimationType const type, float const a, float const b, float const t)
+{
+  switch (type)
   {
     case GAS_NUMBER_ANIMATION_TYPE_FROM_TO:
     case GAS_NUMBER_ANIMATION_TYPE_FROM:
     case GAS_NUMBER_ANIMATION_TYPE_TO:
+      return a + (b - a) * t;
+    case GAS_NUMBER_ANIMATION_TYPE_FROM_DELTA:
+    case GAS_NUMBER_ANIMATION_TYPE_DELTA:
+      return a + b * t;
+    case GAS_NUMBER_ANIMATION_TYPE_DELTA_TO:
+      return (b - a) + a * t;
+    default: assert(0);
+  }
+  return 0.0f;
+}
+
+float _gasAnimateVectorAnimation(gasAnimation* animation, glhckObject* object, float const delta)
+{
+  return _gasVectorAnimationStep(&animation->vectorAnimation, &animation->state, object, delta);
+}
+
+float _gasVectorAnimationStep(_gasVectorAnimation* vector, gasAnimationState* state, glhckObject* object, float const delta)
+{
+  if (*state == GAS_ANIMATION_STATE_NOT_STARTED)
+  {
+    switch (vector->type)
     {
-      value = animation->numberAnimation.a + (animation->numberAnimation.b - animation->numberAnimation.a) * t;
-      break;
+      case GAS_NUMBER_ANIMATION_TYPE_FROM:
+      {
+        vector->b = _gasVectorAnimationGetTargetValue(vector->target, object);
+        break;
+      }
+      case GAS_NUMBER_ANIMATION_TYPE_TO:
+      case GAS_NUMBER_ANIMATION_TYPE_DELTA:
+      {
+        vector->a = _gasVectorAnimationGetTargetValue(vector->target, object);
+        break;
+      }
+      default: break;
     }
+  }
+
+  vector->time += delta;
+
+  float const relativeTime = vector->duration > 0.0f
+      ? vector->time / vector->duration
+      : 1.0f;
+
+  *state = vector->time >= vector->duration
+      ? GAS_ANIMATION_STATE_FINISHED
+      : GAS_ANIMATION_STATE_RUNNING;
+
+  float const x = _gasClamp(relativeTime, 0, 1);
+  float const t = vector->curve ? _gasEasingCurveEvaluate(vector->curve, x) : vector->easing(x);
+
+  kmVec3 value;
+  value.x = _gasNumberAnimationValue(vector->type, vector->a.x, vector->b.x, t);
+  value.y = _gasNumberAnimationValue(vector->type, vector->a.y, vector->b.y, t);
+  value.z = _gasNumberAnimationValue(vector->type, vector->a.z, vector->b.z, t);
+
+  _gasVectorAnimationSetTargetValue(vector->target, object, &value);
+
+  return vector->time >= vector->duration
+      ? vector->time - vector->duration
+      : 0;
+}
+
+static kmQuaternion _gasRotationAnimationGetTargetValue(glhckObject* object)
+{
+  kmVec3 const euler = _gasVectorAnimationGetTargetValue(GAS_VECTOR_ANIMATION_TARGET_ROTATION, object);
+  kmQuaternion q;
+  gasQuaternionFromEuler(&euler, &q);
+  return q;
+}
+
+float _gasAnimateRotationAnimation(gasAnimation* animation, glhckObject* object, float const delta)
+{
+  return _gasRotationAnimationStep(animation->rotationAnimation, &animation->state, object, delta);
+}
+
+float _gasRotationAnimationStep(_gasRotationAnimation* rotation, gasAnimationState* state, glhckObject* object, float const delta)
+{
+  if (*state == GAS_ANIMATION_STATE_NOT_STARTED)
+  {
+    switch (rotation->type)
+    {
+      case GAS_NUMBER_ANIMATION_TYPE_FROM:
+      {
+        rotation->b = _gasRotationAnimationGetTargetValue(object);
+        break;
+      }
+      case GAS_NUMBER_ANIMATION_TYPE_TO:
+      case GAS_NUMBER_ANIMATION_TYPE_DELTA:
+      {
+        rotation->a = _gasRotationAnimationGetTargetValue(object);
+        break;
+      }
+      default: break;
+    }
+  }
+
+  rotation->time += delta;
+
+  float const relativeTime = rotation->duration > 0.0f
+      ? rotation->time / rotation->duration
+      : 1.0f;
+
+  *state = rotation->time >= rotation->duration
+      ? GAS_ANIMATION_STATE_FINISHED
+      : GAS_ANIMATION_STATE_RUNNING;
+
+  float const x = _gasClamp(relativeTime, 0, 1);
+  float const t = rotation->curve ? _gasEasingCurveEvaluate(rotation->curve, x) : rotation->easing(x);
+
+  kmQuaternion value;
+  _gasRotationAnimationValue(rotation, t, &value);
+
+  kmVec3 const euler = _gasQuaternionToEuler(&value);
+  _gasVectorAnimationSetTargetValue(GAS_VECTOR_ANIMATION_TARGET_ROTATION, object, &euler);
+
+  return rotation->time >= rotation->duration
+      ? rotation->time - rotation->duration
+      : 0;
+}
+
+void _gasRotationAnimationValue(_gasRotationAnimation const* rotation, float const t, kmQuaternion* value)
+{
+  kmQuaternion from = rotation->a;
+  kmQuaternion to = rotation->b;
+  switch (rotation->type)
+  {
     case GAS_NUMBER_ANIMATION_TYPE_FROM_DELTA:
     case GAS_NUMBER_ANIMATION_TYPE_DELTA:
-    {
-      value = animation->numberAnimation.a + animation->numberAnimation.b * t;
+      _gasQuaternionMultiply(&rotation->a, &rotation->b, &to);
       break;
-    }
     case GAS_NUMBER_ANIMATION_TYPE_DELTA_TO:
     {
-      value = (animation->numberAnimation.b - animation->numberAnimation.a) + animation->numberAnimation.a * t;
+      kmQuaternion const inverse = { -rotation->a.x, -rotation->a.y, -rotation->a.z, rotation->a.w };
+      _gasQuaternionMultiply(&rotation->b, &inverse, &from);
       break;
     }
-    default: assert(0);
+    default: break;
   }
 
-  _gasNumberAnimationSetTargetValue(animation->numberAnimation.target, object, value);
+  if (rotation->nlerp)
+    _gasQuaternionNlerp(&from, &to, t, value);
+  else
+    _gasQuaternionSlerp(&from, &to, t, value);
+}
 
-  return animation->numberAnimation.time >= animation->numberAnimation.duration
-      ? animation->numberAnimation.time - animation->numberAnimation.duration
-      : 0;
+float _gasAnimateTrackAnimation(gasAnimation* animation, glhckObject* object, float const delta)
+{
+  return _gasTrackAnimationStep(&animation->trackAnimation, &animation->state, object, delta);
+}
+
+float _gasAnimatePathAnimation(gasAnimation* animation, glhckObject* object, float const delta)
+{
+  return _gasPathAnimationStep(&animation->pathAnimation, &animation->state, object, delta);
 }
 
 float _gasAnimatePauseAnimation(gasAnimation* animation, glhckObject* object, float const delta)
 {
-  animation->pauseAnimation.time += delta;
-  animation->state = animation->pauseAnimation.time >= animation->pauseAnimation.duration
+  return _gasPauseAnimationStep(&animation->pauseAnimation, &animation->state, delta);
+}
+
+float _gasPauseAnimationStep(_gasPauseAnimation* pause, gasAnimationState* state, float const delta)
+{
+  pause->time += delta;
+  *state = pause->time >= pause->duration
       ? GAS_ANIMATION_STATE_FINISHED
       : GAS_ANIMATION_STATE_RUNNING;
-  return animation->pauseAnimation.time >= animation->pauseAnimation.duration
-      ? animation->pauseAnimation.time - animation->pauseAnimation.duration
+  return pause->time >= pause->duration
+      ? pause->time - pause->duration
       : 0;
 }
 
@@ -505,15 +1269,34 @@ float _gasAnimateSequentialAnimation(gasAnimation* animation, glhckObject* objec
 float _gasAnimateParallelAnimation(gasAnimation* animation, glhckObject* object, float const delta)
 {
   float minLeft = delta;
-
-  int i;
-  for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+  if (animation->parallelAnimation.overlapping)
+    _gasLoopSkipSuspend();
+
+  /* Finished children would hand back the whole delta, so only the children
+   * still running are visited and those finishing now drop out of the set */
+  gasAnimation** children = animation->parallelAnimation.children;
+  unsigned int* active = animation->parallelAnimation.active;
+  unsigned int const numActive = animation->parallelAnimation.numActive;
+  unsigned int i, j = 0;
+  for (i = 0; i < numActive; ++i)
   {
-    gasAnimation* child = animation->parallelAnimation.children[i];
+    unsigned int const index = active ? active[i] : i;
+    gasAnimation* child = children[index];
     float left = _gasAnimate(child, object, delta);
     minLeft = left < minLeft ? left : minLeft;
+
+    if (active && _gasLoopsLeft(child))
+    {
+      active[j++] = index;
+    }
   }
 
+  if (active)
+    animation->parallelAnimation.numActive = j;
+
+  if (animation->parallelAnimation.overlapping)
+    _gasLoopSkipResume();
+
   animation->state = minLeft > 0
       ? GAS_ANIMATION_STATE_FINISHED
       : GAS_ANIMATION_STATE_RUNNING;
@@ -523,81 +1306,101 @@ float _gasAnimateParallelAnimation(gasAnimation* animation, glhckObject* object,
 
 float _gasAnimateModelAnimation(gasAnimation* animation, glhckObject* object, float const delta)
 {
-  if(animation->modelAnimation.duration <= 0.0f) {
-    animation->state = GAS_ANIMATION_STATE_FINISHED;
+  return _gasModelAnimationStep(&animation->modelAnimation, &animation->state, object, delta);
+}
+
+float _gasModelAnimationStep(_gasModelAnimation* model, gasAnimationState* state, glhckObject* object, float const delta)
+{
+  if(model->duration <= 0.0f) {
+    *state = GAS_ANIMATION_STATE_FINISHED;
     return delta;
   }
 
-  if(animation->modelAnimation.animator == NULL)
+  if(model->binding == NULL)
   {
-    glhckAnimator* animator = glhckAnimatorNew();
-
-    unsigned int numAnimations;
-    glhckAnimation** animations = glhckObjectAnimations(object, &numAnimations);
-    glhckAnimation* modelAnimation = NULL;
-    int i;
-    for(i = 0; i < numAnimations; ++i)
+    model->binding = _gasModelBindingAcquire(model->name, object);
+    if(model->binding == NULL)
     {
-      if(strcmp(animation->modelAnimation.name, glhckAnimationGetName(animations[i])) == 0)
-      {
-        modelAnimation = animations[i];
-        break;
-      }
+      *state = GAS_ANIMATION_STATE_FINISHED;
+      return delta;
     }
-
-    assert(modelAnimation);
-    glhckAnimatorAnimation(animator, modelAnimation);
-    animation->modelAnimation.animationDuration = glhckAnimationGetDuration(modelAnimation);
-
-    unsigned int numBones;
-    glhckBone** bones = glhckObjectBones(object, &numBones);
-    glhckAnimatorInsertBones(animator, bones, numBones);
-
-    animation->modelAnimation.animator = animator;
-
   }
-  animation->modelAnimation.time += delta;
-  float position = animation->modelAnimation.time / animation->modelAnimation.duration;
-  glhckAnimatorUpdate(animation->modelAnimation.animator, _gasClamp(position, 0.0f, 1.0f) * animation->modelAnimation.animationDuration);
-  glhckAnimatorTransform(animation->modelAnimation.animator, object);
-  if(animation->modelAnimation.time > animation->modelAnimation.duration)
+  model->time += delta;
+  float position = model->time / model->duration;
+  float const playTime = _gasClamp(position, 0.0f, 1.0f) * model->binding->animationDuration;
+
+  /* Throttled steps leave the skeleton where it is, the next update catches
+   * up to the current time. The last step always poses the end. */
+  _gasModelBinding* binding = model->binding;
+  binding->steps += 1;
+  if(playTime != binding->playTime
+     && (binding->playTime < 0.0f || model->time > model->duration
+         || (binding->steps >= model->frames && fabsf(playTime - binding->playTime) >= model->minStep)))
+  {
+    glhckAnimatorUpdate(binding->animator, playTime);
+    glhckAnimatorTransform(binding->animator, object);
+    binding->playTime = playTime;
+    binding->steps = 0;
+  }
+
+  if(model->time > model->duration)
   {
-    animation->state = GAS_ANIMATION_STATE_FINISHED;
-    return animation->modelAnimation.time - animation->modelAnimation.duration;
+    *state = GAS_ANIMATION_STATE_FINISHED;
+    return model->time - model->duration;
   }
   else
   {
-    animation->state = GAS_ANIMATION_STATE_RUNNING;
+    *state = GAS_ANIMATION_STATE_RUNNING;
     return 0.0f;
   }
 }
 
 float _gasAnimateAction(gasAnimation* animation, glhckObject* object, float const delta)
 {
-  if(animation->action.callback)
+  return _gasActionStep(&animation->action, &animation->state, object, delta);
+}
+
+float _gasActionStep(_gasAction* action, gasAnimationState* state, glhckObject* object, float const delta)
+{
+  if(action->callback && !_gasEventQueuePush(action->callback, action->userdata, object, delta))
   {
-    animation->action.callback(object, animation->action.userdata);
+    _gasTransformStageFlush();
+    action->callback(object, action->userdata);
   }
 
-  animation->state = GAS_ANIMATION_STATE_FINISHED;
+  *state = GAS_ANIMATION_STATE_FINISHED;
   return delta;
 }
 
 float _gasAnimateCustomAnimation(gasAnimation* animation, glhckObject* object, float const delta)
+{
+  return _gasCustomAnimationStep(&animation->customAnimation, &animation->state, object, delta);
+}
+
+float _gasCustomAnimationStep(_gasCustomAnimation* custom, gasAnimationState* state, glhckObject* object, float const delta)
 {
   float left = delta;
-  if(animation->customAnimation.callback)
+  if(custom->callback)
   {
-    left = animation->customAnimation.callback(object, delta, animation->customAnimation.userdata);
+    _gasTransformStageFlush();
+    left = custom->callback(object, delta, custom->userdata);
   }
 
-  animation->state = left > 0
+  *state = left > 0
       ? GAS_ANIMATION_STATE_FINISHED
       : GAS_ANIMATION_STATE_RUNNING;
 
   return left;
 }
 
+float _gasAnimateProgramAnimation(gasAnimation* animation, glhckObject* object, float const delta)
+{
+  _gasInstructionState* states = animation->programAnimation.states;
+  float const left = _gasProgramAnimate(animation->programAnimation.program, states, 0, object, delta);
+  animation->state = states[0].state;
+  return left;
+}
+
 void _gasAnimationResetCurrentLoop(gasAnimation* animation)
 {
   animation->state = GAS_ANIMATION_STATE_NOT_STARTED;
@@ -611,6 +1414,11 @@ void _gasAnimationResetCurrentLoop(gasAnimation* animation)
     case GAS_ANIMATION_TYPE_MODEL: return _gasAnimationResetModelAnimation(animation); break;
     case GAS_ANIMATION_TYPE_ACTION: return _gasAnimationResetAction(animation); break;
     case GAS_ANIMATION_TYPE_CUSTOM: return _gasAnimationResetCustomAnimation(animation); break;
+    case GAS_ANIMATION_TYPE_PROGRAM: return _gasAnimationResetProgramAnimation(animation); break;
+    case GAS_ANIMATION_TYPE_VECTOR: return _gasAnimationResetVectorAnimation(animation); break;
+    case GAS_ANIMATION_TYPE_ROTATION: return _gasAnimationResetRotationAnimation(animation); break;
+    case GAS_ANIMATION_TYPE_TRACK: return _gasAnimationResetTrackAnimation(animation); break;
+    case GAS_ANIMATION_TYPE_PATH: return _gasAnimationResetPathAnimation(animation); break;
     default: assert(0);
   }
 }
@@ -620,6 +1428,28 @@ void _gasAnimationResetNumberAnimation(gasAnimation* animation)
   animation->numberAnimation.time = 0.0f;
 }
 
+void _gasAnimationResetVectorAnimation(gasAnimation* animation)
+{
+  animation->vectorAnimation.time = 0.0f;
+}
+
+void _gasAnimationResetRotationAnimation(gasAnimation* animation)
+{
+  animation->rotationAnimation->time = 0.0f;
+}
+
+void _gasAnimationResetTrackAnimation(gasAnimation* animation)
+{
+  animation->trackAnimation.time = 0.0f;
+  animation->trackAnimation.cursor = 0;
+}
+
+void _gasAnimationResetPathAnimation(gasAnimation* animation)
+{
+  animation->pathAnimation.time = 0.0f;
+  animation->pathAnimation.cursor = 0;
+}
+
 void _gasAnimationResetPauseAnimation(gasAnimation* animation)
 {
   animation->pauseAnimation.time = 0.0f;
@@ -644,12 +1474,27 @@ void _gasAnimationResetParallelAnimation(gasAnimation* animation)
     gasAnimation* child = animation->parallelAnimation.children[i];
     gasAnimationReset(child);
   }
+  _gasParallelAnimationActivate(animation);
+}
+
+void _gasParallelAnimationActivate(gasAnimation* animation)
+{
+  animation->parallelAnimation.numActive = animation->parallelAnimation.numChildren;
+  if (!animation->parallelAnimation.active)
+    return;
+
+  unsigned int i;
+  for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+  {
+    animation->parallelAnimation.active[i] = i;
+  }
 }
 
 void _gasAnimationResetAction(gasAnimation* animation)
 {
   if(animation->action.resetCallback)
   {
+    _gasTransformStageFlush();
     animation->action.resetCallback(animation->action.userdata);
   }
 }
@@ -658,6 +1503,7 @@ void _gasAnimationResetCustomAnimation(gasAnimation* animation)
 {
   if(animation->customAnimation.resetCallback)
   {
+    _gasTransformStageFlush();
     animation->customAnimation.resetCallback(animation->customAnimation.userdata);
   }
 }
@@ -667,8 +1513,17 @@ void _gasAnimationResetModelAnimation(gasAnimation* animation)
   animation->modelAnimation.time = 0.0f;
 }
 
+void _gasAnimationResetProgramAnimation(gasAnimation* animation)
+{
+  _gasProgramResetCurrentLoop(animation->programAnimation.program, animation->programAnimation.states, 0);
+  animation->programAnimation.states[0].loop = 0;
+}
+
 float _gasNumberAnimationGetTargetValue(gasNumberAnimationTarget target, glhckObject* object)
 {
+  if (_gasTransformStageActive())
+    return _gasTransformStageGetValue(target, object);
+
   switch (target)
   {
     case GAS_NUMBER_ANIMATION_TARGET_X: return glhckObjectGetPosition(object)->x;
@@ -683,6 +1538,12 @@ float _gasNumberAnimationGetTargetValue(gasNumberAnimationTarget target, glhckOb
 
 void _gasNumberAnimationSetTargetValue(gasNumberAnimationTarget target, glhckObject* object, float const value)
 {
+  if (_gasTransformStageActive())
+  {
+    _gasTransformStageSetValue(target, object, value);
+    return;
+  }
+
   switch (target)
   {
     case GAS_NUMBER_ANIMATION_TARGET_X:
@@ -719,6 +1580,38 @@ void _gasNumberAnimationSetTargetValue(gasNumberAnimationTarget target, glhckObj
   }
 }
 
+kmVec3 _gasVectorAnimationGetTargetValue(gasVectorAnimationTarget target, glhckObject* object)
+{
+  if (_gasTransformStageActive())
+    return _gasTransformStageGetVector(target, object);
+
+  switch (target)
+  {
+    case GAS_VECTOR_ANIMATION_TARGET_POSITION: return *glhckObjectGetPosition(object);
+    case GAS_VECTOR_ANIMATION_TARGET_ROTATION: return *glhckObjectGetRotation(object);
+    case GAS_VECTOR_ANIMATION_TARGET_SCALE: return *glhckObjectGetScale(object);
+    default: assert(0);
+  }
+  return _gasZeroVector;
+}
+
+void _gasVectorAnimationSetTargetValue(gasVectorAnimationTarget target, glhckObject* object, kmVec3 const* value)
+{
+  if (_gasTransformStageActive())
+  {
+    _gasTransformStageSetVector(target, object, value);
+    return;
+  }
+
+  switch (target)
+  {
+    case GAS_VECTOR_ANIMATION_TARGET_POSITION: glhckObjectPosition(object, value); break;
+    case GAS_VECTOR_ANIMATION_TARGET_ROTATION: glhckObjectRotation(object, value); break;
+    case GAS_VECTOR_ANIMATION_TARGET_SCALE: glhckObjectScale(object, value); break;
+    default: assert(0);
+  }
+}
+
 float _gasClamp(float const value, float const minValue, float const maxValue)
 {
   return value <= minValue ? minValue : value >= maxValue ? maxValue : value;
@@ -735,41 +1628,157 @@ gasAnimationState gasAnimationGetState(gasAnimation* animation)
 }
 
 
+/* Clones are allocated as one block holding every node, rotation, child
+ * array and program state block of the tree, so freeing a clone is a single
+ * free unless some of its nodes need finalizing. */
 gasAnimation* gasAnimationClone(gasAnimation* animation)
 {
-  gasAnimation* newAnimation = _gasAnimationNew(animation->type);
+  size_t numNodes = 0;
+  size_t numRotations = 0;
+  size_t numChildren = 0;
+  size_t stateSize = 0;
+  gasBoolean finalizers = GAS_FALSE;
+  _gasAnimationMeasure(animation, &numNodes, &numRotations, &numChildren, &stateSize, &finalizers);
+
+  char* block = malloc(numNodes * sizeof(_gasAnimation) + numRotations * sizeof(_gasRotationAnimation)
+                       + numChildren * sizeof(gasAnimation*) + stateSize);
+  gasAnimation* nodes = (gasAnimation*) block;
+  _gasRotationAnimation* rotations = (_gasRotationAnimation*) (nodes + numNodes);
+  gasAnimation** children = (gasAnimation**) (rotations + numRotations);
+  char* states = (char*) (children + numChildren);
+
+  gasAnimation* newAnimation = _gasAnimationCloneInto(animation, &nodes, &rotations, &children, &states);
+  newAnimation->allocation = GAS_ALLOCATION_BLOCK_ROOT;
+  newAnimation->finalizers = finalizers;
+  return newAnimation;
+}
+
+void _gasAnimationMeasure(gasAnimation* animation, size_t* numNodes, size_t* numRotations, size_t* numChildren,
+                          size_t* stateSize, gasBoolean* finalizers)
+{
+  *numNodes += 1;
+
+  int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      *numChildren += animation->sequentialAnimation.numChildren;
+      for(i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        _gasAnimationMeasure(animation->sequentialAnimation.children[i], numNodes, numRotations, numChildren, stateSize, finalizers);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      *numChildren += GAS_PARALLEL_SLOTS(animation->parallelAnimation.numChildren);
+      for(i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        _gasAnimationMeasure(animation->parallelAnimation.children[i], numNodes, numRotations, numChildren, stateSize, finalizers);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      *finalizers = GAS_TRUE;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      *finalizers = *finalizers || animation->action.freeCallback;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    {
+      *finalizers = *finalizers || animation->customAnimation.freeCallback;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      *stateSize += animation->programAnimation.program->stateSize;
+      *finalizers = GAS_TRUE;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      *numRotations += 1;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      *finalizers = GAS_TRUE;
+      break;
+    }
+    default: break;
+  }
+}
+
+gasAnimation* _gasAnimationCloneInto(gasAnimation* animation, gasAnimation** nodes, _gasRotationAnimation** rotations,
+                                     gasAnimation*** children, char** states)
+{
+  gasAnimation* newAnimation = (*nodes)++;
   *newAnimation = *animation;
+  newAnimation->allocation = GAS_ALLOCATION_BLOCK;
+  newAnimation->finalizers = GAS_FALSE;
 
   switch (animation->type)
   {
     case GAS_ANIMATION_TYPE_NUMBER: break;
+    case GAS_ANIMATION_TYPE_VECTOR: break;
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      newAnimation->rotationAnimation = (*rotations)++;
+      *newAnimation->rotationAnimation = *animation->rotationAnimation;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      _gasTrackKeysRetain(animation->trackAnimation.keys);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      _gasPathPointsRetain(animation->pathAnimation.points);
+      break;
+    }
     case GAS_ANIMATION_TYPE_PAUSE: break;
     case GAS_ANIMATION_TYPE_SEQUENTIAL:
     {
       int n = newAnimation->sequentialAnimation.numChildren;
-      newAnimation->sequentialAnimation.children = calloc(n, sizeof(gasAnimation*));
+      newAnimation->sequentialAnimation.children = *children;
+      *children += n;
       int i;
       for(i = 0; i < n; ++i)
       {
-        newAnimation->sequentialAnimation.children[i] = gasAnimationClone(animation->sequentialAnimation.children[i]);
+        newAnimation->sequentialAnimation.children[i] =
+            _gasAnimationCloneInto(animation->sequentialAnimation.children[i], nodes, rotations, children, states);
       }
       break;
     }
     case GAS_ANIMATION_TYPE_PARALLEL:
     {
       int n = newAnimation->parallelAnimation.numChildren;
-      newAnimation->parallelAnimation.children = calloc(n, sizeof(gasAnimation*));
+      newAnimation->parallelAnimation.children = *children;
+      if (animation->parallelAnimation.active)
+      {
+        newAnimation->parallelAnimation.active = (unsigned int*) (*children + n);
+        memcpy(newAnimation->parallelAnimation.active, animation->parallelAnimation.active,
+               animation->parallelAnimation.numActive * sizeof(unsigned int));
+      }
+      *children += GAS_PARALLEL_SLOTS(n);
       int i;
       for(i = 0; i < n; ++i)
       {
-        newAnimation->parallelAnimation.children[i] = gasAnimationClone(animation->parallelAnimation.children[i]);
+        newAnimation->parallelAnimation.children[i] =
+            _gasAnimationCloneInto(animation->parallelAnimation.children[i], nodes, rotations, children, states);
       }
       break;
     }
     case GAS_ANIMATION_TYPE_MODEL:
     {
-      newAnimation->modelAnimation.name = strdup(animation->modelAnimation.name);
-      newAnimation->modelAnimation.animator = NULL;
+      newAnimation->modelAnimation.binding = NULL;
       break;
     }
     case GAS_ANIMATION_TYPE_ACTION:
@@ -780,7 +1789,7 @@ gasAnimation* gasAnimationClone(gasAnimation* animation)
       }
       break;
     }
-    case GAS_ANIMATION_TYPE_CUSTOM: break;
+    case GAS_ANIMATION_TYPE_CUSTOM:
     {
       if(animation->customAnimation.cloneCallback)
       {
@@ -788,49 +1797,368 @@ gasAnimation* gasAnimationClone(gasAnimation* animation)
       }
       break;
     }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      _gasProgram* program = animation->programAnimation.program;
+      _gasProgramRetain(program);
+      newAnimation->programAnimation.states = (_gasInstructionState*) *states;
+      _gasProgramStatesCopy(program, newAnimation->programAnimation.states, animation->programAnimation.states);
+      *states += program->stateSize;
+      break;
+    }
     default: assert(0);
   }
 
   return newAnimation;
 }
 
-_gasManagerAnimation* _gasManagerAnimationNew(gasAnimation* animation, glhckObject* object)
+_gasManagerAnimation* _gasManagerAnimationNew(_gasManager* manager, gasAnimation* animation, glhckObject* object)
 {
-  _gasManagerAnimation* a = calloc(1, sizeof(_gasManagerAnimation));
+  _gasManagerAnimation* a = _gasPoolAlloc(&manager->entryPool);
   a->animation = animation;
   a->object = object;
   a->manageObject = GAS_FALSE;
+  a->slot = GAS_NO_SLOT;
+  a->flags = 0;
+  a->owed = 0.0f;
   a->next = NULL;
+  a->prev = NULL;
+  a->wake = 0;
   return a;
 }
 
-_gasManagerAnimation* _gasManagerAnimationFree(_gasManagerAnimation* animation)
+_gasManagerAnimation* _gasManagerAnimationFree(_gasManager* manager, _gasManagerAnimation* animation)
 {
   _gasManagerAnimation* next = animation->next;
+  if (animation->slot != GAS_NO_SLOT)
+  {
+    _gasSlotRelease(&manager->slots, animation->slot);
+  }
   gasAnimationFree(animation->animation);
-  free(animation);
+  _gasPoolRelease(&manager->entryPool, animation);
   return next;
 }
 
-_gasManagerAnimationReference* _gasManagerEnqueueRemoveAnimation(_gasManager* manager, _gasManagerAnimation* animation)
+/* Removed entries stay linked until the next gasManagerAnimate unlinks
+ * them, so removal is safe from inside animation callbacks */
+void _gasManagerAnimationRemove(_gasManager* manager, _gasManagerAnimation* animation)
+{
+  if (animation->flags & GAS_MANAGER_ANIMATION_PARKED)
+    _gasManagerAnimationWake(manager, animation);
+
+  animation->flags |= GAS_MANAGER_ANIMATION_REMOVED;
+  if (animation->slot != GAS_NO_SLOT)
+  {
+    _gasSlotRelease(&manager->slots, animation->slot);
+    animation->slot = GAS_NO_SLOT;
+  }
+}
+
+void _gasManagerSlotRemove(_gasManager* manager, _gasSlot* slot)
+{
+  if (slot->entry)
+    _gasManagerAnimationRemove(manager, slot->entry);
+  else
+    _gasManagerBatchRemoveGroup(&_gasManagerSlotShard(manager, slot)->batch, slot->group);
+}
+
+void _gasManagerSlotPause(_gasManager* manager, _gasSlot* slot, gasBoolean const paused)
+{
+  if (slot->entry)
+  {
+    if (paused && slot->entry->flags & GAS_MANAGER_ANIMATION_PARKED)
+      _gasManagerAnimationWake(manager, slot->entry);
+
+    if (paused)
+      slot->entry->flags |= GAS_MANAGER_ANIMATION_PAUSED;
+    else
+      slot->entry->flags &= ~GAS_MANAGER_ANIMATION_PAUSED;
+  }
+  else
+  {
+    _gasManagerSlotShard(manager, slot)->batch.groups[slot->group].paused = paused;
+  }
+}
+
+/* Parked entries owe the time their shard was advanced by since they were
+ * parked, which the step after they rejoin the shard catches up on */
+static void _gasManagerAnimationUnpark(_gasManagerShard* shard, _gasManagerAnimation* animation)
+{
+  animation->flags &= ~GAS_MANAGER_ANIMATION_PARKED;
+  animation->owed = (float) (shard->time - animation->parked);
+}
+
+/* Takes a parked entry off its wheel to rejoin its shard when the shard is
+ * advanced next */
+void _gasManagerAnimationWake(_gasManager* manager, _gasManagerAnimation* animation)
+{
+  _gasManagerShard* shard = _gasManagerShardOf(manager, animation->object);
+  _gasTimingWheelUnlink(&shard->wheel, animation);
+  _gasManagerAnimationUnpark(shard, animation);
+  animation->next = shard->woken;
+  shard->woken = animation;
+}
+
+gasBoolean _gasManagerAnimationRemoved(_gasManagerAnimation* animation)
+{
+  return animation->flags & GAS_MANAGER_ANIMATION_REMOVED ? GAS_TRUE : GAS_FALSE;
+}
+
+_gasManagerShard* _gasManagerShardsNew(_gasManager* manager, unsigned int const numShards)
+{
+  _gasManagerShard* shards = calloc(numShards, sizeof(_gasManagerShard));
+  unsigned int i;
+  for (i = 0; i < numShards; ++i)
+  {
+    _gasManagerBatchInit(&shards[i].batch, &manager->slots);
+    _gasTransformStageInit(&shards[i].stage);
+    _gasEventQueueInit(&shards[i].events);
+    _gasTimingWheelInit(&shards[i].wheel, _gasTimingWheelTick(manager->time));
+    shards[i].time = manager->time;
+  }
+  return shards;
+}
+
+/* Objects are sharded by the memory page they live on rather than one by
+ * one, so a shard still visits objects allocated together in address order
+ * instead of scattering its reads and writes over all of them */
+unsigned int _gasManagerShardIndex(glhckObject* object, unsigned int const numShards)
+{
+  return _gasObjectHash((glhckObject*) ((uintptr_t) object / GAS_MANAGER_SHARD_PAGE)) % numShards;
+}
+
+_gasManagerShard* _gasManagerShardOf(_gasManager* manager, glhckObject* object)
+{
+  if (manager->numShards == 1)
+    return manager->shards;
+
+  return &manager->shards[_gasManagerShardIndex(object, manager->numShards)];
+}
+
+_gasManagerShard* _gasManagerSlotShard(_gasManager* manager, _gasSlot* slot)
+{
+  return _gasManagerShardOf(manager, manager->slots.objects.records[slot->record].object);
+}
+
+/* Moves every animation to the shard its object maps to in a new set of
+ * shards. Pushing entries onto the new lists reverses them, so the lists are
+ * reversed once more to keep each object's animations in order. Pending
+ * events move to the manager's queue and entries waiting for them to be
+ * dispatched go along to any shard. Parked entries are woken. */
+void _gasManagerReshard(_gasManager* manager, unsigned int const numShards)
+{
+  if (numShards == manager->numShards)
+    return;
+
+  _gasEventQueueMerge(&manager->events, manager->shards, manager->numShards);
+
+  _gasManagerShard* shards = _gasManagerShardsNew(manager, numShards);
+  unsigned int i;
+  for (i = 0; i < manager->numShards; ++i)
+  {
+    _gasManagerShard* shard = &manager->shards[i];
+    _gasManagerBatchMove(&shard->batch, shards, numShards);
+    _gasManagerBatchFree(&shard->batch);
+    _gasEventQueueFree(&shard->events);
+
+    while (shard->finished)
+    {
+      _gasManagerAnimation* a = shard->finished;
+      shard->finished = a->next;
+      a->next = shards[0].finished;
+      shards[0].finished = a;
+    }
+
+    _gasManagerAnimation* parked = _gasTimingWheelDrain(&shard->wheel);
+    while (parked)
+    {
+      _gasManagerAnimation* a = parked;
+      parked = a->next;
+      _gasManagerAnimationUnpark(shard, a);
+      a->next = shard->woken;
+      shard->woken = a;
+    }
+
+    while (shard->woken)
+    {
+      _gasManagerAnimation* a = shard->woken;
+      shard->woken = a->next;
+
+      _gasManagerShard* target = &shards[_gasManagerShardIndex(a->object, numShards)];
+      a->next = target->woken;
+      target->woken = a;
+    }
+
+    while (shard->animations)
+    {
+      _gasManagerAnimation* a = shard->animations;
+      shard->animations = a->next;
+
+      _gasManagerShard* target = &shards[_gasManagerShardIndex(a->object, numShards)];
+      a->next = target->animations;
+      target->animations = a;
+      target->numAnimations += 1;
+    }
+  }
+
+  for (i = 0; i < numShards; ++i)
+  {
+    _gasManagerAnimation* reversed = NULL;
+    while (shards[i].animations)
+    {
+      _gasManagerAnimation* a = shards[i].animations;
+      shards[i].animations = a->next;
+      a->next = reversed;
+      reversed = a;
+    }
+    shards[i].animations = reversed;
+  }
+
+  free(manager->shards);
+  manager->shards = shards;
+  manager->numShards = numShards;
+}
+
+/* Brings back the entries woken since the shard was last advanced and the
+ * parked ones due by the end of this step */
+static void _gasManagerShardWake(_gasManager* manager, _gasManagerShard* shard)
+{
+  while (shard->woken)
+  {
+    _gasManagerAnimation* a = shard->woken;
+    shard->woken = a->next;
+    a->next = shard->animations;
+    shard->animations = a;
+    shard->numAnimations += 1;
+  }
+
+  unsigned long long const tick = _gasTimingWheelTick(manager->time);
+  if (shard->wheel.numEntries == 0)
+  {
+    shard->wheel.tick = tick;
+    return;
+  }
+
+  _gasManagerAnimation* due = _gasTimingWheelAdvance(&shard->wheel, tick);
+  while (due)
+  {
+    _gasManagerAnimation* a = due;
+    due = a->next;
+    _gasManagerAnimationUnpark(shard, a);
+    a->next = shard->animations;
+    shard->animations = a;
+    shard->numAnimations += 1;
+  }
+}
+
+/* Parks the entry at *a if it will stay idle for long enough. It is set to
+ * wake a tick early so that rounding can never make it late. */
+static gasBoolean _gasManagerShardPark(_gasManager* manager, _gasManagerShard* shard, _gasManagerAnimation** a)
+{
+  _gasManagerAnimation* entry = *a;
+  if (entry->wake > shard->wheel.tick)
+    return GAS_FALSE;
+
+  gasBoolean through;
+  float const idle = _gasAnimationIdle(entry->animation, &through);
+  unsigned long long const wake = idle >= GAS_MANAGER_PARK_MIN_IDLE ? _gasTimingWheelTick(manager->time + idle) - 1 : 0;
+  if (wake <= shard->wheel.tick + 1)
+  {
+    entry->wake = shard->wheel.tick + GAS_MANAGER_PARK_RETRY_TICKS;
+    return GAS_FALSE;
+  }
+
+  *a = entry->next;
+  shard->numAnimations -= 1;
+  entry->flags |= GAS_MANAGER_ANIMATION_PARKED;
+  entry->parked = manager->time;
+  entry->wake = wake;
+  _gasTimingWheelInsert(&shard->wheel, entry);
+  return GAS_TRUE;
+}
+
+/* Advances every animation of a shard. Entries and batch groups that finish
+ * are released right away on the manager's thread, or queued for
+ * _gasManagerShardRelease when running on a worker or when events recorded
+ * into the shard may still refer to them. Entries that are left idle for a
+ * while are parked. */
+void _gasManagerShardAnimate(_gasManager* manager, _gasManagerShard* shard, float const delta, gasBoolean const release)
 {
-  _gasManagerAnimationReference* ref = calloc(1, sizeof(_gasManagerAnimationReference));
-  ref->animation = animation;
-  ref->next = manager->removeAnimations;
-  manager->removeAnimations = ref;
+  _gasManagerShardWake(manager, shard);
+  shard->time = manager->time;
+
+  if (!shard->animations && shard->batch.numRows == 0)
+    return;
+
+  _gasStagedTransform* previousStage = _gasTransformStageBegin(&shard->stage);
+  _gasEventQueue* previousQueue = _gasEventQueueBegin(manager->deferActions ? &shard->events : NULL);
+  shard->events.delta = delta;
+
+  _gasManagerBatchAnimate(&shard->batch, delta);
+  if (release)
+    _gasManagerBatchRelease(&shard->batch);
+
+  _gasManagerAnimation** a = &shard->animations;
+  while (*a)
+  {
+    _gasManagerAnimation* entry = *a;
+    shard->events.animation = entry->animation;
+    if (!_gasManagerAnimationRemoved(entry))
+    {
+      if (entry->flags & GAS_MANAGER_ANIMATION_PAUSED)
+      {
+        a = &entry->next;
+        continue;
+      }
+
+      float const step = delta + entry->owed;
+      entry->owed = 0.0f;
+      if (gasAnimate(entry->animation, entry->object, step))
+      {
+        if (!manager->parking || entry->flags & (GAS_MANAGER_ANIMATION_REMOVED | GAS_MANAGER_ANIMATION_PAUSED)
+            || !_gasManagerShardPark(manager, shard, a))
+          a = &entry->next;
+        continue;
+      }
+    }
+
+    *a = entry->next;
+    shard->numAnimations -= 1;
+    if (release)
+    {
+      _gasManagerAnimationFree(manager, entry);
+    }
+    else
+    {
+      entry->next = shard->finished;
+      shard->finished = entry;
+    }
+  }
+
+  _gasEventQueueEnd(previousQueue);
+  _gasTransformStageEnd(previousStage);
 }
 
-_gasManagerAnimationReference* _gasManagerRemoveAnimationByReference(_gasManager* manager, _gasManagerAnimationReference* ref)
+void _gasManagerShardRelease(_gasManager* manager, _gasManagerShard* shard)
 {
-  _gasManagerAnimation** a = &manager->animations;
-  while (*a && *a != ref->animation)
+  _gasManagerBatchRelease(&shard->batch);
+  while (shard->finished)
   {
-    a = &(*a)->next;
+    shard->finished = _gasManagerAnimationFree(manager, shard->finished);
   }
+}
+
+/* Workers claim shards one at a time from a shared counter, so a worker that
+ * drew light shards keeps taking more instead of idling */
+void _gasManagerAnimateTask(void* task, unsigned int worker)
+{
+  _gasManager* manager = task;
+  unsigned int shard;
+  (void) worker;
 
-  if (*a)
+  while ((shard = __atomic_fetch_add(&manager->dispatch.nextShard, 1, __ATOMIC_RELAXED)) < manager->numShards)
   {
-    *a = _gasManagerAnimationFree(*a);
+    _gasManagerShardAnimate(manager, &manager->shards[shard], manager->dispatch.delta, GAS_FALSE);
   }
 }
 
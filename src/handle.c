@@ -0,0 +1,110 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Generational slots behind gasAnimationHandle
+ *
+ * Slots are recycled through a free list and keep their generation while
+ * free. Generations start at 1 and skip 0 when they wrap, so a zeroed
+ * handle never resolves. The table outlives gasManagerClear, which only
+ * bumps every generation, so handles from before a clear stay stale. Live
+ * slots are also indexed by the object they animate. */
+
+void _gasSlotTableInit(_gasSlotTable* table)
+{
+  memset(table, 0, sizeof(_gasSlotTable));
+  table->freeSlot = GAS_NO_SLOT;
+  _gasObjectIndexInit(&table->objects);
+}
+
+static void _gasSlotBump(_gasSlot* slot)
+{
+  slot->generation += 1;
+  if (slot->generation == 0)
+    slot->generation = 1;
+}
+
+void _gasSlotTableClear(_gasSlotTable* table)
+{
+  table->freeSlot = GAS_NO_SLOT;
+
+  unsigned int i = table->numSlots;
+  while (i > 0)
+  {
+    i -= 1;
+    _gasSlot* slot = &table->slots[i];
+    if (slot->entry || slot->group != GAS_BATCH_NO_GROUP)
+    {
+      _gasSlotBump(slot);
+      slot->entry = NULL;
+      slot->group = GAS_BATCH_NO_GROUP;
+    }
+    slot->record = GAS_NO_RECORD;
+    slot->nextFree = table->freeSlot;
+    table->freeSlot = i;
+  }
+
+  _gasObjectIndexClear(&table->objects);
+}
+
+void _gasSlotTableFree(_gasSlotTable* table)
+{
+  free(table->slots);
+  _gasObjectIndexFree(&table->objects);
+  _gasSlotTableInit(table);
+}
+
+gasAnimationHandle _gasSlotNew(_gasSlotTable* table, glhckObject* object)
+{
+  unsigned int index;
+  if (table->freeSlot != GAS_NO_SLOT)
+  {
+    index = table->freeSlot;
+    table->freeSlot = table->slots[index].nextFree;
+  }
+  else
+  {
+    if (table->numSlots == table->capacity)
+    {
+      table->capacity = table->capacity ? table->capacity * 2 : 256;
+      table->slots = realloc(table->slots, table->capacity * sizeof(_gasSlot));
+    }
+
+    index = table->numSlots++;
+    table->slots[index].generation = 1;
+  }
+
+  _gasSlot* slot = &table->slots[index];
+  slot->nextFree = GAS_NO_SLOT;
+  slot->entry = NULL;
+  slot->group = GAS_BATCH_NO_GROUP;
+  _gasObjectIndexInsert(&table->objects, table->slots, object, index);
+
+  gasAnimationHandle handle = { index, slot->generation };
+  return handle;
+}
+
+void _gasSlotRelease(_gasSlotTable* table, unsigned int const index)
+{
+  _gasSlot* slot = &table->slots[index];
+  _gasObjectIndexRemove(&table->objects, table->slots, index);
+  _gasSlotBump(slot);
+  slot->entry = NULL;
+  slot->group = GAS_BATCH_NO_GROUP;
+  slot->nextFree = table->freeSlot;
+  table->freeSlot = index;
+}
+
+_gasSlot* _gasSlotGet(_gasSlotTable* table, gasAnimationHandle const handle)
+{
+  if (handle.index >= table->numSlots)
+    return NULL;
+
+  _gasSlot* slot = &table->slots[handle.index];
+  if (slot->generation != handle.generation || (!slot->entry && slot->group == GAS_BATCH_NO_GROUP))
+    return NULL;
+
+  return slot;
+}
@@ -0,0 +1,217 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Object to slot index
+ *
+ * Every object with live animations in a manager owns a record holding the
+ * slots of those animations in one contiguous array, kept inside the record
+ * while it is small. Slots remember their position in it so unlinking one is
+ * a swap with the last. Records are found through an open addressing table
+ * with linear probing and backward shift deletion. Records whose object has
+ * no animations left go back to a free list with their slot arrays, so
+ * objects coming and going in bursts do not reach malloc. */
+
+#define GAS_OBJECT_INDEX_MIN_BUCKETS 64
+
+unsigned int _gasObjectHash(glhckObject* object)
+{
+  uint64_t h = (uint64_t) (uintptr_t) object;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return (unsigned int) h;
+}
+
+void _gasObjectIndexInit(_gasObjectIndex* index)
+{
+  memset(index, 0, sizeof(_gasObjectIndex));
+  index->freeRecord = GAS_NO_RECORD;
+}
+
+void _gasObjectIndexClear(_gasObjectIndex* index)
+{
+  unsigned int i;
+  for (i = 0; i < index->numBuckets; ++i)
+  {
+    index->buckets[i] = GAS_NO_RECORD;
+  }
+
+  index->freeRecord = GAS_NO_RECORD;
+  i = index->numRecords;
+  while (i > 0)
+  {
+    i -= 1;
+    index->records[i].object = NULL;
+    index->records[i].numSlots = 0;
+    index->records[i].nextFree = index->freeRecord;
+    index->freeRecord = i;
+  }
+  index->numUsed = 0;
+}
+
+void _gasObjectIndexFree(_gasObjectIndex* index)
+{
+  unsigned int i;
+  for (i = 0; i < index->numRecords; ++i)
+  {
+    free(index->records[i].spill);
+  }
+  free(index->records);
+  free(index->buckets);
+  _gasObjectIndexInit(index);
+}
+
+static unsigned int _gasObjectIndexBucket(_gasObjectIndex* index, glhckObject* object)
+{
+  unsigned int const mask = index->numBuckets - 1;
+  unsigned int b = _gasObjectHash(object) & mask;
+  while (index->buckets[b] != GAS_NO_RECORD && index->records[index->buckets[b]].object != object)
+  {
+    b = (b + 1) & mask;
+  }
+  return b;
+}
+
+static void _gasObjectIndexGrow(_gasObjectIndex* index)
+{
+  unsigned int const numBuckets = index->numBuckets ? index->numBuckets * 2 : GAS_OBJECT_INDEX_MIN_BUCKETS;
+  free(index->buckets);
+  index->buckets = malloc(numBuckets * sizeof(unsigned int));
+  index->numBuckets = numBuckets;
+
+  unsigned int i;
+  for (i = 0; i < numBuckets; ++i)
+  {
+    index->buckets[i] = GAS_NO_RECORD;
+  }
+
+  for (i = 0; i < index->numRecords; ++i)
+  {
+    if (index->records[i].numSlots > 0)
+    {
+      index->buckets[_gasObjectIndexBucket(index, index->records[i].object)] = i;
+    }
+  }
+}
+
+_gasObjectRecord* _gasObjectIndexFind(_gasObjectIndex* index, glhckObject* object)
+{
+  if (index->numUsed == 0)
+    return NULL;
+
+  unsigned int const r = index->buckets[_gasObjectIndexBucket(index, object)];
+  return r != GAS_NO_RECORD ? &index->records[r] : NULL;
+}
+
+unsigned int* _gasObjectRecordSlots(_gasObjectRecord* record)
+{
+  return record->spill ? record->spill : record->inlineSlots;
+}
+
+static unsigned int _gasObjectIndexNewRecord(_gasObjectIndex* index, glhckObject* object)
+{
+  unsigned int r;
+  if (index->freeRecord != GAS_NO_RECORD)
+  {
+    r = index->freeRecord;
+    index->freeRecord = index->records[r].nextFree;
+  }
+  else
+  {
+    if (index->numRecords == index->recordCapacity)
+    {
+      index->recordCapacity = index->recordCapacity ? index->recordCapacity * 2 : 64;
+      index->records = realloc(index->records, index->recordCapacity * sizeof(_gasObjectRecord));
+    }
+    r = index->numRecords++;
+    index->records[r].spill = NULL;
+    index->records[r].slotCapacity = GAS_OBJECT_RECORD_INLINE_SLOTS;
+  }
+
+  _gasObjectRecord* record = &index->records[r];
+  record->object = object;
+  record->numSlots = 0;
+  record->nextFree = GAS_NO_RECORD;
+  return r;
+}
+
+unsigned int _gasObjectIndexInsert(_gasObjectIndex* index, _gasSlot* slots, glhckObject* object, unsigned int const slot)
+{
+  if ((index->numUsed + 1) * 4 > index->numBuckets * 3)
+  {
+    _gasObjectIndexGrow(index);
+  }
+
+  unsigned int const b = _gasObjectIndexBucket(index, object);
+  if (index->buckets[b] == GAS_NO_RECORD)
+  {
+    index->buckets[b] = _gasObjectIndexNewRecord(index, object);
+    index->numUsed += 1;
+  }
+
+  unsigned int const r = index->buckets[b];
+  _gasObjectRecord* record = &index->records[r];
+  if (record->numSlots == record->slotCapacity)
+  {
+    gasBoolean const spilled = record->spill ? GAS_TRUE : GAS_FALSE;
+    record->slotCapacity *= 2;
+    record->spill = realloc(record->spill, record->slotCapacity * sizeof(unsigned int));
+    if (!spilled)
+      memcpy(record->spill, record->inlineSlots, sizeof(record->inlineSlots));
+  }
+
+  slots[slot].record = r;
+  slots[slot].recordPosition = record->numSlots;
+  _gasObjectRecordSlots(record)[record->numSlots++] = slot;
+  return r;
+}
+
+static void _gasObjectIndexUnlinkRecord(_gasObjectIndex* index, glhckObject* object)
+{
+  unsigned int const mask = index->numBuckets - 1;
+  unsigned int hole = _gasObjectIndexBucket(index, object);
+  unsigned int const r = index->buckets[hole];
+
+  unsigned int b = hole;
+  for (;;)
+  {
+    b = (b + 1) & mask;
+    unsigned int const next = index->buckets[b];
+    if (next == GAS_NO_RECORD)
+      break;
+
+    unsigned int const home = _gasObjectHash(index->records[next].object) & mask;
+    if (((b - home) & mask) >= ((b - hole) & mask))
+    {
+      index->buckets[hole] = next;
+      hole = b;
+    }
+  }
+  index->buckets[hole] = GAS_NO_RECORD;
+
+  index->records[r].object = NULL;
+  index->records[r].nextFree = index->freeRecord;
+  index->freeRecord = r;
+  index->numUsed -= 1;
+}
+
+void _gasObjectIndexRemove(_gasObjectIndex* index, _gasSlot* slots, unsigned int const slot)
+{
+  _gasObjectRecord* record = &index->records[slots[slot].record];
+  unsigned int* recordSlots = _gasObjectRecordSlots(record);
+  unsigned int const position = slots[slot].recordPosition;
+  unsigned int const last = recordSlots[--record->numSlots];
+
+  recordSlots[position] = last;
+  slots[last].recordPosition = position;
+  slots[slot].record = GAS_NO_RECORD;
+
+  if (record->numSlots == 0)
+  {
+    _gasObjectIndexUnlinkRecord(index, record->object);
+  }
+}
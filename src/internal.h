@@ -3,6 +3,14 @@
 
 #include "gas.h"
 
+#if defined(_MSC_VER)
+#  define GAS_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#  define GAS_THREAD_LOCAL __thread
+#else
+#  define GAS_THREAD_LOCAL _Thread_local
+#endif
+
 typedef enum _gasAnimationType {
   GAS_ANIMATION_TYPE_NUMBER,
   GAS_ANIMATION_TYPE_PAUSE,
@@ -10,9 +18,21 @@ typedef enum _gasAnimationType {
   GAS_ANIMATION_TYPE_PARALLEL,
   GAS_ANIMATION_TYPE_MODEL,
   GAS_ANIMATION_TYPE_ACTION,
-  GAS_ANIMATION_TYPE_CUSTOM
+  GAS_ANIMATION_TYPE_CUSTOM,
+  GAS_ANIMATION_TYPE_PROGRAM,
+  GAS_ANIMATION_TYPE_VECTOR,
+  GAS_ANIMATION_TYPE_ROTATION,
+  GAS_ANIMATION_TYPE_TRACK,
+  GAS_ANIMATION_TYPE_PATH
 } _gasAnimationType;
 
+typedef struct _gasEasingCurve {
+  unsigned int resolution;
+  float scale;
+  float error;
+  float samples[];
+} _gasEasingCurve;
+
 typedef enum _gasNumberAnimationType {
   GAS_NUMBER_ANIMATION_TYPE_FROM_TO,
   GAS_NUMBER_ANIMATION_TYPE_FROM_DELTA,
@@ -28,10 +48,81 @@ typedef struct _gasNumberAnimation {
   float a;
   float b;
   float duration;
-  gasEasingFunc easing;
   float time;
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
 } _gasNumberAnimation;
 
+/* Animates a whole position, rotation or scale vector. Values follow the
+ * same rules as number animations, applied to each component. */
+typedef struct _gasVectorAnimation {
+  _gasNumberAnimationType type;
+  gasVectorAnimationTarget target;
+  kmVec3 a;
+  kmVec3 b;
+  float duration;
+  float time;
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
+} _gasVectorAnimation;
+
+/* Interpolates the object's orientation between two quaternions. Delta
+ * variants rotate by b in the local frame of a, so endpoints are resolved
+ * every step instead of being stored. Tree nodes keep it out of line since
+ * it is larger than any other node. */
+typedef struct _gasRotationAnimation {
+  _gasNumberAnimationType type;
+  gasBoolean nlerp;
+  kmQuaternion a;
+  kmQuaternion b;
+  float duration;
+  float time;
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
+} _gasRotationAnimation;
+
+/* Keys are shared, by reference count, between a track, its clones and the
+ * programs compiled from it. cursor is the key closing the span the track
+ * was last in, 0 up to the first key's time. */
+typedef struct _gasTrackKeys {
+  unsigned int references;
+  unsigned int numKeys;
+  gasKeyframe keys[];
+} _gasTrackKeys;
+
+typedef struct _gasTrackAnimation {
+  gasNumberAnimationTarget target;
+  float duration;
+  float time;
+  unsigned int cursor;
+  _gasTrackKeys* keys;
+} _gasTrackAnimation;
+
+/* Waypoints are shared like track keys. Each segment is divided into
+ * samples pieces, and lengths holds the distance along the path at the end
+ * of each piece, after a leading 0. Splines also keep their speed at the
+ * same places in speeds. cursor is the piece the path was last in, counted
+ * from 1, or 0 at its start. */
+typedef struct _gasPathPoints {
+  unsigned int references;
+  unsigned int numPoints;
+  unsigned int samples;
+  gasPathInterpolation interpolation;
+  float hop;
+  float* lengths;
+  float* speeds;
+  kmVec3 points[];
+} _gasPathPoints;
+
+typedef struct _gasPathAnimation {
+  float duration;
+  float time;
+  unsigned int cursor;
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
+  _gasPathPoints* points;
+} _gasPathAnimation;
+
 typedef struct _gasPauseAnimation {
   float duration;
   float time;
@@ -46,14 +137,44 @@ typedef struct _gasSequentialAnimation {
 typedef struct _gasParallelAnimation {
   struct _gasAnimation** children;
   unsigned int numChildren;
+  gasBoolean overlapping;
+  unsigned int* active;
+  unsigned int numActive;
 } _gasParallelAnimation;
 
+/* Wide parallel animations list the indices of their children still
+ * running, in the original order, in the slots following the children
+ * pointers. Narrower ones just visit every child. */
+#define GAS_PARALLEL_MIN_TRACKED_CHILDREN 8
+#define GAS_PARALLEL_TRACKS(numChildren) ((numChildren) >= GAS_PARALLEL_MIN_TRACKED_CHILDREN)
+#define GAS_PARALLEL_SLOTS(numChildren) ((numChildren) + (GAS_PARALLEL_TRACKS(numChildren) \
+    ? ((numChildren) * sizeof(unsigned int) + sizeof(struct _gasAnimation*) - 1) / sizeof(struct _gasAnimation*) : 0))
+
+/* An animator playing one skeletal animation on one skeleton. Model
+ * animations hold one while bound and hand it back to be reused by the next
+ * model animation playing the same animation on the same skeleton.
+ * playTime is where the skeleton was last posed, negative until it is, and
+ * steps counts the steps since. */
+typedef struct _gasModelBinding {
+  glhckAnimator* animator;
+  glhckAnimation* animation;
+  glhckBone* skeleton;
+  float animationDuration;
+  float playTime;
+  unsigned int steps;
+  struct _gasModelBinding* next;
+} _gasModelBinding;
+
+/* name is interned and shared by every model animation with that name. The
+ * skeleton is posed at most every frames steps, once it has moved on by
+ * minStep. */
 typedef struct _gasModelAnimation {
   float duration;
   float time;
-  char* name;
-  glhckAnimator* animator;
-  float animationDuration;
+  char const* name;
+  _gasModelBinding* binding;
+  float minStep;
+  unsigned int frames;
 } _gasModelAnimation;
 
 typedef struct _gasAction {
@@ -62,6 +183,7 @@ typedef struct _gasAction {
   gasActionCloneCallback cloneCallback;
   gasActionFreeCallback freeCallback;
   void* userdata;
+  gasBoolean fireOnce;
 } _gasAction;
 
 typedef struct _gasCustomAnimation {
@@ -72,11 +194,200 @@ typedef struct _gasCustomAnimation {
   void* userdata;
 } _gasCustomAnimation;
 
+/* Compiled programs: a pre-order array of instructions where every
+ * instruction knows where its subtree ends, so the next sibling of a child
+ * is found without pointers. Callbacks, model state, vector, rotation,
+ * track and path animations and embedded programs live in a side table of
+ * extras to keep instructions small. A program is also what a
+ * gasAnimationTemplate is: instructions and extras only describe the
+ * animation and are never written once built, so every animation made from
+ * a program shares it. What changes while animating lives in a state block
+ * per animation, one _gasInstructionState per instruction followed by one
+ * _gasExtraState per extra. Captured values are the endpoints FROM, TO and
+ * DELTA animations read from the object when they start. loopDuration is
+ * how long one loop of the instruction takes, or negative when its loops
+ * cannot be skipped. */
+typedef struct _gasInstruction {
+  unsigned char type;
+  int loops;
+  unsigned int end;
+  float loopDuration;
+
+  union {
+    _gasNumberAnimation numberAnimation;
+    _gasPauseAnimation pauseAnimation;
+    struct {
+      unsigned int numChildren;
+    } sequentialAnimation;
+    struct {
+      unsigned int numChildren;
+      gasBoolean overlapping;
+    } parallelAnimation;
+    unsigned int extra;
+  };
+} _gasInstruction;
+
+typedef struct _gasProgramExtra {
+  union {
+    _gasModelAnimation modelAnimation;
+    _gasAction action;
+    _gasCustomAnimation customAnimation;
+    _gasVectorAnimation vectorAnimation;
+    _gasRotationAnimation rotationAnimation;
+    _gasTrackAnimation trackAnimation;
+    _gasPathAnimation pathAnimation;
+  };
+} _gasProgramExtra;
+
+typedef struct _gasInstructionState {
+  gasAnimationState state;
+  int loop;
+
+  union {
+    struct {
+      float time;
+      float captured;
+    } numberAnimation;
+    struct {
+      float time;
+    } pauseAnimation;
+    struct {
+      unsigned int currentIndex;
+      unsigned int currentChild;
+    } sequentialAnimation;
+  };
+} _gasInstructionState;
+
+typedef struct _gasExtraState {
+  union {
+    struct {
+      float time;
+      float minStep;
+      _gasModelBinding* binding;
+      unsigned int frames;
+    } modelAnimation;
+    struct {
+      float time;
+      kmVec3 captured;
+    } vectorAnimation;
+    struct {
+      float time;
+      kmQuaternion captured;
+    } rotationAnimation;
+    struct {
+      float time;
+      unsigned int cursor;
+    } trackAnimation;
+    struct {
+      float time;
+      unsigned int cursor;
+    } pathAnimation;
+    void* userdata;
+    struct _gasAnimation* animation;
+  };
+} _gasExtraState;
+
+#define GAS_LOOP_CHANNELS 9
+
+/* How one loop of a subtree moves each channel it writes: a channel that
+ * was value when the loop started ends it as value * scale + offset.
+ * Channels are X, Y, Z, ROT_X, ROT_Y, ROT_Z and the three scale
+ * components. */
+typedef struct _gasSampleMap {
+  unsigned short channels;
+  float scale[GAS_LOOP_CHANNELS];
+  float offset[GAS_LOOP_CHANNELS];
+} _gasSampleMap;
+
+/* A node of a sampler, which is a pre-order array of nodes describing a
+ * tree or program the way sampling reads it. duration is the length of one
+ * loop, negative when the subtree cannot be sampled, map what one loop does
+ * to the channels. Children of sequential and parallel nodes are listed in
+ * the sampler's child table. Within a sequential parent a node starts at
+ * start, finishes at finish and before is what its earlier siblings do.
+ * definition is the leaf animation's definition or the program animation
+ * being embedded. */
+typedef struct _gasSampleNode {
+  unsigned char type;
+  int loops;
+  unsigned int children;
+  unsigned int numChildren;
+  float duration;
+  float start;
+  float finish;
+  void const* definition;
+  _gasSampleMap map;
+  _gasSampleMap before;
+} _gasSampleNode;
+
+typedef struct _gasSampler {
+  unsigned int numNodes;
+  _gasSampleNode* nodes;
+  unsigned int* children;
+} _gasSampler;
+
+/* states is the state block instances start from. It owns the userdata
+ * instances clone their action and custom userdata from and the embedded
+ * animations they clone. sampler is built the first time the program is
+ * sampled. */
+typedef struct _gasAnimationTemplate {
+  size_t size;
+  size_t stateSize;
+  unsigned int references;
+  unsigned int numInstructions;
+  unsigned int numExtras;
+  gasAnimationState state;
+  int loops;
+  int loop;
+  _gasInstruction* instructions;
+  _gasProgramExtra* extras;
+  _gasInstructionState* states;
+  _gasSampler* sampler;
+} _gasProgram;
+
+typedef struct _gasProgramAnimation {
+  _gasProgram* program;
+  _gasInstructionState* states;
+} _gasProgramAnimation;
+
+/* What skipping loops needs to know about one loop of a subtree. Channels
+ * are X, Y, Z, ROT_X, ROT_Y, ROT_Z and the three scale components. A loop
+ * moves relative channels by delta and leaves absolute channels where the
+ * previous loop left them. */
+typedef struct _gasLoopInfo {
+  float duration;
+  unsigned short relative;
+  unsigned short absolute;
+  gasBoolean actions;
+  float delta[GAS_LOOP_CHANNELS];
+} _gasLoopInfo;
+
+/* Serialized animations are written into a growing buffer. references is
+ * the table callbacks, easing functions and curves are looked up in and
+ * failed is set once one of them is missing from it. */
+typedef struct _gasSerialWriter {
+  unsigned char* data;
+  size_t size;
+  size_t capacity;
+  gasReference const* references;
+  unsigned int numReferences;
+  unsigned int numNodes;
+  gasBoolean failed;
+} _gasSerialWriter;
+
+typedef enum _gasAllocation {
+  GAS_ALLOCATION_POOL,
+  GAS_ALLOCATION_BLOCK,
+  GAS_ALLOCATION_BLOCK_ROOT
+} _gasAllocation;
+
 typedef struct _gasAnimation {
   _gasAnimationType type;
   gasAnimationState state;
   int loops;
   int loop;
+  unsigned char allocation;
+  unsigned char finalizers;
 
   union {
     _gasNumberAnimation numberAnimation;
@@ -86,32 +397,244 @@ typedef struct _gasAnimation {
     _gasModelAnimation modelAnimation;
     _gasAction action;
     _gasCustomAnimation customAnimation;
+    _gasProgramAnimation programAnimation;
+    _gasVectorAnimation vectorAnimation;
+    _gasRotationAnimation* rotationAnimation;
+    _gasTrackAnimation trackAnimation;
+    _gasPathAnimation pathAnimation;
   };
 } _gasAnimation;
 
+typedef struct _gasPool
+{
+  size_t blockSize;
+  unsigned int blocksPerChunk;
+  void* freeBlocks;
+  char* chunks;
+  unsigned int used;
+} _gasPool;
+
+#define GAS_NO_SLOT ((unsigned int) -1)
+#define GAS_MANAGER_ANIMATION_REMOVED 0x1
+#define GAS_MANAGER_ANIMATION_PAUSED 0x2
+#define GAS_MANAGER_ANIMATION_PARKED 0x4
+
+/* Parked entries sit in a timing wheel list linked through next and prev
+ * until the wake tick. Other entries are not parked before it. owed is the
+ * time that passed while they were parked, which the next step adds to its
+ * delta. */
 typedef struct _gasManagerAnimation
 {
   glhckObject* object;
   gasAnimation* animation;
   gasBoolean manageObject;
+  unsigned int slot;
+  unsigned char flags;
+  float owed;
   struct _gasManagerAnimation* next;
+  struct _gasManagerAnimation** prev;
+  double parked;
+  unsigned long long wake;
 } _gasManagerAnimation;
 
-typedef struct _gasManagerAnimationReference
+/* A slot locates the entry or batch group behind a handle. Releasing a slot
+ * bumps its generation, which invalidates every handle given out for it. */
+typedef struct _gasSlot
 {
-  _gasManagerAnimation* animation;
-  struct _gasManagerAnimationReference* next;
-} _gasManagerAnimationReference;
+  unsigned int generation;
+  unsigned int nextFree;
+  _gasManagerAnimation* entry;
+  unsigned int group;
+  unsigned int record;
+  unsigned int recordPosition;
+} _gasSlot;
 
-typedef struct _gasManager
+#define GAS_NO_RECORD ((unsigned int) -1)
+
+#define GAS_OBJECT_RECORD_INLINE_SLOTS 4
+
+/* The live slots of one object, in no particular order. Slots are kept
+ * inline until they outgrow it and move to spill. */
+typedef struct _gasObjectRecord
+{
+  glhckObject* object;
+  unsigned int* spill;
+  unsigned int numSlots;
+  unsigned int slotCapacity;
+  unsigned int nextFree;
+  unsigned int inlineSlots[GAS_OBJECT_RECORD_INLINE_SLOTS];
+} _gasObjectRecord;
+
+typedef struct _gasObjectIndex
+{
+  _gasObjectRecord* records;
+  unsigned int numRecords;
+  unsigned int recordCapacity;
+  unsigned int freeRecord;
+  unsigned int* buckets;
+  unsigned int numBuckets;
+  unsigned int numUsed;
+} _gasObjectIndex;
+
+typedef struct _gasSlotTable
+{
+  _gasSlot* slots;
+  unsigned int numSlots;
+  unsigned int capacity;
+  unsigned int freeSlot;
+  _gasObjectIndex objects;
+} _gasSlotTable;
+
+typedef enum _gasEasingId {
+  GAS_EASING_ID_CUSTOM = 0,
+  GAS_EASING_ID_LINEAR = GAS_EASING_LINEAR,
+  GAS_EASING_ID_QUAD_IN = GAS_EASING_QUAD_IN,
+  GAS_EASING_ID_QUAD_OUT = GAS_EASING_QUAD_OUT,
+  GAS_EASING_ID_EASE = GAS_EASING_EASE,
+  GAS_EASING_ID_EASE_IN = GAS_EASING_EASE_IN,
+  GAS_EASING_ID_EASE_OUT = GAS_EASING_EASE_OUT,
+  GAS_EASING_ID_EASE_IN_OUT = GAS_EASING_EASE_IN_OUT,
+  GAS_EASING_ID_CURVE
+} _gasEasingId;
+
+#define GAS_BATCH_NO_GROUP ((unsigned int) -1)
+#define GAS_BATCH_ROW_STARTED 0x1
+#define GAS_BATCH_ROW_FINISHED 0x2
+
+typedef struct _gasManagerBatchGroup
+{
+  gasAnimation* animation;
+  glhckObject* object;
+  unsigned int numRows;
+  unsigned int nextFree;
+  unsigned int slot;
+  gasBoolean parallel;
+  gasBoolean removed;
+  gasBoolean paused;
+  gasAnimationState state;
+} _gasManagerBatchGroup;
+
+typedef struct _gasManagerBatch
+{
+  unsigned int numRows;
+  unsigned int rowCapacity;
+  float* time;
+  float* duration;
+  float* a;
+  float* b;
+  float* eased;
+  gasEasingFunc* easing;
+  gasEasingCurve const** curve;
+  unsigned char* easingId;
+  unsigned char* type;
+  unsigned char* target;
+  unsigned char* flags;
+  unsigned int* group;
+  glhckObject** object;
+  gasAnimation** animation;
+
+  _gasSlotTable* slots;
+  _gasManagerBatchGroup* groups;
+  unsigned int numGroups;
+  unsigned int groupCapacity;
+  unsigned int freeGroup;
+  unsigned int doneGroup;
+} _gasManagerBatch;
+
+typedef struct _gasStagedTransform
+{
+  glhckObject* object;
+  kmVec3 position;
+  kmVec3 rotation;
+  unsigned char flags;
+} _gasStagedTransform;
+
+/* animation and delta describe what is being advanced while recording */
+typedef struct _gasEventQueue
+{
+  gasEvent* events;
+  unsigned int numEvents;
+  unsigned int capacity;
+  gasEvent* scratch;
+  unsigned int scratchCapacity;
+  gasAnimation* animation;
+  float delta;
+} _gasEventQueue;
+
+/* Timing wheel ticks are 1/64 s. Every level has 64 slots, each slot of a
+ * level spanning a whole turn of the level below, so four levels reach out
+ * about three days and anything further waits in the last slot. */
+#define GAS_WHEEL_TICKS_PER_SECOND 64.0
+#define GAS_WHEEL_LEVEL_BITS 6
+#define GAS_WHEEL_SLOTS (1 << GAS_WHEEL_LEVEL_BITS)
+#define GAS_WHEEL_LEVELS 4
+
+typedef struct _gasTimingWheel
+{
+  _gasManagerAnimation* slots[GAS_WHEEL_LEVELS][GAS_WHEEL_SLOTS];
+  unsigned long long tick;
+  unsigned int numEntries;
+} _gasTimingWheel;
+
+/* Animations are sharded by target object so shards can be advanced on
+ * different threads. Entries a worker finishes wait in finished until the
+ * manager releases them on its own thread. Idle entries are parked in wheel
+ * and entries woken outside gasManagerAnimate wait in woken until the shard
+ * is advanced next. */
+typedef struct _gasManagerShard
 {
   _gasManagerAnimation* animations;
+  _gasManagerAnimation* finished;
+  _gasManagerAnimation* woken;
+  unsigned int numAnimations;
+  _gasManagerBatch batch;
+  _gasStagedTransform stage;
+  _gasEventQueue events;
+  _gasTimingWheel wheel;
+  double time;
+} _gasManagerShard;
+
+typedef struct _gasThreadPool _gasThreadPool;
+
+typedef struct _gasManagerDispatch
+{
+  gasDispatchCallback dispatch;
+  void* userdata;
+  unsigned int numWorkers;
+  _gasThreadPool* pool;
+  unsigned int nextShard;
+  float delta;
+} _gasManagerDispatch;
+
+typedef struct _gasManager
+{
   _gasManagerAnimation* newAnimations;
-  _gasManagerAnimationReference* removeAnimations;
+  _gasManagerShard* shards;
+  unsigned int numShards;
+  gasBoolean batching;
+  _gasPool entryPool;
+  _gasSlotTable slots;
+  _gasManagerDispatch dispatch;
+  gasBoolean deferActions;
+  gasBoolean dispatchingEvents;
+  _gasEventQueue events;
+  gasBoolean parking;
+  double time;
 } _gasManager;
 
 gasAnimation* _gasAnimationNew(_gasAnimationType type);
+void _gasAnimationFinalize(gasAnimation* animation);
+void _gasAnimationFinalizeTree(gasAnimation* animation);
+void _gasAnimationMeasure(gasAnimation* animation, size_t* numNodes, size_t* numRotations, size_t* numChildren,
+                          size_t* stateSize, gasBoolean* finalizers);
+gasAnimation* _gasAnimationCloneInto(gasAnimation* animation, gasAnimation** nodes, _gasRotationAnimation** rotations,
+                                     gasAnimation*** children, char** states);
 gasAnimation* _gasNumberAnimationNew(gasNumberAnimationTarget const target, gasEasingFunc const easing, _gasNumberAnimationType const type, float const a, float const b, float const duration);
+gasAnimation* _gasVectorAnimationNew(gasVectorAnimationTarget const target, gasEasingFunc const easing,
+                                     _gasNumberAnimationType const type, kmVec3 const* a, kmVec3 const* b,
+                                     float const duration);
+gasAnimation* _gasRotationAnimationNew(gasEasingFunc const easing, _gasNumberAnimationType const type,
+                                       kmQuaternion const* a, kmQuaternion const* b, float const duration);
 
 float _gasAnimate(gasAnimation* animation, glhckObject* object, float const delta);
 float _gasAnimateNumberAnimation(gasAnimation* animation, glhckObject* object, float const delta);
@@ -121,26 +644,215 @@ float _gasAnimateParallelAnimation(gasAnimation* animation, glhckObject* object,
 float _gasAnimateModelAnimation(gasAnimation* animation, glhckObject* object, float const delta);
 float _gasAnimateAction(gasAnimation* animation, glhckObject* object, float const delta);
 float _gasAnimateCustomAnimation(gasAnimation* animation, glhckObject* object, float const delta);
+float _gasAnimateProgramAnimation(gasAnimation* animation, glhckObject* object, float const delta);
+float _gasAnimateVectorAnimation(gasAnimation* animation, glhckObject* object, float const delta);
+float _gasAnimateRotationAnimation(gasAnimation* animation, glhckObject* object, float const delta);
+float _gasAnimateTrackAnimation(gasAnimation* animation, glhckObject* object, float const delta);
+float _gasAnimatePathAnimation(gasAnimation* animation, glhckObject* object, float const delta);
+
+float _gasNumberAnimationStep(_gasNumberAnimation* number, gasAnimationState* state, glhckObject* object, float const delta);
+float _gasVectorAnimationStep(_gasVectorAnimation* vector, gasAnimationState* state, glhckObject* object, float const delta);
+float _gasRotationAnimationStep(_gasRotationAnimation* rotation, gasAnimationState* state, glhckObject* object, float const delta);
+void _gasRotationAnimationValue(_gasRotationAnimation const* rotation, float const t, kmQuaternion* value);
+float _gasTrackAnimationStep(_gasTrackAnimation* track, gasAnimationState* state, glhckObject* object, float const delta);
+float _gasPathAnimationStep(_gasPathAnimation* path, gasAnimationState* state, glhckObject* object, float const delta);
+float _gasPauseAnimationStep(_gasPauseAnimation* pause, gasAnimationState* state, float const delta);
+float _gasModelAnimationStep(_gasModelAnimation* model, gasAnimationState* state, glhckObject* object, float const delta);
+float _gasActionStep(_gasAction* action, gasAnimationState* state, glhckObject* object, float const delta);
+float _gasCustomAnimationStep(_gasCustomAnimation* custom, gasAnimationState* state, glhckObject* object, float const delta);
 
 void _gasAnimationResetCurrentLoop(gasAnimation* animation);
 void _gasAnimationResetNumberAnimation(gasAnimation* animation);
 void _gasAnimationResetPauseAnimation(gasAnimation* animation);
 void _gasAnimationResetSequentialAnimation(gasAnimation* animation);
 void _gasAnimationResetParallelAnimation(gasAnimation* animation);
+void _gasParallelAnimationActivate(gasAnimation* animation);
 void _gasAnimationResetModelAnimation(gasAnimation* animation);
 void _gasAnimationResetAction(gasAnimation* animation);
 void _gasAnimationResetCustomAnimation(gasAnimation* animation);
+void _gasAnimationResetProgramAnimation(gasAnimation* animation);
+void _gasAnimationResetVectorAnimation(gasAnimation* animation);
+void _gasAnimationResetRotationAnimation(gasAnimation* animation);
+void _gasAnimationResetTrackAnimation(gasAnimation* animation);
+void _gasAnimationResetPathAnimation(gasAnimation* animation);
+
+float _gasNumberAnimationValue(_gasNumberAnimationType const type, float const a, float const b, float const t);
+void _gasTransformStageInit(_gasStagedTransform* stage);
+_gasStagedTransform* _gasTransformStageBegin(_gasStagedTransform* stage);
+void _gasTransformStageEnd(_gasStagedTransform* previous);
+void _gasTransformStageFlush();
+gasBoolean _gasTransformStageActive();
+float _gasTransformStageGetValue(gasNumberAnimationTarget target, glhckObject* object);
+void _gasTransformStageSetValue(gasNumberAnimationTarget target, glhckObject* object, float const value);
+kmVec3 _gasTransformStageGetVector(gasVectorAnimationTarget target, glhckObject* object);
+void _gasTransformStageSetVector(gasVectorAnimationTarget target, glhckObject* object, kmVec3 const* value);
 
 float _gasNumberAnimationGetTargetValue(gasNumberAnimationTarget target, glhckObject* object);
 void _gasNumberAnimationSetTargetValue(gasNumberAnimationTarget target, glhckObject* object, float const value);
+kmVec3 _gasVectorAnimationGetTargetValue(gasVectorAnimationTarget target, glhckObject* object);
+void _gasVectorAnimationSetTargetValue(gasVectorAnimationTarget target, glhckObject* object, kmVec3 const* value);
+
+kmVec3 _gasQuaternionToEuler(kmQuaternion const* q);
+void _gasQuaternionMultiply(kmQuaternion const* a, kmQuaternion const* b, kmQuaternion* out);
+void _gasQuaternionNormalize(kmQuaternion* q);
+void _gasQuaternionLerp(kmQuaternion const* from, kmQuaternion const* to, float const t, kmQuaternion* out);
+void _gasQuaternionNlerp(kmQuaternion const* from, kmQuaternion const* to, float const t, kmQuaternion* out);
+void _gasQuaternionSlerp(kmQuaternion const* from, kmQuaternion const* to, float const t, kmQuaternion* out);
+void _gasQuaternionNormalizeBatch(kmQuaternion* q, size_t const n);
 
 float _gasClamp(float const value, float const minValue, float const maxValue);
 float _gasLoopsLeft(_gasAnimation* animation);
 
-_gasManagerAnimation* _gasManagerAnimationNew(gasAnimation* animation, glhckObject* object);
-_gasManagerAnimation* _gasManagerAnimationFree(_gasManagerAnimation* animation);
-_gasManagerAnimationReference* _gasManagerEnqueueRemoveAnimation(_gasManager* manager, _gasManagerAnimation* animation);
-_gasManagerAnimationReference* _gasManagerRemoveAnimationByReference(_gasManager* manager, _gasManagerAnimationReference* ref);
+gasBoolean _gasLoopInfoNumber(_gasLoopInfo* info, _gasNumberAnimation const* number);
+gasBoolean _gasLoopInfoVector(_gasLoopInfo* info, _gasVectorAnimation const* vector);
+gasBoolean _gasLoopInfoRotation(_gasLoopInfo* info, _gasRotationAnimation const* rotation);
+void _gasLoopInfoTrack(_gasLoopInfo* info, _gasTrackAnimation const* track);
+void _gasLoopInfoPath(_gasLoopInfo* info, _gasPathAnimation const* path);
+void _gasLoopInfoPause(_gasLoopInfo* info, float const duration);
+gasBoolean _gasLoopInfoRepeat(_gasLoopInfo* info, int const loops);
+void _gasLoopInfoAppend(_gasLoopInfo* info, _gasLoopInfo const* next);
+gasBoolean _gasLoopInfoMerge(_gasLoopInfo* info, _gasLoopInfo const* other);
+void _gasLoopInfoApply(_gasLoopInfo const* info, glhckObject* object, unsigned int const count);
+gasBoolean _gasLoopChannelsOverlap(gasAnimation** animations, unsigned int const numAnimations);
+void _gasLoopSkipSuspend();
+void _gasLoopSkipResume();
+gasBoolean _gasLoopSkipSuspended();
+unsigned int _gasLoopSkipCount(float const duration, int const loop, int const loops, float const left);
+gasBoolean _gasAnimationLoopInfo(gasAnimation* animation, float const limit, _gasLoopInfo* info);
+gasBoolean _gasAnimationSkipLoops(gasAnimation* animation, glhckObject* object, gasBoolean const ended, float* left);
+void _gasAnimationFireSkipped(gasAnimation* animation, glhckObject* object, float const left, gasBoolean const last);
+
+_gasManagerAnimation* _gasManagerAnimationNew(_gasManager* manager, gasAnimation* animation, glhckObject* object);
+_gasManagerAnimation* _gasManagerAnimationFree(_gasManager* manager, _gasManagerAnimation* animation);
+void _gasManagerAnimationRemove(_gasManager* manager, _gasManagerAnimation* animation);
+gasBoolean _gasManagerAnimationRemoved(_gasManagerAnimation* animation);
+void _gasManagerSlotRemove(_gasManager* manager, _gasSlot* slot);
+void _gasManagerSlotPause(_gasManager* manager, _gasSlot* slot, gasBoolean const paused);
+_gasManagerShard* _gasManagerShardsNew(_gasManager* manager, unsigned int const numShards);
+unsigned int _gasManagerShardIndex(glhckObject* object, unsigned int const numShards);
+_gasManagerShard* _gasManagerShardOf(_gasManager* manager, glhckObject* object);
+_gasManagerShard* _gasManagerSlotShard(_gasManager* manager, _gasSlot* slot);
+void _gasManagerReshard(_gasManager* manager, unsigned int const numShards);
+void _gasManagerShardAnimate(_gasManager* manager, _gasManagerShard* shard, float const delta, gasBoolean const release);
+void _gasManagerShardRelease(_gasManager* manager, _gasManagerShard* shard);
+void _gasManagerAnimateTask(void* task, unsigned int worker);
+void _gasManagerAnimationWake(_gasManager* manager, _gasManagerAnimation* animation);
+
+unsigned long long _gasTimingWheelTick(double const time);
+void _gasTimingWheelInit(_gasTimingWheel* wheel, unsigned long long const tick);
+void _gasTimingWheelInsert(_gasTimingWheel* wheel, _gasManagerAnimation* entry);
+void _gasTimingWheelUnlink(_gasTimingWheel* wheel, _gasManagerAnimation* entry);
+_gasManagerAnimation* _gasTimingWheelDrain(_gasTimingWheel* wheel);
+_gasManagerAnimation* _gasTimingWheelAdvance(_gasTimingWheel* wheel, unsigned long long const tick);
+_gasManagerAnimation* _gasTimingWheelFind(_gasTimingWheel* wheel, gasAnimation* animation);
+float _gasAnimationIdle(gasAnimation* animation, gasBoolean* through);
+float _gasProgramIdle(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                      gasBoolean* through);
+
+char const* _gasModelNameIntern(char const* name);
+_gasModelBinding* _gasModelBindingAcquire(char const* name, glhckObject* object);
+void _gasModelBindingRelease(_gasModelBinding* binding);
+gasBoolean _gasProgramBind(_gasProgram* program, _gasInstructionState* states, glhckObject* object);
+void _gasProgramUpdateRate(_gasProgram* program, _gasInstructionState* states, unsigned int const frames,
+                           float const minStep);
+
+void _gasSerialWriteNode(_gasSerialWriter* writer, _gasAnimationType const type, int const loops,
+                         void const* definition, void* userdata, unsigned int const numChildren);
+void _gasSerialWriteTree(_gasSerialWriter* writer, gasAnimation* animation);
+void _gasProgramSerialize(_gasProgram* program, _gasInstructionState* states, int const loops,
+                          _gasSerialWriter* writer);
+
+void _gasSlotTableInit(_gasSlotTable* table);
+void _gasSlotTableClear(_gasSlotTable* table);
+void _gasSlotTableFree(_gasSlotTable* table);
+gasAnimationHandle _gasSlotNew(_gasSlotTable* table, glhckObject* object);
+void _gasSlotRelease(_gasSlotTable* table, unsigned int const index);
+_gasSlot* _gasSlotGet(_gasSlotTable* table, gasAnimationHandle const handle);
+
+unsigned int _gasObjectHash(glhckObject* object);
+void _gasObjectIndexInit(_gasObjectIndex* index);
+void _gasObjectIndexClear(_gasObjectIndex* index);
+void _gasObjectIndexFree(_gasObjectIndex* index);
+_gasObjectRecord* _gasObjectIndexFind(_gasObjectIndex* index, glhckObject* object);
+unsigned int* _gasObjectRecordSlots(_gasObjectRecord* record);
+unsigned int _gasObjectIndexInsert(_gasObjectIndex* index, _gasSlot* slots, glhckObject* object, unsigned int const slot);
+void _gasObjectIndexRemove(_gasObjectIndex* index, _gasSlot* slots, unsigned int const slot);
+
+void _gasManagerBatchInit(_gasManagerBatch* batch, _gasSlotTable* slots);
+void _gasManagerBatchClear(_gasManagerBatch* batch);
+void _gasManagerBatchFree(_gasManagerBatch* batch);
+gasBoolean _gasManagerBatchAccepts(gasAnimation* animation);
+unsigned int _gasManagerBatchAdd(_gasManagerBatch* batch, gasAnimation* animation, glhckObject* object,
+                                 unsigned int const slot);
+void _gasManagerBatchRemoveGroup(_gasManagerBatch* batch, unsigned int const index);
+gasBoolean _gasManagerBatchRemoveAnimation(_gasManagerBatch* batch, gasAnimation* animation);
+void _gasManagerBatchAnimate(_gasManagerBatch* batch, float const delta);
+void _gasManagerBatchRelease(_gasManagerBatch* batch);
+void _gasManagerBatchMove(_gasManagerBatch* batch, _gasManagerShard* shards, unsigned int const numShards);
+
+void _gasEventQueueInit(_gasEventQueue* queue);
+void _gasEventQueueFree(_gasEventQueue* queue);
+_gasEventQueue* _gasEventQueueBegin(_gasEventQueue* queue);
+void _gasEventQueueEnd(_gasEventQueue* previous);
+gasBoolean _gasEventQueuePush(gasActionCallback callback, void* userdata, glhckObject* object, float const delta);
+void _gasEventQueueMerge(_gasEventQueue* queue, _gasManagerShard* shards, unsigned int const numShards);
+
+_gasThreadPool* _gasThreadPoolNew(unsigned int const numThreads);
+void _gasThreadPoolFree(_gasThreadPool* pool);
+unsigned int _gasThreadPoolSize(_gasThreadPool* pool);
+void _gasThreadPoolDispatch(gasTaskFunc run, void* task, unsigned int numWorkers, void* userdata);
+unsigned int _gasProcessorCount();
+
+void _gasPoolInit(_gasPool* pool, size_t const blockSize, unsigned int const blocksPerChunk);
+void* _gasPoolAlloc(_gasPool* pool);
+void _gasPoolRelease(_gasPool* pool, void* block);
+void _gasPoolReset(_gasPool* pool);
+
+gasAnimation* _gasAnimationAlloc();
+void _gasAnimationRelease(gasAnimation* animation);
+gasAnimation** _gasChildrenAlloc(unsigned int const numChildren);
+void _gasChildrenRelease(gasAnimation** children, unsigned int const numChildren);
+_gasRotationAnimation* _gasRotationAnimationAlloc();
+void _gasRotationAnimationRelease(_gasRotationAnimation* rotation);
+
+_gasTrackKeys* _gasTrackKeysNew(gasKeyframe const* keys, unsigned int const numKeys);
+void _gasTrackKeysRetain(_gasTrackKeys* keys);
+void _gasTrackKeysRelease(_gasTrackKeys* keys);
+unsigned int _gasTrackSeek(_gasTrackKeys const* keys, unsigned int const cursor, float const time);
+float _gasTrackValue(_gasTrackKeys const* keys, unsigned int const cursor, float const time);
+
+_gasPathPoints* _gasPathPointsNew(gasPathInterpolation const interpolation, kmVec3 const* points,
+                                  unsigned int const numPoints, float const hop);
+void _gasPathPointsRetain(_gasPathPoints* points);
+void _gasPathPointsRelease(_gasPathPoints* points);
+kmVec3 _gasPathPosition(_gasPathAnimation const* path, unsigned int* cursor, float const time);
+
+_gasProgram* _gasProgramNew(gasAnimation* animation);
+void _gasProgramRetain(_gasProgram* program);
+void _gasProgramRelease(_gasProgram* program);
+void _gasProgramStatesCopy(_gasProgram* program, _gasInstructionState* states, _gasInstructionState const* source);
+void _gasProgramStatesFinalize(_gasProgram* program, _gasInstructionState* states);
+float _gasProgramAnimate(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                         glhckObject* object, float const delta);
+void _gasProgramResetCurrentLoop(_gasProgram* program, _gasInstructionState* states, unsigned int const index);
+gasBoolean _gasProgramLoopInfo(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                               float const limit, _gasLoopInfo* info);
+void _gasProgramFireSkippedLoop(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                                glhckObject* object, float const left, gasBoolean const last);
+_gasSampler* _gasProgramSampler(_gasProgram* program);
+
+_gasSampler* _gasSamplerAlloc(unsigned int const numNodes, unsigned int const numChildren);
+void _gasSampleNodeFinish(_gasSampler* sampler, unsigned int const index, gasBoolean const overlapping);
+gasBoolean _gasSamplerSample(_gasSampler* sampler, int const loops, glhckObject* object, float const time);
+
+_gasEasingId _gasEasingIdFromFunc(gasEasingFunc easing);
+gasEasingFunc _gasEasingFuncFromId(_gasEasingId const id);
+float _gasEasingEvaluate(_gasEasingId const id, gasEasingFunc easing, gasEasingCurve const* curve, float const t);
+float _gasEasingCurveEvaluate(gasEasingCurve const* curve, float const t);
+float _gasEasingEnd(gasEasingFunc easing, gasEasingCurve const* curve);
+gasEasingCurve const* _gasEasingBuiltinCurve(_gasEasingId const id);
+void _gasEasingEvaluateBatch(_gasEasingId const id, gasEasingFunc easing, gasEasingCurve const* curve,
+                             float const* t, float* out, size_t const n);
 
 float _gasCubicBezierXFromT(float t, float x1, float x2);
 float _gasCubicBezierYFromT(float t, float y1, float y2);
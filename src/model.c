@@ -0,0 +1,333 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Model animation bindings
+ *
+ * A model animation plays a skeletal animation of its object, looked up by
+ * name, through a glhck animator holding the object's bones. Names are
+ * interned, so model animations, their clones and programs share one string
+ * per name and caches compare them by pointer. Which of an object's
+ * animations a name resolves to is remembered in a small direct mapped
+ * cache. Animators are not freed with their model animation but kept idle,
+ * keyed by animation and skeleton, for the next model animation playing the
+ * same animation on the same skeleton. Past a limit, an animator released
+ * into a full cache takes the place of the one idle longest in its own hash
+ * bucket, or is freed if that bucket holds none, so eviction is per bucket
+ * rather than least recently idle overall. Idle animators hold on to their
+ * animation and bones, so keys never match a different skeleton that reuses
+ * freed memory. Model animations bind on their first step, possibly on
+ * several workers at once, so all of this sits behind one mutex. */
+
+#define GAS_MODEL_LOOKUP_SIZE 1024
+#define GAS_MODEL_IDLE_BUCKETS 1024
+#define GAS_MODEL_MAX_IDLE_BINDINGS 4096
+
+typedef struct _gasModelLookup {
+  glhckObject* object;
+  char const* name;
+  unsigned int index;
+} _gasModelLookup;
+
+static pthread_mutex_t modelMutex = PTHREAD_MUTEX_INITIALIZER;
+static char** internedNames = NULL;
+static unsigned int numInternedNames = 0;
+static unsigned int internedCapacity = 0;
+static _gasModelLookup lookups[GAS_MODEL_LOOKUP_SIZE];
+static _gasModelBinding* idleBindings[GAS_MODEL_IDLE_BUCKETS];
+static unsigned int numIdleBindings = 0;
+static _gasPool bindingPool = { sizeof(_gasModelBinding), 64, NULL, NULL, 0 };
+
+static unsigned int _gasModelNameHash(char const* name)
+{
+  uint32_t h = 2166136261u;
+  while (*name)
+  {
+    h ^= (unsigned char) *name++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static unsigned int _gasModelPairHash(void const* a, void const* b)
+{
+  return _gasObjectHash((glhckObject*) a) ^ (_gasObjectHash((glhckObject*) b) * 31u);
+}
+
+static void _gasModelNamesGrow()
+{
+  unsigned int const capacity = internedCapacity ? internedCapacity * 2 : 64;
+  char** names = calloc(capacity, sizeof(char*));
+  unsigned int i;
+  for (i = 0; i < internedCapacity; ++i)
+  {
+    if (!internedNames[i])
+      continue;
+
+    unsigned int b = _gasModelNameHash(internedNames[i]) & (capacity - 1);
+    while (names[b])
+    {
+      b = (b + 1) & (capacity - 1);
+    }
+    names[b] = internedNames[i];
+  }
+
+  free(internedNames);
+  internedNames = names;
+  internedCapacity = capacity;
+}
+
+/* Interned names live as long as the process */
+char const* _gasModelNameIntern(char const* name)
+{
+  pthread_mutex_lock(&modelMutex);
+  if ((numInternedNames + 1) * 2 > internedCapacity)
+  {
+    _gasModelNamesGrow();
+  }
+
+  unsigned int const mask = internedCapacity - 1;
+  unsigned int b = _gasModelNameHash(name) & mask;
+  while (internedNames[b] && strcmp(internedNames[b], name) != 0)
+  {
+    b = (b + 1) & mask;
+  }
+  if (!internedNames[b])
+  {
+    internedNames[b] = strdup(name);
+    numInternedNames += 1;
+  }
+
+  char const* interned = internedNames[b];
+  pthread_mutex_unlock(&modelMutex);
+  return interned;
+}
+
+/* Cached indices are checked against the object's current animations, so
+ * objects changing their animations or freed objects whose memory is reused
+ * only cost a fresh search */
+static glhckAnimation* _gasModelAnimationLookup(char const* name, glhckObject* object)
+{
+  unsigned int numAnimations;
+  glhckAnimation** animations = glhckObjectAnimations(object, &numAnimations);
+  _gasModelLookup* lookup = &lookups[_gasModelPairHash(object, name) & (GAS_MODEL_LOOKUP_SIZE - 1)];
+  if (lookup->object == object && lookup->name == name && lookup->index < numAnimations
+      && strcmp(glhckAnimationGetName(animations[lookup->index]), name) == 0)
+    return animations[lookup->index];
+
+  unsigned int i;
+  for (i = 0; i < numAnimations; ++i)
+  {
+    if (strcmp(glhckAnimationGetName(animations[i]), name) == 0)
+    {
+      lookup->object = object;
+      lookup->name = name;
+      lookup->index = i;
+      return animations[i];
+    }
+  }
+  return NULL;
+}
+
+static _gasModelBinding* _gasModelBindingTakeIdle(glhckAnimation* animation, glhckBone* skeleton)
+{
+  _gasModelBinding** binding = &idleBindings[_gasModelPairHash(animation, skeleton) & (GAS_MODEL_IDLE_BUCKETS - 1)];
+  for (; *binding; binding = &(*binding)->next)
+  {
+    if ((*binding)->animation == animation && (*binding)->skeleton == skeleton)
+    {
+      _gasModelBinding* idle = *binding;
+      *binding = idle->next;
+      idle->next = NULL;
+      numIdleBindings -= 1;
+      return idle;
+    }
+  }
+  return NULL;
+}
+
+/* name must be interned. Returns NULL if the object has no animation by
+ * that name. */
+_gasModelBinding* _gasModelBindingAcquire(char const* name, glhckObject* object)
+{
+  unsigned int numBones;
+  glhckBone** bones = glhckObjectBones(object, &numBones);
+  glhckBone* skeleton = numBones ? bones[0] : NULL;
+
+  pthread_mutex_lock(&modelMutex);
+  glhckAnimation* animation = _gasModelAnimationLookup(name, object);
+  _gasModelBinding* binding = NULL;
+  gasBoolean idle = GAS_FALSE;
+  if (animation)
+  {
+    binding = _gasModelBindingTakeIdle(animation, skeleton);
+    idle = binding != NULL;
+    if (!binding)
+    {
+      binding = _gasPoolAlloc(&bindingPool);
+    }
+  }
+  pthread_mutex_unlock(&modelMutex);
+
+  if (binding)
+  {
+    binding->playTime = -1.0f;
+    binding->steps = 0;
+  }
+  if (binding && !idle)
+  {
+    binding->animator = glhckAnimatorNew();
+    binding->animation = animation;
+    binding->skeleton = skeleton;
+    binding->animationDuration = glhckAnimationGetDuration(animation);
+    glhckAnimatorAnimation(binding->animator, animation);
+    glhckAnimatorInsertBones(binding->animator, bones, numBones);
+  }
+  return binding;
+}
+
+/* Buckets are kept newest first, so once the limit is reached the last
+ * binding of the bucket makes room, and a binding going into an empty bucket
+ * is freed instead */
+void _gasModelBindingRelease(_gasModelBinding* binding)
+{
+  pthread_mutex_lock(&modelMutex);
+  _gasModelBinding** bucket = &idleBindings[_gasModelPairHash(binding->animation, binding->skeleton)
+      & (GAS_MODEL_IDLE_BUCKETS - 1)];
+  _gasModelBinding* evicted = NULL;
+  if (numIdleBindings < GAS_MODEL_MAX_IDLE_BINDINGS)
+  {
+    numIdleBindings += 1;
+  }
+  else if (*bucket)
+  {
+    _gasModelBinding** last = bucket;
+    while ((*last)->next)
+    {
+      last = &(*last)->next;
+    }
+    evicted = *last;
+    *last = NULL;
+  }
+  else
+  {
+    evicted = binding;
+    binding = NULL;
+  }
+
+  if (binding)
+  {
+    binding->next = *bucket;
+    *bucket = binding;
+  }
+  pthread_mutex_unlock(&modelMutex);
+
+  if (evicted)
+  {
+    glhckAnimatorFree(evicted->animator);
+    pthread_mutex_lock(&modelMutex);
+    _gasPoolRelease(&bindingPool, evicted);
+    pthread_mutex_unlock(&modelMutex);
+  }
+}
+
+gasBoolean gasModelAnimationBind(gasAnimation* animation, glhckObject* object)
+{
+  gasBoolean bound = GAS_TRUE;
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        bound &= gasModelAnimationBind(animation->sequentialAnimation.children[i], object);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        bound &= gasModelAnimationBind(animation->parallelAnimation.children[i], object);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      if (!animation->modelAnimation.binding)
+      {
+        animation->modelAnimation.binding = _gasModelBindingAcquire(animation->modelAnimation.name, object);
+      }
+      bound = animation->modelAnimation.binding != NULL;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      bound = _gasProgramBind(animation->programAnimation.program, animation->programAnimation.states, object);
+      break;
+    }
+    default: break;
+  }
+  return bound;
+}
+
+gasAnimation* gasModelAnimationUpdateRate(gasAnimation* animation, unsigned int const frames, float const minStep)
+{
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        gasModelAnimationUpdateRate(animation->sequentialAnimation.children[i], frames, minStep);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        gasModelAnimationUpdateRate(animation->parallelAnimation.children[i], frames, minStep);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      animation->modelAnimation.frames = frames > 0 ? frames : 1;
+      animation->modelAnimation.minStep = minStep > 0.0f ? minStep : 0.0f;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      _gasProgramUpdateRate(animation->programAnimation.program, animation->programAnimation.states, frames, minStep);
+      break;
+    }
+    default: break;
+  }
+  return animation;
+}
+
+void gasModelAnimationClearCache()
+{
+  pthread_mutex_lock(&modelMutex);
+  unsigned int i;
+  for (i = 0; i < GAS_MODEL_IDLE_BUCKETS; ++i)
+  {
+    while (idleBindings[i])
+    {
+      _gasModelBinding* binding = idleBindings[i];
+      idleBindings[i] = binding->next;
+      glhckAnimatorFree(binding->animator);
+      _gasPoolRelease(&bindingPool, binding);
+    }
+  }
+  numIdleBindings = 0;
+  memset(lookups, 0, sizeof(lookups));
+  pthread_mutex_unlock(&modelMutex);
+}
@@ -0,0 +1,900 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Text animation definitions
+ *
+ * A recursive descent parser building the tree as it reads, in one pass
+ * over the text without a separate tokenizer. Children of sequential and
+ * parallel nodes are gathered on the stack, or on the heap for long lists,
+ * and the node is made once its list closes. Text is read up to length and
+ * need not be terminated.
+ *
+ * Caches hash the whole text with 64 bit FNV-1a and keep a copy of it
+ * beside the template parsed from it, so a colliding hash only costs a
+ * compare. */
+
+#define GAS_PARSE_MAX_DEPTH 256
+#define GAS_PARSE_INLINE_CHILDREN 16
+#define GAS_PARSE_INLINE_KEYS 16
+#define GAS_PARSE_INLINE_POINTS 16
+#define GAS_PARSE_MAX_NUMBER 64
+
+typedef struct _gasParser
+{
+  char const* source;
+  char const* position;
+  char const* end;
+  gasReference const* references;
+  unsigned int numReferences;
+  char const* error;
+} _gasParser;
+
+typedef struct _gasAnimationCacheEntry
+{
+  uint64_t hash;
+  char* source;
+  size_t length;
+  gasAnimationTemplate* animationTemplate;
+} _gasAnimationCacheEntry;
+
+struct _gasAnimationCache
+{
+  pthread_mutex_t mutex;
+  gasReference* references;
+  unsigned int numReferences;
+  _gasAnimationCacheEntry* entries;
+  unsigned int numEntries;
+  unsigned int capacity;
+};
+
+static char const* const numberTargets[] = { "x", "y", "z", "rotX", "rotY", "rotZ" };
+static char const* const vectorTargets[] = { "position", "rotation", "scale" };
+static char const* const kinds[] = { "fromTo", "fromDelta", "deltaTo", "from", "to", "delta" };
+static char const* const easings[] = {
+  NULL, "linear", "quadIn", "quadOut", "ease", "easeIn", "easeOut", "easeInOut"
+};
+
+static gasAnimation* _gasParseAnimation(_gasParser* parser, unsigned int const depth);
+
+/* Keeps the first error, which is where the text stopped making sense */
+static void _gasParseFail(_gasParser* parser)
+{
+  if (!parser->error)
+  {
+    parser->error = parser->position;
+  }
+}
+
+static gasBoolean _gasParseIsNameChar(char const c, gasBoolean const first)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (!first && c >= '0' && c <= '9');
+}
+
+static void _gasParseSkip(_gasParser* parser)
+{
+  while (parser->position < parser->end)
+  {
+    char const c = *parser->position;
+    if (c == '#')
+    {
+      while (parser->position < parser->end && *parser->position != '\n')
+      {
+        ++parser->position;
+      }
+    }
+    else if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+    {
+      ++parser->position;
+    }
+    else
+    {
+      break;
+    }
+  }
+}
+
+static gasBoolean _gasParseAccept(_gasParser* parser, char const c)
+{
+  _gasParseSkip(parser);
+  if (parser->position < parser->end && *parser->position == c)
+  {
+    ++parser->position;
+    return GAS_TRUE;
+  }
+  return GAS_FALSE;
+}
+
+static gasBoolean _gasParseExpect(_gasParser* parser, char const c)
+{
+  if (_gasParseAccept(parser, c))
+    return GAS_TRUE;
+
+  _gasParseFail(parser);
+  return GAS_FALSE;
+}
+
+/* Reads an identifier, or a quoted string for names that are not one */
+static gasBoolean _gasParseName(_gasParser* parser, char const** name, size_t* length)
+{
+  _gasParseSkip(parser);
+  char const* start = parser->position;
+  if (start < parser->end && *start == '"')
+  {
+    char const* close = memchr(start + 1, '"', parser->end - start - 1);
+    if (!close)
+    {
+      _gasParseFail(parser);
+      return GAS_FALSE;
+    }
+    *name = start + 1;
+    *length = close - start - 1;
+    parser->position = close + 1;
+    return GAS_TRUE;
+  }
+
+  while (parser->position < parser->end && _gasParseIsNameChar(*parser->position, parser->position == start))
+  {
+    ++parser->position;
+  }
+  *name = start;
+  *length = parser->position - start;
+  if (*length == 0)
+  {
+    _gasParseFail(parser);
+    return GAS_FALSE;
+  }
+  return GAS_TRUE;
+}
+
+static gasBoolean _gasParseNameIs(char const* name, size_t const length, char const* word)
+{
+  return strlen(word) == length && memcmp(name, word, length) == 0;
+}
+
+/* Returns the index of the name in words, or -1 */
+static int _gasParseLookup(char const* name, size_t const length, char const* const* words, unsigned int const numWords)
+{
+  unsigned int i;
+  for (i = 0; i < numWords; ++i)
+  {
+    if (words[i] && _gasParseNameIs(name, length, words[i]))
+      return (int) i;
+  }
+  return -1;
+}
+
+/* Consumes the keyword if it comes next */
+static gasBoolean _gasParseKeyword(_gasParser* parser, char const* keyword)
+{
+  _gasParseSkip(parser);
+  size_t const length = strlen(keyword);
+  if ((size_t) (parser->end - parser->position) < length || memcmp(parser->position, keyword, length) != 0)
+    return GAS_FALSE;
+
+  char const* after = parser->position + length;
+  if (after < parser->end && _gasParseIsNameChar(*after, GAS_FALSE))
+    return GAS_FALSE;
+
+  parser->position = after;
+  return GAS_TRUE;
+}
+
+static float _gasParseNumber(_gasParser* parser)
+{
+  char number[GAS_PARSE_MAX_NUMBER];
+  size_t length = 0;
+  _gasParseSkip(parser);
+  while (parser->position + length < parser->end && length < GAS_PARSE_MAX_NUMBER - 1)
+  {
+    char const c = parser->position[length];
+    if (!((c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E'))
+      break;
+
+    number[length++] = c;
+  }
+  number[length] = '\0';
+
+  char* numberEnd;
+  float const value = strtof(number, &numberEnd);
+  if (length == 0 || numberEnd != number + length)
+  {
+    _gasParseFail(parser);
+    return 0.0f;
+  }
+  parser->position += length;
+  return value;
+}
+
+static float _gasParseDuration(_gasParser* parser)
+{
+  _gasParseSkip(parser);
+  char const* start = parser->position;
+  float const duration = _gasParseNumber(parser);
+  if (!parser->error && !(duration >= 0.0f))
+  {
+    parser->position = start;
+    _gasParseFail(parser);
+  }
+  return duration;
+}
+
+/* A number or a bracketed list of up to maxValues numbers. Returns how many
+ * were read. */
+static unsigned int _gasParseValues(_gasParser* parser, float* values, unsigned int const maxValues)
+{
+  if (!_gasParseAccept(parser, '['))
+  {
+    values[0] = _gasParseNumber(parser);
+    return 1;
+  }
+
+  unsigned int numValues = 0;
+  do
+  {
+    if (numValues == maxValues)
+    {
+      _gasParseFail(parser);
+      return 0;
+    }
+    values[numValues++] = _gasParseNumber(parser);
+  } while (!parser->error && _gasParseAccept(parser, ','));
+  _gasParseExpect(parser, ']');
+  return numValues;
+}
+
+static gasReference const* _gasParseReference(_gasParser* parser, char const* name, size_t const length)
+{
+  unsigned int i;
+  for (i = 0; i < parser->numReferences; ++i)
+  {
+    gasReference const* reference = &parser->references[i];
+    if (reference->name && _gasParseNameIs(name, length, reference->name))
+      return reference;
+  }
+  parser->position = name;
+  _gasParseFail(parser);
+  return NULL;
+}
+
+static void _gasParseEasing(_gasParser* parser, gasEasingFunc* easing, gasEasingCurve const** curve)
+{
+  *easing = gasEasingLinear;
+  *curve = NULL;
+  if (!_gasParseAccept(parser, ','))
+    return;
+
+  char const* name;
+  size_t length;
+  if (!_gasParseName(parser, &name, &length))
+    return;
+
+  int const id = _gasParseLookup(name, length, easings, sizeof(easings) / sizeof(easings[0]));
+  if (id >= 0)
+  {
+    *easing = _gasEasingFuncFromId(id);
+    return;
+  }
+
+  gasReference const* reference = _gasParseReference(parser, name, length);
+  if (reference && !reference->easing && !reference->curve)
+  {
+    parser->position = name;
+    _gasParseFail(parser);
+  }
+  else if (reference)
+  {
+    *easing = reference->easing ? reference->easing : gasEasingLinear;
+    *curve = reference->curve;
+  }
+}
+
+static void* _gasParseUserdata(gasReference const* reference)
+{
+  return reference->cloneCallback ? reference->cloneCallback(reference->userdata) : reference->userdata;
+}
+
+/* target.keys([time, value, easing], ...) */
+static gasAnimation* _gasParseTrack(_gasParser* parser, gasNumberAnimationTarget const target)
+{
+  gasKeyframe inlineKeys[GAS_PARSE_INLINE_KEYS];
+  gasKeyframe* keys = inlineKeys;
+  unsigned int numKeys = 0;
+  unsigned int capacity = GAS_PARSE_INLINE_KEYS;
+
+  _gasParseExpect(parser, '(');
+  do
+  {
+    if (numKeys == capacity)
+    {
+      capacity *= 2;
+      if (keys == inlineKeys)
+      {
+        keys = malloc(capacity * sizeof(gasKeyframe));
+        memcpy(keys, inlineKeys, sizeof(inlineKeys));
+      }
+      else
+      {
+        keys = realloc(keys, capacity * sizeof(gasKeyframe));
+      }
+    }
+
+    gasKeyframe* key = &keys[numKeys++];
+    _gasParseExpect(parser, '[');
+    _gasParseSkip(parser);
+    char const* start = parser->position;
+    key->time = _gasParseDuration(parser);
+    if (!parser->error && numKeys > 1 && key->time < key[-1].time)
+    {
+      parser->position = start;
+      _gasParseFail(parser);
+    }
+    _gasParseExpect(parser, ',');
+    key->value = _gasParseNumber(parser);
+    _gasParseEasing(parser, &key->easing, &key->curve);
+    _gasParseExpect(parser, ']');
+  } while (!parser->error && _gasParseAccept(parser, ','));
+  _gasParseExpect(parser, ')');
+
+  gasAnimation* animation = parser->error ? NULL : gasTrackAnimationNew(target, keys, numKeys);
+  if (keys != inlineKeys)
+  {
+    free(keys);
+  }
+  return animation;
+}
+
+/* position.path([x, y, z], ..., duration, easing), or position.spline */
+static gasAnimation* _gasParsePath(_gasParser* parser, gasPathInterpolation const interpolation)
+{
+  kmVec3 inlinePoints[GAS_PARSE_INLINE_POINTS];
+  kmVec3* points = inlinePoints;
+  unsigned int numPoints = 0;
+  unsigned int capacity = GAS_PARSE_INLINE_POINTS;
+
+  _gasParseExpect(parser, '(');
+  do
+  {
+    if (numPoints == capacity)
+    {
+      capacity *= 2;
+      if (points == inlinePoints)
+      {
+        points = malloc(capacity * sizeof(kmVec3));
+        memcpy(points, inlinePoints, sizeof(inlinePoints));
+      }
+      else
+      {
+        points = realloc(points, capacity * sizeof(kmVec3));
+      }
+    }
+
+    float values[3];
+    _gasParseSkip(parser);
+    char const* start = parser->position;
+    if (_gasParseValues(parser, values, 3) != 3 && !parser->error)
+    {
+      parser->position = start;
+      _gasParseFail(parser);
+    }
+    kmVec3* point = &points[numPoints++];
+    point->x = values[0];
+    point->y = values[1];
+    point->z = values[2];
+    _gasParseExpect(parser, ',');
+    _gasParseSkip(parser);
+  } while (!parser->error && parser->position < parser->end && *parser->position == '[');
+
+  float const duration = _gasParseDuration(parser);
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
+  _gasParseEasing(parser, &easing, &curve);
+  _gasParseExpect(parser, ')');
+
+  gasAnimation* animation = NULL;
+  if (!parser->error)
+  {
+    animation = gasPathAnimationNew(interpolation, easing, points, numPoints, 0.0f, duration);
+    animation->pathAnimation.curve = curve;
+  }
+  if (points != inlinePoints)
+  {
+    free(points);
+  }
+  return animation;
+}
+
+/* target.kind(values, duration, easing) */
+static gasAnimation* _gasParseTween(_gasParser* parser, char const* target, size_t const targetLength)
+{
+  char const* kindName;
+  size_t kindLength;
+  if (!_gasParseExpect(parser, '.') || !_gasParseName(parser, &kindName, &kindLength))
+    return NULL;
+
+  int const numberTarget = _gasParseLookup(target, targetLength, numberTargets, 6);
+  int const vectorTarget = _gasParseLookup(target, targetLength, vectorTargets, 3);
+  gasBoolean const orientation = _gasParseNameIs(target, targetLength, "orientation");
+  int const kind = _gasParseLookup(kindName, kindLength, kinds, 6);
+  if (numberTarget < 0 && vectorTarget < 0 && !orientation)
+  {
+    parser->position = target;
+    _gasParseFail(parser);
+    return NULL;
+  }
+  if (numberTarget >= 0 && _gasParseNameIs(kindName, kindLength, "keys"))
+    return _gasParseTrack(parser, numberTarget);
+
+  if (vectorTarget == GAS_VECTOR_ANIMATION_TARGET_POSITION && _gasParseNameIs(kindName, kindLength, "path"))
+    return _gasParsePath(parser, GAS_PATH_LINEAR);
+
+  if (vectorTarget == GAS_VECTOR_ANIMATION_TARGET_POSITION && _gasParseNameIs(kindName, kindLength, "spline"))
+    return _gasParsePath(parser, GAS_PATH_CATMULL_ROM);
+
+  if (kind < 0)
+  {
+    parser->position = kindName;
+    _gasParseFail(parser);
+    return NULL;
+  }
+
+  /* Single valued kinds put the value where the constructors do */
+  _gasNumberAnimationType const type = kind;
+  unsigned int const numValues = type <= GAS_NUMBER_ANIMATION_TYPE_DELTA_TO ? 2 : 1;
+  unsigned int const maxComponents = numberTarget >= 0 ? 1 : vectorTarget >= 0 ? 3 : 4;
+  float values[2][4] = { { 0.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 0.0f } };
+  float* slots[2] = { values[0], values[1] };
+  if (type != GAS_NUMBER_ANIMATION_TYPE_FROM && numValues == 1)
+  {
+    slots[0] = values[1];
+  }
+
+  unsigned int numComponents[2] = { 0, 0 };
+  unsigned int i;
+  _gasParseExpect(parser, '(');
+  for (i = 0; i < numValues && !parser->error; ++i)
+  {
+    char const* start = parser->position;
+    unsigned int const given = _gasParseValues(parser, slots[i], maxComponents);
+    if (!parser->error && given != maxComponents && !(orientation && given == 3))
+    {
+      parser->position = start;
+      _gasParseFail(parser);
+    }
+    numComponents[slots[i] == values[0] ? 0 : 1] = given;
+    _gasParseExpect(parser, ',');
+  }
+
+  float const duration = _gasParseDuration(parser);
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
+  _gasParseEasing(parser, &easing, &curve);
+  _gasParseExpect(parser, ')');
+  if (parser->error)
+    return NULL;
+
+  gasAnimation* animation;
+  if (numberTarget >= 0)
+  {
+    animation = _gasNumberAnimationNew(numberTarget, easing, type, values[0][0], values[1][0], duration);
+    animation->numberAnimation.curve = curve;
+  }
+  else if (vectorTarget >= 0)
+  {
+    kmVec3 const a = { values[0][0], values[0][1], values[0][2] };
+    kmVec3 const b = { values[1][0], values[1][1], values[1][2] };
+    animation = _gasVectorAnimationNew(vectorTarget, easing, type, &a, &b, duration);
+    animation->vectorAnimation.curve = curve;
+  }
+  else
+  {
+    kmQuaternion quaternions[2] = { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+    for (i = 0; i < 2; ++i)
+    {
+      if (numComponents[i] == 3)
+      {
+        kmVec3 const degrees = { values[i][0], values[i][1], values[i][2] };
+        gasQuaternionFromEuler(&degrees, &quaternions[i]);
+      }
+      else if (numComponents[i] == 4)
+      {
+        quaternions[i].x = values[i][0];
+        quaternions[i].y = values[i][1];
+        quaternions[i].z = values[i][2];
+        quaternions[i].w = values[i][3];
+      }
+    }
+    animation = _gasRotationAnimationNew(easing, type, &quaternions[0], &quaternions[1], duration);
+    animation->rotationAnimation->curve = curve;
+  }
+  return animation;
+}
+
+static gasAnimation* _gasParseGroup(_gasParser* parser, gasBoolean const sequential, unsigned int const depth)
+{
+  gasAnimation* inlineChildren[GAS_PARSE_INLINE_CHILDREN];
+  gasAnimation** children = inlineChildren;
+  unsigned int numChildren = 0;
+  unsigned int capacity = GAS_PARSE_INLINE_CHILDREN;
+  unsigned int i;
+
+  _gasParseExpect(parser, '(');
+  if (!parser->error && !_gasParseAccept(parser, ')'))
+  {
+    do
+    {
+      gasAnimation* child = _gasParseAnimation(parser, depth + 1);
+      if (!child)
+        break;
+
+      if (numChildren == capacity)
+      {
+        capacity *= 2;
+        if (children == inlineChildren)
+        {
+          children = malloc(capacity * sizeof(gasAnimation*));
+          memcpy(children, inlineChildren, sizeof(inlineChildren));
+        }
+        else
+        {
+          children = realloc(children, capacity * sizeof(gasAnimation*));
+        }
+      }
+      children[numChildren++] = child;
+    } while (_gasParseAccept(parser, ','));
+    _gasParseExpect(parser, ')');
+  }
+
+  gasAnimation* animation = NULL;
+  if (!parser->error)
+  {
+    animation = sequential
+        ? gasSequentialAnimationNew(children, numChildren)
+        : gasParallelAnimationNew(children, numChildren);
+  }
+  else
+  {
+    for (i = 0; i < numChildren; ++i)
+    {
+      gasAnimationFree(children[i]);
+    }
+  }
+
+  if (children != inlineChildren)
+  {
+    free(children);
+  }
+  return animation;
+}
+
+static gasAnimation* _gasParseModel(_gasParser* parser)
+{
+  char const* name;
+  size_t length;
+  if (!_gasParseExpect(parser, '(') || !_gasParseName(parser, &name, &length) || !_gasParseExpect(parser, ','))
+    return NULL;
+
+  float const duration = _gasParseDuration(parser);
+  _gasParseExpect(parser, ')');
+  if (parser->error)
+    return NULL;
+
+  char* terminated = malloc(length + 1);
+  memcpy(terminated, name, length);
+  terminated[length] = '\0';
+  gasAnimation* animation = gasModelAnimationNew(terminated, duration);
+  free(terminated);
+  return animation;
+}
+
+static gasAnimation* _gasParseCallback(_gasParser* parser, gasBoolean const action)
+{
+  char const* name;
+  size_t length;
+  if (!_gasParseExpect(parser, '(') || !_gasParseName(parser, &name, &length))
+    return NULL;
+
+  gasReference const* reference = _gasParseReference(parser, name, length);
+  if (reference && (action ? reference->action == NULL : reference->custom == NULL))
+  {
+    parser->position = name;
+    _gasParseFail(parser);
+  }
+  _gasParseExpect(parser, ')');
+  if (parser->error)
+    return NULL;
+
+  return action
+      ? gasActionNew(reference->action, reference->resetCallback, reference->cloneCallback,
+                     reference->freeCallback, _gasParseUserdata(reference))
+      : gasCustomAnimationNew(reference->custom, reference->resetCallback, reference->cloneCallback,
+                              reference->freeCallback, _gasParseUserdata(reference));
+}
+
+static gasAnimation* _gasParsePrimary(_gasParser* parser, unsigned int const depth)
+{
+  char const* name;
+  size_t length;
+  if (depth >= GAS_PARSE_MAX_DEPTH)
+  {
+    _gasParseFail(parser);
+    return NULL;
+  }
+
+  if (_gasParseAccept(parser, '('))
+  {
+    gasAnimation* animation = _gasParseAnimation(parser, depth + 1);
+    if (animation && !_gasParseExpect(parser, ')'))
+    {
+      gasAnimationFree(animation);
+      animation = NULL;
+    }
+    return animation;
+  }
+
+  if (!_gasParseName(parser, &name, &length))
+    return NULL;
+
+  if (_gasParseNameIs(name, length, "seq"))
+    return _gasParseGroup(parser, GAS_TRUE, depth);
+
+  if (_gasParseNameIs(name, length, "par"))
+    return _gasParseGroup(parser, GAS_FALSE, depth);
+
+  if (_gasParseNameIs(name, length, "model"))
+    return _gasParseModel(parser);
+
+  if (_gasParseNameIs(name, length, "action"))
+    return _gasParseCallback(parser, GAS_TRUE);
+
+  if (_gasParseNameIs(name, length, "custom"))
+    return _gasParseCallback(parser, GAS_FALSE);
+
+  if (_gasParseNameIs(name, length, "pause"))
+  {
+    _gasParseExpect(parser, '(');
+    float const duration = _gasParseDuration(parser);
+    _gasParseExpect(parser, ')');
+    return parser->error ? NULL : gasPauseAnimationNew(duration);
+  }
+
+  return _gasParseTween(parser, name, length);
+}
+
+/* Modifiers that do not apply to the node fail where they stand */
+static gasAnimation* _gasParseAnimation(_gasParser* parser, unsigned int const depth)
+{
+  gasAnimation* animation = _gasParsePrimary(parser, depth);
+  while (animation && !parser->error)
+  {
+    _gasParseSkip(parser);
+    char const* modifier = parser->position;
+    if (_gasParseKeyword(parser, "loop"))
+    {
+      _gasParseSkip(parser);
+      if (parser->position < parser->end && *parser->position >= '0' && *parser->position <= '9')
+      {
+        float const times = _gasParseNumber(parser);
+        if (!(times >= 1.0f && times <= 1e9f) || times != (float) (unsigned int) times)
+        {
+          parser->position = modifier;
+          _gasParseFail(parser);
+        }
+        else if (!parser->error)
+        {
+          gasAnimationLoopTimes(animation, (unsigned int) times);
+        }
+      }
+      else
+      {
+        gasAnimationLoop(animation);
+      }
+    }
+    else if (_gasParseKeyword(parser, "rate"))
+    {
+      _gasParseExpect(parser, '(');
+      float const frames = _gasParseNumber(parser);
+      _gasParseExpect(parser, ',');
+      float const minStep = _gasParseDuration(parser);
+      _gasParseExpect(parser, ')');
+      if (!(frames >= 0.0f && frames <= 65536.0f) || frames != (float) (unsigned int) frames)
+      {
+        parser->position = modifier;
+        _gasParseFail(parser);
+      }
+      if (!parser->error)
+      {
+        gasModelAnimationUpdateRate(animation, (unsigned int) frames, minStep);
+      }
+    }
+    else if (_gasParseKeyword(parser, "nlerp"))
+    {
+      if (animation->type != GAS_ANIMATION_TYPE_ROTATION)
+      {
+        parser->position = modifier;
+        _gasParseFail(parser);
+      }
+      else
+      {
+        gasRotationAnimationNlerp(animation, GAS_TRUE);
+      }
+    }
+    else if (_gasParseKeyword(parser, "hop"))
+    {
+      float const hop = _gasParseNumber(parser);
+      if (animation->type != GAS_ANIMATION_TYPE_PATH)
+      {
+        parser->position = modifier;
+        _gasParseFail(parser);
+      }
+      else if (!parser->error)
+      {
+        /* The waypoints were just made, so nothing else shares them yet */
+        animation->pathAnimation.points->hop = hop;
+      }
+    }
+    else if (_gasParseKeyword(parser, "once"))
+    {
+      if (animation->type != GAS_ANIMATION_TYPE_ACTION)
+      {
+        parser->position = modifier;
+        _gasParseFail(parser);
+      }
+      else
+      {
+        gasActionFireOnce(animation, GAS_TRUE);
+      }
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if (animation && parser->error)
+  {
+    gasAnimationFree(animation);
+    animation = NULL;
+  }
+  return animation;
+}
+
+gasAnimation* gasAnimationParse(char const* source, size_t const length, gasReference const* references,
+                                unsigned int const numReferences, size_t* errorOffset)
+{
+  _gasParser parser = { source, source, source + length, references, numReferences, NULL };
+  gasAnimation* animation = _gasParseAnimation(&parser, 0);
+  _gasParseSkip(&parser);
+  if (animation && parser.position != parser.end)
+  {
+    _gasParseFail(&parser);
+    gasAnimationFree(animation);
+    animation = NULL;
+  }
+
+  if (!animation)
+  {
+    _gasParseFail(&parser);
+  }
+  if (errorOffset)
+  {
+    *errorOffset = animation ? 0 : (size_t) (parser.error - source);
+  }
+  return animation;
+}
+
+static uint64_t _gasAnimationCacheHash(char const* source, size_t const length)
+{
+  uint64_t h = 14695981039346656037ull;
+  size_t i;
+  for (i = 0; i < length; ++i)
+  {
+    h ^= (unsigned char) source[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+gasAnimationCache* gasAnimationCacheNew(gasReference const* references, unsigned int const numReferences)
+{
+  gasAnimationCache* cache = calloc(1, sizeof(gasAnimationCache));
+  pthread_mutex_init(&cache->mutex, NULL);
+  if (numReferences)
+  {
+    cache->references = malloc(numReferences * sizeof(gasReference));
+    memcpy(cache->references, references, numReferences * sizeof(gasReference));
+  }
+  cache->numReferences = numReferences;
+  return cache;
+}
+
+static void _gasAnimationCacheGrow(gasAnimationCache* cache)
+{
+  unsigned int const capacity = cache->capacity ? cache->capacity * 2 : 64;
+  _gasAnimationCacheEntry* entries = calloc(capacity, sizeof(_gasAnimationCacheEntry));
+  unsigned int i;
+  for (i = 0; i < cache->capacity; ++i)
+  {
+    if (!cache->entries[i].animationTemplate)
+      continue;
+
+    unsigned int b = (unsigned int) cache->entries[i].hash & (capacity - 1);
+    while (entries[b].animationTemplate)
+    {
+      b = (b + 1) & (capacity - 1);
+    }
+    entries[b] = cache->entries[i];
+  }
+
+  free(cache->entries);
+  cache->entries = entries;
+  cache->capacity = capacity;
+}
+
+/* Text is parsed under the lock, so two threads loading the same new text
+ * never both parse it */
+gasAnimation* gasAnimationCacheLoad(gasAnimationCache* cache, char const* source, size_t const length,
+                                    size_t* errorOffset)
+{
+  uint64_t const hash = _gasAnimationCacheHash(source, length);
+  pthread_mutex_lock(&cache->mutex);
+  if ((cache->numEntries + 1) * 2 > cache->capacity)
+  {
+    _gasAnimationCacheGrow(cache);
+  }
+
+  unsigned int const mask = cache->capacity - 1;
+  unsigned int b = (unsigned int) hash & mask;
+  _gasAnimationCacheEntry* entry = &cache->entries[b];
+  while (entry->animationTemplate
+         && (entry->hash != hash || entry->length != length || memcmp(entry->source, source, length) != 0))
+  {
+    b = (b + 1) & mask;
+    entry = &cache->entries[b];
+  }
+
+  if (!entry->animationTemplate)
+  {
+    gasAnimation* animation = gasAnimationParse(source, length, cache->references, cache->numReferences,
+                                                errorOffset);
+    if (animation)
+    {
+      entry->hash = hash;
+      entry->source = malloc(length ? length : 1);
+      memcpy(entry->source, source, length);
+      entry->length = length;
+      entry->animationTemplate = gasAnimationTemplateNew(animation);
+      cache->numEntries += 1;
+      gasAnimationFree(animation);
+    }
+  }
+  else if (errorOffset)
+  {
+    *errorOffset = 0;
+  }
+
+  gasAnimationTemplate* animationTemplate = entry->animationTemplate;
+  pthread_mutex_unlock(&cache->mutex);
+  return animationTemplate ? gasAnimationTemplateInstantiate(animationTemplate) : NULL;
+}
+
+void gasAnimationCacheFree(gasAnimationCache* cache)
+{
+  unsigned int i;
+  for (i = 0; i < cache->capacity; ++i)
+  {
+    if (cache->entries[i].animationTemplate)
+    {
+      gasAnimationTemplateFree(cache->entries[i].animationTemplate);
+      free(cache->entries[i].source);
+    }
+  }
+  pthread_mutex_destroy(&cache->mutex);
+  free(cache->entries);
+  free(cache->references);
+  free(cache);
+}
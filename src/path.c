@@ -0,0 +1,231 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Waypoint paths
+ *
+ * Speed along a spline is not constant in its parameter, so each segment is
+ * divided into pieces short enough to be taken as straight, and the table of
+ * distances at their ends maps the distance travelled back to a segment and
+ * a parameter within it. Speed still changes noticeably over a piece near
+ * the ends of a spline, so the table also keeps the speed at each end, and
+ * within a piece speed is taken to change linearly, which makes the
+ * parameter for a distance the root of a quadratic. Straight segments are
+ * their own single piece. Like tracks, a path remembers the piece it was
+ * last in and looks a few pieces ahead of it before searching the table. */
+
+#define GAS_PATH_SPLINE_SAMPLES 8
+#define GAS_PATH_SCAN 4
+
+gasAnimation* gasPathAnimationNew(gasPathInterpolation const interpolation, gasEasingFunc easing,
+                                  kmVec3 const* points, unsigned int const numPoints, float const hop,
+                                  float const duration)
+{
+  _gasPathPoints* pathPoints = _gasPathPointsNew(interpolation, points, numPoints, hop);
+  if (!pathPoints)
+    return NULL;
+
+  gasAnimation* animation = _gasAnimationNew(GAS_ANIMATION_TYPE_PATH);
+  animation->pathAnimation.duration = duration;
+  animation->pathAnimation.time = 0.0f;
+  animation->pathAnimation.cursor = 0;
+  animation->pathAnimation.easing = easing;
+  animation->pathAnimation.curve = NULL;
+  animation->pathAnimation.points = pathPoints;
+  return animation;
+}
+
+/* Where segment is at u in [0, 1]. Catmull-Rom segments at either end
+ * repeat their outer point in place of the missing neighbour. */
+static kmVec3 _gasPathSegmentPoint(_gasPathPoints const* path, unsigned int const segment, float const u)
+{
+  kmVec3 const* p1 = &path->points[segment];
+  kmVec3 const* p2 = &path->points[segment + 1];
+  kmVec3 value;
+  if (path->interpolation == GAS_PATH_LINEAR)
+  {
+    value.x = p1->x + (p2->x - p1->x) * u;
+    value.y = p1->y + (p2->y - p1->y) * u;
+    value.z = p1->z + (p2->z - p1->z) * u;
+    return value;
+  }
+
+  kmVec3 const* p0 = segment > 0 ? p1 - 1 : p1;
+  kmVec3 const* p3 = segment + 2 < path->numPoints ? p2 + 1 : p2;
+  float const u2 = u * u;
+  float const u3 = u2 * u;
+  float const w0 = 0.5f * (-u3 + 2.0f * u2 - u);
+  float const w1 = 0.5f * (3.0f * u3 - 5.0f * u2 + 2.0f);
+  float const w2 = 0.5f * (-3.0f * u3 + 4.0f * u2 + u);
+  float const w3 = 0.5f * (u3 - u2);
+  value.x = p0->x * w0 + p1->x * w1 + p2->x * w2 + p3->x * w3;
+  value.y = p0->y * w0 + p1->y * w1 + p2->y * w2 + p3->y * w3;
+  value.z = p0->z * w0 + p1->z * w1 + p2->z * w2 + p3->z * w3;
+  return value;
+}
+
+/* How fast a Catmull-Rom segment moves at u, per unit of u */
+static float _gasPathSegmentSpeed(_gasPathPoints const* path, unsigned int const segment, float const u)
+{
+  kmVec3 const* p1 = &path->points[segment];
+  kmVec3 const* p2 = &path->points[segment + 1];
+  kmVec3 const* p0 = segment > 0 ? p1 - 1 : p1;
+  kmVec3 const* p3 = segment + 2 < path->numPoints ? p2 + 1 : p2;
+  float const u2 = u * u;
+  float const w0 = 0.5f * (-3.0f * u2 + 4.0f * u - 1.0f);
+  float const w1 = 0.5f * (9.0f * u2 - 10.0f * u);
+  float const w2 = 0.5f * (-9.0f * u2 + 8.0f * u + 1.0f);
+  float const w3 = 0.5f * (3.0f * u2 - 2.0f * u);
+  float const dx = p0->x * w0 + p1->x * w1 + p2->x * w2 + p3->x * w3;
+  float const dy = p0->y * w0 + p1->y * w1 + p2->y * w2 + p3->y * w3;
+  float const dz = p0->z * w0 + p1->z * w1 + p2->z * w2 + p3->z * w3;
+  return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+_gasPathPoints* _gasPathPointsNew(gasPathInterpolation const interpolation, kmVec3 const* points,
+                                  unsigned int const numPoints, float const hop)
+{
+  if (numPoints == 0)
+    return NULL;
+
+  gasBoolean const spline = interpolation != GAS_PATH_LINEAR;
+  unsigned int const samples = spline ? GAS_PATH_SPLINE_SAMPLES : 1;
+  unsigned int const numPieces = (numPoints - 1) * samples;
+  _gasPathPoints* path = malloc(sizeof(_gasPathPoints) + numPoints * sizeof(kmVec3)
+                                + (numPieces + 1) * (spline ? 2 : 1) * sizeof(float));
+  path->references = 1;
+  path->numPoints = numPoints;
+  path->samples = samples;
+  path->interpolation = interpolation;
+  path->hop = hop;
+  path->lengths = (float*) (path->points + numPoints);
+  path->speeds = spline ? path->lengths + numPieces + 1 : NULL;
+  memcpy(path->points, points, numPoints * sizeof(kmVec3));
+
+  kmVec3 previous = points[0];
+  float* length = path->lengths;
+  float* speed = path->speeds;
+  unsigned int segment, i;
+  *length = 0.0f;
+  for (segment = 0; segment + 1 < numPoints; ++segment)
+  {
+    for (i = 0; i < samples; ++i)
+    {
+      kmVec3 const next = _gasPathSegmentPoint(path, segment, (float) (i + 1) / samples);
+      float const dx = next.x - previous.x;
+      float const dy = next.y - previous.y;
+      float const dz = next.z - previous.z;
+      length[1] = length[0] + sqrtf(dx * dx + dy * dy + dz * dz);
+      ++length;
+      previous = next;
+      if (spline)
+      {
+        *speed++ = _gasPathSegmentSpeed(path, segment, (float) i / samples);
+      }
+    }
+  }
+  if (spline && numPoints > 1)
+  {
+    *speed = _gasPathSegmentSpeed(path, numPoints - 2, 1.0f);
+  }
+  return path;
+}
+
+void _gasPathPointsRetain(_gasPathPoints* points)
+{
+  __atomic_add_fetch(&points->references, 1, __ATOMIC_RELAXED);
+}
+
+void _gasPathPointsRelease(_gasPathPoints* points)
+{
+  if (__atomic_sub_fetch(&points->references, 1, __ATOMIC_ACQ_REL) == 0)
+    free(points);
+}
+
+/* The first piece ending at or after distance, or the last piece from the
+ * end of the path on */
+static unsigned int _gasPathSeek(_gasPathPoints const* path, unsigned int const cursor, float const distance)
+{
+  float const* lengths = path->lengths;
+  unsigned int const last = (path->numPoints - 1) * path->samples;
+  if (distance >= lengths[last])
+    return last;
+
+  unsigned int i;
+  for (i = cursor; i <= last && i <= cursor + GAS_PATH_SCAN; ++i)
+  {
+    if (lengths[i] >= distance && (i == 0 || lengths[i - 1] < distance))
+      return i;
+  }
+
+  unsigned int low = 0;
+  unsigned int high = last;
+  while (low < high)
+  {
+    unsigned int const middle = low + (high - low) / 2;
+    if (lengths[middle] >= distance)
+      high = middle;
+    else
+      low = middle + 1;
+  }
+  return low;
+}
+
+/* Where the path has the object time into it, moving cursor to the piece
+ * that is in */
+kmVec3 _gasPathPosition(_gasPathAnimation const* path, unsigned int* cursor, float const time)
+{
+  _gasPathPoints const* points = path->points;
+  float const x = path->duration > 0.0f ? _gasClamp(time / path->duration, 0.0f, 1.0f) : 1.0f;
+  float const t = path->curve ? _gasEasingCurveEvaluate(path->curve, x) : path->easing(x);
+  float const* lengths = points->lengths;
+  unsigned int const samples = points->samples;
+  float const distance = _gasClamp(t, 0.0f, 1.0f) * lengths[(points->numPoints - 1) * samples];
+
+  unsigned int const piece = _gasPathSeek(points, *cursor, distance);
+  *cursor = piece;
+  if (piece == 0)
+    return points->points[0];
+
+  unsigned int const segment = (piece - 1) / samples;
+  float const span = lengths[piece] - lengths[piece - 1];
+  float f = span > 0.0f ? _gasClamp((distance - lengths[piece - 1]) / span, 0.0f, 1.0f) : 1.0f;
+  if (points->speeds)
+  {
+    /* Solves f = (v0 u + (v1 - v0) u^2 / 2) / ((v0 + v1) / 2) for u */
+    float const v0 = points->speeds[piece - 1];
+    float const v1 = points->speeds[piece];
+    float const denominator = v0 + sqrtf(v0 * v0 + f * (v1 * v1 - v0 * v0));
+    f = denominator > 0.0f ? _gasClamp(f * (v0 + v1) / denominator, 0.0f, 1.0f) : f;
+  }
+  kmVec3 value = _gasPathSegmentPoint(points, segment, ((piece - 1) % samples + f) / samples);
+
+  if (points->hop != 0.0f)
+  {
+    float const start = lengths[segment * samples];
+    float const length = lengths[(segment + 1) * samples] - start;
+    float const s = length > 0.0f ? _gasClamp((distance - start) / length, 0.0f, 1.0f) : 1.0f;
+    value.y += 4.0f * points->hop * s * (1.0f - s);
+  }
+  return value;
+}
+
+float _gasPathAnimationStep(_gasPathAnimation* path, gasAnimationState* state, glhckObject* object, float const delta)
+{
+  path->time += delta;
+
+  *state = path->time >= path->duration
+      ? GAS_ANIMATION_STATE_FINISHED
+      : GAS_ANIMATION_STATE_RUNNING;
+
+  float const time = path->time < path->duration ? path->time : path->duration;
+  kmVec3 const position = _gasPathPosition(path, &path->cursor, time);
+  _gasVectorAnimationSetTargetValue(GAS_VECTOR_ANIMATION_TARGET_POSITION, object, &position);
+
+  return path->time >= path->duration
+      ? path->time - path->duration
+      : 0;
+}
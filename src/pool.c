@@ -0,0 +1,166 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Fixed size block pools
+ *
+ * Blocks are bump allocated from chunks and recycled through an intrusive
+ * free list, so steady state allocation never reaches malloc. Resetting a
+ * pool releases every block at once by dropping its chunks. */
+
+#define GAS_POOL_ALIGNMENT 16
+#define GAS_POOL_CHUNK_HEADER GAS_POOL_ALIGNMENT
+
+static size_t _gasPoolBlockSize(_gasPool* pool)
+{
+  size_t const size = pool->blockSize < sizeof(void*) ? sizeof(void*) : pool->blockSize;
+  return (size + GAS_POOL_ALIGNMENT - 1) & ~((size_t) GAS_POOL_ALIGNMENT - 1);
+}
+
+void _gasPoolInit(_gasPool* pool, size_t const blockSize, unsigned int const blocksPerChunk)
+{
+  memset(pool, 0, sizeof(_gasPool));
+  pool->blockSize = blockSize;
+  pool->blocksPerChunk = blocksPerChunk;
+}
+
+void* _gasPoolAlloc(_gasPool* pool)
+{
+  size_t const blockSize = _gasPoolBlockSize(pool);
+  void* block;
+
+  if (pool->freeBlocks)
+  {
+    block = pool->freeBlocks;
+    pool->freeBlocks = *(void**) block;
+  }
+  else
+  {
+    if (!pool->chunks || pool->used == pool->blocksPerChunk)
+    {
+      char* chunk = malloc(GAS_POOL_CHUNK_HEADER + blockSize * pool->blocksPerChunk);
+      *(char**) chunk = pool->chunks;
+      pool->chunks = chunk;
+      pool->used = 0;
+    }
+
+    block = pool->chunks + GAS_POOL_CHUNK_HEADER + blockSize * pool->used;
+    pool->used += 1;
+  }
+
+  memset(block, 0, blockSize);
+  return block;
+}
+
+void _gasPoolRelease(_gasPool* pool, void* block)
+{
+  *(void**) block = pool->freeBlocks;
+  pool->freeBlocks = block;
+}
+
+void _gasPoolReset(_gasPool* pool)
+{
+  while (pool->chunks)
+  {
+    char* next = *(char**) pool->chunks;
+    free(pool->chunks);
+    pool->chunks = next;
+  }
+
+  pool->freeBlocks = NULL;
+  pool->used = 0;
+}
+
+/* Shared pools for animation nodes, rotation animation data and child
+ * pointer arrays. Child arrays come in power of two size classes, larger
+ * ones go to malloc directly. Animations are made and freed from any thread,
+ * by caches, banks and callbacks on workers alike, so every shared pool is
+ * only touched under poolMutex. */
+
+#define GAS_NUM_CHILDREN_CLASSES 4
+#define GAS_MAX_POOLED_CHILDREN (2 << (GAS_NUM_CHILDREN_CLASSES - 1))
+
+static pthread_mutex_t poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static _gasPool nodePool = { sizeof(_gasAnimation), 256, NULL, NULL, 0 };
+static _gasPool rotationPool = { sizeof(_gasRotationAnimation), 64, NULL, NULL, 0 };
+static _gasPool childrenPools[GAS_NUM_CHILDREN_CLASSES] = {
+  { 2 * sizeof(gasAnimation*), 256, NULL, NULL, 0 },
+  { 4 * sizeof(gasAnimation*), 128, NULL, NULL, 0 },
+  { 8 * sizeof(gasAnimation*), 64, NULL, NULL, 0 },
+  { 16 * sizeof(gasAnimation*), 32, NULL, NULL, 0 }
+};
+
+static int _gasChildrenClass(unsigned int const numChildren)
+{
+  int c = 0;
+  unsigned int size = 2;
+  while (size < numChildren)
+  {
+    size *= 2;
+    c += 1;
+  }
+  return c;
+}
+
+static void* _gasSharedPoolAlloc(_gasPool* pool)
+{
+  pthread_mutex_lock(&poolMutex);
+  void* block = _gasPoolAlloc(pool);
+  pthread_mutex_unlock(&poolMutex);
+  return block;
+}
+
+static void _gasSharedPoolRelease(_gasPool* pool, void* block)
+{
+  pthread_mutex_lock(&poolMutex);
+  _gasPoolRelease(pool, block);
+  pthread_mutex_unlock(&poolMutex);
+}
+
+gasAnimation* _gasAnimationAlloc()
+{
+  return _gasSharedPoolAlloc(&nodePool);
+}
+
+void _gasAnimationRelease(gasAnimation* animation)
+{
+  _gasSharedPoolRelease(&nodePool, animation);
+}
+
+_gasRotationAnimation* _gasRotationAnimationAlloc()
+{
+  return _gasSharedPoolAlloc(&rotationPool);
+}
+
+void _gasRotationAnimationRelease(_gasRotationAnimation* rotation)
+{
+  _gasSharedPoolRelease(&rotationPool, rotation);
+}
+
+gasAnimation** _gasChildrenAlloc(unsigned int const numChildren)
+{
+  if (numChildren == 0)
+    return NULL;
+
+  if (numChildren > GAS_MAX_POOLED_CHILDREN)
+    return calloc(numChildren, sizeof(gasAnimation*));
+
+  return _gasSharedPoolAlloc(&childrenPools[_gasChildrenClass(numChildren)]);
+}
+
+void _gasChildrenRelease(gasAnimation** children, unsigned int const numChildren)
+{
+  if (!children)
+    return;
+
+  if (numChildren > GAS_MAX_POOLED_CHILDREN)
+  {
+    free(children);
+    return;
+  }
+
+  _gasSharedPoolRelease(&childrenPools[_gasChildrenClass(numChildren)], children);
+}
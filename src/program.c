@@ -0,0 +1,1225 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Compiled animation programs
+ *
+ * A tree is lowered into one block holding the program header, a pre-order
+ * instruction array, the extras table and the state block instances start
+ * from. The interpreter mirrors _gasAnimate and friends node for node so a
+ * compiled animation behaves exactly like the tree it was compiled from.
+ * Steps run the tree's step functions on a copy of the
+ * definition loaded with the instance's time and captured values, so the
+ * program itself is only ever read and any number of instances, on any
+ * threads, can share it. */
+
+static void _gasProgramMeasure(gasAnimation* animation, unsigned int* numInstructions, unsigned int* numExtras)
+{
+  *numInstructions += 1;
+
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        _gasProgramMeasure(animation->sequentialAnimation.children[i], numInstructions, numExtras);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        _gasProgramMeasure(animation->parallelAnimation.children[i], numInstructions, numExtras);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    case GAS_ANIMATION_TYPE_ACTION:
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    case GAS_ANIMATION_TYPE_VECTOR:
+    case GAS_ANIMATION_TYPE_ROTATION:
+    case GAS_ANIMATION_TYPE_TRACK:
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      *numExtras += 1;
+      break;
+    }
+    default: break;
+  }
+}
+
+static _gasProgram* _gasProgramAlloc(unsigned int const numInstructions, unsigned int const numExtras)
+{
+  size_t const stateSize = numInstructions * sizeof(_gasInstructionState) + numExtras * sizeof(_gasExtraState);
+  size_t const size = sizeof(_gasProgram) + numInstructions * sizeof(_gasInstruction)
+      + numExtras * sizeof(_gasProgramExtra) + stateSize;
+  char* block = malloc(size);
+
+  _gasProgram* program = (_gasProgram*) block;
+  program->size = size;
+  program->stateSize = stateSize;
+  program->references = 1;
+  program->numInstructions = numInstructions;
+  program->numExtras = numExtras;
+  program->instructions = (_gasInstruction*) (block + sizeof(_gasProgram));
+  program->extras = (_gasProgramExtra*) (program->instructions + numInstructions);
+  program->states = (_gasInstructionState*) (program->extras + numExtras);
+  program->sampler = NULL;
+  return program;
+}
+
+static _gasExtraState* _gasProgramExtraStates(_gasProgram* program, _gasInstructionState const* states)
+{
+  return (_gasExtraState*) (states + program->numInstructions);
+}
+
+/* FROM animations capture where they end, TO and DELTA where they start */
+static gasBoolean _gasProgramCapturesB(_gasNumberAnimationType const type)
+{
+  return type == GAS_NUMBER_ANIMATION_TYPE_FROM ? GAS_TRUE : GAS_FALSE;
+}
+
+static unsigned int _gasProgramEmit(_gasProgram* program, gasAnimation* animation, unsigned int* numInstructions,
+                                    unsigned int* numExtras)
+{
+  unsigned int const index = (*numInstructions)++;
+  _gasInstruction* instruction = &program->instructions[index];
+  _gasInstructionState* state = &program->states[index];
+  _gasExtraState* extraStates = _gasProgramExtraStates(program, program->states);
+  instruction->type = animation->type;
+  instruction->loops = animation->loops;
+  state->state = animation->state;
+  state->loop = animation->loop;
+
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER:
+    {
+      _gasNumberAnimation const* number = &animation->numberAnimation;
+      instruction->numberAnimation = *number;
+      instruction->numberAnimation.time = 0.0f;
+      state->numberAnimation.time = number->time;
+      state->numberAnimation.captured = _gasProgramCapturesB(number->type) ? number->b : number->a;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PAUSE:
+    {
+      instruction->pauseAnimation = animation->pauseAnimation;
+      instruction->pauseAnimation.time = 0.0f;
+      state->pauseAnimation.time = animation->pauseAnimation.time;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      unsigned int const numChildren = animation->sequentialAnimation.numChildren;
+      instruction->sequentialAnimation.numChildren = numChildren;
+      state->sequentialAnimation.currentIndex = animation->sequentialAnimation.currentIndex;
+      state->sequentialAnimation.currentChild = index + 1;
+
+      for (i = 0; i < numChildren; ++i)
+      {
+        unsigned int const child = _gasProgramEmit(program, animation->sequentialAnimation.children[i],
+                                                   numInstructions, numExtras);
+        if (i == animation->sequentialAnimation.currentIndex)
+        {
+          program->states[index].sequentialAnimation.currentChild = child;
+        }
+      }
+
+      if (animation->sequentialAnimation.currentIndex >= numChildren)
+      {
+        program->states[index].sequentialAnimation.currentChild = *numInstructions;
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      instruction->parallelAnimation.numChildren = animation->parallelAnimation.numChildren;
+      instruction->parallelAnimation.overlapping = animation->parallelAnimation.overlapping;
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        _gasProgramEmit(program, animation->parallelAnimation.children[i], numInstructions, numExtras);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      _gasProgramExtra* extra = &program->extras[*numExtras];
+      _gasExtraState* extraState = &extraStates[*numExtras];
+      instruction->extra = (*numExtras)++;
+      extra->modelAnimation = animation->modelAnimation;
+      extra->modelAnimation.binding = NULL;
+      extraState->modelAnimation.time = animation->modelAnimation.time;
+      extraState->modelAnimation.minStep = animation->modelAnimation.minStep;
+      extraState->modelAnimation.binding = NULL;
+      extraState->modelAnimation.frames = animation->modelAnimation.frames;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      _gasProgramExtra* extra = &program->extras[*numExtras];
+      _gasExtraState* extraState = &extraStates[*numExtras];
+      instruction->extra = (*numExtras)++;
+      extra->action = animation->action;
+      extra->action.userdata = NULL;
+      extraState->userdata = animation->action.userdata;
+      if (animation->action.cloneCallback)
+      {
+        extraState->userdata = animation->action.cloneCallback(animation->action.userdata);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    {
+      _gasProgramExtra* extra = &program->extras[*numExtras];
+      _gasExtraState* extraState = &extraStates[*numExtras];
+      instruction->extra = (*numExtras)++;
+      extra->customAnimation = animation->customAnimation;
+      extra->customAnimation.userdata = NULL;
+      extraState->userdata = animation->customAnimation.userdata;
+      if (animation->customAnimation.cloneCallback)
+      {
+        extraState->userdata = animation->customAnimation.cloneCallback(animation->customAnimation.userdata);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_VECTOR:
+    {
+      _gasVectorAnimation const* vector = &animation->vectorAnimation;
+      _gasExtraState* extraState = &extraStates[*numExtras];
+      instruction->extra = (*numExtras)++;
+      program->extras[instruction->extra].vectorAnimation = *vector;
+      program->extras[instruction->extra].vectorAnimation.time = 0.0f;
+      extraState->vectorAnimation.time = vector->time;
+      extraState->vectorAnimation.captured = _gasProgramCapturesB(vector->type) ? vector->b : vector->a;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      _gasRotationAnimation const* rotation = animation->rotationAnimation;
+      _gasExtraState* extraState = &extraStates[*numExtras];
+      instruction->extra = (*numExtras)++;
+      program->extras[instruction->extra].rotationAnimation = *rotation;
+      program->extras[instruction->extra].rotationAnimation.time = 0.0f;
+      extraState->rotationAnimation.time = rotation->time;
+      extraState->rotationAnimation.captured = _gasProgramCapturesB(rotation->type) ? rotation->b : rotation->a;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      _gasTrackAnimation const* track = &animation->trackAnimation;
+      _gasExtraState* extraState = &extraStates[*numExtras];
+      instruction->extra = (*numExtras)++;
+      program->extras[instruction->extra].trackAnimation = *track;
+      program->extras[instruction->extra].trackAnimation.time = 0.0f;
+      program->extras[instruction->extra].trackAnimation.cursor = 0;
+      _gasTrackKeysRetain(track->keys);
+      extraState->trackAnimation.time = track->time;
+      extraState->trackAnimation.cursor = track->cursor;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      _gasPathAnimation const* path = &animation->pathAnimation;
+      _gasExtraState* extraState = &extraStates[*numExtras];
+      instruction->extra = (*numExtras)++;
+      program->extras[instruction->extra].pathAnimation = *path;
+      program->extras[instruction->extra].pathAnimation.time = 0.0f;
+      program->extras[instruction->extra].pathAnimation.cursor = 0;
+      _gasPathPointsRetain(path->points);
+      extraState->pathAnimation.time = path->time;
+      extraState->pathAnimation.cursor = path->cursor;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      /* Embedded programs stay opaque and carry their own loop state */
+      _gasExtraState* extraState = &extraStates[*numExtras];
+      instruction->extra = (*numExtras)++;
+      instruction->loops = 1;
+      state->loop = 0;
+      extraState->animation = gasAnimationClone(animation);
+      break;
+    }
+    default: assert(0);
+  }
+
+  _gasLoopInfo info;
+  instruction->end = *numInstructions;
+  instruction->loopDuration = _gasAnimationLoopInfo(animation, FLT_MAX, &info)
+      && (animation->type != GAS_ANIMATION_TYPE_PROGRAM || _gasLoopInfoRepeat(&info, animation->loops))
+      ? info.duration
+      : -1.0f;
+  return index;
+}
+
+_gasProgram* _gasProgramNew(gasAnimation* animation)
+{
+  unsigned int numInstructions = 0;
+  unsigned int numExtras = 0;
+  _gasProgramMeasure(animation, &numInstructions, &numExtras);
+
+  _gasProgram* program = _gasProgramAlloc(numInstructions, numExtras);
+
+  numInstructions = 0;
+  numExtras = 0;
+  _gasProgramEmit(program, animation, &numInstructions, &numExtras);
+
+  /* The root's loops are handled by the animation wrapping the program,
+   * except for an embedded root program which keeps its own */
+  gasBoolean const embedded = animation->type == GAS_ANIMATION_TYPE_PROGRAM;
+  program->state = animation->state;
+  program->loops = embedded ? 1 : animation->loops;
+  program->loop = embedded ? 0 : animation->loop;
+  program->instructions[0].loops = 1;
+  program->states[0].loop = 0;
+  return program;
+}
+
+void _gasProgramRetain(_gasProgram* program)
+{
+  __atomic_add_fetch(&program->references, 1, __ATOMIC_RELAXED);
+}
+
+void _gasProgramRelease(_gasProgram* program)
+{
+  if (__atomic_sub_fetch(&program->references, 1, __ATOMIC_ACQ_REL) != 0)
+    return;
+
+  _gasProgramStatesFinalize(program, program->states);
+
+  unsigned int i;
+  for (i = 0; i < program->numInstructions; ++i)
+  {
+    _gasInstruction const* instruction = &program->instructions[i];
+    if (instruction->type == GAS_ANIMATION_TYPE_TRACK)
+    {
+      _gasTrackKeysRelease(program->extras[instruction->extra].trackAnimation.keys);
+    }
+    else if (instruction->type == GAS_ANIMATION_TYPE_PATH)
+    {
+      _gasPathPointsRelease(program->extras[instruction->extra].pathAnimation.points);
+    }
+  }
+
+  free(program->sampler);
+  free(program);
+}
+
+/* Copies a state block the way gasAnimationClone copies a tree: userdata is
+ * cloned through the clone callbacks, embedded animations are cloned and
+ * model animations are left to be bound on the next step */
+void _gasProgramStatesCopy(_gasProgram* program, _gasInstructionState* states, _gasInstructionState const* source)
+{
+  memcpy(states, source, program->stateSize);
+  if (program->numExtras == 0)
+    return;
+
+  _gasExtraState* extraStates = _gasProgramExtraStates(program, states);
+  _gasExtraState const* sourceExtras = _gasProgramExtraStates(program, source);
+  unsigned int i;
+  for (i = 0; i < program->numInstructions; ++i)
+  {
+    _gasInstruction const* instruction = &program->instructions[i];
+    unsigned int const extra = instruction->extra;
+    switch (instruction->type)
+    {
+      case GAS_ANIMATION_TYPE_MODEL:
+      {
+        extraStates[extra].modelAnimation.binding = NULL;
+        break;
+      }
+      case GAS_ANIMATION_TYPE_ACTION:
+      {
+        _gasAction const* action = &program->extras[extra].action;
+        if (action->cloneCallback)
+        {
+          extraStates[extra].userdata = action->cloneCallback(sourceExtras[extra].userdata);
+        }
+        break;
+      }
+      case GAS_ANIMATION_TYPE_CUSTOM:
+      {
+        _gasCustomAnimation const* custom = &program->extras[extra].customAnimation;
+        if (custom->cloneCallback)
+        {
+          extraStates[extra].userdata = custom->cloneCallback(sourceExtras[extra].userdata);
+        }
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PROGRAM:
+      {
+        extraStates[extra].animation = gasAnimationClone(sourceExtras[extra].animation);
+        break;
+      }
+      default: break;
+    }
+  }
+}
+
+void _gasProgramStatesFinalize(_gasProgram* program, _gasInstructionState* states)
+{
+  if (program->numExtras == 0)
+    return;
+
+  _gasExtraState* extraStates = _gasProgramExtraStates(program, states);
+  unsigned int i;
+  for (i = 0; i < program->numInstructions; ++i)
+  {
+    _gasInstruction const* instruction = &program->instructions[i];
+    unsigned int const extra = instruction->extra;
+    switch (instruction->type)
+    {
+      case GAS_ANIMATION_TYPE_MODEL:
+      {
+        if (extraStates[extra].modelAnimation.binding)
+        {
+          _gasModelBindingRelease(extraStates[extra].modelAnimation.binding);
+        }
+        break;
+      }
+      case GAS_ANIMATION_TYPE_ACTION:
+      {
+        _gasAction const* action = &program->extras[extra].action;
+        if (action->freeCallback)
+        {
+          _gasTransformStageFlush();
+          action->freeCallback(extraStates[extra].userdata);
+        }
+        break;
+      }
+      case GAS_ANIMATION_TYPE_CUSTOM:
+      {
+        _gasCustomAnimation const* custom = &program->extras[extra].customAnimation;
+        if (custom->freeCallback)
+        {
+          _gasTransformStageFlush();
+          custom->freeCallback(extraStates[extra].userdata);
+        }
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PROGRAM:
+      {
+        gasAnimationFree(extraStates[extra].animation);
+        break;
+      }
+      default: break;
+    }
+  }
+}
+
+static void _gasProgramResetInstruction(_gasProgram* program, _gasInstructionState* states, unsigned int const index)
+{
+  _gasInstruction const* instruction = &program->instructions[index];
+  _gasInstructionState* state = &states[index];
+  _gasExtraState* extraStates = _gasProgramExtraStates(program, states);
+  unsigned int const extra = instruction->extra;
+  state->state = GAS_ANIMATION_STATE_NOT_STARTED;
+
+  switch (instruction->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER: state->numberAnimation.time = 0.0f; break;
+    case GAS_ANIMATION_TYPE_PAUSE: state->pauseAnimation.time = 0.0f; break;
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      state->sequentialAnimation.currentIndex = 0;
+      state->sequentialAnimation.currentChild = index + 1;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL: break;
+    case GAS_ANIMATION_TYPE_MODEL: extraStates[extra].modelAnimation.time = 0.0f; break;
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      _gasAction const* action = &program->extras[extra].action;
+      if (action->resetCallback)
+      {
+        _gasTransformStageFlush();
+        action->resetCallback(extraStates[extra].userdata);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    {
+      _gasCustomAnimation const* custom = &program->extras[extra].customAnimation;
+      if (custom->resetCallback)
+      {
+        _gasTransformStageFlush();
+        custom->resetCallback(extraStates[extra].userdata);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM: gasAnimationReset(extraStates[extra].animation); break;
+    case GAS_ANIMATION_TYPE_VECTOR: extraStates[extra].vectorAnimation.time = 0.0f; break;
+    case GAS_ANIMATION_TYPE_ROTATION: extraStates[extra].rotationAnimation.time = 0.0f; break;
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      extraStates[extra].trackAnimation.time = 0.0f;
+      extraStates[extra].trackAnimation.cursor = 0;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      extraStates[extra].pathAnimation.time = 0.0f;
+      extraStates[extra].pathAnimation.cursor = 0;
+      break;
+    }
+    default: assert(0);
+  }
+}
+
+/* Resetting a subtree is a linear sweep over its instructions: the subtree
+ * root keeps its loop counter, every descendant starts over from loop 0. */
+void _gasProgramResetCurrentLoop(_gasProgram* program, _gasInstructionState* states, unsigned int const index)
+{
+  _gasProgramResetInstruction(program, states, index);
+
+  unsigned int const end = program->instructions[index].end;
+  unsigned int i;
+  for (i = index + 1; i < end; ++i)
+  {
+    states[i].loop = 0;
+    _gasProgramResetInstruction(program, states, i);
+  }
+}
+
+static float _gasProgramNumberStep(_gasNumberAnimation const* definition, _gasInstructionState* state,
+                                   glhckObject* object, float const delta)
+{
+  _gasNumberAnimation number = *definition;
+  number.time = state->numberAnimation.time;
+  if (_gasProgramCapturesB(number.type))
+    number.b = state->numberAnimation.captured;
+  else
+    number.a = state->numberAnimation.captured;
+
+  float const left = _gasNumberAnimationStep(&number, &state->state, object, delta);
+  state->numberAnimation.time = number.time;
+  state->numberAnimation.captured = _gasProgramCapturesB(number.type) ? number.b : number.a;
+  return left;
+}
+
+static float _gasProgramVectorStep(_gasVectorAnimation const* definition, _gasExtraState* extraState,
+                                   gasAnimationState* state, glhckObject* object, float const delta)
+{
+  _gasVectorAnimation vector = *definition;
+  vector.time = extraState->vectorAnimation.time;
+  if (_gasProgramCapturesB(vector.type))
+    vector.b = extraState->vectorAnimation.captured;
+  else
+    vector.a = extraState->vectorAnimation.captured;
+
+  float const left = _gasVectorAnimationStep(&vector, state, object, delta);
+  extraState->vectorAnimation.time = vector.time;
+  extraState->vectorAnimation.captured = _gasProgramCapturesB(vector.type) ? vector.b : vector.a;
+  return left;
+}
+
+static float _gasProgramRotationStep(_gasRotationAnimation const* definition, _gasExtraState* extraState,
+                                     gasAnimationState* state, glhckObject* object, float const delta)
+{
+  _gasRotationAnimation rotation = *definition;
+  rotation.time = extraState->rotationAnimation.time;
+  if (_gasProgramCapturesB(rotation.type))
+    rotation.b = extraState->rotationAnimation.captured;
+  else
+    rotation.a = extraState->rotationAnimation.captured;
+
+  float const left = _gasRotationAnimationStep(&rotation, state, object, delta);
+  extraState->rotationAnimation.time = rotation.time;
+  extraState->rotationAnimation.captured = _gasProgramCapturesB(rotation.type) ? rotation.b : rotation.a;
+  return left;
+}
+
+static float _gasProgramTrackStep(_gasTrackAnimation const* definition, _gasExtraState* extraState,
+                                  gasAnimationState* state, glhckObject* object, float const delta)
+{
+  _gasTrackAnimation track = *definition;
+  track.time = extraState->trackAnimation.time;
+  track.cursor = extraState->trackAnimation.cursor;
+
+  float const left = _gasTrackAnimationStep(&track, state, object, delta);
+  extraState->trackAnimation.time = track.time;
+  extraState->trackAnimation.cursor = track.cursor;
+  return left;
+}
+
+static float _gasProgramPathStep(_gasPathAnimation const* definition, _gasExtraState* extraState,
+                                 gasAnimationState* state, glhckObject* object, float const delta)
+{
+  _gasPathAnimation path = *definition;
+  path.time = extraState->pathAnimation.time;
+  path.cursor = extraState->pathAnimation.cursor;
+
+  float const left = _gasPathAnimationStep(&path, state, object, delta);
+  extraState->pathAnimation.time = path.time;
+  extraState->pathAnimation.cursor = path.cursor;
+  return left;
+}
+
+static float _gasProgramModelStep(_gasModelAnimation const* definition, _gasExtraState* extraState,
+                                  gasAnimationState* state, glhckObject* object, float const delta)
+{
+  _gasModelAnimation model = *definition;
+  model.time = extraState->modelAnimation.time;
+  model.binding = extraState->modelAnimation.binding;
+  model.minStep = extraState->modelAnimation.minStep;
+  model.frames = extraState->modelAnimation.frames;
+
+  float const left = _gasModelAnimationStep(&model, state, object, delta);
+  extraState->modelAnimation.time = model.time;
+  extraState->modelAnimation.binding = model.binding;
+  return left;
+}
+
+static gasBoolean _gasProgramChildLoopInfo(_gasProgram* program, _gasInstructionState* states, unsigned int const child,
+                                           float const limit, _gasLoopInfo* info)
+{
+  return _gasProgramLoopInfo(program, states, child, limit, info)
+      && _gasLoopInfoRepeat(info, program->instructions[child].loops)
+      && info->duration <= limit
+      ? GAS_TRUE
+      : GAS_FALSE;
+}
+
+/* Mirrors _gasAnimationLoopInfo. Instructions whose loops are known not to
+ * be skippable, or to be too long, give up before looking at children. */
+gasBoolean _gasProgramLoopInfo(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                               float const limit, _gasLoopInfo* info)
+{
+  _gasInstruction const* instruction = &program->instructions[index];
+  if (instruction->loopDuration < 0.0f || instruction->loopDuration > limit)
+    return GAS_FALSE;
+
+  memset(info, 0, sizeof(_gasLoopInfo));
+
+  unsigned int child = index + 1;
+  unsigned int i;
+  switch (instruction->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER:
+    {
+      if (!_gasLoopInfoNumber(info, &instruction->numberAnimation))
+        return GAS_FALSE;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_VECTOR:
+    {
+      if (!_gasLoopInfoVector(info, &program->extras[instruction->extra].vectorAnimation))
+        return GAS_FALSE;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      if (!_gasLoopInfoRotation(info, &program->extras[instruction->extra].rotationAnimation))
+        return GAS_FALSE;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK: _gasLoopInfoTrack(info, &program->extras[instruction->extra].trackAnimation); break;
+    case GAS_ANIMATION_TYPE_PATH: _gasLoopInfoPath(info, &program->extras[instruction->extra].pathAnimation); break;
+    case GAS_ANIMATION_TYPE_PAUSE: _gasLoopInfoPause(info, instruction->pauseAnimation.duration); break;
+    case GAS_ANIMATION_TYPE_ACTION: info->actions = GAS_TRUE; break;
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = 0; i < instruction->sequentialAnimation.numChildren; ++i)
+      {
+        _gasLoopInfo childInfo;
+        if (!_gasProgramChildLoopInfo(program, states, child, limit - info->duration, &childInfo))
+          return GAS_FALSE;
+        _gasLoopInfoAppend(info, &childInfo);
+        child = program->instructions[child].end;
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for (i = 0; i < instruction->parallelAnimation.numChildren; ++i)
+      {
+        _gasLoopInfo childInfo;
+        if (!_gasProgramChildLoopInfo(program, states, child, limit, &childInfo)
+            || !_gasLoopInfoMerge(info, &childInfo))
+          return GAS_FALSE;
+        child = program->instructions[child].end;
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      gasAnimation* embedded = _gasProgramExtraStates(program, states)[instruction->extra].animation;
+      return _gasAnimationLoopInfo(embedded, limit, info)
+          && _gasLoopInfoRepeat(info, embedded->loops)
+          && info->duration <= limit
+          ? GAS_TRUE
+          : GAS_FALSE;
+    }
+    default: return GAS_FALSE;
+  }
+
+  return info->duration <= limit ? GAS_TRUE : GAS_FALSE;
+}
+
+static void _gasProgramFireSkipped(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                                   glhckObject* object, float const left, gasBoolean const last)
+{
+  int const loops = program->instructions[index].loops;
+  int i;
+  for (i = 0; i < loops; ++i)
+  {
+    if (i > 0)
+    {
+      _gasProgramResetCurrentLoop(program, states, index);
+    }
+    _gasProgramFireSkippedLoop(program, states, index, object, left, last && i + 1 == loops ? GAS_TRUE : GAS_FALSE);
+  }
+}
+
+/* Mirrors _gasAnimationFireSkipped for one loop of an instruction */
+void _gasProgramFireSkippedLoop(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                                glhckObject* object, float const left, gasBoolean const last)
+{
+  _gasInstruction const* instruction = &program->instructions[index];
+  _gasExtraState* extraStates = _gasProgramExtraStates(program, states);
+  unsigned int child = index + 1;
+  unsigned int i;
+  switch (instruction->type)
+  {
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      _gasAction action = program->extras[instruction->extra].action;
+      if (!action.fireOnce || last)
+      {
+        gasAnimationState state;
+        action.userdata = extraStates[instruction->extra].userdata;
+        _gasActionStep(&action, &state, object, left);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      unsigned int const numChildren = instruction->type == GAS_ANIMATION_TYPE_SEQUENTIAL
+          ? instruction->sequentialAnimation.numChildren
+          : instruction->parallelAnimation.numChildren;
+      for (i = 0; i < numChildren; ++i)
+      {
+        _gasProgramFireSkipped(program, states, child, object, left, last);
+        child = program->instructions[child].end;
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      _gasAnimationFireSkipped(extraStates[instruction->extra].animation, object, left, last);
+      break;
+    }
+    default: break;
+  }
+}
+
+/* Mirrors _gasAnimationSkipLoops */
+static gasBoolean _gasProgramSkipLoops(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                                       glhckObject* object, gasBoolean const ended, float* left)
+{
+  _gasInstruction const* instruction = &program->instructions[index];
+  if (instruction->loops == 1 || _gasLoopSkipSuspended())
+    return GAS_FALSE;
+
+  _gasLoopInfo info;
+  if (!_gasProgramLoopInfo(program, states, index, *left, &info) || info.duration <= 0.0f
+      || (info.absolute && !ended))
+    return GAS_FALSE;
+
+  _gasInstructionState* state = &states[index];
+  unsigned int const count = _gasLoopSkipCount(info.duration, state->loop, instruction->loops, *left);
+  if (count == 0)
+    return GAS_FALSE;
+
+  if (info.actions)
+  {
+    unsigned int i;
+    for (i = 0; i < count; ++i)
+    {
+      _gasLoopInfoApply(&info, object, 1);
+      _gasProgramFireSkippedLoop(program, states, index, object, *left - (float) (i + 1) * info.duration,
+                                 i + 1 == count ? GAS_TRUE : GAS_FALSE);
+      if (instruction->loops == -1 || state->loop + (int) i + 1 < instruction->loops)
+        _gasProgramResetCurrentLoop(program, states, index);
+    }
+  }
+  else
+  {
+    _gasLoopInfoApply(&info, object, count);
+  }
+
+  if (instruction->loops != -1)
+  {
+    state->loop += count;
+    if (state->loop >= instruction->loops)
+      state->state = GAS_ANIMATION_STATE_FINISHED;
+  }
+  *left -= (float) count * info.duration;
+  return GAS_TRUE;
+}
+
+/* Mirrors gasModelAnimationBind */
+gasBoolean _gasProgramBind(_gasProgram* program, _gasInstructionState* states, glhckObject* object)
+{
+  if (program->numExtras == 0)
+    return GAS_TRUE;
+
+  _gasExtraState* extraStates = _gasProgramExtraStates(program, states);
+  gasBoolean bound = GAS_TRUE;
+  unsigned int i;
+  for (i = 0; i < program->numInstructions; ++i)
+  {
+    _gasInstruction const* instruction = &program->instructions[i];
+    _gasExtraState* extraState = &extraStates[instruction->extra];
+    if (instruction->type == GAS_ANIMATION_TYPE_MODEL)
+    {
+      if (!extraState->modelAnimation.binding)
+      {
+        extraState->modelAnimation.binding =
+            _gasModelBindingAcquire(program->extras[instruction->extra].modelAnimation.name, object);
+      }
+      bound &= extraState->modelAnimation.binding != NULL;
+    }
+    else if (instruction->type == GAS_ANIMATION_TYPE_PROGRAM)
+    {
+      bound &= gasModelAnimationBind(extraState->animation, object);
+    }
+  }
+  return bound;
+}
+
+/* Mirrors gasModelAnimationUpdateRate */
+void _gasProgramUpdateRate(_gasProgram* program, _gasInstructionState* states, unsigned int const frames,
+                           float const minStep)
+{
+  if (program->numExtras == 0)
+    return;
+
+  _gasExtraState* extraStates = _gasProgramExtraStates(program, states);
+  unsigned int i;
+  for (i = 0; i < program->numInstructions; ++i)
+  {
+    _gasInstruction const* instruction = &program->instructions[i];
+    _gasExtraState* extraState = &extraStates[instruction->extra];
+    if (instruction->type == GAS_ANIMATION_TYPE_MODEL)
+    {
+      extraState->modelAnimation.frames = frames > 0 ? frames : 1;
+      extraState->modelAnimation.minStep = minStep > 0.0f ? minStep : 0.0f;
+    }
+    else if (instruction->type == GAS_ANIMATION_TYPE_PROGRAM)
+    {
+      gasModelAnimationUpdateRate(extraState->animation, frames, minStep);
+    }
+  }
+}
+
+/* Mirrors _gasSerialWriteTree. Instructions are in pre-order already, and
+ * the root loops as the animation running the program does. An embedded
+ * root program keeps its own loops, so looping it again takes a sequence
+ * around it. */
+void _gasProgramSerialize(_gasProgram* program, _gasInstructionState* states, int const loops,
+                          _gasSerialWriter* writer)
+{
+  _gasExtraState* extraStates = _gasProgramExtraStates(program, states);
+  unsigned int i;
+  for (i = 0; i < program->numInstructions; ++i)
+  {
+    _gasInstruction const* instruction = &program->instructions[i];
+    unsigned char const type = instruction->type;
+    int const instructionLoops = i == 0 ? loops : instruction->loops;
+    switch (type)
+    {
+      case GAS_ANIMATION_TYPE_NUMBER:
+      {
+        _gasSerialWriteNode(writer, type, instructionLoops, &instruction->numberAnimation, NULL, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PAUSE:
+      {
+        _gasSerialWriteNode(writer, type, instructionLoops, &instruction->pauseAnimation, NULL, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_SEQUENTIAL:
+      {
+        _gasSerialWriteNode(writer, type, instructionLoops, NULL, NULL, instruction->sequentialAnimation.numChildren);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PARALLEL:
+      {
+        _gasSerialWriteNode(writer, type, instructionLoops, NULL, NULL, instruction->parallelAnimation.numChildren);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_MODEL:
+      {
+        _gasExtraState const* extraState = &extraStates[instruction->extra];
+        _gasModelAnimation model = program->extras[instruction->extra].modelAnimation;
+        model.frames = extraState->modelAnimation.frames;
+        model.minStep = extraState->modelAnimation.minStep;
+        _gasSerialWriteNode(writer, type, instructionLoops, &model, NULL, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_ACTION:
+      {
+        _gasProgramExtra const* extra = &program->extras[instruction->extra];
+        _gasSerialWriteNode(writer, type, instructionLoops, &extra->action, extraStates[instruction->extra].userdata, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_CUSTOM:
+      {
+        _gasProgramExtra const* extra = &program->extras[instruction->extra];
+        _gasSerialWriteNode(writer, type, instructionLoops, &extra->customAnimation,
+                            extraStates[instruction->extra].userdata, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_VECTOR:
+      {
+        _gasProgramExtra const* extra = &program->extras[instruction->extra];
+        _gasSerialWriteNode(writer, type, instructionLoops, &extra->vectorAnimation, NULL, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_ROTATION:
+      {
+        _gasProgramExtra const* extra = &program->extras[instruction->extra];
+        _gasSerialWriteNode(writer, type, instructionLoops, &extra->rotationAnimation, NULL, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_TRACK:
+      {
+        _gasProgramExtra const* extra = &program->extras[instruction->extra];
+        _gasSerialWriteNode(writer, type, instructionLoops, &extra->trackAnimation, NULL, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PATH:
+      {
+        _gasProgramExtra const* extra = &program->extras[instruction->extra];
+        _gasSerialWriteNode(writer, type, instructionLoops, &extra->pathAnimation, NULL, 0);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PROGRAM:
+      {
+        if (instructionLoops != 1)
+        {
+          _gasSerialWriteNode(writer, GAS_ANIMATION_TYPE_SEQUENTIAL, instructionLoops, NULL, NULL, 1);
+        }
+        _gasSerialWriteTree(writer, extraStates[instruction->extra].animation);
+        break;
+      }
+      default: assert(0);
+    }
+  }
+}
+
+/* Mirrors _gasAnimationIdle */
+float _gasProgramIdle(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                      gasBoolean* through)
+{
+  _gasInstruction const* instruction = &program->instructions[index];
+  _gasInstructionState* state = &states[index];
+
+  *through = GAS_TRUE;
+  if (state->state == GAS_ANIMATION_STATE_FINISHED || (instruction->loops <= state->loop && instruction->loops != -1))
+    return 0.0f;
+
+  float idle = 0.0f;
+  gasBoolean childThrough;
+  unsigned int child = index + 1;
+  unsigned int i;
+  switch (instruction->type)
+  {
+    case GAS_ANIMATION_TYPE_PAUSE:
+    {
+      idle = instruction->pauseAnimation.duration - state->pauseAnimation.time;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      child = state->sequentialAnimation.currentChild;
+      for (i = state->sequentialAnimation.currentIndex; i < instruction->sequentialAnimation.numChildren && *through; ++i)
+      {
+        idle += _gasProgramIdle(program, states, child, through);
+        child = program->instructions[child].end;
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      idle = INFINITY;
+      for (i = 0; i < instruction->parallelAnimation.numChildren; ++i)
+      {
+        _gasInstruction const* childInstruction = &program->instructions[child];
+        if (states[child].state != GAS_ANIMATION_STATE_FINISHED
+            && (childInstruction->loops > states[child].loop || childInstruction->loops == -1))
+        {
+          float const childIdle = _gasProgramIdle(program, states, child, &childThrough);
+          idle = childIdle < idle ? childIdle : idle;
+        }
+        child = childInstruction->end;
+      }
+      *through = GAS_FALSE;
+      return idle < INFINITY ? idle : 0.0f;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      idle = _gasAnimationIdle(_gasProgramExtraStates(program, states)[instruction->extra].animation, through);
+      break;
+    }
+    default:
+    {
+      *through = GAS_FALSE;
+      return 0.0f;
+    }
+  }
+
+  if (instruction->loops == -1 || state->loop + 1 < instruction->loops)
+    *through = GAS_FALSE;
+
+  return idle;
+}
+
+/* Mirrors _gasSamplerEmit. Embedded programs are sampled from the
+ * animations the program's own state block holds. */
+static void _gasProgramSamplerEmit(_gasProgram* program, _gasSampler* sampler, unsigned int const index,
+                                   unsigned int* numChildren)
+{
+  _gasInstruction const* instruction = &program->instructions[index];
+  _gasExtraState const* extraStates = _gasProgramExtraStates(program, program->states);
+  _gasSampleNode* node = &sampler->nodes[index];
+  node->type = instruction->type;
+  node->loops = instruction->loops;
+  node->numChildren = 0;
+  node->definition = NULL;
+
+  gasBoolean overlapping = GAS_FALSE;
+  switch (instruction->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER: node->definition = &instruction->numberAnimation; break;
+    case GAS_ANIMATION_TYPE_PAUSE: node->definition = &instruction->pauseAnimation; break;
+    case GAS_ANIMATION_TYPE_VECTOR: node->definition = &program->extras[instruction->extra].vectorAnimation; break;
+    case GAS_ANIMATION_TYPE_ROTATION: node->definition = &program->extras[instruction->extra].rotationAnimation; break;
+    case GAS_ANIMATION_TYPE_TRACK: node->definition = &program->extras[instruction->extra].trackAnimation; break;
+    case GAS_ANIMATION_TYPE_PATH: node->definition = &program->extras[instruction->extra].pathAnimation; break;
+    case GAS_ANIMATION_TYPE_MODEL: node->definition = &program->extras[instruction->extra].modelAnimation; break;
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      node->definition = extraStates[instruction->extra].animation;
+      node->loops = extraStates[instruction->extra].animation->loops;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL: node->numChildren = instruction->sequentialAnimation.numChildren; break;
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      node->numChildren = instruction->parallelAnimation.numChildren;
+      overlapping = instruction->parallelAnimation.overlapping;
+      break;
+    }
+    default: break;
+  }
+
+  node->children = *numChildren;
+  *numChildren += node->numChildren;
+
+  unsigned int child = index + 1;
+  unsigned int i;
+  for (i = 0; i < node->numChildren; ++i)
+  {
+    sampler->children[node->children + i] = child;
+    _gasProgramSamplerEmit(program, sampler, child, numChildren);
+    child = program->instructions[child].end;
+  }
+
+  _gasSampleNodeFinish(sampler, index, overlapping);
+}
+
+/* Built on first use. Threads building it at once publish only the first
+ * one and free the rest. */
+_gasSampler* _gasProgramSampler(_gasProgram* program)
+{
+  _gasSampler* sampler = __atomic_load_n(&program->sampler, __ATOMIC_ACQUIRE);
+  if (sampler)
+    return sampler;
+
+  unsigned int numChildren = 0;
+  unsigned int i;
+  for (i = 0; i < program->numInstructions; ++i)
+  {
+    _gasInstruction const* instruction = &program->instructions[i];
+    if (instruction->type == GAS_ANIMATION_TYPE_SEQUENTIAL)
+      numChildren += instruction->sequentialAnimation.numChildren;
+    else if (instruction->type == GAS_ANIMATION_TYPE_PARALLEL)
+      numChildren += instruction->parallelAnimation.numChildren;
+  }
+
+  sampler = _gasSamplerAlloc(program->numInstructions, numChildren);
+  numChildren = 0;
+  _gasProgramSamplerEmit(program, sampler, 0, &numChildren);
+
+  _gasSampler* published = NULL;
+  if (!__atomic_compare_exchange_n(&program->sampler, &published, sampler, GAS_FALSE,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+  {
+    free(sampler);
+    sampler = published;
+  }
+  return sampler;
+}
+
+float _gasProgramAnimate(_gasProgram* program, _gasInstructionState* states, unsigned int const index,
+                         glhckObject* object, float const delta)
+{
+  _gasInstruction const* instruction = &program->instructions[index];
+  _gasInstructionState* state = &states[index];
+
+  if (state->state == GAS_ANIMATION_STATE_FINISHED)
+    return delta;
+
+  float left = delta;
+  gasBoolean ended = GAS_FALSE;
+
+  while ((instruction->loops > state->loop || instruction->loops == -1) && left > 0)
+  {
+    if (state->state == GAS_ANIMATION_STATE_NOT_STARTED
+        && _gasProgramSkipLoops(program, states, index, object, ended, &left))
+      continue;
+
+    float const before = left;
+    gasBoolean const started = state->state == GAS_ANIMATION_STATE_NOT_STARTED;
+    _gasExtraState* extraStates = _gasProgramExtraStates(program, states);
+    switch (instruction->type)
+    {
+      case GAS_ANIMATION_TYPE_NUMBER:
+      {
+        left = _gasProgramNumberStep(&instruction->numberAnimation, state, object, left);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PAUSE:
+      {
+        _gasPauseAnimation pause = { instruction->pauseAnimation.duration, state->pauseAnimation.time };
+        left = _gasPauseAnimationStep(&pause, &state->state, left);
+        state->pauseAnimation.time = pause.time;
+        break;
+      }
+      case GAS_ANIMATION_TYPE_SEQUENTIAL:
+      {
+        while (left > 0 && state->sequentialAnimation.currentIndex < instruction->sequentialAnimation.numChildren)
+        {
+          unsigned int const child = state->sequentialAnimation.currentChild;
+          left = _gasProgramAnimate(program, states, child, object, left);
+
+          if (left > 0)
+          {
+            state->sequentialAnimation.currentIndex += 1;
+            state->sequentialAnimation.currentChild = program->instructions[child].end;
+          }
+        }
+
+        state->state = state->sequentialAnimation.currentIndex >= instruction->sequentialAnimation.numChildren
+            ? GAS_ANIMATION_STATE_FINISHED
+            : GAS_ANIMATION_STATE_RUNNING;
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PARALLEL:
+      {
+        float minLeft = before;
+        if (instruction->parallelAnimation.overlapping)
+          _gasLoopSkipSuspend();
+
+        unsigned int child = index + 1;
+        unsigned int i;
+        for (i = 0; i < instruction->parallelAnimation.numChildren; ++i)
+        {
+          float const childLeft = _gasProgramAnimate(program, states, child, object, before);
+          minLeft = childLeft < minLeft ? childLeft : minLeft;
+          child = program->instructions[child].end;
+        }
+
+        if (instruction->parallelAnimation.overlapping)
+          _gasLoopSkipResume();
+
+        state->state = minLeft > 0
+            ? GAS_ANIMATION_STATE_FINISHED
+            : GAS_ANIMATION_STATE_RUNNING;
+        left = minLeft;
+        break;
+      }
+      case GAS_ANIMATION_TYPE_MODEL:
+      {
+        left = _gasProgramModelStep(&program->extras[instruction->extra].modelAnimation,
+                                    &extraStates[instruction->extra], &state->state, object, left);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_ACTION:
+      {
+        _gasAction action = program->extras[instruction->extra].action;
+        action.userdata = extraStates[instruction->extra].userdata;
+        left = _gasActionStep(&action, &state->state, object, left);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_CUSTOM:
+      {
+        _gasCustomAnimation custom = program->extras[instruction->extra].customAnimation;
+        custom.userdata = extraStates[instruction->extra].userdata;
+        left = _gasCustomAnimationStep(&custom, &state->state, object, left);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_VECTOR:
+      {
+        left = _gasProgramVectorStep(&program->extras[instruction->extra].vectorAnimation,
+                                     &extraStates[instruction->extra], &state->state, object, left);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_ROTATION:
+      {
+        left = _gasProgramRotationStep(&program->extras[instruction->extra].rotationAnimation,
+                                       &extraStates[instruction->extra], &state->state, object, left);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_TRACK:
+      {
+        left = _gasProgramTrackStep(&program->extras[instruction->extra].trackAnimation,
+                                    &extraStates[instruction->extra], &state->state, object, left);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PATH:
+      {
+        left = _gasProgramPathStep(&program->extras[instruction->extra].pathAnimation,
+                                   &extraStates[instruction->extra], &state->state, object, left);
+        break;
+      }
+      case GAS_ANIMATION_TYPE_PROGRAM:
+      {
+        gasAnimation* embedded = extraStates[instruction->extra].animation;
+        left = _gasAnimate(embedded, object, left);
+        state->state = embedded->state;
+        break;
+      }
+      default: assert(0);
+    }
+
+    if (state->state == GAS_ANIMATION_STATE_FINISHED)
+    {
+      state->loop += 1;
+      ended = GAS_TRUE;
+      if (instruction->loops > state->loop || instruction->loops == -1)
+      {
+        _gasProgramResetCurrentLoop(program, states, index);
+
+        if (instruction->loops == -1 && started && left >= before)
+          left = 0.0f;
+      }
+    }
+  }
+
+  return left;
+}
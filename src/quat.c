@@ -0,0 +1,119 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <math.h>
+
+/* Quaternion helpers for rotation animations
+ *
+ * Orientations convert to and from the Euler angles of glhckObjectRotation,
+ * in degrees, as rotations about X, then Y, then Z. Interpolation always
+ * takes the shorter arc. Slerp falls back to nlerp when the endpoints are
+ * close enough that the two agree within float precision. */
+
+#define GAS_DEGREES_TO_RADIANS 0.017453292519943295f
+#define GAS_RADIANS_TO_DEGREES 57.29577951308232f
+#define GAS_SLERP_THRESHOLD 0.9995f
+
+void gasQuaternionFromEuler(kmVec3 const* degrees, kmQuaternion* out)
+{
+  float const hx = degrees->x * GAS_DEGREES_TO_RADIANS * 0.5f;
+  float const hy = degrees->y * GAS_DEGREES_TO_RADIANS * 0.5f;
+  float const hz = degrees->z * GAS_DEGREES_TO_RADIANS * 0.5f;
+  float const cx = cosf(hx), sx = sinf(hx);
+  float const cy = cosf(hy), sy = sinf(hy);
+  float const cz = cosf(hz), sz = sinf(hz);
+
+  out->w = cx * cy * cz + sx * sy * sz;
+  out->x = sx * cy * cz - cx * sy * sz;
+  out->y = cx * sy * cz + sx * cy * sz;
+  out->z = cx * cy * sz - sx * sy * cz;
+}
+
+kmVec3 _gasQuaternionToEuler(kmQuaternion const* q)
+{
+  /* Pitch from atan2 rather than asin keeps it accurate near +-90 degrees */
+  float const sinXcosY = 2.0f * (q->w * q->x + q->y * q->z);
+  float const cosXcosY = 1.0f - 2.0f * (q->x * q->x + q->y * q->y);
+  float const sinY = 2.0f * (q->w * q->y - q->z * q->x);
+
+  kmVec3 degrees;
+  degrees.x = atan2f(sinXcosY, cosXcosY);
+  degrees.y = atan2f(sinY, sqrtf(sinXcosY * sinXcosY + cosXcosY * cosXcosY));
+  degrees.z = atan2f(2.0f * (q->w * q->z + q->x * q->y), 1.0f - 2.0f * (q->y * q->y + q->z * q->z));
+  degrees.x *= GAS_RADIANS_TO_DEGREES;
+  degrees.y *= GAS_RADIANS_TO_DEGREES;
+  degrees.z *= GAS_RADIANS_TO_DEGREES;
+  return degrees;
+}
+
+void _gasQuaternionMultiply(kmQuaternion const* a, kmQuaternion const* b, kmQuaternion* out)
+{
+  kmQuaternion const q = {
+    a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y,
+    a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x,
+    a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w,
+    a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z
+  };
+  *out = q;
+}
+
+void _gasQuaternionNormalize(kmQuaternion* q)
+{
+  float const length = sqrtf(q->x * q->x + q->y * q->y + q->z * q->z + q->w * q->w);
+  if (length == 0.0f)
+  {
+    q->x = q->y = q->z = 0.0f;
+    q->w = 1.0f;
+    return;
+  }
+
+  q->x = q->x / length;
+  q->y = q->y / length;
+  q->z = q->z / length;
+  q->w = q->w / length;
+}
+
+/* Shorter arc linear blend, left unnormalized */
+void _gasQuaternionLerp(kmQuaternion const* from, kmQuaternion const* to, float const t, kmQuaternion* out)
+{
+  float const dot = from->x * to->x + from->y * to->y + from->z * to->z + from->w * to->w;
+  float const b = dot < 0.0f ? -t : t;
+  float const a = 1.0f - t;
+
+  kmQuaternion const q = {
+    a * from->x + b * to->x,
+    a * from->y + b * to->y,
+    a * from->z + b * to->z,
+    a * from->w + b * to->w
+  };
+  *out = q;
+}
+
+void _gasQuaternionNlerp(kmQuaternion const* from, kmQuaternion const* to, float const t, kmQuaternion* out)
+{
+  _gasQuaternionLerp(from, to, t, out);
+  _gasQuaternionNormalize(out);
+}
+
+void _gasQuaternionSlerp(kmQuaternion const* from, kmQuaternion const* to, float const t, kmQuaternion* out)
+{
+  float dot = from->x * to->x + from->y * to->y + from->z * to->z + from->w * to->w;
+  float const sign = dot < 0.0f ? -1.0f : 1.0f;
+  dot *= sign;
+
+  if (dot > GAS_SLERP_THRESHOLD)
+  {
+    _gasQuaternionNlerp(from, to, t, out);
+    return;
+  }
+
+  float const theta = acosf(dot);
+  float const sinTheta = sinf(theta);
+  float const a = sinf((1.0f - t) * theta) / sinTheta;
+  float const b = sign * sinf(t * theta) / sinTheta;
+
+  out->x = a * from->x + b * to->x;
+  out->y = a * from->y + b * to->y;
+  out->z = a * from->z + b * to->z;
+  out->w = a * from->w + b * to->w;
+}
@@ -0,0 +1,567 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Sampling
+ *
+ * Sampling evaluates an animation at an absolute time without stepping it.
+ * A sampler describes the animation as a pre-order array of nodes that know
+ * how long one loop of their subtree takes and what it does to every
+ * channel, as an affine map per channel. Whole loops and earlier siblings
+ * are applied through their maps, so only the path down to the leaves that
+ * are active at the sampled time is visited, finding the active child of a
+ * sequential animation, key of a track or piece of a path by binary search.
+ * Active leaves run their step function on a copy of their definition,
+ * capturing their start from the object as playing them would. Programs
+ * never change, so their sampler is built once and kept. Trees may change
+ * between calls and get a sampler of their own every time they are
+ * sampled. */
+
+static void _gasSampleMapIdentity(_gasSampleMap* map)
+{
+  unsigned int i;
+  map->channels = 0;
+  for (i = 0; i < GAS_LOOP_CHANNELS; ++i)
+  {
+    map->scale[i] = 1.0f;
+    map->offset[i] = 0.0f;
+  }
+}
+
+static void _gasSampleMapSet(_gasSampleMap* map, unsigned int const channel, float const scale, float const offset)
+{
+  map->channels |= 1 << channel;
+  map->scale[channel] = scale;
+  map->offset[channel] = offset;
+}
+
+/* Where a number animation ends, in terms of where its channel was when it
+ * started. FROM animations end where they started unless their easing ends
+ * elsewhere. */
+static void _gasSampleMapNumber(_gasSampleMap* map, unsigned int const channel, _gasNumberAnimationType const type,
+                                float const a, float const b, float const end)
+{
+  switch (type)
+  {
+    case GAS_NUMBER_ANIMATION_TYPE_TO: _gasSampleMapSet(map, channel, 1.0f - end, b * end); break;
+    case GAS_NUMBER_ANIMATION_TYPE_FROM: _gasSampleMapSet(map, channel, end, a * (1.0f - end)); break;
+    case GAS_NUMBER_ANIMATION_TYPE_DELTA: _gasSampleMapSet(map, channel, 1.0f, b * end); break;
+    default: _gasSampleMapSet(map, channel, 0.0f, _gasNumberAnimationValue(type, a, b, end)); break;
+  }
+}
+
+/* Rotations that end on an orientation known up front write constant Euler
+ * angles. The rest end somewhere depending on where they started in a way
+ * no affine map describes. */
+static gasBoolean _gasSampleMapRotation(_gasSampleMap* map, _gasRotationAnimation const* rotation)
+{
+  float const end = _gasEasingEnd(rotation->easing, rotation->curve);
+  kmQuaternion value;
+  switch (rotation->type)
+  {
+    case GAS_NUMBER_ANIMATION_TYPE_FROM_TO:
+    case GAS_NUMBER_ANIMATION_TYPE_FROM_DELTA:
+    case GAS_NUMBER_ANIMATION_TYPE_DELTA_TO:
+    {
+      _gasRotationAnimationValue(rotation, end, &value);
+      break;
+    }
+    case GAS_NUMBER_ANIMATION_TYPE_TO:
+    {
+      if (end != 1.0f)
+        return GAS_FALSE;
+      value = rotation->b;
+      break;
+    }
+    default: return GAS_FALSE;
+  }
+
+  kmVec3 const euler = _gasQuaternionToEuler(&value);
+  _gasSampleMapSet(map, GAS_NUMBER_ANIMATION_TARGET_ROT_X, 0.0f, euler.x);
+  _gasSampleMapSet(map, GAS_NUMBER_ANIMATION_TARGET_ROT_Y, 0.0f, euler.y);
+  _gasSampleMapSet(map, GAS_NUMBER_ANIMATION_TARGET_ROT_Z, 0.0f, euler.z);
+  return GAS_TRUE;
+}
+
+/* next happens after map */
+static void _gasSampleMapThen(_gasSampleMap* map, _gasSampleMap const* next)
+{
+  unsigned int i;
+  for (i = 0; i < GAS_LOOP_CHANNELS; ++i)
+  {
+    if (next->channels & (1 << i))
+    {
+      map->offset[i] = next->scale[i] * map->offset[i] + next->offset[i];
+      map->scale[i] *= next->scale[i];
+    }
+  }
+  map->channels |= next->channels;
+}
+
+/* other happens alongside map, on channels of its own */
+static void _gasSampleMapMerge(_gasSampleMap* map, _gasSampleMap const* other)
+{
+  unsigned int i;
+  for (i = 0; i < GAS_LOOP_CHANNELS; ++i)
+  {
+    if (other->channels & (1 << i))
+    {
+      map->scale[i] = other->scale[i];
+      map->offset[i] = other->offset[i];
+    }
+  }
+  map->channels |= other->channels;
+}
+
+/* map applied count times over */
+static void _gasSampleMapRepeat(_gasSampleMap const* map, float const count, _gasSampleMap* out)
+{
+  *out = *map;
+  unsigned int i;
+  for (i = 0; i < GAS_LOOP_CHANNELS; ++i)
+  {
+    if (map->channels & (1 << i))
+    {
+      float const scale = map->scale[i];
+      out->scale[i] = powf(scale, count);
+      out->offset[i] = scale == 1.0f
+          ? map->offset[i] * count
+          : map->offset[i] * (1.0f - out->scale[i]) / (1.0f - scale);
+    }
+  }
+}
+
+static void _gasSampleMapApply(_gasSampleMap const* map, glhckObject* object)
+{
+  unsigned int i;
+  for (i = GAS_NUMBER_ANIMATION_TARGET_X; i <= GAS_NUMBER_ANIMATION_TARGET_ROT_Z; ++i)
+  {
+    if (map->channels & (1 << i))
+    {
+      float const value = _gasNumberAnimationGetTargetValue(i, object);
+      _gasNumberAnimationSetTargetValue(i, object, value * map->scale[i] + map->offset[i]);
+    }
+  }
+
+  unsigned int const scale = GAS_VECTOR_ANIMATION_TARGET_SCALE * 3;
+  if (map->channels >> scale)
+  {
+    kmVec3 value = _gasVectorAnimationGetTargetValue(GAS_VECTOR_ANIMATION_TARGET_SCALE, object);
+    value.x = value.x * map->scale[scale] + map->offset[scale];
+    value.y = value.y * map->scale[scale + 1] + map->offset[scale + 1];
+    value.z = value.z * map->scale[scale + 2] + map->offset[scale + 2];
+    _gasVectorAnimationSetTargetValue(GAS_VECTOR_ANIMATION_TARGET_SCALE, object, &value);
+  }
+}
+
+static float _gasSampleDuration(float const duration)
+{
+  return duration > 0.0f ? duration : 0.0f;
+}
+
+static float _gasSampleNodeTotal(_gasSampleNode const* node)
+{
+  return node->loops == -1 ? INFINITY : node->duration * (float) node->loops;
+}
+
+/* What every loop of node does. Endless nodes never finish, so what they
+ * do in total is never asked for. */
+static void _gasSampleNodeTotalMap(_gasSampleNode const* node, _gasSampleMap* out)
+{
+  if (node->loops == -1)
+  {
+    *out = node->map;
+    return;
+  }
+  _gasSampleMapRepeat(&node->map, (float) node->loops, out);
+}
+
+_gasSampler* _gasSamplerAlloc(unsigned int const numNodes, unsigned int const numChildren)
+{
+  char* block = malloc(sizeof(_gasSampler) + numNodes * sizeof(_gasSampleNode) + numChildren * sizeof(unsigned int));
+  _gasSampler* sampler = (_gasSampler*) block;
+  sampler->numNodes = numNodes;
+  sampler->nodes = (_gasSampleNode*) (block + sizeof(_gasSampler));
+  sampler->children = (unsigned int*) (sampler->nodes + numNodes);
+  return sampler;
+}
+
+/* Works out the duration and map of a node whose type, loops, definition
+ * and children are filled in and whose children are finished */
+void _gasSampleNodeFinish(_gasSampler* sampler, unsigned int const index, gasBoolean const overlapping)
+{
+  _gasSampleNode* node = &sampler->nodes[index];
+  _gasSampleMapIdentity(&node->map);
+  _gasSampleMapIdentity(&node->before);
+  node->duration = 0.0f;
+
+  unsigned int i;
+  switch (node->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER:
+    {
+      _gasNumberAnimation const* number = node->definition;
+      _gasSampleMapNumber(&node->map, number->target, number->type, number->a, number->b,
+                          _gasEasingEnd(number->easing, number->curve));
+      node->duration = _gasSampleDuration(number->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_VECTOR:
+    {
+      _gasVectorAnimation const* vector = node->definition;
+      unsigned int const first = vector->target * 3;
+      float const end = _gasEasingEnd(vector->easing, vector->curve);
+      _gasSampleMapNumber(&node->map, first, vector->type, vector->a.x, vector->b.x, end);
+      _gasSampleMapNumber(&node->map, first + 1, vector->type, vector->a.y, vector->b.y, end);
+      _gasSampleMapNumber(&node->map, first + 2, vector->type, vector->a.z, vector->b.z, end);
+      node->duration = _gasSampleDuration(vector->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      _gasRotationAnimation const* rotation = node->definition;
+      node->duration = _gasSampleMapRotation(&node->map, rotation) ? _gasSampleDuration(rotation->duration) : -1.0f;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      _gasTrackAnimation const* track = node->definition;
+      unsigned int const last = track->keys->numKeys - 1;
+      _gasSampleMapSet(&node->map, track->target, 0.0f, _gasTrackValue(track->keys, last, track->duration));
+      node->duration = _gasSampleDuration(track->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      _gasPathAnimation const* path = node->definition;
+      unsigned int cursor = 0;
+      kmVec3 const end = _gasPathPosition(path, &cursor, path->duration);
+      _gasSampleMapSet(&node->map, GAS_NUMBER_ANIMATION_TARGET_X, 0.0f, end.x);
+      _gasSampleMapSet(&node->map, GAS_NUMBER_ANIMATION_TARGET_Y, 0.0f, end.y);
+      _gasSampleMapSet(&node->map, GAS_NUMBER_ANIMATION_TARGET_Z, 0.0f, end.z);
+      node->duration = _gasSampleDuration(path->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PAUSE:
+    {
+      _gasPauseAnimation const* pause = node->definition;
+      node->duration = _gasSampleDuration(pause->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      _gasModelAnimation const* model = node->definition;
+      node->duration = _gasSampleDuration(model->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ACTION: break;
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = 0; i < node->numChildren; ++i)
+      {
+        _gasSampleNode* child = &sampler->nodes[sampler->children[node->children + i]];
+        if (child->duration < 0.0f)
+        {
+          node->duration = -1.0f;
+          break;
+        }
+
+        _gasSampleMap total;
+        _gasSampleNodeTotalMap(child, &total);
+        child->start = node->duration;
+        child->before = node->map;
+        node->duration += _gasSampleNodeTotal(child);
+        child->finish = node->duration;
+        _gasSampleMapThen(&node->map, &total);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for (i = 0; i < node->numChildren && !overlapping; ++i)
+      {
+        _gasSampleNode const* child = &sampler->nodes[sampler->children[node->children + i]];
+        if (child->duration < 0.0f)
+          break;
+
+        _gasSampleMap total;
+        _gasSampleNodeTotalMap(child, &total);
+        _gasSampleMapMerge(&node->map, &total);
+        float const duration = _gasSampleNodeTotal(child);
+        node->duration = duration > node->duration ? duration : node->duration;
+      }
+
+      if (overlapping || i < node->numChildren)
+        node->duration = -1.0f;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      gasAnimation const* animation = node->definition;
+      _gasSampleNode const* root = _gasProgramSampler(animation->programAnimation.program)->nodes;
+      node->map = root->map;
+      node->duration = root->duration;
+      break;
+    }
+    default: node->duration = -1.0f; break;
+  }
+
+  if (node->duration >= 0.0f)
+  {
+    node->start = 0.0f;
+    node->finish = _gasSampleNodeTotal(node);
+  }
+}
+
+static void _gasSamplerSampleNode(_gasSampler* sampler, unsigned int const index, int const loops,
+                           glhckObject* object, float const time);
+
+/* Samples one loop of a node, time into it */
+static void _gasSamplerSampleLoop(_gasSampler* sampler, unsigned int const index, glhckObject* object, float const time)
+{
+  _gasSampleNode const* node = &sampler->nodes[index];
+  gasAnimationState state = GAS_ANIMATION_STATE_NOT_STARTED;
+  switch (node->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER:
+    {
+      _gasNumberAnimation number = *(_gasNumberAnimation const*) node->definition;
+      number.time = 0.0f;
+      _gasNumberAnimationStep(&number, &state, object, time);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_VECTOR:
+    {
+      _gasVectorAnimation vector = *(_gasVectorAnimation const*) node->definition;
+      vector.time = 0.0f;
+      _gasVectorAnimationStep(&vector, &state, object, time);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      _gasRotationAnimation rotation = *(_gasRotationAnimation const*) node->definition;
+      rotation.time = 0.0f;
+      _gasRotationAnimationStep(&rotation, &state, object, time);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      _gasTrackAnimation track = *(_gasTrackAnimation const*) node->definition;
+      track.time = 0.0f;
+      track.cursor = 0;
+      _gasTrackAnimationStep(&track, &state, object, time);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      _gasPathAnimation path = *(_gasPathAnimation const*) node->definition;
+      path.time = 0.0f;
+      path.cursor = 0;
+      _gasPathAnimationStep(&path, &state, object, time);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      if (node->numChildren == 0)
+        break;
+
+      /* The first child still running at time, which is the one playing
+       * would have stopped in */
+      unsigned int const* children = sampler->children + node->children;
+      unsigned int low = 0;
+      unsigned int high = node->numChildren - 1;
+      while (low < high)
+      {
+        unsigned int const middle = low + (high - low) / 2;
+        if (sampler->nodes[children[middle]].finish >= time)
+          high = middle;
+        else
+          low = middle + 1;
+      }
+
+      _gasSampleNode const* child = &sampler->nodes[children[low]];
+      _gasSampleMapApply(&child->before, object);
+      _gasSamplerSampleNode(sampler, children[low], child->loops, object, time - child->start);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      unsigned int i;
+      for (i = 0; i < node->numChildren; ++i)
+      {
+        unsigned int const child = sampler->children[node->children + i];
+        _gasSamplerSampleNode(sampler, child, sampler->nodes[child].loops, object, time);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      gasAnimation const* animation = node->definition;
+      _gasSamplerSampleNode(_gasProgramSampler(animation->programAnimation.program), 0, 1, object, time);
+      break;
+    }
+    default: break;
+  }
+}
+
+/* Samples a node looping loops times, time into its first loop. Loops that
+ * are over are applied through the node's map. A time that falls on the
+ * end of a loop samples the end of that loop, as playing stops there. */
+static void _gasSamplerSampleNode(_gasSampler* sampler, unsigned int const index, int const loops,
+                           glhckObject* object, float const time)
+{
+  _gasSampleNode const* node = &sampler->nodes[index];
+  float const duration = node->duration;
+  if (loops == 0)
+    return;
+
+  _gasSampleMap map;
+  if (loops != -1 && time >= duration * (float) loops)
+  {
+    _gasSampleMapRepeat(&node->map, (float) loops, &map);
+    _gasSampleMapApply(&map, object);
+    return;
+  }
+
+  /* An endless loop that takes no time plays once per step */
+  if (duration <= 0.0f)
+  {
+    _gasSampleMapApply(&node->map, object);
+    return;
+  }
+
+  float loop = floorf(time / duration);
+  if (loop > 0.0f && loop * duration >= time)
+  {
+    loop -= 1.0f;
+  }
+
+  if (loop > 0.0f)
+  {
+    _gasSampleMapRepeat(&node->map, loop, &map);
+    _gasSampleMapApply(&map, object);
+  }
+
+  /* Parallel nodes with endless children last forever, where 0 * INFINITY
+   * would make the time NaN */
+  _gasSamplerSampleLoop(sampler, index, object, loop > 0.0f ? time - loop * duration : time);
+}
+
+gasBoolean _gasSamplerSample(_gasSampler* sampler, int const loops, glhckObject* object, float const time)
+{
+  if (sampler->nodes[0].duration < 0.0f)
+    return GAS_FALSE;
+
+  _gasSamplerSampleNode(sampler, 0, loops, object, time > 0.0f ? time : 0.0f);
+  return GAS_TRUE;
+}
+
+static void _gasSamplerMeasure(gasAnimation* animation, unsigned int* numNodes, unsigned int* numChildren)
+{
+  *numNodes += 1;
+
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      *numChildren += animation->sequentialAnimation.numChildren;
+      for (i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        _gasSamplerMeasure(animation->sequentialAnimation.children[i], numNodes, numChildren);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      *numChildren += animation->parallelAnimation.numChildren;
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        _gasSamplerMeasure(animation->parallelAnimation.children[i], numNodes, numChildren);
+      }
+      break;
+    }
+    default: break;
+  }
+}
+
+static unsigned int _gasSamplerEmit(_gasSampler* sampler, gasAnimation* animation, unsigned int* numNodes,
+                                    unsigned int* numChildren)
+{
+  unsigned int const index = (*numNodes)++;
+  _gasSampleNode* node = &sampler->nodes[index];
+  node->type = animation->type;
+  node->loops = animation->loops;
+  node->numChildren = 0;
+  node->definition = NULL;
+
+  gasAnimation** children = NULL;
+  gasBoolean overlapping = GAS_FALSE;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER: node->definition = &animation->numberAnimation; break;
+    case GAS_ANIMATION_TYPE_VECTOR: node->definition = &animation->vectorAnimation; break;
+    case GAS_ANIMATION_TYPE_ROTATION: node->definition = animation->rotationAnimation; break;
+    case GAS_ANIMATION_TYPE_TRACK: node->definition = &animation->trackAnimation; break;
+    case GAS_ANIMATION_TYPE_PATH: node->definition = &animation->pathAnimation; break;
+    case GAS_ANIMATION_TYPE_PAUSE: node->definition = &animation->pauseAnimation; break;
+    case GAS_ANIMATION_TYPE_MODEL: node->definition = &animation->modelAnimation; break;
+    case GAS_ANIMATION_TYPE_PROGRAM: node->definition = animation; break;
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      children = animation->sequentialAnimation.children;
+      node->numChildren = animation->sequentialAnimation.numChildren;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      children = animation->parallelAnimation.children;
+      node->numChildren = animation->parallelAnimation.numChildren;
+      overlapping = animation->parallelAnimation.overlapping;
+      break;
+    }
+    default: break;
+  }
+
+  node->children = *numChildren;
+  *numChildren += node->numChildren;
+
+  unsigned int i;
+  for (i = 0; i < node->numChildren; ++i)
+  {
+    sampler->children[node->children + i] = _gasSamplerEmit(sampler, children[i], numNodes, numChildren);
+  }
+
+  _gasSampleNodeFinish(sampler, index, overlapping);
+  return index;
+}
+
+gasBoolean gasAnimationSample(gasAnimation* animation, glhckObject* object, float const time)
+{
+  if (animation->type == GAS_ANIMATION_TYPE_PROGRAM)
+  {
+    _gasSampler* sampler = _gasProgramSampler(animation->programAnimation.program);
+    return _gasSamplerSample(sampler, animation->loops, object, time);
+  }
+
+  unsigned int numNodes = 0;
+  unsigned int numChildren = 0;
+  _gasSamplerMeasure(animation, &numNodes, &numChildren);
+
+  _gasSampler* sampler = _gasSamplerAlloc(numNodes, numChildren);
+  numNodes = 0;
+  numChildren = 0;
+  _gasSamplerEmit(sampler, animation, &numNodes, &numChildren);
+
+  gasBoolean const sampled = _gasSamplerSample(sampler, animation->loops, object, time);
+  free(sampler);
+  return sampled;
+}
+
+gasBoolean gasAnimationTemplateSample(gasAnimationTemplate* animationTemplate, glhckObject* object, float const time)
+{
+  return _gasSamplerSample(_gasProgramSampler(animationTemplate), animationTemplate->loops, object, time);
+}
@@ -0,0 +1,995 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Serialized animations
+ *
+ * An animation is stored as a header followed by its nodes in pre-order,
+ * every field a 32 bit word and children following their sequential or
+ * parallel parent by count rather than by offset, so nothing in the data
+ * depends on where it lies. Every node starts with its type and loops:
+ *
+ *   NUMBER    type, target, easing, curve, a, b, duration
+ *   VECTOR    type, target, easing, curve, a.xyz, b.xyz, duration
+ *   ROTATION  type, nlerp, easing, curve, a.xyzw, b.xyzw, duration
+ *   PAUSE     duration
+ *   SEQ, PAR  numChildren
+ *   MODEL     duration, frames, minStep, length, name padded to words
+ *   ACTION    reference, fireOnce
+ *   CUSTOM    reference
+ *   TRACK     target, numKeys, keys of time, value, easing, curve
+ *   PATH      interpolation, easing, curve, hop, duration, numPoints,
+ *             points.xyz
+ *
+ * Easings are built-in ids or references, curves references or none.
+ * Reading trusts nothing: every read is bounds checked, every enum and
+ * reference validated and nesting limited, and a partially read tree is
+ * freed again.
+ *
+ * A bank is a header, a directory of name and data ranges sorted by name,
+ * the names and the serialized animations. Programs hold function pointers
+ * and live state, so a bank cannot run in place, but opening one touches
+ * only its directory and every animation is read once, on first use, into
+ * a template instances share. */
+
+#define GAS_SERIAL_VERSION 1
+#define GAS_SERIAL_BYTE_ORDER 0x01020304u
+#define GAS_SERIAL_HEADER_SIZE 20
+#define GAS_SERIAL_MIN_NODE_SIZE 12
+#define GAS_SERIAL_NO_REFERENCE 0xffffffffu
+#define GAS_SERIAL_REFERENCE 0x80000000u
+#define GAS_SERIAL_MAX_DEPTH 1024
+#define GAS_SERIAL_INLINE_CHILDREN 16
+#define GAS_SERIAL_DIRECTORY_ENTRY_SIZE 16
+#define GAS_SERIAL_KEY_SIZE 16
+#define GAS_SERIAL_POINT_SIZE 12
+
+static char const animationMagic[4] = { 'G', 'A', 'S', 'A' };
+static char const bankMagic[4] = { 'G', 'A', 'S', 'B' };
+
+struct _gasAnimationBank
+{
+  unsigned char const* data;
+  size_t size;
+  unsigned int numAnimations;
+  gasReference* references;
+  unsigned int numReferences;
+  pthread_mutex_t mutex;
+  gasAnimationTemplate** templates;
+};
+
+typedef struct _gasSerialReader
+{
+  unsigned char const* data;
+  size_t size;
+  size_t position;
+  gasReference const* references;
+  unsigned int numReferences;
+  unsigned int numNodes;
+  gasBoolean failed;
+} _gasSerialReader;
+
+typedef struct _gasSerialBankEntry
+{
+  char const* name;
+  gasAnimation* animation;
+} _gasSerialBankEntry;
+
+static void _gasSerialWrite(_gasSerialWriter* writer, void const* data, size_t const size)
+{
+  if (writer->size + size > writer->capacity)
+  {
+    size_t capacity = writer->capacity ? writer->capacity * 2 : 256;
+    while (capacity < writer->size + size)
+    {
+      capacity *= 2;
+    }
+    writer->data = realloc(writer->data, capacity);
+    writer->capacity = capacity;
+  }
+  memcpy(writer->data + writer->size, data, size);
+  writer->size += size;
+}
+
+static void _gasSerialWriteWord(_gasSerialWriter* writer, uint32_t const word)
+{
+  _gasSerialWrite(writer, &word, sizeof(word));
+}
+
+static void _gasSerialWriteFloat(_gasSerialWriter* writer, float const value)
+{
+  _gasSerialWrite(writer, &value, sizeof(value));
+}
+
+static void _gasSerialPatchWord(_gasSerialWriter* writer, size_t const offset, uint32_t const word)
+{
+  memcpy(writer->data + offset, &word, sizeof(word));
+}
+
+/* Names are written with their terminator and padded to whole words */
+static void _gasSerialWriteName(_gasSerialWriter* writer, char const* name)
+{
+  static char const padding[4] = { 0, 0, 0, 0 };
+  size_t const length = strlen(name);
+  _gasSerialWriteWord(writer, (uint32_t) length);
+  _gasSerialWrite(writer, name, length);
+  _gasSerialWrite(writer, padding, 4 - length % 4);
+}
+
+static void _gasSerialWriteEasing(_gasSerialWriter* writer, gasEasingFunc easing, gasEasingCurve const* curve)
+{
+  uint32_t easingWord = _gasEasingIdFromFunc(easing);
+  uint32_t curveWord = GAS_SERIAL_NO_REFERENCE;
+  unsigned int i;
+  if (easingWord == GAS_EASING_ID_CUSTOM && easing)
+  {
+    easingWord = GAS_SERIAL_NO_REFERENCE;
+    for (i = 0; i < writer->numReferences && easingWord == GAS_SERIAL_NO_REFERENCE; ++i)
+    {
+      if (writer->references[i].easing == easing)
+      {
+        easingWord = GAS_SERIAL_REFERENCE | i;
+      }
+    }
+    writer->failed |= easingWord == GAS_SERIAL_NO_REFERENCE;
+  }
+  if (curve)
+  {
+    for (i = 0; i < writer->numReferences && curveWord == GAS_SERIAL_NO_REFERENCE; ++i)
+    {
+      if (writer->references[i].curve == curve)
+      {
+        curveWord = i;
+      }
+    }
+    writer->failed |= curveWord == GAS_SERIAL_NO_REFERENCE;
+  }
+  _gasSerialWriteWord(writer, easingWord);
+  _gasSerialWriteWord(writer, curveWord);
+}
+
+/* Entries with the same callbacks are told apart by userdata where it
+ * matches, which it no longer does once userdata has been cloned */
+static uint32_t _gasSerialCallbackReference(_gasSerialWriter* writer, gasActionCallback action,
+                                            gasCustomAnimationCallback custom, gasActionResetCallback resetCallback,
+                                            gasActionCloneCallback cloneCallback,
+                                            gasActionFreeCallback freeCallback, void* userdata)
+{
+  uint32_t found = GAS_SERIAL_NO_REFERENCE;
+  unsigned int i;
+  for (i = 0; i < writer->numReferences; ++i)
+  {
+    gasReference const* reference = &writer->references[i];
+    if (reference->action != action || reference->custom != custom || reference->resetCallback != resetCallback
+        || reference->cloneCallback != cloneCallback || reference->freeCallback != freeCallback)
+      continue;
+
+    if (reference->userdata == userdata)
+      return i;
+
+    if (found == GAS_SERIAL_NO_REFERENCE)
+    {
+      found = i;
+    }
+  }
+  writer->failed |= found == GAS_SERIAL_NO_REFERENCE;
+  return found;
+}
+
+void _gasSerialWriteNode(_gasSerialWriter* writer, _gasAnimationType const type, int const loops,
+                         void const* definition, void* userdata, unsigned int const numChildren)
+{
+  writer->numNodes += 1;
+  _gasSerialWriteWord(writer, type);
+  _gasSerialWriteWord(writer, (uint32_t) loops);
+
+  unsigned int i;
+  switch (type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER:
+    {
+      _gasNumberAnimation const* number = definition;
+      _gasSerialWriteWord(writer, number->type);
+      _gasSerialWriteWord(writer, number->target);
+      _gasSerialWriteEasing(writer, number->easing, number->curve);
+      _gasSerialWriteFloat(writer, number->a);
+      _gasSerialWriteFloat(writer, number->b);
+      _gasSerialWriteFloat(writer, number->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_VECTOR:
+    {
+      _gasVectorAnimation const* vector = definition;
+      _gasSerialWriteWord(writer, vector->type);
+      _gasSerialWriteWord(writer, vector->target);
+      _gasSerialWriteEasing(writer, vector->easing, vector->curve);
+      _gasSerialWriteFloat(writer, vector->a.x);
+      _gasSerialWriteFloat(writer, vector->a.y);
+      _gasSerialWriteFloat(writer, vector->a.z);
+      _gasSerialWriteFloat(writer, vector->b.x);
+      _gasSerialWriteFloat(writer, vector->b.y);
+      _gasSerialWriteFloat(writer, vector->b.z);
+      _gasSerialWriteFloat(writer, vector->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      _gasRotationAnimation const* rotation = definition;
+      kmQuaternion const* quaternions[2] = { &rotation->a, &rotation->b };
+      _gasSerialWriteWord(writer, rotation->type);
+      _gasSerialWriteWord(writer, rotation->nlerp);
+      _gasSerialWriteEasing(writer, rotation->easing, rotation->curve);
+      for (i = 0; i < 2; ++i)
+      {
+        _gasSerialWriteFloat(writer, quaternions[i]->x);
+        _gasSerialWriteFloat(writer, quaternions[i]->y);
+        _gasSerialWriteFloat(writer, quaternions[i]->z);
+        _gasSerialWriteFloat(writer, quaternions[i]->w);
+      }
+      _gasSerialWriteFloat(writer, rotation->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      _gasTrackAnimation const* track = definition;
+      _gasSerialWriteWord(writer, track->target);
+      _gasSerialWriteWord(writer, track->keys->numKeys);
+      for (i = 0; i < track->keys->numKeys; ++i)
+      {
+        gasKeyframe const* key = &track->keys->keys[i];
+        _gasSerialWriteFloat(writer, key->time);
+        _gasSerialWriteFloat(writer, key->value);
+        _gasSerialWriteEasing(writer, key->easing, key->curve);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      _gasPathAnimation const* path = definition;
+      _gasSerialWriteWord(writer, path->points->interpolation);
+      _gasSerialWriteEasing(writer, path->easing, path->curve);
+      _gasSerialWriteFloat(writer, path->points->hop);
+      _gasSerialWriteFloat(writer, path->duration);
+      _gasSerialWriteWord(writer, path->points->numPoints);
+      for (i = 0; i < path->points->numPoints; ++i)
+      {
+        _gasSerialWriteFloat(writer, path->points->points[i].x);
+        _gasSerialWriteFloat(writer, path->points->points[i].y);
+        _gasSerialWriteFloat(writer, path->points->points[i].z);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PAUSE:
+    {
+      _gasSerialWriteFloat(writer, ((_gasPauseAnimation const*) definition)->duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      _gasSerialWriteWord(writer, numChildren);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      _gasModelAnimation const* model = definition;
+      _gasSerialWriteFloat(writer, model->duration);
+      _gasSerialWriteWord(writer, model->frames);
+      _gasSerialWriteFloat(writer, model->minStep);
+      _gasSerialWriteName(writer, model->name);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      _gasAction const* action = definition;
+      _gasSerialWriteWord(writer, _gasSerialCallbackReference(writer, action->callback, NULL, action->resetCallback,
+                                                              action->cloneCallback, action->freeCallback, userdata));
+      _gasSerialWriteWord(writer, action->fireOnce);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    {
+      _gasCustomAnimation const* custom = definition;
+      _gasSerialWriteWord(writer, _gasSerialCallbackReference(writer, NULL, custom->callback, custom->resetCallback,
+                                                              custom->cloneCallback, custom->freeCallback, userdata));
+      break;
+    }
+    default: assert(0);
+  }
+}
+
+void _gasSerialWriteTree(_gasSerialWriter* writer, gasAnimation* animation)
+{
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, &animation->numberAnimation, NULL, 0);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PAUSE:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, &animation->pauseAnimation, NULL, 0);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, NULL, NULL,
+                          animation->sequentialAnimation.numChildren);
+      for (i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        _gasSerialWriteTree(writer, animation->sequentialAnimation.children[i]);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, NULL, NULL,
+                          animation->parallelAnimation.numChildren);
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        _gasSerialWriteTree(writer, animation->parallelAnimation.children[i]);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, &animation->modelAnimation, NULL, 0);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, &animation->action,
+                          animation->action.userdata, 0);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, &animation->customAnimation,
+                          animation->customAnimation.userdata, 0);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      _gasProgramSerialize(animation->programAnimation.program, animation->programAnimation.states, animation->loops,
+                           writer);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_VECTOR:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, &animation->vectorAnimation, NULL, 0);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, animation->rotationAnimation, NULL, 0);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, &animation->trackAnimation, NULL, 0);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      _gasSerialWriteNode(writer, animation->type, animation->loops, &animation->pathAnimation, NULL, 0);
+      break;
+    }
+    default: assert(0);
+  }
+}
+
+/* Appends a header and the animation, patching in its size and node count
+ * once they are known */
+static void _gasSerialWriteAnimation(_gasSerialWriter* writer, gasAnimation* animation)
+{
+  size_t const start = writer->size;
+  writer->numNodes = 0;
+  _gasSerialWrite(writer, animationMagic, sizeof(animationMagic));
+  _gasSerialWriteWord(writer, GAS_SERIAL_VERSION);
+  _gasSerialWriteWord(writer, GAS_SERIAL_BYTE_ORDER);
+  _gasSerialWriteWord(writer, 0);
+  _gasSerialWriteWord(writer, 0);
+  _gasSerialWriteTree(writer, animation);
+  _gasSerialPatchWord(writer, start + 12, (uint32_t) (writer->size - start));
+  _gasSerialPatchWord(writer, start + 16, writer->numNodes);
+}
+
+static void _gasSerialWriterInit(_gasSerialWriter* writer, gasReference const* references,
+                                 unsigned int const numReferences)
+{
+  memset(writer, 0, sizeof(_gasSerialWriter));
+  writer->references = references;
+  writer->numReferences = numReferences;
+}
+
+static void* _gasSerialWriterFinish(_gasSerialWriter* writer, size_t* size)
+{
+  if (writer->failed)
+  {
+    free(writer->data);
+    writer->data = NULL;
+    writer->size = 0;
+  }
+  if (size)
+  {
+    *size = writer->size;
+  }
+  return writer->data;
+}
+
+void* gasAnimationSerialize(gasAnimation* animation, gasReference const* references, unsigned int const numReferences,
+                            size_t* size)
+{
+  _gasSerialWriter writer;
+  _gasSerialWriterInit(&writer, references, numReferences);
+  _gasSerialWriteAnimation(&writer, animation);
+  return _gasSerialWriterFinish(&writer, size);
+}
+
+/* Reads past the end fail the reader and return zeros */
+static uint32_t _gasSerialReadWord(_gasSerialReader* reader)
+{
+  uint32_t word = 0;
+  if (reader->failed || reader->size - reader->position < sizeof(word))
+  {
+    reader->failed = GAS_TRUE;
+    return 0;
+  }
+  memcpy(&word, reader->data + reader->position, sizeof(word));
+  reader->position += sizeof(word);
+  return word;
+}
+
+static float _gasSerialReadFloat(_gasSerialReader* reader)
+{
+  uint32_t const word = _gasSerialReadWord(reader);
+  float value;
+  memcpy(&value, &word, sizeof(value));
+  return value;
+}
+
+static void _gasSerialCheck(_gasSerialReader* reader, gasBoolean const valid)
+{
+  reader->failed |= !valid;
+}
+
+/* Negative and NaN durations fail the reader */
+static float _gasSerialReadDuration(_gasSerialReader* reader)
+{
+  float const duration = _gasSerialReadFloat(reader);
+  _gasSerialCheck(reader, duration >= 0.0f);
+  return duration;
+}
+
+static char const* _gasSerialReadName(_gasSerialReader* reader)
+{
+  uint32_t const length = _gasSerialReadWord(reader);
+  size_t const padded = ((size_t) length + 4) & ~(size_t) 3;
+  _gasSerialCheck(reader, reader->size - reader->position >= padded);
+  if (reader->failed)
+    return NULL;
+
+  char const* name = (char const*) reader->data + reader->position;
+  _gasSerialCheck(reader, name[length] == '\0');
+  reader->position += padded;
+  return name;
+}
+
+static void _gasSerialReadEasing(_gasSerialReader* reader, gasEasingFunc* easing, gasEasingCurve const** curve)
+{
+  uint32_t const easingWord = _gasSerialReadWord(reader);
+  uint32_t const curveWord = _gasSerialReadWord(reader);
+  *easing = NULL;
+  *curve = NULL;
+  if (easingWord & GAS_SERIAL_REFERENCE)
+  {
+    uint32_t const index = easingWord & ~GAS_SERIAL_REFERENCE;
+    _gasSerialCheck(reader, index < reader->numReferences && reader->references[index].easing);
+    *easing = reader->failed ? NULL : reader->references[index].easing;
+  }
+  else if (easingWord != GAS_EASING_ID_CUSTOM)
+  {
+    *easing = _gasEasingFuncFromId(easingWord);
+    _gasSerialCheck(reader, *easing != NULL);
+  }
+
+  if (curveWord != GAS_SERIAL_NO_REFERENCE)
+  {
+    _gasSerialCheck(reader, curveWord < reader->numReferences && reader->references[curveWord].curve);
+    *curve = reader->failed ? NULL : reader->references[curveWord].curve;
+  }
+  _gasSerialCheck(reader, *easing || *curve);
+}
+
+static gasReference const* _gasSerialReadReference(_gasSerialReader* reader)
+{
+  uint32_t const index = _gasSerialReadWord(reader);
+  _gasSerialCheck(reader, index < reader->numReferences);
+  return reader->failed ? NULL : &reader->references[index];
+}
+
+static void* _gasSerialUserdata(gasReference const* reference)
+{
+  return reference->cloneCallback ? reference->cloneCallback(reference->userdata) : reference->userdata;
+}
+
+static void _gasSerialReadVector(_gasSerialReader* reader, kmVec3* vector)
+{
+  vector->x = _gasSerialReadFloat(reader);
+  vector->y = _gasSerialReadFloat(reader);
+  vector->z = _gasSerialReadFloat(reader);
+}
+
+static void _gasSerialReadQuaternion(_gasSerialReader* reader, kmQuaternion* quaternion)
+{
+  quaternion->x = _gasSerialReadFloat(reader);
+  quaternion->y = _gasSerialReadFloat(reader);
+  quaternion->z = _gasSerialReadFloat(reader);
+  quaternion->w = _gasSerialReadFloat(reader);
+}
+
+static gasAnimation* _gasSerialReadNode(_gasSerialReader* reader, unsigned int const depth)
+{
+  _gasSerialCheck(reader, reader->numNodes > 0 && depth < GAS_SERIAL_MAX_DEPTH);
+  if (reader->failed)
+    return NULL;
+
+  reader->numNodes -= 1;
+  uint32_t const type = _gasSerialReadWord(reader);
+  int const loops = (int) _gasSerialReadWord(reader);
+  _gasSerialCheck(reader, loops >= -1);
+
+  gasAnimation* animation = NULL;
+  gasEasingFunc easing;
+  gasEasingCurve const* curve;
+  unsigned int i;
+  switch (type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER:
+    {
+      uint32_t const numberType = _gasSerialReadWord(reader);
+      uint32_t const target = _gasSerialReadWord(reader);
+      _gasSerialReadEasing(reader, &easing, &curve);
+      float const a = _gasSerialReadFloat(reader);
+      float const b = _gasSerialReadFloat(reader);
+      float const duration = _gasSerialReadDuration(reader);
+      _gasSerialCheck(reader, numberType <= GAS_NUMBER_ANIMATION_TYPE_DELTA
+                      && target <= GAS_NUMBER_ANIMATION_TARGET_ROT_Z);
+      if (reader->failed)
+        return NULL;
+
+      animation = _gasNumberAnimationNew(target, easing, numberType, a, b, duration);
+      animation->numberAnimation.curve = curve;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_VECTOR:
+    {
+      kmVec3 a, b;
+      uint32_t const numberType = _gasSerialReadWord(reader);
+      uint32_t const target = _gasSerialReadWord(reader);
+      _gasSerialReadEasing(reader, &easing, &curve);
+      _gasSerialReadVector(reader, &a);
+      _gasSerialReadVector(reader, &b);
+      float const duration = _gasSerialReadDuration(reader);
+      _gasSerialCheck(reader, numberType <= GAS_NUMBER_ANIMATION_TYPE_DELTA
+                      && target <= GAS_VECTOR_ANIMATION_TARGET_SCALE);
+      if (reader->failed)
+        return NULL;
+
+      animation = _gasVectorAnimationNew(target, easing, numberType, &a, &b, duration);
+      animation->vectorAnimation.curve = curve;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      kmQuaternion a, b;
+      uint32_t const numberType = _gasSerialReadWord(reader);
+      uint32_t const nlerp = _gasSerialReadWord(reader);
+      _gasSerialReadEasing(reader, &easing, &curve);
+      _gasSerialReadQuaternion(reader, &a);
+      _gasSerialReadQuaternion(reader, &b);
+      float const duration = _gasSerialReadDuration(reader);
+      _gasSerialCheck(reader, numberType <= GAS_NUMBER_ANIMATION_TYPE_DELTA && nlerp <= GAS_TRUE);
+      if (reader->failed)
+        return NULL;
+
+      animation = _gasRotationAnimationNew(easing, numberType, &a, &b, duration);
+      animation->rotationAnimation->nlerp = nlerp;
+      animation->rotationAnimation->curve = curve;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK:
+    {
+      /* Every key takes its words, which bounds the allocation */
+      uint32_t const target = _gasSerialReadWord(reader);
+      uint32_t const numKeys = _gasSerialReadWord(reader);
+      _gasSerialCheck(reader, target <= GAS_NUMBER_ANIMATION_TARGET_ROT_Z && numKeys > 0
+                      && numKeys <= (reader->size - reader->position) / GAS_SERIAL_KEY_SIZE);
+      if (reader->failed)
+        return NULL;
+
+      gasKeyframe* keys = malloc(numKeys * sizeof(gasKeyframe));
+      for (i = 0; i < numKeys; ++i)
+      {
+        keys[i].time = _gasSerialReadFloat(reader);
+        keys[i].value = _gasSerialReadFloat(reader);
+        _gasSerialReadEasing(reader, &keys[i].easing, &keys[i].curve);
+      }
+
+      if (!reader->failed)
+      {
+        animation = gasTrackAnimationNew(target, keys, numKeys);
+        _gasSerialCheck(reader, animation != NULL);
+      }
+      free(keys);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PATH:
+    {
+      /* Every point takes its words, which bounds the allocation */
+      uint32_t const interpolation = _gasSerialReadWord(reader);
+      _gasSerialReadEasing(reader, &easing, &curve);
+      float const hop = _gasSerialReadFloat(reader);
+      float const duration = _gasSerialReadDuration(reader);
+      uint32_t const numPoints = _gasSerialReadWord(reader);
+      _gasSerialCheck(reader, interpolation <= GAS_PATH_CATMULL_ROM && numPoints > 0
+                      && numPoints <= (reader->size - reader->position) / GAS_SERIAL_POINT_SIZE);
+      if (reader->failed)
+        return NULL;
+
+      kmVec3* points = malloc(numPoints * sizeof(kmVec3));
+      for (i = 0; i < numPoints; ++i)
+      {
+        _gasSerialReadVector(reader, &points[i]);
+      }
+
+      if (!reader->failed)
+      {
+        animation = gasPathAnimationNew(interpolation, easing, points, numPoints, hop, duration);
+        animation->pathAnimation.curve = curve;
+      }
+      free(points);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PAUSE:
+    {
+      float const duration = _gasSerialReadDuration(reader);
+      if (reader->failed)
+        return NULL;
+
+      animation = gasPauseAnimationNew(duration);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      /* Every child takes a node, and the node count was checked against
+       * the data, which bounds the allocation */
+      uint32_t const numChildren = _gasSerialReadWord(reader);
+      _gasSerialCheck(reader, numChildren <= reader->numNodes);
+      if (reader->failed)
+        return NULL;
+
+      gasAnimation* inlineChildren[GAS_SERIAL_INLINE_CHILDREN];
+      gasAnimation** children = numChildren > GAS_SERIAL_INLINE_CHILDREN
+          ? malloc(numChildren * sizeof(gasAnimation*))
+          : inlineChildren;
+      for (i = 0; i < numChildren && !reader->failed; ++i)
+      {
+        children[i] = _gasSerialReadNode(reader, depth + 1);
+      }
+
+      if (!reader->failed)
+      {
+        animation = type == GAS_ANIMATION_TYPE_SEQUENTIAL
+            ? gasSequentialAnimationNew(children, numChildren)
+            : gasParallelAnimationNew(children, numChildren);
+      }
+      else
+      {
+        while (i-- > 0)
+        {
+          if (children[i])
+          {
+            gasAnimationFree(children[i]);
+          }
+        }
+      }
+
+      if (children != inlineChildren)
+      {
+        free(children);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_MODEL:
+    {
+      float const duration = _gasSerialReadDuration(reader);
+      uint32_t const frames = _gasSerialReadWord(reader);
+      float const minStep = _gasSerialReadDuration(reader);
+      char const* name = _gasSerialReadName(reader);
+      if (reader->failed)
+        return NULL;
+
+      animation = gasModelAnimationUpdateRate(gasModelAnimationNew(name, duration), frames, minStep);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      gasReference const* reference = _gasSerialReadReference(reader);
+      uint32_t const fireOnce = _gasSerialReadWord(reader);
+      _gasSerialCheck(reader, fireOnce <= GAS_TRUE && (!reference || reference->action));
+      if (reader->failed)
+        return NULL;
+
+      animation = gasActionNew(reference->action, reference->resetCallback, reference->cloneCallback,
+                               reference->freeCallback, _gasSerialUserdata(reference));
+      gasActionFireOnce(animation, fireOnce);
+      break;
+    }
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    {
+      gasReference const* reference = _gasSerialReadReference(reader);
+      _gasSerialCheck(reader, !reference || reference->custom);
+      if (reader->failed)
+        return NULL;
+
+      animation = gasCustomAnimationNew(reference->custom, reference->resetCallback, reference->cloneCallback,
+                                        reference->freeCallback, _gasSerialUserdata(reference));
+      break;
+    }
+    default:
+    {
+      reader->failed = GAS_TRUE;
+      break;
+    }
+  }
+
+  if (animation)
+  {
+    animation->loops = loops;
+  }
+  return animation;
+}
+
+/* Limits the reader to the data the header claims and leaves it at the
+ * first node */
+static gasBoolean _gasSerialReadHeader(_gasSerialReader* reader, char const magic[4], uint32_t* count)
+{
+  size_t const start = reader->position;
+  _gasSerialCheck(reader, reader->size - start >= GAS_SERIAL_HEADER_SIZE
+                  && memcmp(reader->data + start, magic, 4) == 0);
+  if (reader->failed)
+    return GAS_FALSE;
+
+  reader->position += 4;
+  uint32_t const version = _gasSerialReadWord(reader);
+  uint32_t const byteOrder = _gasSerialReadWord(reader);
+  uint32_t const size = _gasSerialReadWord(reader);
+  *count = _gasSerialReadWord(reader);
+  _gasSerialCheck(reader, version == GAS_SERIAL_VERSION && byteOrder == GAS_SERIAL_BYTE_ORDER
+                  && size >= GAS_SERIAL_HEADER_SIZE && size <= reader->size - start);
+  if (reader->failed)
+    return GAS_FALSE;
+
+  reader->size = start + size;
+  return GAS_TRUE;
+}
+
+static gasAnimation* _gasSerialReadAnimation(unsigned char const* data, size_t const size,
+                                             gasReference const* references, unsigned int const numReferences)
+{
+  _gasSerialReader reader = { data, size, 0, references, numReferences, 0, GAS_FALSE };
+  if (!_gasSerialReadHeader(&reader, animationMagic, &reader.numNodes)
+      || reader.numNodes > (reader.size - reader.position) / GAS_SERIAL_MIN_NODE_SIZE)
+    return NULL;
+
+  gasAnimation* animation = _gasSerialReadNode(&reader, 0);
+  if (animation && (reader.numNodes != 0 || reader.position != reader.size))
+  {
+    gasAnimationFree(animation);
+    animation = NULL;
+  }
+  return animation;
+}
+
+gasAnimation* gasAnimationDeserialize(void const* data, size_t const size, gasReference const* references,
+                                      unsigned int const numReferences)
+{
+  return _gasSerialReadAnimation(data, size, references, numReferences);
+}
+
+static int _gasSerialBankEntryCompare(void const* a, void const* b)
+{
+  return strcmp(((_gasSerialBankEntry const*) a)->name, ((_gasSerialBankEntry const*) b)->name);
+}
+
+void* gasAnimationBankWrite(gasAnimation** animations, char const** names, unsigned int const numAnimations,
+                            gasReference const* references, unsigned int const numReferences, size_t* size)
+{
+  _gasSerialBankEntry* entries = malloc((numAnimations ? numAnimations : 1) * sizeof(_gasSerialBankEntry));
+  unsigned int i;
+  for (i = 0; i < numAnimations; ++i)
+  {
+    entries[i].name = names[i];
+    entries[i].animation = animations[i];
+  }
+  qsort(entries, numAnimations, sizeof(_gasSerialBankEntry), _gasSerialBankEntryCompare);
+
+  _gasSerialWriter writer;
+  _gasSerialWriterInit(&writer, references, numReferences);
+  _gasSerialWrite(&writer, bankMagic, sizeof(bankMagic));
+  _gasSerialWriteWord(&writer, GAS_SERIAL_VERSION);
+  _gasSerialWriteWord(&writer, GAS_SERIAL_BYTE_ORDER);
+  _gasSerialWriteWord(&writer, 0);
+  _gasSerialWriteWord(&writer, numAnimations);
+
+  size_t const directory = writer.size;
+  for (i = 0; i < numAnimations * GAS_SERIAL_DIRECTORY_ENTRY_SIZE / 4; ++i)
+  {
+    _gasSerialWriteWord(&writer, 0);
+  }
+
+  /* Name ranges point at the name itself, past its length word */
+  for (i = 0; i < numAnimations; ++i)
+  {
+    size_t const entry = directory + i * GAS_SERIAL_DIRECTORY_ENTRY_SIZE;
+    writer.failed |= i > 0 && strcmp(entries[i - 1].name, entries[i].name) == 0;
+    _gasSerialPatchWord(&writer, entry, (uint32_t) (writer.size + 4));
+    _gasSerialPatchWord(&writer, entry + 4, (uint32_t) strlen(entries[i].name));
+    _gasSerialWriteName(&writer, entries[i].name);
+  }
+
+  for (i = 0; i < numAnimations; ++i)
+  {
+    size_t const entry = directory + i * GAS_SERIAL_DIRECTORY_ENTRY_SIZE;
+    size_t const start = writer.size;
+    _gasSerialWriteAnimation(&writer, entries[i].animation);
+    _gasSerialPatchWord(&writer, entry + 8, (uint32_t) start);
+    _gasSerialPatchWord(&writer, entry + 12, (uint32_t) (writer.size - start));
+  }
+  _gasSerialPatchWord(&writer, 12, (uint32_t) writer.size);
+
+  free(entries);
+  return _gasSerialWriterFinish(&writer, size);
+}
+
+static uint32_t _gasAnimationBankWord(gasAnimationBank* bank, size_t const offset)
+{
+  uint32_t word;
+  memcpy(&word, bank->data + offset, sizeof(word));
+  return word;
+}
+
+static size_t _gasAnimationBankEntry(unsigned int const index)
+{
+  return GAS_SERIAL_HEADER_SIZE + (size_t) index * GAS_SERIAL_DIRECTORY_ENTRY_SIZE;
+}
+
+gasAnimationBank* gasAnimationBankOpen(void const* data, size_t const size, gasReference const* references,
+                                       unsigned int const numReferences)
+{
+  _gasSerialReader reader = { data, size, 0, references, numReferences, 0, GAS_FALSE };
+  uint32_t numAnimations;
+  if (!_gasSerialReadHeader(&reader, bankMagic, &numAnimations)
+      || (reader.size - GAS_SERIAL_HEADER_SIZE) / GAS_SERIAL_DIRECTORY_ENTRY_SIZE < numAnimations)
+    return NULL;
+
+  gasAnimationBank* bank = calloc(1, sizeof(gasAnimationBank));
+  bank->data = data;
+  bank->size = reader.size;
+  bank->numAnimations = numAnimations;
+
+  /* Names must be strictly ascending for gasAnimationBankFind to find them */
+  char const* previous = NULL;
+  unsigned int i;
+  for (i = 0; i < numAnimations; ++i)
+  {
+    size_t const entry = _gasAnimationBankEntry(i);
+    size_t const name = _gasAnimationBankWord(bank, entry);
+    size_t const length = _gasAnimationBankWord(bank, entry + 4);
+    size_t const offset = _gasAnimationBankWord(bank, entry + 8);
+    size_t const animationSize = _gasAnimationBankWord(bank, entry + 12);
+    if (name > bank->size || length >= bank->size - name || bank->data[name + length] != '\0'
+        || offset > bank->size || animationSize > bank->size - offset
+        || (previous && strcmp(previous, (char const*) bank->data + name) >= 0))
+    {
+      free(bank);
+      return NULL;
+    }
+    previous = (char const*) bank->data + name;
+  }
+
+  if (numReferences)
+  {
+    bank->references = malloc(numReferences * sizeof(gasReference));
+    memcpy(bank->references, references, numReferences * sizeof(gasReference));
+  }
+  bank->numReferences = numReferences;
+  bank->templates = calloc(numAnimations ? numAnimations : 1, sizeof(gasAnimationTemplate*));
+  pthread_mutex_init(&bank->mutex, NULL);
+  return bank;
+}
+
+unsigned int gasAnimationBankSize(gasAnimationBank* bank)
+{
+  return bank->numAnimations;
+}
+
+char const* gasAnimationBankName(gasAnimationBank* bank, unsigned int const index)
+{
+  if (index >= bank->numAnimations)
+    return NULL;
+
+  return (char const*) bank->data + _gasAnimationBankWord(bank, _gasAnimationBankEntry(index));
+}
+
+int gasAnimationBankFind(gasAnimationBank* bank, char const* name)
+{
+  unsigned int low = 0;
+  unsigned int high = bank->numAnimations;
+  while (low < high)
+  {
+    unsigned int const middle = low + (high - low) / 2;
+    int const order = strcmp(gasAnimationBankName(bank, middle), name);
+    if (order == 0)
+      return (int) middle;
+
+    if (order < 0)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+  return -1;
+}
+
+gasAnimationTemplate* gasAnimationBankTemplate(gasAnimationBank* bank, unsigned int const index)
+{
+  if (index >= bank->numAnimations)
+    return NULL;
+
+  pthread_mutex_lock(&bank->mutex);
+  gasAnimationTemplate* animationTemplate = bank->templates[index];
+  if (!animationTemplate)
+  {
+    size_t const entry = _gasAnimationBankEntry(index);
+    gasAnimation* animation = _gasSerialReadAnimation(bank->data + _gasAnimationBankWord(bank, entry + 8),
+                                                      _gasAnimationBankWord(bank, entry + 12), bank->references,
+                                                      bank->numReferences);
+    if (animation)
+    {
+      animationTemplate = gasAnimationTemplateNew(animation);
+      gasAnimationFree(animation);
+      bank->templates[index] = animationTemplate;
+    }
+  }
+  pthread_mutex_unlock(&bank->mutex);
+  return animationTemplate;
+}
+
+void gasAnimationBankFree(gasAnimationBank* bank)
+{
+  unsigned int i;
+  for (i = 0; i < bank->numAnimations; ++i)
+  {
+    if (bank->templates[i])
+    {
+      gasAnimationTemplateFree(bank->templates[i]);
+    }
+  }
+  pthread_mutex_destroy(&bank->mutex);
+  free(bank->templates);
+  free(bank->references);
+  free(bank);
+}
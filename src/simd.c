@@ -0,0 +1,398 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <string.h>
+
+/* Vectorized kernels
+ *
+ * Each kernel has a scalar version and, on x86 with GCC or Clang, SSE2 and
+ * AVX2 versions compiled with function level target attributes so the rest
+ * of the library keeps its baseline flags. The widest supported set is
+ * picked on first use. Vector kernels perform the same float operations in
+ * the same order as the scalar ones, so results are bit-identical. */
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GAS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+typedef enum _gasSimdLevel {
+  GAS_SIMD_UNKNOWN,
+  GAS_SIMD_SCALAR,
+  GAS_SIMD_SSE2,
+  GAS_SIMD_AVX2
+} _gasSimdLevel;
+
+static _gasSimdLevel simdLevel = GAS_SIMD_UNKNOWN;
+
+/* Threads racing through detection all store the same level */
+static _gasSimdLevel _gasSimdDetect()
+{
+  _gasSimdLevel const detected = __atomic_load_n(&simdLevel, __ATOMIC_RELAXED);
+  if (detected != GAS_SIMD_UNKNOWN)
+    return detected;
+
+  _gasSimdLevel level = GAS_SIMD_SCALAR;
+#ifdef GAS_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    level = GAS_SIMD_AVX2;
+  else if (__builtin_cpu_supports("sse2"))
+    level = GAS_SIMD_SSE2;
+#endif
+
+  __atomic_store_n(&simdLevel, level, __ATOMIC_RELAXED);
+  return level;
+}
+
+/* Scalar */
+
+static void _gasQuadInBatchScalar(float const* t, float* out, size_t const n)
+{
+  size_t i;
+  for (i = 0; i < n; ++i)
+  {
+    out[i] = t[i] * t[i];
+  }
+}
+
+static void _gasQuadOutBatchScalar(float const* t, float* out, size_t const n)
+{
+  size_t i;
+  for (i = 0; i < n; ++i)
+  {
+    out[i] = 2 * t[i] - t[i] * t[i];
+  }
+}
+
+static void _gasCurveBatchScalar(gasEasingCurve const* curve, float const* t, float* out, size_t const n)
+{
+  size_t i;
+  for (i = 0; i < n; ++i)
+  {
+    out[i] = _gasEasingCurveEvaluate(curve, t[i]);
+  }
+}
+
+static void _gasQuaternionNormalizeBatchScalar(kmQuaternion* q, size_t const n)
+{
+  size_t i;
+  for (i = 0; i < n; ++i)
+  {
+    _gasQuaternionNormalize(&q[i]);
+  }
+}
+
+#ifdef GAS_SIMD_X86
+
+/* SSE2 */
+
+__attribute__((target("sse2")))
+static void _gasQuadInBatchSSE2(float const* t, float* out, size_t const n)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 const x = _mm_loadu_ps(t + i);
+    _mm_storeu_ps(out + i, _mm_mul_ps(x, x));
+  }
+  _gasQuadInBatchScalar(t + i, out + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void _gasQuadOutBatchSSE2(float const* t, float* out, size_t const n)
+{
+  __m128 const two = _mm_set1_ps(2.0f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 const x = _mm_loadu_ps(t + i);
+    _mm_storeu_ps(out + i, _mm_sub_ps(_mm_mul_ps(two, x), _mm_mul_ps(x, x)));
+  }
+  _gasQuadOutBatchScalar(t + i, out + i, n - i);
+}
+
+/* Lanes at or past the last sample, including t >= 1, take the last sample
+ * directly just like _gasEasingCurveEvaluate. t <= 0 lands on index 0 with
+ * a zero fraction, which yields the first sample exactly. */
+__attribute__((target("sse2")))
+static void _gasCurveBatchSSE2(gasEasingCurve const* curve, float const* t, float* out, size_t const n)
+{
+  float const* samples = curve->samples;
+  __m128 const zero = _mm_setzero_ps();
+  __m128 const one = _mm_set1_ps(1.0f);
+  __m128 const scale = _mm_set1_ps(curve->scale);
+  __m128i const last = _mm_set1_epi32((int) curve->resolution);
+  __m128 const lastSample = _mm_set1_ps(samples[curve->resolution]);
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 const x = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(t + i), zero), one), scale);
+    __m128i index = _mm_cvttps_epi32(x);
+    __m128i const top = _mm_cmpeq_epi32(index, last);
+    index = _mm_add_epi32(index, top);
+    __m128 const f = _mm_sub_ps(x, _mm_cvtepi32_ps(index));
+
+    int lanes[4];
+    _mm_storeu_si128((__m128i*) lanes, index);
+    __m128 const a = _mm_setr_ps(samples[lanes[0]], samples[lanes[1]], samples[lanes[2]], samples[lanes[3]]);
+    __m128 const b = _mm_setr_ps(samples[lanes[0] + 1], samples[lanes[1] + 1],
+                                 samples[lanes[2] + 1], samples[lanes[3] + 1]);
+    __m128 const y = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f));
+
+    __m128 const mask = _mm_castsi128_ps(top);
+    _mm_storeu_ps(out + i, _mm_or_ps(_mm_and_ps(mask, lastSample), _mm_andnot_ps(mask, y)));
+  }
+  _gasCurveBatchScalar(curve, t + i, out + i, n - i);
+}
+
+/* Four quaternions at a time, transposed so each register holds one
+ * component. Zero length quaternions become the identity like the scalar
+ * version. */
+__attribute__((target("sse2")))
+static void _gasQuaternionNormalizeBatchSSE2(kmQuaternion* q, size_t const n)
+{
+  __m128 const zero = _mm_setzero_ps();
+  __m128 const one = _mm_set1_ps(1.0f);
+  float* f = (float*) q;
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(f + 4 * i);
+    __m128 y = _mm_loadu_ps(f + 4 * i + 4);
+    __m128 z = _mm_loadu_ps(f + 4 * i + 8);
+    __m128 w = _mm_loadu_ps(f + 4 * i + 12);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    __m128 const squared = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                                 _mm_mul_ps(z, z)), _mm_mul_ps(w, w));
+    __m128 const length = _mm_sqrt_ps(squared);
+    __m128 const degenerate = _mm_cmpeq_ps(length, zero);
+    x = _mm_andnot_ps(degenerate, _mm_div_ps(x, length));
+    y = _mm_andnot_ps(degenerate, _mm_div_ps(y, length));
+    z = _mm_andnot_ps(degenerate, _mm_div_ps(z, length));
+    w = _mm_or_ps(_mm_and_ps(degenerate, one), _mm_andnot_ps(degenerate, _mm_div_ps(w, length)));
+
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(f + 4 * i, x);
+    _mm_storeu_ps(f + 4 * i + 4, y);
+    _mm_storeu_ps(f + 4 * i + 8, z);
+    _mm_storeu_ps(f + 4 * i + 12, w);
+  }
+  _gasQuaternionNormalizeBatchScalar(q + i, n - i);
+}
+
+/* AVX2 */
+
+__attribute__((target("avx2")))
+static void _gasQuadInBatchAVX2(float const* t, float* out, size_t const n)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256 const x = _mm256_loadu_ps(t + i);
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(x, x));
+  }
+  _gasQuadInBatchScalar(t + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void _gasQuadOutBatchAVX2(float const* t, float* out, size_t const n)
+{
+  __m256 const two = _mm256_set1_ps(2.0f);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256 const x = _mm256_loadu_ps(t + i);
+    _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_mul_ps(two, x), _mm256_mul_ps(x, x)));
+  }
+  _gasQuadOutBatchScalar(t + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void _gasCurveBatchAVX2(gasEasingCurve const* curve, float const* t, float* out, size_t const n)
+{
+  float const* samples = curve->samples;
+  __m256 const zero = _mm256_setzero_ps();
+  __m256 const one = _mm256_set1_ps(1.0f);
+  __m256 const scale = _mm256_set1_ps(curve->scale);
+  __m256i const last = _mm256_set1_epi32((int) curve->resolution);
+  __m256i const next = _mm256_set1_epi32(1);
+  __m256 const lastSample = _mm256_set1_ps(samples[curve->resolution]);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256 const x = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(t + i), zero), one), scale);
+    __m256i index = _mm256_cvttps_epi32(x);
+    __m256i const top = _mm256_cmpeq_epi32(index, last);
+    index = _mm256_add_epi32(index, top);
+    __m256 const f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(index));
+
+    __m256 const a = _mm256_i32gather_ps(samples, index, 4);
+    __m256 const b = _mm256_i32gather_ps(samples, _mm256_add_epi32(index, next), 4);
+    __m256 const y = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), f));
+
+    _mm256_storeu_ps(out + i, _mm256_blendv_ps(y, lastSample, _mm256_castsi256_ps(top)));
+  }
+  _gasCurveBatchScalar(curve, t + i, out + i, n - i);
+}
+
+/* Eight quaternions at a time. Each register holds two quaternions and the
+ * transpose stays within 128-bit lanes, which is its own inverse. */
+__attribute__((target("avx2")))
+static void _gasQuaternionTransposeAVX2(__m256* a, __m256* b, __m256* c, __m256* d)
+{
+  __m256 const t0 = _mm256_unpacklo_ps(*a, *b);
+  __m256 const t1 = _mm256_unpacklo_ps(*c, *d);
+  __m256 const t2 = _mm256_unpackhi_ps(*a, *b);
+  __m256 const t3 = _mm256_unpackhi_ps(*c, *d);
+  *a = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+  *b = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+  *c = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  *d = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+__attribute__((target("avx2")))
+static void _gasQuaternionNormalizeBatchAVX2(kmQuaternion* q, size_t const n)
+{
+  __m256 const zero = _mm256_setzero_ps();
+  __m256 const one = _mm256_set1_ps(1.0f);
+  float* f = (float*) q;
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(f + 4 * i);
+    __m256 y = _mm256_loadu_ps(f + 4 * i + 8);
+    __m256 z = _mm256_loadu_ps(f + 4 * i + 16);
+    __m256 w = _mm256_loadu_ps(f + 4 * i + 24);
+    _gasQuaternionTransposeAVX2(&x, &y, &z, &w);
+
+    __m256 const squared = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)),
+                                                       _mm256_mul_ps(z, z)), _mm256_mul_ps(w, w));
+    __m256 const length = _mm256_sqrt_ps(squared);
+    __m256 const degenerate = _mm256_cmp_ps(length, zero, _CMP_EQ_OQ);
+    x = _mm256_andnot_ps(degenerate, _mm256_div_ps(x, length));
+    y = _mm256_andnot_ps(degenerate, _mm256_div_ps(y, length));
+    z = _mm256_andnot_ps(degenerate, _mm256_div_ps(z, length));
+    w = _mm256_blendv_ps(_mm256_div_ps(w, length), one, degenerate);
+
+    _gasQuaternionTransposeAVX2(&x, &y, &z, &w);
+    _mm256_storeu_ps(f + 4 * i, x);
+    _mm256_storeu_ps(f + 4 * i + 8, y);
+    _mm256_storeu_ps(f + 4 * i + 16, z);
+    _mm256_storeu_ps(f + 4 * i + 24, w);
+  }
+  _gasQuaternionNormalizeBatchScalar(q + i, n - i);
+}
+
+#endif
+
+static void _gasQuadInBatch(float const* t, float* out, size_t const n)
+{
+  switch (_gasSimdDetect())
+  {
+#ifdef GAS_SIMD_X86
+    case GAS_SIMD_AVX2: _gasQuadInBatchAVX2(t, out, n); break;
+    case GAS_SIMD_SSE2: _gasQuadInBatchSSE2(t, out, n); break;
+#endif
+    default: _gasQuadInBatchScalar(t, out, n); break;
+  }
+}
+
+static void _gasQuadOutBatch(float const* t, float* out, size_t const n)
+{
+  switch (_gasSimdDetect())
+  {
+#ifdef GAS_SIMD_X86
+    case GAS_SIMD_AVX2: _gasQuadOutBatchAVX2(t, out, n); break;
+    case GAS_SIMD_SSE2: _gasQuadOutBatchSSE2(t, out, n); break;
+#endif
+    default: _gasQuadOutBatchScalar(t, out, n); break;
+  }
+}
+
+static void _gasCurveBatch(gasEasingCurve const* curve, float const* t, float* out, size_t const n)
+{
+  switch (_gasSimdDetect())
+  {
+#ifdef GAS_SIMD_X86
+    case GAS_SIMD_AVX2: _gasCurveBatchAVX2(curve, t, out, n); break;
+    case GAS_SIMD_SSE2: _gasCurveBatchSSE2(curve, t, out, n); break;
+#endif
+    default: _gasCurveBatchScalar(curve, t, out, n); break;
+  }
+}
+
+void _gasQuaternionNormalizeBatch(kmQuaternion* q, size_t const n)
+{
+  switch (_gasSimdDetect())
+  {
+#ifdef GAS_SIMD_X86
+    case GAS_SIMD_AVX2: _gasQuaternionNormalizeBatchAVX2(q, n); break;
+    case GAS_SIMD_SSE2: _gasQuaternionNormalizeBatchSSE2(q, n); break;
+#endif
+    default: _gasQuaternionNormalizeBatchScalar(q, n); break;
+  }
+}
+
+void _gasEasingEvaluateBatch(_gasEasingId const id, gasEasingFunc easing, gasEasingCurve const* curve,
+                             float const* t, float* out, size_t const n)
+{
+  size_t i;
+  switch (id)
+  {
+    case GAS_EASING_ID_LINEAR:
+      if (out != t)
+        memmove(out, t, n * sizeof(float));
+      break;
+    case GAS_EASING_ID_QUAD_IN: _gasQuadInBatch(t, out, n); break;
+    case GAS_EASING_ID_QUAD_OUT: _gasQuadOutBatch(t, out, n); break;
+    case GAS_EASING_ID_EASE:
+    case GAS_EASING_ID_EASE_IN:
+    case GAS_EASING_ID_EASE_OUT:
+    case GAS_EASING_ID_EASE_IN_OUT: _gasCurveBatch(_gasEasingBuiltinCurve(id), t, out, n); break;
+    case GAS_EASING_ID_CURVE: _gasCurveBatch(curve, t, out, n); break;
+    default:
+      for (i = 0; i < n; ++i)
+      {
+        out[i] = easing(t[i]);
+      }
+      break;
+  }
+}
+
+void gasEasingEvaluateBatch(gasEasingId const easing, float const* t, float* out, size_t const n)
+{
+  if (easing < GAS_EASING_LINEAR || easing > GAS_EASING_EASE_IN_OUT)
+    return;
+
+  _gasEasingEvaluateBatch((_gasEasingId) easing, NULL, NULL, t, out, n);
+}
+
+void gasEasingCurveEvaluateBatch(gasEasingCurve const* curve, float const* t, float* out, size_t const n)
+{
+  _gasCurveBatch(curve, t, out, n);
+}
+
+void gasQuaternionNormalizeBatch(kmQuaternion* q, size_t const n)
+{
+  _gasQuaternionNormalizeBatch(q, n);
+}
+
+/* The blend is scalar and the normalization vectorized. Each output matches
+ * _gasQuaternionNlerp exactly. */
+void gasQuaternionNlerpBatch(kmQuaternion const* from, kmQuaternion const* to, float const* t,
+                             kmQuaternion* out, size_t const n)
+{
+  size_t i;
+  for (i = 0; i < n; ++i)
+  {
+    _gasQuaternionLerp(&from[i], &to[i], t[i], &out[i]);
+  }
+
+  _gasQuaternionNormalizeBatch(out, n);
+}
@@ -0,0 +1,472 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+/* Loop skipping
+ *
+ * When a loop finishes with more of the step left than another whole loop
+ * takes, the loops that would start and finish within the step are skipped
+ * instead of played and only the last, partial loop is evaluated. That
+ * needs the length of a loop to be known without playing it, and every loop
+ * to leave the object somewhere predictable. Channels written by anything
+ * but delta and from animations end every loop on the same value, which the
+ * loop that just finished has already written. Channels written only by
+ * delta and from animations move on by the same amount every loop, which is
+ * added once per skipped loop. Model and custom animations, infinite loops, delta rotations
+ * and parallel siblings writing the same channel rule skipping out. Actions
+ * in skipped loops fire, and their subtrees reset, as if the loops had been
+ * played, each firing as its loop ends. */
+
+static GAS_THREAD_LOCAL unsigned int suspended = 0;
+
+static unsigned short _gasLoopChannels(unsigned int const first, unsigned int const count)
+{
+  return ((1 << count) - 1) << first;
+}
+
+/* Channels animation may write. Custom animations and embedded programs
+ * could write any of them. */
+static unsigned short _gasAnimationChannels(gasAnimation* animation)
+{
+  unsigned short channels = 0;
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER: return _gasLoopChannels(animation->numberAnimation.target, 1);
+    case GAS_ANIMATION_TYPE_VECTOR: return _gasLoopChannels(animation->vectorAnimation.target * 3, 3);
+    case GAS_ANIMATION_TYPE_ROTATION: return _gasLoopChannels(GAS_NUMBER_ANIMATION_TARGET_ROT_X, 3);
+    case GAS_ANIMATION_TYPE_TRACK: return _gasLoopChannels(animation->trackAnimation.target, 1);
+    case GAS_ANIMATION_TYPE_PATH: return _gasLoopChannels(GAS_NUMBER_ANIMATION_TARGET_X, 3);
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        channels |= _gasAnimationChannels(animation->sequentialAnimation.children[i]);
+      }
+      return channels;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        channels |= _gasAnimationChannels(animation->parallelAnimation.children[i]);
+      }
+      return channels;
+    }
+    case GAS_ANIMATION_TYPE_CUSTOM:
+    case GAS_ANIMATION_TYPE_PROGRAM: return _gasLoopChannels(0, GAS_LOOP_CHANNELS);
+    default: return 0;
+  }
+}
+
+/* Delta animations capture where they start, so skipping loops of one while
+ * a parallel sibling also moves its channels would lose the sibling's
+ * writes. Parallel animations whose children overlap like that suspend
+ * skipping below them while they step. */
+gasBoolean _gasLoopChannelsOverlap(gasAnimation** animations, unsigned int const numAnimations)
+{
+  unsigned short seen = 0;
+  unsigned int i;
+  for (i = 0; i < numAnimations; ++i)
+  {
+    unsigned short const channels = _gasAnimationChannels(animations[i]);
+    if (channels & seen)
+      return GAS_TRUE;
+    seen |= channels;
+  }
+  return GAS_FALSE;
+}
+
+void _gasLoopSkipSuspend()
+{
+  suspended += 1;
+}
+
+void _gasLoopSkipResume()
+{
+  suspended -= 1;
+}
+
+gasBoolean _gasLoopSkipSuspended()
+{
+  return suspended > 0 ? GAS_TRUE : GAS_FALSE;
+}
+
+static float _gasLoopDuration(float const duration)
+{
+  return duration > 0.0f ? duration : 0.0f;
+}
+
+/* Where a number animation of type leaves channel after a loop. From
+ * animations return to where they started and to animations end where they
+ * were told to, but only with an easing that ends on 1; otherwise where they
+ * end depends on where they start. */
+static gasBoolean _gasLoopInfoChannel(_gasLoopInfo* info, unsigned int const channel,
+                                      _gasNumberAnimationType const type, float const b, float const end)
+{
+  unsigned short const bit = _gasLoopChannels(channel, 1);
+  switch (type)
+  {
+    case GAS_NUMBER_ANIMATION_TYPE_DELTA:
+    {
+      info->relative |= bit;
+      info->delta[channel] = b * end;
+      return GAS_TRUE;
+    }
+    case GAS_NUMBER_ANIMATION_TYPE_FROM:
+    {
+      info->relative |= bit;
+      info->delta[channel] = 0.0f;
+      return end == 1.0f ? GAS_TRUE : GAS_FALSE;
+    }
+    case GAS_NUMBER_ANIMATION_TYPE_TO:
+    {
+      info->absolute |= bit;
+      return end == 1.0f ? GAS_TRUE : GAS_FALSE;
+    }
+    default:
+    {
+      info->absolute |= bit;
+      return GAS_TRUE;
+    }
+  }
+}
+
+gasBoolean _gasLoopInfoNumber(_gasLoopInfo* info, _gasNumberAnimation const* number)
+{
+  info->duration = _gasLoopDuration(number->duration);
+  return _gasLoopInfoChannel(info, number->target, number->type, number->b,
+                             _gasEasingEnd(number->easing, number->curve));
+}
+
+gasBoolean _gasLoopInfoVector(_gasLoopInfo* info, _gasVectorAnimation const* vector)
+{
+  unsigned int const first = vector->target * 3;
+  float const end = _gasEasingEnd(vector->easing, vector->curve);
+  info->duration = _gasLoopDuration(vector->duration);
+  return _gasLoopInfoChannel(info, first, vector->type, vector->b.x, end)
+      && _gasLoopInfoChannel(info, first + 1, vector->type, vector->b.y, end)
+      && _gasLoopInfoChannel(info, first + 2, vector->type, vector->b.z, end)
+      ? GAS_TRUE
+      : GAS_FALSE;
+}
+
+/* Delta rotations compose orientations, which no per channel delta
+ * describes, and rotations to a target only end on it with an easing that
+ * ends on 1 */
+gasBoolean _gasLoopInfoRotation(_gasLoopInfo* info, _gasRotationAnimation const* rotation)
+{
+  if (rotation->type == GAS_NUMBER_ANIMATION_TYPE_DELTA
+      || (rotation->type == GAS_NUMBER_ANIMATION_TYPE_TO && _gasEasingEnd(rotation->easing, rotation->curve) != 1.0f))
+    return GAS_FALSE;
+
+  info->duration = _gasLoopDuration(rotation->duration);
+  info->absolute |= _gasLoopChannels(GAS_NUMBER_ANIMATION_TARGET_ROT_X, 3);
+  return GAS_TRUE;
+}
+
+void _gasLoopInfoTrack(_gasLoopInfo* info, _gasTrackAnimation const* track)
+{
+  info->duration = _gasLoopDuration(track->duration);
+  info->absolute |= _gasLoopChannels(track->target, 1);
+}
+
+void _gasLoopInfoPath(_gasLoopInfo* info, _gasPathAnimation const* path)
+{
+  info->duration = _gasLoopDuration(path->duration);
+  info->absolute |= _gasLoopChannels(GAS_NUMBER_ANIMATION_TARGET_X, 3);
+}
+
+void _gasLoopInfoPause(_gasLoopInfo* info, float const duration)
+{
+  info->duration = _gasLoopDuration(duration);
+}
+
+gasBoolean _gasLoopInfoRepeat(_gasLoopInfo* info, int const loops)
+{
+  if (loops < 0)
+    return GAS_FALSE;
+
+  if (loops == 0)
+  {
+    gasBoolean const actions = info->actions;
+    memset(info, 0, sizeof(_gasLoopInfo));
+    info->actions = actions;
+    return GAS_TRUE;
+  }
+
+  unsigned int i;
+  info->duration *= loops;
+  for (i = 0; i < GAS_LOOP_CHANNELS; ++i)
+  {
+    info->delta[i] *= loops;
+  }
+  return GAS_TRUE;
+}
+
+/* next plays after info. A channel next writes absolutely ends where next
+ * leaves it, one it moves relatively keeps what info made of it. */
+void _gasLoopInfoAppend(_gasLoopInfo* info, _gasLoopInfo const* next)
+{
+  info->duration += next->duration;
+  info->actions = info->actions || next->actions ? GAS_TRUE : GAS_FALSE;
+
+  unsigned int i;
+  for (i = 0; i < GAS_LOOP_CHANNELS; ++i)
+  {
+    unsigned short const bit = _gasLoopChannels(i, 1);
+    if (next->absolute & bit)
+    {
+      info->absolute |= bit;
+      info->relative &= ~bit;
+      info->delta[i] = 0.0f;
+    }
+    else if ((next->relative & bit) && !(info->absolute & bit))
+    {
+      info->relative |= bit;
+      info->delta[i] += next->delta[i];
+    }
+  }
+}
+
+/* other plays alongside info. Which of two parallel writers of a channel
+ * writes it last depends on how the loop was stepped, so they must not
+ * share any. */
+gasBoolean _gasLoopInfoMerge(_gasLoopInfo* info, _gasLoopInfo const* other)
+{
+  if ((info->relative | info->absolute) & (other->relative | other->absolute))
+    return GAS_FALSE;
+
+  unsigned int i;
+  for (i = 0; i < GAS_LOOP_CHANNELS; ++i)
+  {
+    if (other->relative & _gasLoopChannels(i, 1))
+      info->delta[i] = other->delta[i];
+  }
+
+  info->duration = other->duration > info->duration ? other->duration : info->duration;
+  info->relative |= other->relative;
+  info->absolute |= other->absolute;
+  info->actions = info->actions || other->actions ? GAS_TRUE : GAS_FALSE;
+  return GAS_TRUE;
+}
+
+/* Moves the relative channels on by count loops */
+void _gasLoopInfoApply(_gasLoopInfo const* info, glhckObject* object, unsigned int const count)
+{
+  float const loops = (float) count;
+  unsigned int i;
+  for (i = GAS_NUMBER_ANIMATION_TARGET_X; i <= GAS_NUMBER_ANIMATION_TARGET_ROT_Z; ++i)
+  {
+    if (info->relative & _gasLoopChannels(i, 1))
+    {
+      float const value = _gasNumberAnimationGetTargetValue(i, object);
+      _gasNumberAnimationSetTargetValue(i, object, value + loops * info->delta[i]);
+    }
+  }
+
+  unsigned int const scale = GAS_VECTOR_ANIMATION_TARGET_SCALE * 3;
+  if (info->relative & _gasLoopChannels(scale, 3))
+  {
+    kmVec3 value = _gasVectorAnimationGetTargetValue(GAS_VECTOR_ANIMATION_TARGET_SCALE, object);
+    value.x += loops * info->delta[scale];
+    value.y += loops * info->delta[scale + 1];
+    value.z += loops * info->delta[scale + 2];
+    _gasVectorAnimationSetTargetValue(GAS_VECTOR_ANIMATION_TARGET_SCALE, object, &value);
+  }
+}
+
+/* How many whole loops of what is left of a loop count fit in left */
+unsigned int _gasLoopSkipCount(float const duration, int const loop, int const loops, float const left)
+{
+  float const whole = floorf(left / duration);
+  unsigned int count = whole < (float) INT_MAX ? (unsigned int) whole : INT_MAX;
+  if (loops != -1 && count > (unsigned int) (loops - loop))
+  {
+    count = loops - loop;
+  }
+
+  while (count > 0 && (float) count * duration > left)
+  {
+    count -= 1;
+  }
+  return count;
+}
+
+static gasBoolean _gasAnimationChildLoopInfo(gasAnimation* child, float const limit, _gasLoopInfo* info)
+{
+  return _gasAnimationLoopInfo(child, limit, info)
+      && _gasLoopInfoRepeat(info, child->loops)
+      && info->duration <= limit
+      ? GAS_TRUE
+      : GAS_FALSE;
+}
+
+/* Describes one loop of animation, giving up as soon as it is known not to
+ * be skippable or to take longer than limit */
+gasBoolean _gasAnimationLoopInfo(gasAnimation* animation, float const limit, _gasLoopInfo* info)
+{
+  memset(info, 0, sizeof(_gasLoopInfo));
+
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_NUMBER:
+    {
+      if (!_gasLoopInfoNumber(info, &animation->numberAnimation))
+        return GAS_FALSE;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_VECTOR:
+    {
+      if (!_gasLoopInfoVector(info, &animation->vectorAnimation))
+        return GAS_FALSE;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_ROTATION:
+    {
+      if (!_gasLoopInfoRotation(info, animation->rotationAnimation))
+        return GAS_FALSE;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_TRACK: _gasLoopInfoTrack(info, &animation->trackAnimation); break;
+    case GAS_ANIMATION_TYPE_PATH: _gasLoopInfoPath(info, &animation->pathAnimation); break;
+    case GAS_ANIMATION_TYPE_PAUSE: _gasLoopInfoPause(info, animation->pauseAnimation.duration); break;
+    case GAS_ANIMATION_TYPE_ACTION: info->actions = GAS_TRUE; break;
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        _gasLoopInfo child;
+        if (!_gasAnimationChildLoopInfo(animation->sequentialAnimation.children[i], limit - info->duration, &child))
+          return GAS_FALSE;
+        _gasLoopInfoAppend(info, &child);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        _gasLoopInfo child;
+        if (!_gasAnimationChildLoopInfo(animation->parallelAnimation.children[i], limit, &child)
+            || !_gasLoopInfoMerge(info, &child))
+          return GAS_FALSE;
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      return _gasProgramLoopInfo(animation->programAnimation.program, animation->programAnimation.states, 0,
+                                 limit, info);
+    }
+    default: return GAS_FALSE;
+  }
+
+  return info->duration <= limit ? GAS_TRUE : GAS_FALSE;
+}
+
+static void _gasAnimationFireSkippedLoop(gasAnimation* animation, glhckObject* object, float const left,
+                                         gasBoolean const last)
+{
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_ACTION:
+    {
+      if (!animation->action.fireOnce || last)
+      {
+        gasAnimationState state;
+        _gasActionStep(&animation->action, &state, object, left);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = 0; i < animation->sequentialAnimation.numChildren; ++i)
+      {
+        _gasAnimationFireSkipped(animation->sequentialAnimation.children[i], object, left, last);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        _gasAnimationFireSkipped(animation->parallelAnimation.children[i], object, left, last);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      _gasProgramFireSkippedLoop(animation->programAnimation.program, animation->programAnimation.states, 0,
+                                 object, left, last);
+      break;
+    }
+    default: break;
+  }
+}
+
+/* Fires the actions of every loop of a freshly reset animation, resetting
+ * it between loops the way playing it would. Actions that fire once only
+ * fire in the last loop of the last skipped loop around them. */
+void _gasAnimationFireSkipped(gasAnimation* animation, glhckObject* object, float const left, gasBoolean const last)
+{
+  int i;
+  for (i = 0; i < animation->loops; ++i)
+  {
+    if (i > 0)
+    {
+      _gasAnimationResetCurrentLoop(animation);
+    }
+    _gasAnimationFireSkippedLoop(animation, object, left, last && i + 1 == animation->loops ? GAS_TRUE : GAS_FALSE);
+  }
+}
+
+/* Called at the start of a loop of a looping animation. Absolute channels
+ * are only where skipped loops would leave them if a loop has just ended,
+ * so before that only loops without any can be skipped. Returns whether any
+ * loops were skipped, taking them out of left. Skipping the last of a loop
+ * count finishes the animation. */
+gasBoolean _gasAnimationSkipLoops(gasAnimation* animation, glhckObject* object, gasBoolean const ended, float* left)
+{
+  if (animation->loops == 1 || suspended > 0)
+    return GAS_FALSE;
+
+  _gasLoopInfo info;
+  if (!_gasAnimationLoopInfo(animation, *left, &info) || info.duration <= 0.0f || (info.absolute && !ended))
+    return GAS_FALSE;
+
+  unsigned int const count = _gasLoopSkipCount(info.duration, animation->loop, animation->loops, *left);
+  if (count == 0)
+    return GAS_FALSE;
+
+  if (info.actions)
+  {
+    unsigned int i;
+    for (i = 0; i < count; ++i)
+    {
+      _gasLoopInfoApply(&info, object, 1);
+      _gasAnimationFireSkippedLoop(animation, object, *left - (float) (i + 1) * info.duration,
+                                   i + 1 == count ? GAS_TRUE : GAS_FALSE);
+      if (animation->loops == -1 || animation->loop + (int) i + 1 < animation->loops)
+        _gasAnimationResetCurrentLoop(animation);
+    }
+  }
+  else
+  {
+    _gasLoopInfoApply(&info, object, count);
+  }
+
+  if (animation->loops != -1)
+  {
+    animation->loop += count;
+    if (animation->loop >= animation->loops)
+      animation->state = GAS_ANIMATION_STATE_FINISHED;
+  }
+  *left -= (float) count * info.duration;
+  return GAS_TRUE;
+}
@@ -0,0 +1,159 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <string.h>
+
+/* Staged transform writes
+ *
+ * While a manager animates, number and vector animations read and write a
+ * staged copy of the current object's position and rotation instead of
+ * going through glhck for every channel. The staged vectors are committed
+ * with one setter call each when channels move on to another object, when
+ * the manager finishes, and before any user callback runs so callbacks
+ * always see, and may change, the current transform. Channels of one object
+ * follow each other in batch groups and animation trees, so this commits
+ * once per object per frame in the common cases without keeping a table of
+ * every object touched. The active stage is per thread, so each worker of a
+ * threaded manager stages into the stage of the shard it is advancing. */
+
+#define GAS_STAGE_POSITION_LOADED 0x1
+#define GAS_STAGE_POSITION_DIRTY 0x2
+#define GAS_STAGE_ROTATION_LOADED 0x4
+#define GAS_STAGE_ROTATION_DIRTY 0x8
+
+static GAS_THREAD_LOCAL _gasStagedTransform* activeStage = NULL;
+
+void _gasTransformStageInit(_gasStagedTransform* stage)
+{
+  memset(stage, 0, sizeof(_gasStagedTransform));
+}
+
+_gasStagedTransform* _gasTransformStageBegin(_gasStagedTransform* stage)
+{
+  _gasTransformStageFlush();
+  _gasStagedTransform* previous = activeStage;
+  activeStage = stage;
+  return previous;
+}
+
+void _gasTransformStageEnd(_gasStagedTransform* previous)
+{
+  _gasTransformStageFlush();
+  activeStage = previous;
+}
+
+void _gasTransformStageFlush()
+{
+  _gasStagedTransform* transform = activeStage;
+  if (!transform || !transform->object)
+    return;
+
+  if (transform->flags & GAS_STAGE_POSITION_DIRTY)
+    glhckObjectPosition(transform->object, &transform->position);
+  if (transform->flags & GAS_STAGE_ROTATION_DIRTY)
+    glhckObjectRotation(transform->object, &transform->rotation);
+
+  transform->object = NULL;
+  transform->flags = 0;
+}
+
+static _gasStagedTransform* _gasTransformStageGet(glhckObject* object)
+{
+  _gasStagedTransform* transform = activeStage;
+  if (transform->object != object)
+  {
+    _gasTransformStageFlush();
+    transform->object = object;
+  }
+  return transform;
+}
+
+static kmVec3* _gasStagedPosition(_gasStagedTransform* transform)
+{
+  if (!(transform->flags & GAS_STAGE_POSITION_LOADED))
+  {
+    transform->position = *glhckObjectGetPosition(transform->object);
+    transform->flags |= GAS_STAGE_POSITION_LOADED;
+  }
+  return &transform->position;
+}
+
+static kmVec3* _gasStagedRotation(_gasStagedTransform* transform)
+{
+  if (!(transform->flags & GAS_STAGE_ROTATION_LOADED))
+  {
+    transform->rotation = *glhckObjectGetRotation(transform->object);
+    transform->flags |= GAS_STAGE_ROTATION_LOADED;
+  }
+  return &transform->rotation;
+}
+
+gasBoolean _gasTransformStageActive()
+{
+  return activeStage ? GAS_TRUE : GAS_FALSE;
+}
+
+float _gasTransformStageGetValue(gasNumberAnimationTarget target, glhckObject* object)
+{
+  _gasStagedTransform* transform = _gasTransformStageGet(object);
+  switch (target)
+  {
+    case GAS_NUMBER_ANIMATION_TARGET_X: return _gasStagedPosition(transform)->x;
+    case GAS_NUMBER_ANIMATION_TARGET_Y: return _gasStagedPosition(transform)->y;
+    case GAS_NUMBER_ANIMATION_TARGET_Z: return _gasStagedPosition(transform)->z;
+    case GAS_NUMBER_ANIMATION_TARGET_ROT_X: return _gasStagedRotation(transform)->x;
+    case GAS_NUMBER_ANIMATION_TARGET_ROT_Y: return _gasStagedRotation(transform)->y;
+    case GAS_NUMBER_ANIMATION_TARGET_ROT_Z: return _gasStagedRotation(transform)->z;
+    default: return 0;
+  }
+}
+
+void _gasTransformStageSetValue(gasNumberAnimationTarget target, glhckObject* object, float const value)
+{
+  _gasStagedTransform* transform = _gasTransformStageGet(object);
+  switch (target)
+  {
+    case GAS_NUMBER_ANIMATION_TARGET_X: _gasStagedPosition(transform)->x = value; break;
+    case GAS_NUMBER_ANIMATION_TARGET_Y: _gasStagedPosition(transform)->y = value; break;
+    case GAS_NUMBER_ANIMATION_TARGET_Z: _gasStagedPosition(transform)->z = value; break;
+    case GAS_NUMBER_ANIMATION_TARGET_ROT_X: _gasStagedRotation(transform)->x = value; break;
+    case GAS_NUMBER_ANIMATION_TARGET_ROT_Y: _gasStagedRotation(transform)->y = value; break;
+    case GAS_NUMBER_ANIMATION_TARGET_ROT_Z: _gasStagedRotation(transform)->z = value; break;
+    default: return;
+  }
+
+  transform->flags |= target <= GAS_NUMBER_ANIMATION_TARGET_Z ? GAS_STAGE_POSITION_DIRTY : GAS_STAGE_ROTATION_DIRTY;
+}
+
+/* Vector animations replace a whole vector, so a staged write needs no load.
+ * Scale is not staged: nothing else writes it in pieces. */
+kmVec3 _gasTransformStageGetVector(gasVectorAnimationTarget target, glhckObject* object)
+{
+  switch (target)
+  {
+    case GAS_VECTOR_ANIMATION_TARGET_POSITION: return *_gasStagedPosition(_gasTransformStageGet(object));
+    case GAS_VECTOR_ANIMATION_TARGET_ROTATION: return *_gasStagedRotation(_gasTransformStageGet(object));
+    default: return *glhckObjectGetScale(object);
+  }
+}
+
+void _gasTransformStageSetVector(gasVectorAnimationTarget target, glhckObject* object, kmVec3 const* value)
+{
+  if (target == GAS_VECTOR_ANIMATION_TARGET_SCALE)
+  {
+    glhckObjectScale(object, value);
+    return;
+  }
+
+  _gasStagedTransform* transform = _gasTransformStageGet(object);
+  if (target == GAS_VECTOR_ANIMATION_TARGET_POSITION)
+  {
+    transform->position = *value;
+    transform->flags |= GAS_STAGE_POSITION_LOADED | GAS_STAGE_POSITION_DIRTY;
+  }
+  else
+  {
+    transform->rotation = *value;
+    transform->flags |= GAS_STAGE_ROTATION_LOADED | GAS_STAGE_ROTATION_DIRTY;
+  }
+}
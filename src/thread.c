@@ -0,0 +1,156 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Worker threads for threaded managers
+ *
+ * The thread calling _gasThreadPoolDispatch works as worker 0 and the pool's
+ * own threads as the rest. Threads sleep on a condition variable between
+ * dispatches and notice new work by a generation counter, so a spurious
+ * wakeup never runs a task twice. */
+
+struct _gasThreadPool
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  pthread_t* threads;
+  unsigned int numThreads;
+  unsigned int generation;
+  unsigned int pending;
+  gasBoolean quit;
+  gasTaskFunc run;
+  void* task;
+};
+
+typedef struct _gasThreadPoolWorker
+{
+  _gasThreadPool* pool;
+  unsigned int index;
+} _gasThreadPoolWorker;
+
+static void* _gasThreadPoolMain(void* argument)
+{
+  _gasThreadPoolWorker* worker = argument;
+  _gasThreadPool* pool = worker->pool;
+  unsigned int const index = worker->index;
+  unsigned int generation = 0;
+  free(worker);
+
+  pthread_mutex_lock(&pool->mutex);
+  for (;;)
+  {
+    while (pool->generation == generation && !pool->quit)
+    {
+      pthread_cond_wait(&pool->wake, &pool->mutex);
+    }
+
+    if (pool->quit)
+      break;
+
+    generation = pool->generation;
+    gasTaskFunc const run = pool->run;
+    void* task = pool->task;
+    pthread_mutex_unlock(&pool->mutex);
+
+    run(task, index);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->pending -= 1;
+    if (pool->pending == 0)
+      pthread_cond_signal(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return NULL;
+}
+
+unsigned int _gasProcessorCount()
+{
+  long const count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (unsigned int) count : 1;
+}
+
+_gasThreadPool* _gasThreadPoolNew(unsigned int const numThreads)
+{
+  _gasThreadPool* pool = calloc(1, sizeof(_gasThreadPool));
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->threads = calloc(numThreads, sizeof(pthread_t));
+  pool->numThreads = 1;
+
+  unsigned int i;
+  for (i = 1; i < numThreads; ++i)
+  {
+    _gasThreadPoolWorker* worker = malloc(sizeof(_gasThreadPoolWorker));
+    worker->pool = pool;
+    worker->index = i;
+    if (pthread_create(&pool->threads[pool->numThreads - 1], NULL, _gasThreadPoolMain, worker) != 0)
+    {
+      free(worker);
+      break;
+    }
+    pool->numThreads += 1;
+  }
+
+  return pool;
+}
+
+void _gasThreadPoolFree(_gasThreadPool* pool)
+{
+  pthread_mutex_lock(&pool->mutex);
+  pool->quit = GAS_TRUE;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->mutex);
+
+  unsigned int i;
+  for (i = 0; i + 1 < pool->numThreads; ++i)
+  {
+    pthread_join(pool->threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool->threads);
+  free(pool);
+}
+
+/* Workers that failed to start are left out, so this may be less than asked
+ * for in _gasThreadPoolNew */
+unsigned int _gasThreadPoolSize(_gasThreadPool* pool)
+{
+  return pool->numThreads;
+}
+
+void _gasThreadPoolDispatch(gasTaskFunc run, void* task, unsigned int numWorkers, void* userdata)
+{
+  _gasThreadPool* pool = userdata;
+  (void) numWorkers;
+
+  if (pool->numThreads > 1)
+  {
+    pthread_mutex_lock(&pool->mutex);
+    pool->run = run;
+    pool->task = task;
+    pool->pending = pool->numThreads - 1;
+    pool->generation += 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mutex);
+  }
+
+  run(task, 0);
+
+  if (pool->numThreads > 1)
+  {
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pending > 0)
+    {
+      pthread_cond_wait(&pool->done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+  }
+}
@@ -0,0 +1,128 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Keyframe tracks
+ *
+ * A track remembers the key closing the span it was last in. Playing moves
+ * time forward by less than a span most steps, so the cursor is checked
+ * first and the few keys after it next, and only a jump any further, such
+ * as sampling or the first step after a reset, searches the keys. */
+
+#define GAS_TRACK_SCAN 4
+
+gasAnimation* gasTrackAnimationNew(gasNumberAnimationTarget const target, gasKeyframe const* keys,
+                                   unsigned int const numKeys)
+{
+  _gasTrackKeys* trackKeys = _gasTrackKeysNew(keys, numKeys);
+  if (!trackKeys)
+    return NULL;
+
+  gasAnimation* animation = _gasAnimationNew(GAS_ANIMATION_TYPE_TRACK);
+  animation->trackAnimation.target = target;
+  animation->trackAnimation.duration = trackKeys->keys[numKeys - 1].time;
+  animation->trackAnimation.time = 0.0f;
+  animation->trackAnimation.cursor = 0;
+  animation->trackAnimation.keys = trackKeys;
+  return animation;
+}
+
+/* Keys without an easing are linear unless they have a curve. Times must
+ * not be negative, NaN or out of order. */
+_gasTrackKeys* _gasTrackKeysNew(gasKeyframe const* keys, unsigned int const numKeys)
+{
+  unsigned int i;
+  if (numKeys == 0)
+    return NULL;
+
+  for (i = 0; i < numKeys; ++i)
+  {
+    if (!(keys[i].time >= (i > 0 ? keys[i - 1].time : 0.0f)))
+      return NULL;
+  }
+
+  _gasTrackKeys* trackKeys = malloc(sizeof(_gasTrackKeys) + numKeys * sizeof(gasKeyframe));
+  trackKeys->references = 1;
+  trackKeys->numKeys = numKeys;
+  memcpy(trackKeys->keys, keys, numKeys * sizeof(gasKeyframe));
+  for (i = 0; i < numKeys; ++i)
+  {
+    if (!trackKeys->keys[i].easing)
+    {
+      trackKeys->keys[i].easing = gasEasingLinear;
+    }
+  }
+  return trackKeys;
+}
+
+void _gasTrackKeysRetain(_gasTrackKeys* keys)
+{
+  __atomic_add_fetch(&keys->references, 1, __ATOMIC_RELAXED);
+}
+
+void _gasTrackKeysRelease(_gasTrackKeys* keys)
+{
+  if (__atomic_sub_fetch(&keys->references, 1, __ATOMIC_ACQ_REL) == 0)
+    free(keys);
+}
+
+/* The first key at or after time, or the last key from its time on. Keys
+ * sharing a time make a jump from the first of them to the last. */
+unsigned int _gasTrackSeek(_gasTrackKeys const* keys, unsigned int const cursor, float const time)
+{
+  gasKeyframe const* key = keys->keys;
+  unsigned int const last = keys->numKeys - 1;
+  if (time >= key[last].time)
+    return last;
+
+  unsigned int i;
+  for (i = cursor; i <= last && i <= cursor + GAS_TRACK_SCAN; ++i)
+  {
+    if (key[i].time >= time && (i == 0 || key[i - 1].time < time))
+      return i;
+  }
+
+  unsigned int low = 0;
+  unsigned int high = last;
+  while (low < high)
+  {
+    unsigned int const middle = low + (high - low) / 2;
+    if (key[middle].time >= time)
+      high = middle;
+    else
+      low = middle + 1;
+  }
+  return low;
+}
+
+float _gasTrackValue(_gasTrackKeys const* keys, unsigned int const cursor, float const time)
+{
+  gasKeyframe const* to = &keys->keys[cursor];
+  if (cursor == 0)
+    return to->value;
+
+  gasKeyframe const* from = to - 1;
+  float const span = to->time - from->time;
+  float const x = span > 0.0f ? _gasClamp((time - from->time) / span, 0.0f, 1.0f) : 1.0f;
+  float const t = to->curve ? _gasEasingCurveEvaluate(to->curve, x) : to->easing(x);
+  return from->value + (to->value - from->value) * t;
+}
+
+float _gasTrackAnimationStep(_gasTrackAnimation* track, gasAnimationState* state, glhckObject* object, float const delta)
+{
+  track->time += delta;
+
+  *state = track->time >= track->duration
+      ? GAS_ANIMATION_STATE_FINISHED
+      : GAS_ANIMATION_STATE_RUNNING;
+
+  float const time = track->time < track->duration ? track->time : track->duration;
+  track->cursor = _gasTrackSeek(track->keys, track->cursor, time);
+  _gasNumberAnimationSetTargetValue(track->target, object, _gasTrackValue(track->keys, track->cursor, time));
+
+  return track->time >= track->duration
+      ? track->time - track->duration
+      : 0;
+}
@@ -0,0 +1,247 @@
+#include "gas.h"
+#include "internal.h"
+
+#include <math.h>
+#include <string.h>
+
+/* Parking idle animations
+ *
+ * An animation whose next change lies in the future, like one waiting out a
+ * pause, does nothing but count time until then. Managers take such entries
+ * off their shard's list and park them in a hierarchical timing wheel keyed
+ * by the tick they are due, so they cost nothing per frame while they wait.
+ * Entries wake a tick before they are due, catch up on the time they were
+ * parked for in their next step and then run as usual. Waking early is
+ * always safe, so entries that are paused, removed or resharded are simply
+ * woken up. */
+
+#define GAS_WHEEL_SLOT_MASK ((unsigned long long) GAS_WHEEL_SLOTS - 1)
+
+static unsigned int _gasTimingWheelShift(unsigned int const level)
+{
+  return GAS_WHEEL_LEVEL_BITS * level;
+}
+
+unsigned long long _gasTimingWheelTick(double const time)
+{
+  return (unsigned long long) (time * GAS_WHEEL_TICKS_PER_SECOND);
+}
+
+void _gasTimingWheelInit(_gasTimingWheel* wheel, unsigned long long const tick)
+{
+  memset(wheel, 0, sizeof(_gasTimingWheel));
+  wheel->tick = tick;
+}
+
+/* Entries go to the lowest level whose slots tell their tick apart from the
+ * current one, which is always a slot the wheel has yet to reach. Ticks
+ * beyond the top level wait in its last slot and are placed again when it
+ * is cascaded. */
+static _gasManagerAnimation** _gasTimingWheelSlot(_gasTimingWheel* wheel, unsigned long long const wake)
+{
+  unsigned int level;
+  for (level = 0; level < GAS_WHEEL_LEVELS; ++level)
+  {
+    unsigned int const shift = _gasTimingWheelShift(level + 1);
+    if (wake >> shift == wheel->tick >> shift)
+      return &wheel->slots[level][(wake >> _gasTimingWheelShift(level)) & GAS_WHEEL_SLOT_MASK];
+  }
+
+  level = GAS_WHEEL_LEVELS - 1;
+  return &wheel->slots[level][((wheel->tick >> _gasTimingWheelShift(level)) - 1) & GAS_WHEEL_SLOT_MASK];
+}
+
+static void _gasTimingWheelLink(_gasManagerAnimation** slot, _gasManagerAnimation* entry)
+{
+  entry->next = *slot;
+  entry->prev = slot;
+  if (*slot)
+    (*slot)->prev = &entry->next;
+  *slot = entry;
+}
+
+/* entry->wake must lie after the current tick */
+void _gasTimingWheelInsert(_gasTimingWheel* wheel, _gasManagerAnimation* entry)
+{
+  _gasTimingWheelLink(_gasTimingWheelSlot(wheel, entry->wake), entry);
+  wheel->numEntries += 1;
+}
+
+void _gasTimingWheelUnlink(_gasTimingWheel* wheel, _gasManagerAnimation* entry)
+{
+  *entry->prev = entry->next;
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  entry->next = NULL;
+  entry->prev = NULL;
+  wheel->numEntries -= 1;
+}
+
+/* Takes every entry off the wheel and returns them linked through next */
+_gasManagerAnimation* _gasTimingWheelDrain(_gasTimingWheel* wheel)
+{
+  _gasManagerAnimation* drained = NULL;
+  unsigned int level, slot;
+  for (level = 0; level < GAS_WHEEL_LEVELS; ++level)
+  {
+    for (slot = 0; slot < GAS_WHEEL_SLOTS; ++slot)
+    {
+      while (wheel->slots[level][slot])
+      {
+        _gasManagerAnimation* entry = wheel->slots[level][slot];
+        wheel->slots[level][slot] = entry->next;
+        entry->next = drained;
+        entry->prev = NULL;
+        drained = entry;
+      }
+    }
+  }
+  wheel->numEntries = 0;
+  return drained;
+}
+
+/* Moves the wheel on to tick and returns the entries due by then linked
+ * through next. Long jumps drain the wheel and place the entries not yet
+ * due again rather than turning it tick by tick. */
+_gasManagerAnimation* _gasTimingWheelAdvance(_gasTimingWheel* wheel, unsigned long long const tick)
+{
+  _gasManagerAnimation* due = NULL;
+  if (tick <= wheel->tick)
+    return due;
+
+  if (tick - wheel->tick > GAS_WHEEL_SLOTS)
+  {
+    _gasManagerAnimation* drained = _gasTimingWheelDrain(wheel);
+    wheel->tick = tick;
+    while (drained)
+    {
+      _gasManagerAnimation* entry = drained;
+      drained = entry->next;
+      if (entry->wake <= tick)
+      {
+        entry->next = due;
+        due = entry;
+        continue;
+      }
+      _gasTimingWheelInsert(wheel, entry);
+    }
+    return due;
+  }
+
+  while (wheel->tick < tick)
+  {
+    wheel->tick += 1;
+
+    unsigned int level;
+    for (level = GAS_WHEEL_LEVELS - 1; level > 0; --level)
+    {
+      if (wheel->tick & ((1ull << _gasTimingWheelShift(level)) - 1))
+        continue;
+
+      _gasManagerAnimation** slot = &wheel->slots[level][(wheel->tick >> _gasTimingWheelShift(level)) & GAS_WHEEL_SLOT_MASK];
+      _gasManagerAnimation* cascaded = *slot;
+      *slot = NULL;
+      while (cascaded)
+      {
+        _gasManagerAnimation* entry = cascaded;
+        cascaded = entry->next;
+        _gasTimingWheelLink(_gasTimingWheelSlot(wheel, entry->wake), entry);
+      }
+    }
+
+    _gasManagerAnimation** slot = &wheel->slots[0][wheel->tick & GAS_WHEEL_SLOT_MASK];
+    while (*slot)
+    {
+      _gasManagerAnimation* entry = *slot;
+      *slot = entry->next;
+      entry->next = due;
+      entry->prev = NULL;
+      due = entry;
+      wheel->numEntries -= 1;
+    }
+  }
+
+  return due;
+}
+
+/* Finds the parked entry animating animation */
+_gasManagerAnimation* _gasTimingWheelFind(_gasTimingWheel* wheel, gasAnimation* animation)
+{
+  if (wheel->numEntries == 0)
+    return NULL;
+
+  unsigned int level, slot;
+  for (level = 0; level < GAS_WHEEL_LEVELS; ++level)
+  {
+    for (slot = 0; slot < GAS_WHEEL_SLOTS; ++slot)
+    {
+      _gasManagerAnimation* entry;
+      for (entry = wheel->slots[level][slot]; entry; entry = entry->next)
+      {
+        if (entry->animation == animation)
+          return entry;
+      }
+    }
+  }
+  return NULL;
+}
+
+/* Time animation can advance by without writing, firing or finishing
+ * anything. through tells whether it stays idle until it finishes. */
+float _gasAnimationIdle(gasAnimation* animation, gasBoolean* through)
+{
+  *through = GAS_TRUE;
+  if (animation->state == GAS_ANIMATION_STATE_FINISHED || !_gasLoopsLeft(animation))
+    return 0.0f;
+
+  float idle = 0.0f;
+  gasBoolean childThrough;
+  unsigned int i;
+  switch (animation->type)
+  {
+    case GAS_ANIMATION_TYPE_PAUSE:
+    {
+      idle = animation->pauseAnimation.duration - animation->pauseAnimation.time;
+      break;
+    }
+    case GAS_ANIMATION_TYPE_SEQUENTIAL:
+    {
+      for (i = animation->sequentialAnimation.currentIndex; i < animation->sequentialAnimation.numChildren && *through; ++i)
+      {
+        idle += _gasAnimationIdle(animation->sequentialAnimation.children[i], through);
+      }
+      break;
+    }
+    case GAS_ANIMATION_TYPE_PARALLEL:
+    {
+      idle = INFINITY;
+      for (i = 0; i < animation->parallelAnimation.numChildren; ++i)
+      {
+        gasAnimation* child = animation->parallelAnimation.children[i];
+        if (child->state == GAS_ANIMATION_STATE_FINISHED || !_gasLoopsLeft(child))
+          continue;
+
+        float const childIdle = _gasAnimationIdle(child, &childThrough);
+        idle = childIdle < idle ? childIdle : idle;
+      }
+      *through = GAS_FALSE;
+      return idle < INFINITY ? idle : 0.0f;
+    }
+    case GAS_ANIMATION_TYPE_PROGRAM:
+    {
+      idle = _gasProgramIdle(animation->programAnimation.program, animation->programAnimation.states, 0, through);
+      break;
+    }
+    default:
+    {
+      *through = GAS_FALSE;
+      return 0.0f;
+    }
+  }
+
+  /* Loops after this one start over, which is left for the next step */
+  if (animation->loops == -1 || animation->loop + 1 < animation->loops)
+    *through = GAS_FALSE;
+
+  return idle;
+}
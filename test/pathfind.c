@@ -228,23 +228,6 @@ LevelPosition* findPath(int fromX, int fromZ, int toX, int toZ, int* level, int
   return path;
 }
 
-gasAnimation* moveStep(kmVec3 const* from, kmVec3 const* to)
-{
-  gasAnimation* x = gasNumberAnimationNewFromTo(GAS_NUMBER_ANIMATION_TARGET_X, gasEasingLinear, from->x, to->x, 1.0f);
-  float peak = (from->y > to->y ? from->y : to->y) + 4.0f;
-  float t = (from->y > to->y ? 0.3f : from->y < to->y ? 0.7f : 0.5f);
-  gasAnimation* ys[2] = {
-    gasNumberAnimationNewFromTo(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadOut, from->y, peak, t),
-    gasNumberAnimationNewFromTo(GAS_NUMBER_ANIMATION_TARGET_Y, gasEasingQuadIn, peak, to->y, 1.0f - t)
-  };
-  gasAnimation* y = gasSequentialAnimationNew(ys, 2);
-
-  gasAnimation* z = gasNumberAnimationNewFromTo(GAS_NUMBER_ANIMATION_TARGET_Z, gasEasingLinear, from->z, to->z, 1.0f);
-  gasAnimation* animations[] = {x, y, z};
-  return gasParallelAnimationNew(animations, 3);
-}
-
-
 gasAnimation* move(int fromX, int fromZ, int toX, int toZ, int* level, int levelSize)
 {
   int pathLength;
@@ -255,22 +238,19 @@ gasAnimation* move(int fromX, int fromZ, int toX, int toZ, int* level, int level
     return NULL;
   }
 
-  gasAnimation** animations = calloc(pathLength - 1, sizeof(gasAnimation*));
+  kmVec3* points = calloc(pathLength, sizeof(kmVec3));
 
   int i;
-  for(i = 1; i < pathLength; ++i)
+  for(i = 0; i < pathLength; ++i)
   {
-    kmVec3 from = { path[i-1].x * GRID_SIZE,
-                    (level[path[i-1].x + path[i-1].z * levelSize]) * GRID_SIZE + GRID_SIZE/4,
-                    (path[i-1].z) * GRID_SIZE};
-    kmVec3 to = { path[i].x * GRID_SIZE,
-                  (level[path[i].x + path[i].z * levelSize]) * GRID_SIZE + GRID_SIZE/4,
-                  path[i].z * GRID_SIZE};
-    animations[i - 1] = moveStep(&from, &to);
+    points[i].x = path[i].x * GRID_SIZE;
+    points[i].y = (level[path[i].x + path[i].z * levelSize]) * GRID_SIZE + GRID_SIZE/4;
+    points[i].z = path[i].z * GRID_SIZE;
   }
 
-  gasAnimation* animation = gasSequentialAnimationNew(animations, pathLength - 1);
-  free(animations);
+  gasAnimation* animation = gasPathAnimationNew(GAS_PATH_LINEAR, gasEasingLinear, points, pathLength, 4.0f,
+                                                pathLength - 1);
+  free(points);
   free(path);
 
   return animation;